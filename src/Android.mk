@@ -26,7 +26,7 @@ include $(CLEAR_VARS)
 
 LOCAL_C_INCLUDES:= $(LOCAL_PATH)/llaudio $(LOCAL_PATH)/../external/include
 LOCAL_MODULE    := soundalchemy
-LOCAL_SRC_FILES := main.cpp logs.cpp dspserver.cpp clientconnector.cpp message.cpp androidconnector.cpp thread.cpp soundeffect.cpp effectdatabase.cpp ladspaeffect.cpp
+LOCAL_SRC_FILES := main.cpp logs.cpp dspserver.cpp clientconnector.cpp message.cpp androidconnector.cpp thread.cpp soundeffect.cpp effectdatabase.cpp ladspaeffect.cpp nativeeffect.cpp parametriceq.cpp fft.cpp convolution.cpp oversampler.cpp resampler.cpp latencyprobe.cpp clockbridge.cpp driftbuffer.cpp aggregatedevice.cpp binaryprotocol.cpp controlmap.cpp midiconnector.cpp socketconnector.cpp analyzer.cpp tuner.cpp sharedcontrol.cpp audioexport.cpp jitterprobe.cpp
 LOCAL_STATIC_LIBRARIES := libllaudio  
 LOCAL_LDLIBS += -L$(LOCAL_PATH)/../external/lib/arm_androideabi -lsalsa -ljsoncpp -llog
 
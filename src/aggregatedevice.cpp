@@ -0,0 +1,436 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "aggregatedevice.h"
+#include "logs.h"
+#include <cstring>
+
+using namespace llaudio;
+
+namespace soundalchemy {
+
+// Finds the device of a member.
+static llaDevice* findDevice(const AggregateMember& member) {
+	llaDevice& device =
+			llaDeviceManager::getInstance().getDevice(member.device.c_str());
+	if(device.isNull()) {
+		log(LEVEL_ERROR, "The member device %s of the aggregate is not found",
+				member.device.c_str());
+		return NULL;
+	}
+	return &device;
+}
+
+// AggregateInput //////////////////////////////////////////////////////////////
+//
+AggregateInput::AggregateInput(const TAggregateMembers& members):
+		relay_(*this), members_(members), rate_(SR_DEFAULT), opened_(false) {
+	for(unsigned int i = 1; i < members_.size(); i++) {
+		captures_.push_back(new Capture());
+	}
+}
+
+AggregateInput::~AggregateInput() {
+	close();
+	for(unsigned int i = 0; i < captures_.size(); i++) delete captures_[i];
+}
+
+TErrors AggregateInput::resolve(void) {
+	streams_.clear();
+	for(unsigned int i = 0; i < members_.size(); i++) {
+		llaDevice* device = findDevice(members_[i]);
+
+		// all the channels of the member are used, the most are asked for
+		llaInputStream* stream = device == NULL ? NULL :
+				&device->getInputStream(members_[i].stream, rate_, CH_MAX);
+		if(stream == NULL || stream->isNull()) {
+			streams_.clear();
+			return E_OPEN_STREAM;
+		}
+		streams_.push_back(stream);
+	}
+	return streams_.empty() ? E_OPEN_STREAM : llaudio::E_OK;
+}
+
+TErrors AggregateInput::open(void) {
+	if(opened_) return llaudio::E_OK;
+
+	TErrors ret = resolve();
+	for(unsigned int i = 0; ret == llaudio::E_OK && i < streams_.size(); i++) {
+		ret = streams_[i]->open();
+	}
+
+	if(ret != llaudio::E_OK) {
+		for(unsigned int i = 0; i < streams_.size(); i++) streams_[i]->close();
+		return ret;
+	}
+	opened_ = true;
+	return llaudio::E_OK;
+}
+
+void AggregateInput::close(void) {
+	if(!opened_) return;
+	for(unsigned int i = 0; i < streams_.size(); i++) streams_[i]->close();
+	opened_ = false;
+}
+
+TErrors AggregateInput::setSampleRate(TSampleRate sample_rate) {
+	rate_ = sample_rate;
+	return llaudio::E_OK;
+}
+
+TSampleRate AggregateInput::getSampleRate(void) {
+	return streams_.empty() ? rate_ : streams_[0]->getSampleRate();
+}
+
+TChannels AggregateInput::getChannelCount(void) {
+	unsigned int channels = 0;
+	for(unsigned int i = 0; i < streams_.size(); i++) {
+		channels += streams_[i]->getChannelCount();
+	}
+	return (TChannels) channels;
+}
+
+double AggregateInput::getLatency(void) {
+	if(streams_.empty()) return llaStream::getLatency();
+
+	double latency = streams_[0]->getLatency();
+	for(unsigned int i = 1; i < streams_.size(); i++) {
+		double l = streams_[i]->getLatency() +
+				captures_[i - 1]->getDriftBuffer().getLatency();
+		if(l > latency) latency = l;
+	}
+	return latency;
+}
+
+unsigned long AggregateInput::getXrunCount(void) {
+	unsigned long xruns = 0;
+	for(unsigned int i = 0; i < captures_.size(); i++) {
+		xruns += captures_[i]->getDriftBuffer().getXrunCount();
+	}
+	for(unsigned int i = 0; i < streams_.size(); i++) {
+		xruns += streams_[i]->getXrunCount();
+	}
+	return xruns;
+}
+
+TErrors AggregateInput::connect(llaOutputStream* output, llaAudioPipe& buffer) {
+	TErrors ret = open();
+	if(ret != llaudio::E_OK) return ret;
+
+	// the captured members are resampled to the rate of the first one
+	TSize frames = buffer.getBufferLength();
+	TSampleRate rate = streams_[0]->getSampleRate();
+	unsigned int started = 0;
+	for(; ret == llaudio::E_OK && started < captures_.size(); started++) {
+		ret = captures_[started]->start(*streams_[started + 1], rate, frames);
+	}
+
+	if(ret == llaudio::E_OK) {
+		pipe_.setup(buffer);
+		pipe_.setBufferLength(frames);
+		relay_.setup(output, buffer);
+		ret = streams_[0]->connect(&relay_, pipe_);
+	}
+
+	for(unsigned int i = 0; i < started; i++) captures_[i]->stop();
+	close();
+	return ret;
+}
+
+void AggregateInput::Relay::setup(llaOutputStream* output,
+		llaAudioPipe& buffer) {
+	output_ = output;
+	buffer_ = &buffer;
+	alloc_ = true;
+}
+
+TErrors AggregateInput::Relay::write(llaAudioPipe& buffer) {
+	llaAudioPipe::Buffer& in = buffer_->getInputBuffer();
+	if(alloc_) {
+		in.organizationRequested = llaAudioPipe::NON_INTERLEAVED;
+		in.formatRequested = llaAudioPipe::FORMAT_FLOAT;
+		in.channelsRequested = input_.getChannelCount();
+		in.alloc();
+		alloc_ = false;
+	}
+
+	// a failed read gives a negative count
+	TSize frames = getBufferLastWrite(buffer);
+	if(frames <= buffer.getBufferLength()) {
+		float** first = buffer.getInputBuffer().getSamples();
+		float** samples = in.getSamples();
+
+		unsigned int channel = buffer.getInputBuffer().getChannels();
+		for(unsigned int c = 0; c < channel; c++) {
+			memcpy(samples[c], first[c], frames * sizeof(float));
+		}
+
+		for(unsigned int i = 0; i < input_.captures_.size(); i++) {
+			DriftBuffer& drift = input_.captures_[i]->getDriftBuffer();
+			drift.pull(samples + channel, frames);
+			channel += drift.getChannels();
+		}
+	}
+
+	setBufferLastWrite(*buffer_, frames);
+	return output_->write(*buffer_);
+}
+
+AggregateInput::Capture::Capture(): pipe_(*this), input_(NULL),
+		thread_(Thread::getNewThread()), exit_(false) {
+
+	// the capture has to keep up with its device like the processing
+	thread_->setRealtime(Thread::THREAD_WORKER);
+}
+
+AggregateInput::Capture::~Capture() {
+	stop();
+	delete thread_;
+}
+
+TErrors AggregateInput::Capture::start(llaInputStream& input, TSampleRate rate,
+		TSize frames) {
+	input_ = &input;
+	drift_.prepare(input.getSampleRate(), rate, input.getChannelCount(),
+			frames);
+	pipe_.setBufferLength(frames);
+
+	exit_ = false;
+	if(thread_->run(*this) == E_THREAD) return E_OPEN_STREAM;
+	return llaudio::E_OK;
+}
+
+void AggregateInput::Capture::stop(void) {
+	exit_ = true;
+	if(thread_->isRunning()) thread_->join();
+}
+
+void* AggregateInput::Capture::run(void) {
+	if(input_->connect(this, pipe_) != llaudio::E_OK) {
+		log(LEVEL_ERROR, "Cannot capture the member %s of the aggregate device",
+				input_->getName());
+	}
+	return NULL;
+}
+
+TErrors AggregateInput::Capture::write(llaAudioPipe& buffer) {
+	// a failed read gives a negative count
+	TSize frames = getBufferLastWrite(buffer);
+	if(frames <= buffer.getBufferLength()) {
+		drift_.push(buffer.getInputBuffer().getSamples(), frames);
+	}
+	return llaudio::E_OK;
+}
+
+// AggregateOutput /////////////////////////////////////////////////////////////
+//
+AggregateOutput::AggregateOutput(const TAggregateMembers& members,
+		const char* master): members_(members), master_(master),
+		rate_(SR_DEFAULT), opened_(false), alloc_(true) {
+	for(unsigned int i = 0; i < members_.size(); i++) {
+		parts_.push_back(new Part());
+		bridges_.push_back(members_[i].device == master_ ?
+				NULL : new ClockBridge());
+	}
+}
+
+AggregateOutput::~AggregateOutput() {
+	close();
+	for(unsigned int i = 0; i < members_.size(); i++) {
+		delete bridges_[i];
+		delete parts_[i];
+	}
+}
+
+TErrors AggregateOutput::resolve(void) {
+	streams_.clear();
+	for(unsigned int i = 0; i < members_.size(); i++) {
+		llaDevice* device = findDevice(members_[i]);
+
+		// all the channels of the member are used, the most are asked for
+		llaOutputStream* stream = device == NULL ? NULL :
+				&device->getOutputStream(members_[i].stream, rate_, CH_MAX);
+		if(stream == NULL || stream->isNull()) {
+			streams_.clear();
+			return E_OPEN_STREAM;
+		}
+		streams_.push_back(stream);
+	}
+	return streams_.empty() ? E_OPEN_STREAM : llaudio::E_OK;
+}
+
+TErrors AggregateOutput::open(void) {
+	if(opened_) return llaudio::E_OK;
+
+	TErrors ret = resolve();
+	for(unsigned int i = 0; ret == llaudio::E_OK && i < streams_.size(); i++) {
+		ret = streams_[i]->open();
+	}
+
+	if(ret != llaudio::E_OK) {
+		for(unsigned int i = 0; i < streams_.size(); i++) streams_[i]->close();
+		return ret;
+	}
+	opened_ = true;
+	return llaudio::E_OK;
+}
+
+void AggregateOutput::close(void) {
+	if(!opened_) return;
+	for(unsigned int i = 0; i < streams_.size(); i++) {
+		// the bridges are set up on the first write
+		if(bridges_[i] != NULL && !alloc_) bridges_[i]->close();
+		streams_[i]->close();
+	}
+	alloc_ = true;
+	opened_ = false;
+}
+
+TErrors AggregateOutput::setSampleRate(TSampleRate sample_rate) {
+	rate_ = sample_rate;
+	return llaudio::E_OK;
+}
+
+TSampleRate AggregateOutput::getSampleRate(void) {
+	return streams_.empty() ? rate_ : streams_[0]->getSampleRate();
+}
+
+TChannels AggregateOutput::getChannelCount(void) {
+	unsigned int channels = 0;
+	for(unsigned int i = 0; i < streams_.size(); i++) {
+		channels += streams_[i]->getChannelCount();
+	}
+	return (TChannels) channels;
+}
+
+double AggregateOutput::getLatency(void) {
+	if(streams_.empty()) return llaStream::getLatency();
+
+	double latency = 0.0;
+	for(unsigned int i = 0; i < streams_.size(); i++) {
+		// the bridges are set up on the first write
+		double l = bridges_[i] != NULL && !alloc_ ?
+				bridges_[i]->getLatency() : streams_[i]->getLatency();
+		if(l > latency) latency = l;
+	}
+	return latency;
+}
+
+unsigned long AggregateOutput::getXrunCount(void) {
+	unsigned long xruns = 0;
+	for(unsigned int i = 0; i < bridges_.size(); i++) {
+		if(bridges_[i] != NULL) xruns += bridges_[i]->getRingXrunCount();
+	}
+	for(unsigned int i = 0; i < streams_.size(); i++) {
+		xruns += streams_[i]->getXrunCount();
+	}
+	return xruns;
+}
+
+TErrors AggregateOutput::setup(llaAudioPipe& buffer) {
+	llaAudioPipe::Buffer& out = buffer.getOutputBuffer();
+	out.organizationRequested = llaAudioPipe::NON_INTERLEAVED;
+	out.channelsRequested = getChannelCount();
+	out.alloc();
+
+	TSize frames = buffer.getBufferLength();
+	unsigned int offset = 0;
+	for(unsigned int i = 0; i < streams_.size(); i++) {
+		parts_[i]->setup(buffer, offset);
+		parts_[i]->setBufferLength(frames);
+		parts_[i]->getOutputBuffer().channelsRequested =
+				streams_[i]->getChannelCount();
+		offset += streams_[i]->getChannelCount();
+
+		// the bridged members are resampled from the rate of the first one
+		if(bridges_[i] != NULL) {
+			bridges_[i]->prepare(*streams_[i], frames, getSampleRate());
+			TErrors ret = bridges_[i]->open();
+			if(ret != llaudio::E_OK) return ret;
+		}
+	}
+
+	alloc_ = false;
+	return llaudio::E_OK;
+}
+
+TErrors AggregateOutput::write(llaAudioPipe& buffer) {
+	if(!opened_) return E_WRITE_STREAM;
+
+	TErrors ret = llaudio::E_OK;
+	if(alloc_ && (ret = setup(buffer)) != llaudio::E_OK) return ret;
+
+	buffer.onSamplesReady();
+	if(buffer.fail()) return E_WRITE_STREAM;
+
+	TSize frames = getBufferLastWrite(buffer);
+	for(unsigned int i = 0; i < streams_.size(); i++) {
+		parts_[i]->setFrames(frames);
+		TErrors err = bridges_[i] != NULL ?
+				bridges_[i]->write(*parts_[i]) : streams_[i]->write(*parts_[i]);
+		if(err != llaudio::E_OK) ret = err;
+	}
+	return ret;
+}
+
+void AggregateOutput::Part::onSamplesReady(void) {
+	llaAudioPipe::Buffer& out = getOutputBuffer();
+	float** from = source_->getOutputBuffer().getSamples() + offset_;
+	float** to = out.getSamples();
+
+	// a failed read gives a negative count
+	TSize frames = lastwrite_ <= getBufferLength() ?
+			lastwrite_ : getBufferLength();
+	for(unsigned int c = 0; c < out.getChannels(); c++) {
+		memcpy(to[c], from[c], frames * sizeof(float));
+	}
+	out.writeSamples();
+}
+
+// AggregateDevice /////////////////////////////////////////////////////////////
+//
+AggregateDevice::AggregateDevice(const char* name,
+		const TAggregateMembers& inputs, const TAggregateMembers& outputs):
+		name_(name) {
+
+	if(!inputs.empty()) master_ = inputs[0].device;
+	else if(!outputs.empty()) master_ = outputs[0].device;
+
+	// the full name lists the member devices
+	std::vector<std::string> devices;
+	for(unsigned int i = 0; i < inputs.size() + outputs.size(); i++) {
+		const std::string& device = i < inputs.size() ?
+				inputs[i].device : outputs[i - inputs.size()].device;
+		bool found = false;
+		for(unsigned int j = 0; j < devices.size(); j++) {
+			if(devices[j] == device) found = true;
+		}
+		if(!found) devices.push_back(device);
+	}
+	fullname_ = name_ + " (aggregate of";
+	for(unsigned int i = 0; i < devices.size(); i++) {
+		fullname_ += (i == 0 ? " " : ", ") + devices[i];
+	}
+	fullname_ += ")";
+
+	if(!inputs.empty()) {
+		AggregateInput* input = new AggregateInput(inputs);
+		input->setOwner(*this);
+		input_stream_list_->add(STREAM_ID_DEFAULT, input);
+	}
+	if(!outputs.empty()) {
+		AggregateOutput* output = new AggregateOutput(outputs, master_.c_str());
+		output->setOwner(*this);
+		output_stream_list_->add(STREAM_ID_DEFAULT, output);
+	}
+}
+
+} /* namespace soundalchemy */
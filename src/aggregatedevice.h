@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef AGGREGATEDEVICE_H_
+#define AGGREGATEDEVICE_H_
+
+#include "thread.h"
+#include "driftbuffer.h"
+#include "clockbridge.h"
+#include "llaudio/llaudio.h"
+#include <string>
+#include <vector>
+
+namespace soundalchemy {
+
+/// A stream of a device which is a part of an aggregate device
+struct AggregateMember {
+	AggregateMember(const char* dev, llaudio::TStreamId id):
+		device(dev), stream(id) {}
+
+	std::string device;
+	llaudio::TStreamId stream;
+};
+
+typedef std::vector<AggregateMember> TAggregateMembers;
+
+/**
+ * @brief The input stream of an aggregate device.
+ *
+ * The channels of the member streams follow each other in the order of the
+ * members. The first member is read in the cycle of the processing, the
+ * others are captured by their own threads into DriftBuffers which resample
+ * them to the clock of the first one.
+ */
+class AggregateInput: public llaudio::llaInputStream {
+public:
+	AggregateInput(const TAggregateMembers& members);
+	~AggregateInput();
+
+	/* implementable methods from the interface llaStream: */
+	llaudio::TErrors open(void);
+	void close(void);
+
+	const char * getName(void) { return "aggregate input"; }
+	int getId(void) { return llaudio::STREAM_ID_DEFAULT; }
+
+	llaudio::TErrors setSampleRate(llaudio::TSampleRate sample_rate);
+
+	/// The channel count is the sum of the members', it can't be set.
+	llaudio::TErrors setChannelCount(llaudio::TChannels channels) {
+		return llaudio::E_OK;
+	}
+
+	llaudio::TSampleRate getSampleRate(void);
+	llaudio::TChannels getChannelCount(void);
+
+	/**
+	 * @return Returns the largest latency of the members, the ones captured
+	 * by a thread are delayed by their DriftBuffer too.
+	 */
+	double getLatency(void);
+	unsigned long getXrunCount(void);
+
+	/* implementable methods from llaInputStream: */
+	llaudio::TErrors read(llaudio::llaAudioPipe& buffer) {
+		return llaudio::E_UNIMPLEMENTED;
+	}
+	llaudio::TErrors connect(llaudio::llaOutputStream* output,
+			llaudio::llaAudioPipe& buffer);
+
+private:
+
+	// Captures a member into a DriftBuffer on its own thread. It's the output
+	// stream the member is connected to.
+	class Capture: public llaudio::llaOutputStream, private Runnable {
+	public:
+		Capture();
+		~Capture();
+
+		// Starts the capture thread, the input has to be opened already.
+		llaudio::TErrors start(llaudio::llaInputStream& input,
+				llaudio::TSampleRate rate, llaudio::TSize frames);
+		void stop(void);
+
+		DriftBuffer& getDriftBuffer(void) { return drift_; }
+
+		llaudio::TErrors open(void) { return llaudio::E_OK; }
+		void close(void) {}
+		const char * getName(void) { return input_->getName(); }
+		int getId(void) { return input_->getId(); }
+		llaudio::TErrors setSampleRate(llaudio::TSampleRate sample_rate) {
+			return llaudio::E_OK;
+		}
+		llaudio::TErrors setChannelCount(llaudio::TChannels channels) {
+			return llaudio::E_OK;
+		}
+		llaudio::TSampleRate getSampleRate(void) {
+			return input_->getSampleRate();
+		}
+		llaudio::TChannels getChannelCount(void) {
+			return input_->getChannelCount();
+		}
+
+		llaudio::TErrors write(llaudio::llaAudioPipe& buffer);
+
+	private:
+		class Pipe: public llaudio::llaAudioPipe {
+		public:
+			Pipe(Capture& capture): capture_(capture) {}
+			bool stop(void) { return capture_.exit_; }
+		private:
+			Capture& capture_;
+		} pipe_;
+
+		void* run(void);
+
+		llaudio::llaInputStream* input_;
+		Thread *thread_;
+		DriftBuffer drift_;
+		volatile bool exit_;
+	};
+
+	// The output stream the first member is connected to. It completes the
+	// cycle with the captured members and passes it to the real output.
+	class Relay: public llaudio::llaOutputStream {
+	public:
+		Relay(AggregateInput& input): input_(input), output_(NULL),
+				buffer_(NULL), alloc_(false) {}
+
+		void setup(llaudio::llaOutputStream* output,
+				llaudio::llaAudioPipe& buffer);
+
+		llaudio::TErrors open(void) { return output_->open(); }
+		void close(void) { output_->close(); }
+		const char * getName(void) { return output_->getName(); }
+		int getId(void) { return output_->getId(); }
+		llaudio::TErrors setSampleRate(llaudio::TSampleRate sample_rate) {
+			return llaudio::E_OK;
+		}
+		llaudio::TErrors setChannelCount(llaudio::TChannels channels) {
+			return llaudio::E_OK;
+		}
+		llaudio::TSampleRate getSampleRate(void) {
+			return output_->getSampleRate();
+		}
+		llaudio::TChannels getChannelCount(void) {
+			return output_->getChannelCount();
+		}
+
+		llaudio::TErrors write(llaudio::llaAudioPipe& buffer);
+
+	private:
+		AggregateInput& input_;
+		llaudio::llaOutputStream* output_;
+		llaudio::llaAudioPipe* buffer_;
+		bool alloc_;
+	} relay_;
+
+	// The buffer of the first member, it stops with the buffer of the
+	// processing.
+	class Pipe: public llaudio::llaAudioPipe {
+	public:
+		Pipe(): buffer_(NULL) {}
+		void setup(llaudio::llaAudioPipe& buffer) { buffer_ = &buffer; }
+		bool stop(void) { return buffer_->stop(); }
+	private:
+		llaudio::llaAudioPipe* buffer_;
+	} pipe_;
+
+	// Finds the member streams, they are looked up on every open as the
+	// devices are recreated when they are detected again. The streams are
+	// kept after close for counting their xruns.
+	llaudio::TErrors resolve(void);
+
+	TAggregateMembers members_;
+	std::vector<llaudio::llaInputStream*> streams_;
+	std::vector<Capture*> captures_;
+	llaudio::TSampleRate rate_;
+	bool opened_;
+};
+
+/**
+ * @brief The output stream of an aggregate device.
+ *
+ * The channels of the member streams follow each other in the order of the
+ * members. The members on the clock master device are written in the cycle
+ * of the processing, the others are played through ClockBridges.
+ */
+class AggregateOutput: public llaudio::llaOutputStream {
+public:
+	AggregateOutput(const TAggregateMembers& members, const char* master);
+	~AggregateOutput();
+
+	/* implementable methods from the interface llaStream: */
+	llaudio::TErrors open(void);
+	void close(void);
+
+	const char * getName(void) { return "aggregate output"; }
+	int getId(void) { return llaudio::STREAM_ID_DEFAULT; }
+
+	llaudio::TErrors setSampleRate(llaudio::TSampleRate sample_rate);
+
+	/// The channel count is the sum of the members', it can't be set.
+	llaudio::TErrors setChannelCount(llaudio::TChannels channels) {
+		return llaudio::E_OK;
+	}
+
+	llaudio::TSampleRate getSampleRate(void);
+	llaudio::TChannels getChannelCount(void);
+
+	/// @return Returns the largest latency of the members.
+	double getLatency(void);
+	unsigned long getXrunCount(void);
+
+	/* implementable methods from llaOutputStream: */
+	llaudio::TErrors write(llaudio::llaAudioPipe& buffer);
+
+private:
+
+	// The buffer of a member, it takes its channels from the buffer of the
+	// processing.
+	class Part: public llaudio::llaAudioPipe {
+	public:
+		Part(): source_(NULL), offset_(0) {}
+		void setup(llaudio::llaAudioPipe& source, unsigned int offset) {
+			source_ = &source;
+			offset_ = offset;
+		}
+		void setFrames(llaudio::TSize frames) { lastwrite_ = frames; }
+		void onSamplesReady(void);
+	private:
+		llaudio::llaAudioPipe* source_;
+		unsigned int offset_;
+	};
+
+	llaudio::TErrors resolve(void);
+
+	// Prepares the parts and opens the bridges on the first write when the
+	// buffer length is known.
+	llaudio::TErrors setup(llaudio::llaAudioPipe& buffer);
+
+	TAggregateMembers members_;
+	std::string master_;
+	std::vector<llaudio::llaOutputStream*> streams_;
+	std::vector<ClockBridge*> bridges_;
+	std::vector<Part*> parts_;
+	llaudio::TSampleRate rate_;
+	bool opened_;
+	bool alloc_;
+};
+
+/**
+ * @brief A device made of the streams of other devices.
+ *
+ * Its input and output streams have the channels of all the member streams,
+ * so e.g. two interfaces with 8 inputs each can feed one effect chain as a
+ * 16 channel input. The members are found by the names of their devices when
+ * the streams are opened.
+ *
+ * The aggregate follows the clock of one member device, the clock master.
+ * It's the device of the first input member or of the first output member
+ * if there are no inputs. The members on other devices are resampled to the
+ * clock of the master by the same drift correction which bridges the output
+ * of the processing.
+ */
+class AggregateDevice: public llaudio::llaDevice {
+public:
+
+	/**
+	 * @param name The name of the device, it has to be unique.
+	 * @param inputs The input streams of the members.
+	 * @param outputs The output streams of the members.
+	 */
+	AggregateDevice(const char* name, const TAggregateMembers& inputs,
+			const TAggregateMembers& outputs);
+
+	const char* getName(bool full = false) {
+		return full ? fullname_.c_str() : name_.c_str();
+	}
+
+	/// @return Returns the name of the device whose clock is followed.
+	const char* getClockMaster(void) { return master_.c_str(); }
+
+private:
+	std::string name_;
+	std::string fullname_;
+	std::string master_;
+};
+
+} /* namespace soundalchemy */
+#endif /* AGGREGATEDEVICE_H_ */
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "analyzer.h"
+#include "simd.h"
+#include <cmath>
+
+namespace soundalchemy {
+
+const float SpectrumAnalyzer::DEFAULT_OVERLAP = 0.5f;
+const float SpectrumAnalyzer::MAX_OVERLAP = 0.875f;
+const float SpectrumAnalyzer::MIN_FREQUENCY = 20.0f;
+const float SpectrumAnalyzer::FLOOR_DB = -96.0f;
+
+SpectrumAnalyzer::SpectrumAnalyzer(): fft_(NULL), size_(0), hop_(0),
+		filled_(0), full_scale_(1.0f), mutex_(Thread::getMutex()) {
+	configure(DEFAULT_SIZE, DEFAULT_OVERLAP, DEFAULT_BINS, 44100);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer() {
+	delete fft_;
+	delete mutex_;
+}
+
+void SpectrumAnalyzer::configure(unsigned int size, float overlap,
+		unsigned int bins, unsigned int sample_rate) {
+	unsigned int n = MIN_SIZE;
+	while(n < size && n < MAX_SIZE) n <<= 1;
+
+	if(overlap < 0.0f) overlap = 0.0f;
+	if(overlap > MAX_OVERLAP) overlap = MAX_OVERLAP;
+	if(bins == 0) bins = DEFAULT_BINS;
+	if(bins > MAX_BINS) bins = MAX_BINS;
+
+	if(n != size_) {
+		delete fft_;
+		fft_ = new FFT(n);
+		size_ = n;
+
+		history_.assign(n, 0.0f);
+		windowed_.assign(n, 0.0f);
+		re_.assign(fft_->getBins(), 0.0f);
+		im_.assign(fft_->getBins(), 0.0f);
+
+		window_.resize(n);
+		for(unsigned int i = 0; i < n; i++)
+			window_[i] = 0.5f - 0.5f * cos(2.0 * M_PI * i / n);
+	}
+
+	hop_ = (unsigned int) (n * (1.0f - overlap));
+	if(hop_ == 0) hop_ = 1;
+	filled_ = 0;
+
+	// a full scale sine wave gives size/4 in its bin through the Hann window
+	full_scale_ = (float) n * n / 16.0f;
+
+	// the bins are spaced evenly on a logarithmic frequency scale, a bin
+	// narrower than the resolution of the transform gets one transform bin
+	unsigned int half = n / 2;
+	float nyquist = sample_rate / 2.0f;
+	float resolution = (float) sample_rate / n;
+	edges_.resize(bins + 1);
+	for(unsigned int b = 0; b <= bins; b++) {
+		float f = MIN_FREQUENCY * pow(nyquist / MIN_FREQUENCY, (float) b / bins);
+		unsigned int k = (unsigned int) (f / resolution + 0.5f);
+		if(k < 1) k = 1;
+		if(k > half) k = half;
+		edges_[b] = k;
+	}
+	edges_[bins] = half + 1;
+
+	// drop the samples of the previous set up
+	ring_.read(NULL, ring_.getAvailable());
+
+	mutex_->lock();
+	frame_.clear();
+	mutex_->unlock();
+}
+
+bool SpectrumAnalyzer::analyze(void) {
+	// The analysis fell behind, jump to the latest samples. The windows
+	// start over as if the signal started here.
+	unsigned int available = ring_.getAvailable();
+	if(available > size_ + hop_) {
+		ring_.read(NULL, available - size_);
+		filled_ = 0;
+		available = size_;
+	}
+
+	if(filled_ < size_) {
+		// fill the history before the first window
+		unsigned int count = size_ - filled_;
+		if(available < count) return false;
+		ring_.read(&history_[filled_], count);
+		filled_ = size_;
+	}
+	else {
+		if(available < hop_) return false;
+		memmove(&history_[0], &history_[hop_], (size_ - hop_) * sizeof(float));
+		ring_.read(&history_[size_ - hop_], hop_);
+	}
+
+	// the size is a multiple of the lanes
+	for(unsigned int i = 0; i < size_; i += simd::LANES) {
+		simd::store(&windowed_[i], simd::mul(simd::load(&history_[i]),
+				simd::load(&window_[i])));
+	}
+
+	fft_->forward(&windowed_[0], &re_[0], &im_[0]);
+
+	// the power spectrum in place of the real parts
+	unsigned int count = fft_->getBins();
+	unsigned int k = 0;
+	for(; k + simd::LANES <= count; k += simd::LANES) {
+		simd::TVec r = simd::load(&re_[k]);
+		simd::TVec i = simd::load(&im_[k]);
+		simd::store(&re_[k], simd::madd(i, i, simd::mul(r, r)));
+	}
+	for(; k < count; k++) re_[k] = re_[k] * re_[k] + im_[k] * im_[k];
+
+	unsigned int bins = edges_.size() - 1;
+	mutex_->lock();
+	frame_.resize(bins);
+	for(unsigned int b = 0; b < bins; b++) {
+		unsigned int end = edges_[b+1] > edges_[b] ? edges_[b+1] : edges_[b] + 1;
+		float power = 0.0f;
+		for(unsigned int j = edges_[b]; j < end && j < count; j++)
+			if(re_[j] > power) power = re_[j];
+
+		float db = power > 0.0f ? 10.0f * log10f(power / full_scale_) : FLOOR_DB;
+		float level = (db - FLOOR_DB) / -FLOOR_DB * 255.0f + 0.5f;
+		frame_[b] = level < 0.0f ? 0 : level > 255.0f ? 255 :
+				(unsigned char) level;
+	}
+	mutex_->unlock();
+
+	return true;
+}
+
+void SpectrumAnalyzer::getFrame(std::vector<unsigned char>& levels) {
+	mutex_->lock();
+	levels = frame_;
+	mutex_->unlock();
+}
+
+} /* namespace soundalchemy */
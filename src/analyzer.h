@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef ANALYZER_H_
+#define ANALYZER_H_
+
+#include "fft.h"
+#include "thread.h"
+#include <cstring>
+#include <vector>
+
+namespace soundalchemy {
+
+/**
+ * @brief A ring of samples from one writing thread to one reading thread.
+ *
+ * The processing thread copies the samples of the analyzed signal into the
+ * ring and the analyzer takes them in its own thread. Neither of them ever
+ * waits, the samples which don't fit are dropped.
+ */
+class SampleRing {
+public:
+
+	/// The count of samples the ring holds, a power of two
+	static const unsigned int SIZE = 32768;
+
+	SampleRing(): write_pos_(0), read_pos_(0) {}
+
+	/**
+	 * Copies samples into the ring. Called by the writing thread.
+	 * @return Returns the count of samples written.
+	 */
+	unsigned int write(const float* samples, unsigned int count) {
+		unsigned int pos = write_pos_;
+		unsigned int space = SIZE - (pos - read_pos_);
+		if(count > space) count = space;
+
+		unsigned int index = pos & (SIZE - 1);
+		unsigned int first = count < SIZE - index ? count : SIZE - index;
+		memcpy(samples_ + index, samples, first * sizeof(float));
+		memcpy(samples_, samples + first, (count - first) * sizeof(float));
+
+		__sync_synchronize();
+		write_pos_ = pos + count;
+		return count;
+	}
+
+	/// @return Returns the count of samples waiting to be read.
+	unsigned int getAvailable(void) { return write_pos_ - read_pos_; }
+
+	/**
+	 * Takes samples from the ring. Called by the reading thread.
+	 * @param samples The samples are copied here, NULL to drop them.
+	 * @return Returns the count of samples read.
+	 */
+	unsigned int read(float* samples, unsigned int count) {
+		unsigned int pos = read_pos_;
+		unsigned int available = write_pos_ - pos;
+		if(count > available) count = available;
+		__sync_synchronize();
+
+		if(samples != NULL) {
+			unsigned int index = pos & (SIZE - 1);
+			unsigned int first = count < SIZE - index ? count : SIZE - index;
+			memcpy(samples, samples_ + index, first * sizeof(float));
+			memcpy(samples + first, samples_, (count - first) * sizeof(float));
+		}
+
+		__sync_synchronize();
+		read_pos_ = pos + count;
+		return count;
+	}
+
+private:
+	// The positions run freely, the index is the position masked with
+	// SIZE - 1. write_pos_ is written by the writing thread, read_pos_ by
+	// the reading one.
+	float samples_[SIZE];
+	volatile unsigned int write_pos_;
+	volatile unsigned int read_pos_;
+};
+
+/**
+ * @brief Spectrum analyzer of a signal tapped from the effect chain.
+ *
+ * The samples come through a SampleRing and they are analyzed in windows of
+ * a power of two size overlapping each other. Every window is weighted with
+ * a Hann window and transformed, and the power spectrum is reduced to bins
+ * spaced logarithmically from MIN_FREQUENCY to the Nyquist frequency. The
+ * level of a bin is its strongest component quantized to 8 bits: 0 is
+ * FLOOR_DB or below, 255 is the level of a full scale sine wave.
+ *
+ * analyze() is called by the thread of the analysis, the latest frame is
+ * read by getFrame() from any thread.
+ */
+class SpectrumAnalyzer {
+public:
+
+	static const unsigned int MIN_SIZE = 256;
+	static const unsigned int MAX_SIZE = 8192;
+	static const unsigned int DEFAULT_SIZE = 2048;
+
+	static const unsigned int MAX_BINS = 256;
+	static const unsigned int DEFAULT_BINS = 64;
+
+	static const float DEFAULT_OVERLAP;
+	static const float MAX_OVERLAP;
+	static const float MIN_FREQUENCY;
+	static const float FLOOR_DB;
+
+	SpectrumAnalyzer();
+	~SpectrumAnalyzer();
+
+	/**
+	 * Sets up the analysis. It must not run meanwhile. The samples waiting
+	 * in the ring are dropped.
+	 * @param size The count of samples in a window, it's rounded to a power
+	 * of two between MIN_SIZE and MAX_SIZE.
+	 * @param overlap The part of a window overlapping the next one, between
+	 * 0 and MAX_OVERLAP.
+	 * @param bins The count of the bins of a frame, at most MAX_BINS.
+	 * @param sample_rate The sample rate of the signal.
+	 */
+	void configure(unsigned int size, float overlap, unsigned int bins,
+			unsigned int sample_rate);
+
+	/// The ring the signal has to be copied into.
+	SampleRing& getRing(void) { return ring_; }
+
+	/**
+	 * Analyzes the next window if enough samples have arrived for it.
+	 * @return Returns true if a new frame has been made.
+	 */
+	bool analyze(void);
+
+	/**
+	 * Gets the latest frame.
+	 * @param levels The levels of the bins, it's empty if there is no frame
+	 * yet.
+	 */
+	void getFrame(std::vector<unsigned char>& levels);
+
+private:
+
+	SampleRing ring_;
+	FFT* fft_;
+
+	unsigned int size_;
+	unsigned int hop_;
+
+	// count of the samples in the history before the first window
+	unsigned int filled_;
+
+	// the last size_ samples of the signal
+	std::vector<float> history_;
+	std::vector<float> window_;
+	std::vector<float> windowed_;
+	std::vector<float> re_;
+	std::vector<float> im_;
+
+	// The first transform bin of each frame bin, the last one ends at the
+	// first of the next one.
+	std::vector<unsigned int> edges_;
+
+	// the power of a full scale sine wave
+	float full_scale_;
+
+	// the latest frame, guarded by mutex_
+	std::vector<unsigned char> frame_;
+	Mutex* mutex_;
+};
+
+} /* namespace soundalchemy */
+#endif /* ANALYZER_H_ */
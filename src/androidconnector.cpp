@@ -25,8 +25,7 @@ AndroidConnector::~AndroidConnector() {
 InboundMessage* AndroidConnector::read(void) {
 
 	// read the message
-	InboundMessage* dest_msg =
-			InboundMessage::unserialize(Message::PROTOCOL_JSON, cin, ENDCHAR);
+	InboundMessage* dest_msg = readMessage(cin, ENDCHAR);
 
 	if(cin.fail()) {
 		dest_msg = InboundMessage::newMsgClientOut();
@@ -41,7 +40,10 @@ InboundMessage* AndroidConnector::read(void) {
 }
 
 void AndroidConnector::send(OutboundMessage& message) {
-	message.serialize(Message::PROTOCOL_JSON, cout, ENDCHAR);
+	SharedBuffer* buffer = message.getSerialized(getProtocol(), ENDCHAR);
+	cout.write(buffer->getData(), buffer->getSize());
+	cout.flush();
+	buffer->release();
 }
 
 } /* namespace soundalchemy */
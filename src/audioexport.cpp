@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "audioexport.h"
+#include <climits>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+namespace soundalchemy {
+
+// the ring starts on a cache line of its own
+static const unsigned int RING_OFFSET = 64;
+
+AudioExport::AudioExport(): header_(NULL), ring_(NULL), size_(0) {
+}
+
+AudioExport::~AudioExport() {
+	close();
+}
+
+TAlchemyError AudioExport::open(const char* path, unsigned int channels,
+		unsigned int frames, unsigned int sample_rate) {
+	close();
+
+	if(channels == 0) channels = 1;
+	if(channels > MAX_CHANNELS) channels = MAX_CHANNELS;
+	if(frames == 0) frames = DEFAULT_FRAMES;
+	unsigned int n = 1;
+	while(n < frames && n < MAX_FRAMES) n <<= 1;
+	frames = n;
+
+	int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0660);
+	if(fd < 0) {
+		log(LEVEL_ERROR, "%s: %s (%s)", STR_ERRORS[E_FILE], path,
+				strerror(errno));
+		return E_FILE;
+	}
+
+	size_t size = RING_OFFSET + (size_t) frames * channels * sizeof(float);
+	void *p = MAP_FAILED;
+	if(ftruncate(fd, size) == 0)
+		p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	int err = errno;
+	::close(fd);
+
+	if(p == MAP_FAILED) {
+		log(LEVEL_ERROR, "%s: %s (%s)", STR_ERRORS[E_FILE], path,
+				strerror(err));
+		unlink(path);
+		return E_FILE;
+	}
+
+	// the file is truncated, the ring is silence
+	header_ = (AudioExportHeader*) p;
+	ring_ = (float*) ((char*) p + RING_OFFSET);
+	size_ = size;
+	header_->version = AudioExportHeader::VERSION;
+	header_->size = size;
+	header_->sample_rate = sample_rate;
+	header_->channels = channels;
+	header_->frames = frames;
+	header_->offset = RING_OFFSET;
+
+	// the readers check the magic last
+	__sync_synchronize();
+	header_->magic = AudioExportHeader::MAGIC;
+
+	path_ = path;
+	log(LEVEL_INFO, "audio export: %s", path);
+	return E_OK;
+}
+
+void AudioExport::close(void) {
+	if(header_ == NULL) return;
+
+	// wake the readers for good
+	header_->magic = 0;
+	__sync_add_and_fetch(&header_->futex, 1);
+	syscall(__NR_futex, &header_->futex, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+
+	munmap(header_, size_);
+	header_ = NULL;
+	ring_ = NULL;
+
+	unlink(path_.c_str());
+	path_.clear();
+}
+
+void AudioExport::write(float* const* buffers, unsigned int count,
+		unsigned int sample_count) {
+	unsigned int channels = header_->channels;
+	unsigned int mask = header_->frames - 1;
+	uint32_t index = header_->write_index;
+
+	// a cycle longer than the ring leaves only its end
+	unsigned int skip = 0;
+	if(sample_count > header_->frames) {
+		skip = sample_count - header_->frames;
+		index += skip;
+		sample_count -= skip;
+	}
+
+	for(unsigned int c = 0; c < channels; c++) {
+		const float *in = buffers[c < count ? c : count - 1] + skip;
+		float *out = ring_ + c;
+		for(unsigned int i = 0; i < sample_count; i++)
+			out[((index + i) & mask) * channels] = in[i];
+	}
+
+	// the samples are in place before the readers see the index
+	__sync_synchronize();
+	header_->write_index = index + sample_count;
+	__sync_add_and_fetch(&header_->futex, 1);
+
+	if(header_->waiters != 0)
+		syscall(__NR_futex, &header_->futex, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+} /* namespace soundalchemy */
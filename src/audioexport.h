@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef AUDIOEXPORT_H_
+#define AUDIOEXPORT_H_
+
+#include "logs.h"
+#include <stdint.h>
+#include <string>
+
+namespace soundalchemy {
+
+/**
+ * The header of an exported signal. It's followed by a ring of
+ * frames * channels interleaved float samples in the same file. Only fixed
+ * size types are used so 32 and 64 bit processes see the same layout.
+ *
+ * The server never waits for the readers. A reader keeps its own position
+ * in frames and reads the frames between it and write_index in place. If
+ * the server got more than frames ahead, the reader lost samples and it
+ * jumps to write_index - frames. The frames being read may be overwritten
+ * meanwhile, so a reader checks write_index again after reading them.
+ *
+ * To sleep until new frames arrive a reader announces itself in waiters
+ * and waits on the futex word:
+ *
+ *   __sync_add_and_fetch(&header->waiters, 1);
+ *   uint32_t seq = header->futex;
+ *   if(header->write_index == position)
+ *       syscall(__NR_futex, &header->futex, FUTEX_WAIT, seq, &timeout, 0, 0);
+ *   __sync_sub_and_fetch(&header->waiters, 1);
+ *
+ * The server makes a system call to wake them only while there are waiters.
+ */
+struct AudioExportHeader {
+
+	static const uint32_t MAGIC = 0x53414158; // "SAAX"
+	static const uint32_t VERSION = 1;
+
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;        //!< the size of the file in bytes
+	uint32_t sample_rate; //!< the rate of the chain, it may change
+	uint32_t channels;
+	uint32_t frames;      //!< the frames of the ring, a power of two
+	uint32_t offset;      //!< the offset of the ring from the header
+
+	/// the count of frames written, it runs freely and wraps around
+	volatile uint32_t write_index;
+
+	/// incremented after every write, the readers wait on it
+	volatile uint32_t futex;
+
+	/// the count of the readers waiting on the futex
+	volatile uint32_t waiters;
+};
+
+/**
+ * @brief A signal of the effect chain exported to other local processes.
+ *
+ * The samples are written to a ring in a file mapped by the server and the
+ * readers, so the readers don't need any copy or call to the server. The
+ * processing thread writes the ring, the export is opened and closed while
+ * it doesn't use it.
+ * @see AudioExportHeader
+ */
+class AudioExport {
+public:
+
+	static const unsigned int MAX_CHANNELS = 8;
+
+	/// The frames of the ring if the client doesn't give them, a power of
+	/// two, and the most frames
+	static const unsigned int DEFAULT_FRAMES = 65536;
+	static const unsigned int MAX_FRAMES = 1048576;
+
+	AudioExport();
+	~AudioExport();
+
+	/**
+	 * Creates the file of the export and maps it.
+	 * @param path The path of the file, on a tmpfs preferably.
+	 * @param channels The count of the channels, at most MAX_CHANNELS.
+	 * @param frames The frames of the ring, rounded up to a power of two,
+	 * 0 is DEFAULT_FRAMES.
+	 * @param sample_rate The sample rate of the signal.
+	 * @return Returns E_OK or E_FILE if it can't be created or mapped.
+	 */
+	TAlchemyError open(const char* path, unsigned int channels,
+			unsigned int frames, unsigned int sample_rate);
+
+	/**
+	 * Unmaps the file and removes it.
+	 */
+	void close(void);
+
+	const std::string& getPath(void) { return path_; }
+
+	void setSampleRate(unsigned int sample_rate) {
+		header_->sample_rate = sample_rate;
+	}
+
+	/**
+	 * Writes a cycle of samples to the ring and wakes the waiting readers.
+	 * Called by the processing thread.
+	 * @param buffers The buffers of the channels of the signal.
+	 * @param count The count of the buffers. If the export has more
+	 * channels, the last buffer is used for the remaining ones.
+	 * @param sample_count The count of samples in a buffer.
+	 */
+	void write(float* const* buffers, unsigned int count,
+			unsigned int sample_count);
+
+private:
+
+	AudioExportHeader* header_;
+	float* ring_;
+	size_t size_;
+	std::string path_;
+};
+
+} /* namespace soundalchemy */
+#endif /* AUDIOEXPORT_H_ */
@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "binaryprotocol.h"
+#include <cstring>
+#include <stdint.h>
+
+namespace soundalchemy {
+
+// little-endian numbers from a byte array
+static inline unsigned int loadU16(const unsigned char* p) {
+	return p[0] | (p[1] << 8);
+}
+
+static inline unsigned int loadU32(const unsigned char* p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int) p[3] << 24);
+}
+
+bool BinaryProtocol::parseHeader(const char* header, unsigned int& type,
+		unsigned int& length) {
+	const unsigned char* bytes = (const unsigned char*) header;
+	length = loadU32(bytes + 8);
+	type = loadU16(bytes + 4);
+	return header[0] == MAGIC_0 && header[1] == MAGIC_1 &&
+			bytes[2] == VERSION && length <= MAX_PAYLOAD;
+}
+
+bool BinaryProtocol::readFrame(std::istream& stream, std::vector<char>& payload,
+		unsigned int& type, unsigned int& length) {
+	char header[HEADER_SIZE];
+	if(!stream.read(header, HEADER_SIZE)) return false;
+
+	if(!parseHeader(header, type, length)) {
+		stream.setstate(std::ios::failbit);
+		return false;
+	}
+
+	if(payload.size() < length) payload.resize(length);
+	if(length > 0 && !stream.read(&payload[0], length)) return false;
+
+	return true;
+}
+
+void BinaryProtocol::writeU16(std::ostream& stream, unsigned int value) {
+	char bytes[2] = { (char) value, (char) (value >> 8) };
+	stream.write(bytes, 2);
+}
+
+void BinaryProtocol::writeU32(std::ostream& stream, unsigned int value) {
+	char bytes[4] = { (char) value, (char) (value >> 8), (char) (value >> 16),
+			(char) (value >> 24) };
+	stream.write(bytes, 4);
+}
+
+void BinaryProtocol::writeFrame(std::ostream& stream, unsigned int type,
+		const Json::Value& value) {
+	stream.put(MAGIC_0);
+	stream.put(MAGIC_1);
+	stream.put(VERSION);
+	stream.put(0);
+	writeU16(stream, type);
+	writeU16(stream, 0);
+	writeU32(stream, valueSize(value));
+	writeValue(stream, value);
+}
+
+unsigned int BinaryProtocol::valueSize(const Json::Value& value) {
+	unsigned int size = 1;
+	switch(value.type()) {
+	case Json::nullValue:
+		break;
+	case Json::intValue:
+	case Json::uintValue:
+		size += 4;
+		break;
+	case Json::realValue:
+		size += 8;
+		break;
+	case Json::stringValue:
+		size += 4 + strlen(value.asCString());
+		break;
+	case Json::booleanValue:
+		size += 1;
+		break;
+	case Json::arrayValue:
+		size += 4;
+		for(Json::Value::UInt i = 0; i < value.size(); i++) {
+			size += valueSize(value[i]);
+		}
+		break;
+	case Json::objectValue:
+		size += 4;
+		for(Json::Value::const_iterator it = value.begin(); it != value.end();
+				it++) {
+			size += 2 + strlen(it.memberName()) + valueSize(*it);
+		}
+		break;
+	}
+	return size;
+}
+
+void BinaryProtocol::writeValue(std::ostream& stream, const Json::Value& value) {
+	switch(value.type()) {
+	case Json::nullValue:
+		stream.put(TAG_NULL);
+		break;
+	case Json::intValue:
+		stream.put(TAG_INT);
+		writeU32(stream, (unsigned int) value.asInt());
+		break;
+	case Json::uintValue:
+		stream.put(TAG_UINT);
+		writeU32(stream, value.asUInt());
+		break;
+	case Json::realValue: {
+		double d = value.asDouble();
+		uint64_t bits;
+		memcpy(&bits, &d, sizeof(bits));
+		stream.put(TAG_DOUBLE);
+		writeU32(stream, (unsigned int) bits);
+		writeU32(stream, (unsigned int) (bits >> 32));
+	}
+		break;
+	case Json::stringValue: {
+		const char* str = value.asCString();
+		unsigned int length = strlen(str);
+		stream.put(TAG_STRING);
+		writeU32(stream, length);
+		stream.write(str, length);
+	}
+		break;
+	case Json::booleanValue:
+		stream.put(TAG_BOOL);
+		stream.put(value.asBool() ? 1 : 0);
+		break;
+	case Json::arrayValue:
+		stream.put(TAG_ARRAY);
+		writeU32(stream, value.size());
+		for(Json::Value::UInt i = 0; i < value.size(); i++) {
+			writeValue(stream, value[i]);
+		}
+		break;
+	case Json::objectValue:
+		stream.put(TAG_OBJECT);
+		writeU32(stream, value.size());
+		for(Json::Value::const_iterator it = value.begin(); it != value.end();
+				it++) {
+			const char* key = it.memberName();
+			unsigned int length = strlen(key);
+			writeU16(stream, length);
+			stream.write(key, length);
+			writeValue(stream, *it);
+		}
+		break;
+	}
+}
+
+// Reader //////////////////////////////////////////////////////////////////////
+//
+bool BinaryProtocol::Reader::need(unsigned int n) {
+	if(fail_ || (unsigned int) (end_ - pos_) < n) {
+		fail_ = true;
+		return false;
+	}
+	return true;
+}
+
+unsigned int BinaryProtocol::Reader::getU8(void) {
+	if(!need(1)) return 0;
+	return (unsigned char) *pos_++;
+}
+
+unsigned int BinaryProtocol::Reader::getU16(void) {
+	if(!need(2)) return 0;
+	unsigned int value = loadU16((const unsigned char*) pos_);
+	pos_ += 2;
+	return value;
+}
+
+unsigned int BinaryProtocol::Reader::getU32(void) {
+	if(!need(4)) return 0;
+	unsigned int value = loadU32((const unsigned char*) pos_);
+	pos_ += 4;
+	return value;
+}
+
+float BinaryProtocol::Reader::getF32(void) {
+	uint32_t bits = getU32();
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+void BinaryProtocol::Reader::getString(char* str) {
+	str[0] = 0;
+	unsigned int length = getU16();
+	if(length > MAX_STRING) fail_ = true;
+	if(!need(length)) return;
+	memcpy(str, pos_, length);
+	str[length] = 0;
+	pos_ += length;
+}
+
+// Writer //////////////////////////////////////////////////////////////////////
+//
+bool BinaryProtocol::Writer::need(unsigned int n) {
+	if(fail_ || (unsigned int) (end_ - pos_) < n) {
+		fail_ = true;
+		return false;
+	}
+	return true;
+}
+
+void BinaryProtocol::Writer::putU16(unsigned int value) {
+	if(!need(2)) return;
+	*pos_++ = (char) value;
+	*pos_++ = (char) (value >> 8);
+}
+
+void BinaryProtocol::Writer::putU32(unsigned int value) {
+	if(!need(4)) return;
+	*pos_++ = (char) value;
+	*pos_++ = (char) (value >> 8);
+	*pos_++ = (char) (value >> 16);
+	*pos_++ = (char) (value >> 24);
+}
+
+void BinaryProtocol::Writer::putObject(unsigned int count) {
+	if(!need(1)) return;
+	*pos_++ = TAG_OBJECT;
+	putU32(count);
+}
+
+void BinaryProtocol::Writer::putKey(const char* key) {
+	unsigned int length = strlen(key);
+	putU16(length);
+	if(!need(length)) return;
+	memcpy(pos_, key, length);
+	pos_ += length;
+}
+
+void BinaryProtocol::Writer::putInt(int value) {
+	if(!need(1)) return;
+	*pos_++ = TAG_INT;
+	putU32((unsigned int) value);
+}
+
+void BinaryProtocol::Writer::putUInt(unsigned int value) {
+	if(!need(1)) return;
+	*pos_++ = TAG_UINT;
+	putU32(value);
+}
+
+void BinaryProtocol::Writer::putDouble(double value) {
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	if(!need(1)) return;
+	*pos_++ = TAG_DOUBLE;
+	putU32((unsigned int) bits);
+	putU32((unsigned int) (bits >> 32));
+}
+
+void BinaryProtocol::Writer::putString(const char* value) {
+	unsigned int length = strlen(value);
+	if(!need(1)) return;
+	*pos_++ = TAG_STRING;
+	putU32(length);
+	if(!need(length)) return;
+	memcpy(pos_, value, length);
+	pos_ += length;
+}
+
+void BinaryProtocol::Writer::putBool(bool value) {
+	if(!need(2)) return;
+	*pos_++ = TAG_BOOL;
+	*pos_++ = value ? 1 : 0;
+}
+
+unsigned int BinaryProtocol::Writer::finish(unsigned int type) {
+	if(fail_) return 0;
+
+	unsigned int length = pos_ - begin_ - HEADER_SIZE;
+	char* end = pos_;
+	pos_ = begin_;
+	*pos_++ = MAGIC_0;
+	*pos_++ = MAGIC_1;
+	*pos_++ = VERSION;
+	*pos_++ = 0;
+	putU16(type);
+	putU16(0);
+	putU32(length);
+	pos_ = end;
+	return end - begin_;
+}
+
+} /* namespace soundalchemy */
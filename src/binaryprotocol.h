@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef BINARYPROTOCOL_H_
+#define BINARYPROTOCOL_H_
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <json/json.h>
+
+namespace soundalchemy {
+
+/**
+ * @brief Framing and encoding of the binary control protocol.
+ *
+ * The binary protocol is an alternative of the JSON protocol for clients
+ * sending many messages, e.g. control surfaces. Every message is a frame of
+ * a fixed header and a payload, all the numbers are little-endian:
+ *
+ *     offset  size  field
+ *     0       2     magic bytes 'S' 'A'
+ *     2       1     VERSION
+ *     3       1     flags, 0
+ *     4       2     the TMessageType of the message
+ *     6       2     reserved, 0
+ *     8       4     the length of the payload
+ *
+ * The payload of an inbound message has fixed fields for each message type,
+ * they are parsed in place by a Reader. A string is its length on 2 bytes
+ * followed by the characters without a terminating zero, it's at most
+ * MAX_STRING long.
+ *
+ * The payload of an outbound message is its data as a tagged value: a
+ * TValueTag byte followed by the value. Integers and floats are 4 bytes,
+ * doubles 8 bytes, strings have a 4 byte length, arrays a 4 byte count of
+ * the values and objects a 4 byte count of the (string key, value) pairs
+ * where the key has a 2 byte length.
+ */
+class BinaryProtocol {
+public:
+
+	/// The version of the protocol sent in every frame
+	static const unsigned char VERSION = 1;
+
+	/// The size of the frame header in bytes
+	static const unsigned int HEADER_SIZE = 12;
+
+	/// The longest payload accepted from a client
+	static const unsigned int MAX_PAYLOAD = 65536;
+
+	/// The longest string of an inbound payload
+	static const unsigned int MAX_STRING = 255;
+
+	/// The first byte of a frame, a JSON message can't start with it
+	static const char MAGIC_0 = 'S';
+	static const char MAGIC_1 = 'A';
+
+	/// Types of the values of an outbound payload
+	typedef enum {
+		TAG_NULL,
+		TAG_INT,
+		TAG_UINT,
+		TAG_DOUBLE,
+		TAG_STRING,
+		TAG_BOOL,
+		TAG_ARRAY,
+		TAG_OBJECT
+	} TValueTag;
+
+	/**
+	 * Reads a whole frame. A frame which can't be read leaves the stream in
+	 * failed state as the next one can't be found anymore.
+	 * @param stream The input of the client.
+	 * @param payload The payload is read here, the buffer is reused by the
+	 * following calls so it grows only to the longest payload.
+	 * @param type The type of the message.
+	 * @param length The length of the payload.
+	 * @return Returns false if the stream failed or the header is invalid.
+	 */
+	static bool readFrame(std::istream& stream, std::vector<char>& payload,
+			unsigned int& type, unsigned int& length);
+
+	/**
+	 * Parses the header of a frame.
+	 * @param header HEADER_SIZE bytes of the header.
+	 * @param type The type of the message.
+	 * @param length The length of the payload.
+	 * @return Returns false if the header is invalid.
+	 */
+	static bool parseHeader(const char* header, unsigned int& type,
+			unsigned int& length);
+
+	/**
+	 * Writes a frame with a value as the payload.
+	 * @param stream The output of the client.
+	 * @param type The type of the message.
+	 * @param value The data of the message.
+	 */
+	static void writeFrame(std::ostream& stream, unsigned int type,
+			const Json::Value& value);
+
+	/**
+	 * @brief Parses the fields of a payload in place.
+	 *
+	 * Reading past the end of the payload gives zeros and sets the failed
+	 * state, so the fields can be read without checking every one of them.
+	 */
+	class Reader {
+	public:
+		Reader(const char* payload, unsigned int length):
+			pos_(payload), end_(payload + length), fail_(false) {}
+
+		unsigned int getU8(void);
+		unsigned int getU16(void);
+		unsigned int getU32(void);
+		int getI32(void) { return (int) getU32(); }
+		float getF32(void);
+
+		/**
+		 * Copies a string, as it isn't terminated in the payload.
+		 * @param str The buffer of at least MAX_STRING + 1 characters the
+		 * string is copied to with a terminating zero.
+		 */
+		void getString(char* str);
+
+		bool fail(void) { return fail_; }
+
+	private:
+		// checks that n more bytes are in the payload
+		bool need(unsigned int n);
+
+		const char* pos_;
+		const char* end_;
+		bool fail_;
+	};
+
+	/**
+	 * @brief Encodes a frame in a fixed buffer without building the value
+	 * first.
+	 *
+	 * The payload is written field by field after the place of the header,
+	 * finish() writes the header. Writing past the end of the buffer sets the
+	 * failed state. The keys of an object have to be put in the order of the
+	 * encoding of the same Json::Value, i.e. sorted.
+	 */
+	class Writer {
+	public:
+		Writer(char* buffer, unsigned int size): begin_(buffer),
+			pos_(buffer + HEADER_SIZE), end_(buffer + size),
+			fail_(size < HEADER_SIZE) {}
+
+		void putObject(unsigned int count);
+		void putKey(const char* key);
+		void putInt(int value);
+		void putUInt(unsigned int value);
+		void putDouble(double value);
+		void putString(const char* value);
+		void putBool(bool value);
+
+		/**
+		 * Writes the header of the frame.
+		 * @param type The type of the message.
+		 * @return Returns the size of the frame or 0 if it didn't fit.
+		 */
+		unsigned int finish(unsigned int type);
+
+		bool fail(void) { return fail_; }
+
+	private:
+		// checks that n more bytes fit in the buffer
+		bool need(unsigned int n);
+
+		void putU16(unsigned int value);
+		void putU32(unsigned int value);
+
+		char* begin_;
+		char* pos_;
+		char* end_;
+		bool fail_;
+	};
+
+private:
+
+	// the encoded size of a value
+	static unsigned int valueSize(const Json::Value& value);
+
+	static void writeValue(std::ostream& stream, const Json::Value& value);
+	static void writeU16(std::ostream& stream, unsigned int value);
+	static void writeU32(std::ostream& stream, unsigned int value);
+};
+
+} /* namespace soundalchemy */
+#endif /* BINARYPROTOCOL_H_ */
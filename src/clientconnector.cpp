@@ -9,6 +9,7 @@
  *     Mészáros Tamás - initial API and implementation
  */
 #include "clientconnector.h"
+#include "binaryprotocol.h"
 #include <signal.h>
 #include <cstring>
 
@@ -19,7 +20,8 @@ namespace soundalchemy {
 ////////////////////////////////////////////////////////////////////////////////
 
 ClientConnector::ClientConnector(std::string name): name_(name), watcher_(*this),
-		watching_(false), server_(NULL) {
+		watching_(false), server_(NULL), protocol_(Message::PROTOCOL_JSON),
+		negotiated_(false) {
 	thread_ = Thread::getNewThread();
 	mutex_ = Thread::getMutex();
 }
@@ -28,6 +30,26 @@ void ClientConnector::instructServer(InboundMessage& message) {
 	server_->processMessage(message);
 }
 
+InboundMessage* ClientConnector::readMessage(std::istream& input,
+		int delimiter) {
+	if(!negotiated_) {
+		if(input.peek() == BinaryProtocol::MAGIC_0) {
+			protocol_ = Message::PROTOCOL_BINARY;
+			log(LEVEL_INFO, "%s uses the binary protocol", getName().c_str());
+		}
+		negotiated_ = true;
+	}
+
+	if(protocol_ != Message::PROTOCOL_BINARY) {
+		return InboundMessage::unserialize(protocol_, input, delimiter);
+	}
+
+	unsigned int type, length;
+	if(!BinaryProtocol::readFrame(input, frame_, type, length)) return NULL;
+	return InboundMessage::unserialize(type, frame_.empty() ? NULL : &frame_[0],
+			length);
+}
+
 ClientConnector::~ClientConnector() {
 	stopWatching();
 	delete mutex_;
@@ -15,6 +15,8 @@
 #include "dspserver.h"
 #include "message.h"
 #include "thread.h"
+#include <istream>
+#include <vector>
 
 namespace soundalchemy {
 class DspServer;
@@ -51,6 +53,19 @@ protected:
 	void instructServer(InboundMessage& message);
 	virtual InboundMessage* read(void) = 0;
 
+	/**
+	 * Reads the next message from the input of the client. The protocol is
+	 * negotiated by the first message: if it's a binary frame the client
+	 * uses PROTOCOL_BINARY for the rest of the connection, otherwise JSON.
+	 * @param input The input stream of the client.
+	 * @param delimiter The end of a JSON message.
+	 * @return Returns the message or NULL if it can't be parsed.
+	 */
+	InboundMessage* readMessage(std::istream& input, int delimiter);
+
+	/// @return Returns the negotiated protocol, the replies are sent in it.
+	Message::TProtocol getProtocol(void) { return protocol_; }
+
 	class WatchInput: public Runnable {
 	public:
 		WatchInput(ClientConnector& parent):parent_(parent) { }
@@ -70,6 +85,12 @@ protected:
 
 private:
 	DspServer* server_;
+
+	Message::TProtocol protocol_;
+	bool negotiated_;
+
+	// the payloads of the binary frames are read here, it's reused
+	std::vector<char> frame_;
 };
 
 
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "clockbridge.h"
+
+using namespace llaudio;
+
+namespace soundalchemy {
+
+ClockBridge::ClockBridge(): playback_(*this), output_(NULL),
+		thread_(Thread::getNewThread()), channels_(0), alloc_(false),
+		exit_(false), failed_(false) {
+
+	// the playback has to keep up with the device like the processing
+	thread_->setRealtime(Thread::THREAD_WORKER);
+}
+
+ClockBridge::~ClockBridge() {
+	close();
+	delete thread_;
+}
+
+void ClockBridge::prepare(llaOutputStream& output, unsigned int frames,
+		TSampleRate rate) {
+	output_ = &output;
+	channels_ = output.getChannelCount();
+	alloc_ = true;
+
+	// the playback cycle has the same length as the processing cycle
+	if(rate == 0) rate = output.getSampleRate();
+	drift_.prepare(rate, output.getSampleRate(), channels_, frames);
+
+	playback_.setBufferLength(frames);
+	playback_.getOutputBuffer().channelsRequested = (TChannels) channels_;
+}
+
+TErrors ClockBridge::open(void) {
+	if(output_ == NULL) return E_OPEN_STREAM;
+
+	TErrors ret = output_->open();
+	if(ret != llaudio::E_OK || thread_->isRunning()) return ret;
+
+	exit_ = false;
+	failed_ = false;
+	if(thread_->run(*this) == E_THREAD) {
+		output_->close();
+		return E_OPEN_STREAM;
+	}
+	return llaudio::E_OK;
+}
+
+void ClockBridge::close(void) {
+	if(output_ == NULL) return;
+
+	exit_ = true;
+	if(thread_->isRunning()) thread_->join();
+	output_->close();
+}
+
+double ClockBridge::getLatency(void) {
+	if(output_ == NULL) return llaStream::getLatency();
+	return output_->getLatency() + drift_.getLatency();
+}
+
+void* ClockBridge::run(void) {
+	while(!exit_) {
+		if(output_->write(playback_) != llaudio::E_OK) {
+			failed_ = true;
+			break;
+		}
+	}
+	return NULL;
+}
+
+void ClockBridge::Playback::onSamplesReady(void) {
+	bridge_.drift_.pull(getOutputBuffer().getSamples(), getBufferLength());
+	getOutputBuffer().writeSamples();
+}
+
+TErrors ClockBridge::write(llaAudioPipe& buffer) {
+	if(failed_) return E_WRITE_STREAM;
+
+	llaAudioPipe::Buffer& out = buffer.getOutputBuffer();
+	if(alloc_) {
+		out.channelsRequested = (TChannels) channels_;
+		out.alloc();
+		alloc_ = false;
+	}
+
+	buffer.onSamplesReady();
+	if(buffer.fail()) return E_WRITE_STREAM;
+
+	// a failed read gives a negative count
+	TSize frames = getBufferLastWrite(buffer);
+	if(frames <= buffer.getBufferLength()) drift_.push(out.getSamples(), frames);
+
+	return llaudio::E_OK;
+}
+
+} /* namespace soundalchemy */
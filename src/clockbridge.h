@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef CLOCKBRIDGE_H_
+#define CLOCKBRIDGE_H_
+
+#include "thread.h"
+#include "driftbuffer.h"
+#include "llaudio/llaudio.h"
+#include <vector>
+
+namespace soundalchemy {
+
+/**
+ * @brief An output stream which plays to a stream of another device.
+ *
+ * The processing runs in the cycle of the input stream. If the output stream
+ * belongs to another device, it runs on another clock and the two drift
+ * apart slowly, which ends in periodic xruns. The bridge decouples them: the
+ * processing writes to the bridge, the samples are put to a ring buffer and
+ * a separate thread plays them on the output in its own cycle.
+ *
+ * The ring buffer is a DriftBuffer, it resamples the written samples to
+ * follow the drift of the clocks and adds a bounded latency of about its
+ * target fill.
+ */
+class ClockBridge: public llaudio::llaOutputStream, private Runnable {
+public:
+
+	ClockBridge();
+	~ClockBridge();
+
+	/**
+	 * Sets up the bridge for a processing run. Has to be called before the
+	 * bridge is opened, outside of the processing cycle as the buffers are
+	 * allocated here.
+	 * @param output The stream to play to, it has to be opened already to
+	 * know its sample rate and channel count.
+	 * @param frames The buffer length of the processing.
+	 * @param rate The sample rate of the processing, it's the rate of the
+	 * output if 0.
+	 */
+	void prepare(llaudio::llaOutputStream& output, unsigned int frames,
+			llaudio::TSampleRate rate = 0);
+
+	/**
+	 * @return Returns the current ratio of the output and the input rate of
+	 * the resampling.
+	 */
+	double getRatio(void) { return drift_.getRatio(); }
+
+	/* implementable methods from the interface llaStream: */
+	llaudio::TErrors open(void);
+	void close(void);
+
+	const char * getName(void) { return output_->getName(); }
+	int getId(void) { return output_->getId(); }
+
+	llaudio::TErrors setSampleRate(llaudio::TSampleRate sample_rate) {
+		return output_->setSampleRate(sample_rate);
+	}
+	llaudio::TErrors setChannelCount(llaudio::TChannels channels) {
+		return output_->setChannelCount(channels);
+	}
+
+	llaudio::TSampleRate getSampleRate(void) { return output_->getSampleRate(); }
+	llaudio::TChannels getChannelCount(void) { return output_->getChannelCount(); }
+
+	/**
+	 * The latency of the output stream together with the target fill of
+	 * the ring buffer and the delay of the resampler.
+	 * @return Returns the latency in milliseconds.
+	 */
+	double getLatency(void);
+
+	/**
+	 * @return Returns the xruns of the output stream and the overflows and
+	 * underflows of the ring buffer.
+	 */
+	unsigned long getXrunCount(void) {
+		return drift_.getXrunCount() + output_->getXrunCount();
+	}
+
+	/**
+	 * @return Returns the overflows and underflows of the ring buffer only.
+	 */
+	unsigned long getRingXrunCount(void) { return drift_.getXrunCount(); }
+
+	/* implementable methods from llaOutputStream: */
+	llaudio::TErrors write(llaudio::llaAudioPipe& buffer);
+
+private:
+
+	// The buffer of the playback thread. It takes the samples from the ring
+	// buffer when the output stream asks for them.
+	class Playback: public llaudio::llaAudioPipe {
+	public:
+		Playback(ClockBridge& bridge): bridge_(bridge) {}
+		void onSamplesReady(void);
+	private:
+		ClockBridge& bridge_;
+	} playback_;
+
+	// The playback thread, writes to the output stream until close().
+	void* run(void);
+
+	llaudio::llaOutputStream* output_;
+	Thread *thread_;
+
+	unsigned int channels_;
+	bool alloc_;
+
+	// written by the processing thread and read by the playback thread
+	DriftBuffer drift_;
+
+	volatile bool exit_;
+	volatile bool failed_;
+};
+
+} /* namespace soundalchemy */
+#endif /* CLOCKBRIDGE_H_ */
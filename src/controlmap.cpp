@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "controlmap.h"
+#include "logs.h"
+#include <cmath>
+
+namespace soundalchemy {
+
+ControlMap::ControlMap(): mutex_(Thread::getMutex()), learning_(false) {
+}
+
+ControlMap::~ControlMap() {
+	delete mutex_;
+}
+
+void ControlMap::bind(TControlId control, SoundEffect::TEffectID effect,
+		SoundEffect::TParamID param) {
+	Binding binding;
+	binding.effect = effect;
+	binding.param = param;
+
+	mutex_->lock();
+	bindings_[control] = binding;
+	mutex_->unlock();
+}
+
+unsigned int ControlMap::unbind(SoundEffect::TEffectID effect,
+		SoundEffect::TParamID param) {
+	unsigned int count = 0;
+
+	mutex_->lock();
+	if(learning_ && learn_.effect == effect && learn_.param == param) {
+		learning_ = false;
+	}
+
+	TBindings::iterator it = bindings_.begin();
+	while(it != bindings_.end()) {
+		if(it->second.effect == effect && it->second.param == param) {
+			bindings_.erase(it++);
+			count++;
+		}
+		else it++;
+	}
+	mutex_->unlock();
+
+	return count;
+}
+
+void ControlMap::learn(SoundEffect::TEffectID effect,
+		SoundEffect::TParamID param) {
+	mutex_->lock();
+	learn_ = Binding();
+	learn_.effect = effect;
+	learn_.param = param;
+	learning_ = true;
+	mutex_->unlock();
+}
+
+bool ControlMap::find(TControlId control, Binding& binding, bool& learned) {
+	mutex_->lock();
+	learned = learning_;
+	if(learning_) {
+		bindings_[control] = learn_;
+		learning_ = false;
+	}
+
+	TBindings::iterator it = bindings_.find(control);
+	bool found = it != bindings_.end();
+	if(found) binding = it->second;
+	mutex_->unlock();
+
+	if(learned) {
+		log(LEVEL_INFO, "Controller %lx is bound to parameter %lu of effect %lu",
+				control, binding.param, binding.effect);
+	}
+	return found;
+}
+
+void ControlMap::setHandle(TControlId control, const Binding& binding) {
+	mutex_->lock();
+	TBindings::iterator it = bindings_.find(control);
+	// the binding may have been changed while the parameter was resolved
+	if(it != bindings_.end() && it->second.effect == binding.effect &&
+			it->second.param == binding.param) {
+		it->second = binding;
+	}
+	mutex_->unlock();
+}
+
+SoundEffect::TParamValue ControlMap::scale(SoundEffect::Param& param,
+		float position) {
+	SoundEffect::TParamValue min = param.getMin();
+	SoundEffect::TParamValue max = param.getMax();
+
+	switch(param.getType()) {
+	case SoundEffect::Param::PARAM_TOGGLE:
+		return position < 0.5f ? min : max;
+	case SoundEffect::Param::PARAM_INTEGER:
+		return floor(min + position * (max - min) + 0.5);
+	default:
+		break;
+	}
+
+	if(param.isLogarithmic() && min > 0.0 && max > min) {
+		return min * pow(max / min, (SoundEffect::TParamValue) position);
+	}
+	return min + position * (max - min);
+}
+
+} /* namespace soundalchemy */
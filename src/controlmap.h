@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef CONTROLMAP_H_
+#define CONTROLMAP_H_
+
+#include "soundeffect.h"
+#include "thread.h"
+#include <map>
+
+namespace soundalchemy {
+
+/// Identifies a MIDI controller by its kind, channel and number
+typedef unsigned long TControlId;
+
+/**
+ * @brief The bindings of MIDI controllers to effect parameters.
+ *
+ * A controller is a control change (CC) or a non-registered parameter number
+ * (NRPN) on a channel. It's bound to a parameter given by the ID of the
+ * effect and the parameter, the bindings are kept when the effects are
+ * instantiated again. A binding is made explicitly or learned: after
+ * learn() the next controller moved is bound to the parameter.
+ *
+ * The map is used by the thread reading the controllers and by the thread of
+ * the messages, it's locked by its own mutex.
+ */
+class ControlMap {
+public:
+
+	typedef enum {
+		CONTROL_CC,  //!< 7 bit control change
+		CONTROL_NRPN //!< 14 bit non-registered parameter number
+	} TControlKind;
+
+	/// The parameter a controller is bound to
+	struct Binding {
+		Binding(): effect(0), param(0), target(NULL), handle(NULL), layout(0) {}
+
+		SoundEffect::TEffectID effect;
+		SoundEffect::TParamID param;
+
+		// The parameter resolved in the effect chain, it's valid while the
+		// layout of the chain doesn't change.
+		SoundEffect* target;
+		SoundEffect::Param* handle;
+		unsigned long layout;
+	};
+
+	ControlMap();
+	~ControlMap();
+
+	static TControlId makeId(TControlKind kind, unsigned int channel,
+			unsigned int number) {
+		return ((TControlId) kind << 20) | ((channel & 0x0F) << 16) |
+				(number & 0x3FFF);
+	}
+
+	static TControlKind getKind(TControlId id) { return (TControlKind) (id >> 20); }
+	static unsigned int getChannel(TControlId id) { return (id >> 16) & 0x0F; }
+	static unsigned int getNumber(TControlId id) { return id & 0x3FFF; }
+
+	/**
+	 * Binds a controller to a parameter. The previous binding of the
+	 * controller is replaced.
+	 */
+	void bind(TControlId control, SoundEffect::TEffectID effect,
+			SoundEffect::TParamID param);
+
+	/**
+	 * Removes the bindings of a parameter and stops learning it.
+	 * @return Returns the count of the removed bindings.
+	 */
+	unsigned int unbind(SoundEffect::TEffectID effect,
+			SoundEffect::TParamID param);
+
+	/**
+	 * Binds the next controller moved to the parameter.
+	 */
+	void learn(SoundEffect::TEffectID effect, SoundEffect::TParamID param);
+
+	/**
+	 * Looks up the binding of a controller. If a parameter is being learned
+	 * the controller is bound to it first.
+	 * @param control The controller moved.
+	 * @param binding The binding is copied here.
+	 * @param learned Set to true if the controller has just been learned.
+	 * @return Returns false if the controller isn't bound.
+	 */
+	bool find(TControlId control, Binding& binding, bool& learned);
+
+	/**
+	 * Stores the parameter resolved for a binding, so the next events of the
+	 * controller don't have to look it up.
+	 */
+	void setHandle(TControlId control, const Binding& binding);
+
+	/**
+	 * Converts the position of a controller to the range of a parameter.
+	 * @param param The parameter.
+	 * @param position The position of the controller between 0 and 1.
+	 * @return Returns the value of the parameter.
+	 */
+	static SoundEffect::TParamValue scale(SoundEffect::Param& param,
+			float position);
+
+private:
+	typedef std::map<TControlId, Binding> TBindings;
+
+	TBindings bindings_;
+	Mutex *mutex_;
+
+	bool learning_;
+	Binding learn_;
+};
+
+/// A controller event on the way to the parameter worker
+struct ControlEvent {
+	ControlMap::Binding binding;
+	float position;          //!< the position of the controller, 0 to 1
+	unsigned long time;      //!< arrival in microseconds, may wrap around
+};
+
+/**
+ * @brief A lock-free queue of controller events.
+ *
+ * The events are passed from the thread reading the controllers to the
+ * thread setting the parameters without locking, so the controllers are
+ * never blocked by it. There has to be only one pushing and one popping
+ * thread.
+ */
+class ControlQueue {
+public:
+
+	/// The count of events the queue holds, a power of two
+	static const unsigned int SIZE = 256;
+
+	ControlQueue(): write_pos_(0), read_pos_(0) {}
+
+	/**
+	 * @return Returns false if the queue is full, the event is dropped.
+	 */
+	bool push(const ControlEvent& event) {
+		unsigned int pos = write_pos_;
+		if(pos - read_pos_ == SIZE) return false;
+		events_[pos & (SIZE - 1)] = event;
+		__sync_synchronize();
+		write_pos_ = pos + 1;
+		return true;
+	}
+
+	/**
+	 * @return Returns false if the queue is empty.
+	 */
+	bool pop(ControlEvent& event) {
+		unsigned int pos = read_pos_;
+		if(pos == write_pos_) return false;
+		__sync_synchronize();
+		event = events_[pos & (SIZE - 1)];
+		__sync_synchronize();
+		read_pos_ = pos + 1;
+		return true;
+	}
+
+private:
+	// The positions run freely, the index is the position masked with
+	// SIZE - 1. write_pos_ is written by the pushing thread, read_pos_ by the
+	// popping one.
+	ControlEvent events_[SIZE];
+	volatile unsigned int write_pos_;
+	volatile unsigned int read_pos_;
+};
+
+} /* namespace soundalchemy */
+#endif /* CONTROLMAP_H_ */
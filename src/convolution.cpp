@@ -0,0 +1,546 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "convolution.h"
+#include "simd.h"
+#include "logs.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#define ID_RIFF 0x46464952
+#define ID_WAVE 0x45564157
+#define ID_FMT  0x20746d66
+#define ID_DATA 0x61746164
+
+#define WAVE_FORMAT_PCM        0x0001
+#define WAVE_FORMAT_IEEE_FLOAT 0x0003
+#define WAVE_FORMAT_EXTENSIBLE 0xFFFE
+
+namespace soundalchemy {
+
+static NativeEffect::Registrar registrar("convolution", ConvolutionEffect::create);
+
+// wave files above this rate are refused
+static const unsigned int MAX_WAVE_RATE = 384000;
+
+/* ************************************************************************** */
+
+TailWorker::TailWorker(): mutex_(Thread::getMutex()), thread_(NULL),
+		running_(false) {
+}
+
+TailWorker::~TailWorker() {
+	if(thread_ != NULL) {
+		if(running_) {
+			running_ = false;
+			work_.post();
+			thread_->join();
+		}
+		delete thread_;
+	}
+	delete mutex_;
+}
+
+TAlchemyError TailWorker::attach(Convolver* convolver) {
+	TAlchemyError ret = E_OK;
+	mutex_->lock();
+	if(thread_ == NULL) {
+		// the tails are due in real time like the blocks of the bridges, a
+		// scheduling error leaves the thread running with the default one
+		thread_ = Thread::getNewThread();
+		thread_->setRealtime(Thread::THREAD_WORKER);
+		running_ = thread_->run(*this) != E_THREAD;
+	}
+	if(running_) convolvers_.push_back(convolver);
+	else ret = E_THREAD;
+	mutex_->unlock();
+	return ret;
+}
+
+void TailWorker::detach(Convolver* convolver) {
+	mutex_->lock();
+	std::vector<Convolver*>::iterator it = std::find(convolvers_.begin(),
+			convolvers_.end(), convolver);
+	if(it != convolvers_.end()) convolvers_.erase(it);
+	mutex_->unlock();
+}
+
+void* TailWorker::run(void) {
+	for(;;) {
+		work_.wait();
+		if(!running_) break;
+
+		// a post may stand for the blocks of several convolvers
+		mutex_->lock();
+		for(unsigned int i = 0; i < convolvers_.size(); i++)
+			convolvers_[i]->serveTail();
+		mutex_->unlock();
+	}
+	return NULL;
+}
+
+/* ************************************************************************** */
+
+Convolver::Partitions::Partitions(const float* ir, unsigned int length,
+		unsigned int block): block_(block), bins_(block + 1),
+		count_((length + block - 1) / block), fft_(2 * block),
+		h_re_(count_ * bins_), h_im_(count_ * bins_),
+		x_re_(count_ * bins_), x_im_(count_ * bins_), x_pos_(0),
+		acc_re_(bins_), acc_im_(bins_), time_(2 * block) {
+
+	// every partition is zero padded to the double of its length
+	for(unsigned int p = 0; p < count_; p++) {
+		unsigned int taps = length - p * block_;
+		if(taps > block_) taps = block_;
+
+		std::fill(time_.begin(), time_.end(), 0.0f);
+		memcpy(&time_[0], ir + p * block_, taps * sizeof(float));
+		fft_.forward(&time_[0], &h_re_[p * bins_], &h_im_[p * bins_]);
+	}
+}
+
+void Convolver::Partitions::process(const float* in, float* out) {
+	using namespace simd;
+
+	fft_.forward(in, &x_re_[x_pos_ * bins_], &x_im_[x_pos_ * bins_]);
+
+	float *ar = &acc_re_[0];
+	float *ai = &acc_im_[0];
+	std::fill(acc_re_.begin(), acc_re_.end(), 0.0f);
+	std::fill(acc_im_.begin(), acc_im_.end(), 0.0f);
+
+	// multiply every partition with the spectrum of the input it delays
+	unsigned int x = x_pos_;
+	for(unsigned int p = 0; p < count_; p++) {
+		const float *hr = &h_re_[p * bins_];
+		const float *hi = &h_im_[p * bins_];
+		const float *xr = &x_re_[x * bins_];
+		const float *xi = &x_im_[x * bins_];
+
+		unsigned int k = 0;
+		for(; k + LANES <= bins_; k += LANES) {
+			TVec vxr = load(xr + k), vxi = load(xi + k);
+			TVec vhr = load(hr + k), vhi = load(hi + k);
+			store(ar + k, sub(madd(vxr, vhr, load(ar + k)), mul(vxi, vhi)));
+			store(ai + k, madd(vxr, vhi, madd(vxi, vhr, load(ai + k))));
+		}
+		for(; k < bins_; k++) {
+			ar[k] += xr[k] * hr[k] - xi[k] * hi[k];
+			ai[k] += xr[k] * hi[k] + xi[k] * hr[k];
+		}
+
+		x = (x == 0 ? count_ : x) - 1;
+	}
+
+	x_pos_ = (x_pos_ + 1) % count_;
+
+	// overlap-save: the second half is the valid output
+	fft_.inverse(ar, ai, &time_[0]);
+	memcpy(out, &time_[block_], block_ * sizeof(float));
+}
+
+/* ************************************************************************** */
+
+Convolver::Convolver(const std::vector<float>& ir, TailWorker* worker):
+		head_(HEAD_SIZE, 0.0f), input_(2 * HEAD_SIZE, 0.0f), pos_(0),
+		body_(NULL), body_out_(HEAD_SIZE, 0.0f), tail_(NULL),
+		tail_submitted_(0), tail_done_(0), tail_busy_(0), tail_waiting_(false),
+		tail_pos_(0), tail_ready_(false), tail_misses_(0), worker_(NULL),
+		own_worker_(false) {
+
+	unsigned int length = ir.size();
+	const unsigned int tail_start = 2 * TAIL_BLOCK;
+
+	for(unsigned int i = 0; i < HEAD_SIZE && i < length; i++) {
+		head_[HEAD_SIZE - 1 - i] = ir[i];
+	}
+
+	if(length > HEAD_SIZE) {
+		unsigned int end = length < tail_start ? length : tail_start;
+		body_ = new Partitions(&ir[HEAD_SIZE], end - HEAD_SIZE, HEAD_SIZE);
+	}
+
+	if(length > tail_start) {
+		tail_ = new Partitions(&ir[tail_start], length - tail_start, TAIL_BLOCK);
+		tail_in_.assign(TAIL_SLOTS * TAIL_BLOCK, 0.0f);
+		tail_out_.assign(TAIL_SLOTS * TAIL_BLOCK, 0.0f);
+		tail_work_.assign(2 * TAIL_BLOCK, 0.0f);
+
+		own_worker_ = worker == NULL;
+		worker_ = own_worker_ ? new TailWorker() : worker;
+		if(worker_->attach(this) != E_OK) {
+			if(own_worker_) delete worker_;
+			worker_ = NULL;
+			log(LEVEL_WARNING, "%s: the tail is computed in the processing "
+					"thread", STR_ERRORS[E_THREAD]);
+		}
+	}
+}
+
+Convolver::~Convolver() {
+	if(worker_ != NULL) {
+		worker_->detach(this);
+		if(own_worker_) delete worker_;
+	}
+
+	delete body_;
+	delete tail_;
+}
+
+void Convolver::serveTail(void) {
+	// the processing thread posts the worker again if it takes over
+	computeTail(tail_submitted_);
+}
+
+bool Convolver::computeTail(unsigned int until) {
+	while((int) (until - tail_done_) > 0) {
+		// the blocks are claimed one by one, so the other thread can take
+		// over between them
+		if(!__sync_bool_compare_and_swap(&tail_busy_, 0, 1)) return false;
+
+		if((int) (until - tail_done_) > 0) {
+			// The input slot of the next block is overwritten once the
+			// processing thread is TAIL_SLOTS blocks ahead. The blocks lost
+			// are skipped, the tail restarts with the oldest one still
+			// intact.
+			unsigned int submitted = tail_submitted_;
+			if(submitted - tail_done_ >= TAIL_SLOTS) {
+				__sync_add_and_fetch(&tail_misses_, 1);
+				tail_done_ = submitted - (TAIL_SLOTS - 1);
+			}
+
+			__sync_synchronize();
+			processTail(tail_done_);
+			__sync_synchronize();
+			tail_done_ = tail_done_ + 1;
+		}
+
+		__sync_synchronize();
+		tail_busy_ = 0;
+		__sync_synchronize();
+		if(tail_waiting_) tail_wait_.post();
+	}
+	return true;
+}
+
+void Convolver::processTail(unsigned int block) {
+	unsigned int slot = (block % TAIL_SLOTS) * TAIL_BLOCK;
+
+	memcpy(&tail_work_[TAIL_BLOCK], &tail_in_[slot], TAIL_BLOCK * sizeof(float));
+	tail_->process(&tail_work_[0], &tail_out_[slot]);
+	memcpy(&tail_work_[0], &tail_work_[TAIL_BLOCK], TAIL_BLOCK * sizeof(float));
+}
+
+void Convolver::process(const float* in, float* out, unsigned int sample_count) {
+	using namespace simd;
+
+	while(sample_count > 0) {
+		// work until the end of the current head block, the tail blocks end
+		// at head block boundaries too
+		unsigned int count = HEAD_SIZE - pos_;
+		if(count > sample_count) count = sample_count;
+
+		memcpy(&input_[HEAD_SIZE + pos_], in, count * sizeof(float));
+
+		const float *tail = NULL;
+		if(tail_ != NULL) {
+			unsigned int slot = (tail_submitted_ % TAIL_SLOTS) * TAIL_BLOCK;
+			memcpy(&tail_in_[slot + tail_pos_], in, count * sizeof(float));
+			if(tail_ready_) {
+				// the output of the block submitted two blocks ago
+				slot = ((tail_submitted_ + 1) % TAIL_SLOTS) * TAIL_BLOCK;
+				tail = &tail_out_[slot + tail_pos_];
+			}
+		}
+
+		for(unsigned int i = 0; i < count; i++) {
+			const float *x = &input_[pos_ + i + 1];
+			TVec acc = set1(0.0f);
+			for(unsigned int j = 0; j < HEAD_SIZE; j += LANES) {
+				acc = madd(load(&head_[j]), load(x + j), acc);
+			}
+
+			float y = hsum(acc) + body_out_[pos_ + i];
+			if(tail != NULL) y += tail[i];
+			out[i] = y;
+		}
+
+		in += count;
+		out += count;
+		sample_count -= count;
+		pos_ += count;
+
+		if(pos_ == HEAD_SIZE) {
+			if(body_ != NULL) body_->process(&input_[0], &body_out_[0]);
+			memcpy(&input_[0], &input_[HEAD_SIZE], HEAD_SIZE * sizeof(float));
+			pos_ = 0;
+		}
+
+		if(tail_ != NULL) {
+			tail_pos_ += count;
+			if(tail_pos_ == TAIL_BLOCK) {
+				tail_pos_ = 0;
+
+				// hand over the block, the post makes a system call only if
+				// the worker sleeps
+				__sync_synchronize();
+				tail_submitted_ = tail_submitted_ + 1;
+				if(worker_ != NULL) worker_->post();
+
+				// The output of the block submitted two blocks ago is due
+				// now. If the worker is late, it's computed here or waited
+				// for while the worker computes it, it's never left out.
+				unsigned int block = tail_submitted_;
+				if(block >= 2 && (int) (block - 1 - tail_done_) > 0) {
+					__sync_add_and_fetch(&tail_misses_, 1);
+					tail_wait_.reset();
+					tail_waiting_ = true;
+					__sync_synchronize();
+					while(!computeTail(block - 1)) tail_wait_.wait(TAIL_WAIT_MS);
+					tail_waiting_ = false;
+
+					// the worker leaves the blocks to this thread while it
+					// computes one
+					if(worker_ != NULL) worker_->post();
+				}
+				tail_ready_ = block >= 2;
+				__sync_synchronize();
+			}
+		}
+	}
+}
+
+/* ************************************************************************** */
+
+static unsigned int readLE(const unsigned char* p, unsigned int bytes) {
+	unsigned int v = 0;
+	for(unsigned int i = 0; i < bytes; i++) v |= (unsigned int) p[i] << (8 * i);
+	return v;
+}
+
+/**
+ * Reads the first channel of a riff wave file.
+ * @param file Name of the file.
+ * @param samples The samples of the first channel.
+ * @param rate The sample rate of the file.
+ * @return Returns E_OK or E_FILE.
+ */
+static TAlchemyError readWave(const std::string& file,
+		std::vector<float>& samples, unsigned int& rate) {
+
+	FILE *f = fopen(file.c_str(), "rb");
+	if(f == NULL) {
+		log(LEVEL_ERROR, "%s: %s", STR_ERRORS[E_FILE], file.c_str());
+		return E_FILE;
+	}
+
+	// the sizes of the chunks are checked against the size of the file
+	fseek(f, 0, SEEK_END);
+	long file_size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	unsigned char header[12];
+	if(fread(header, sizeof(header), 1, f) != 1 ||
+			readLE(header, 4) != ID_RIFF || readLE(header + 8, 4) != ID_WAVE) {
+		fclose(f);
+		log(LEVEL_ERROR, "%s: %s is not a wave file", STR_ERRORS[E_FILE],
+				file.c_str());
+		return E_FILE;
+	}
+
+	unsigned int format = 0, channels = 0, block_align = 0, bits = 0;
+	unsigned int data_size = 0;
+	bool data = false;
+	rate = 0;
+
+	unsigned char chunk[8];
+	while(!data && fread(chunk, sizeof(chunk), 1, f) == 1) {
+		unsigned int size = readLE(chunk + 4, 4);
+		switch(readLE(chunk, 4)) {
+		case ID_FMT: {
+			unsigned char fmt[40];
+			unsigned int n = size < sizeof(fmt) ? size : sizeof(fmt);
+			if(n < 16 || fread(fmt, n, 1, f) != 1) break;
+			format = readLE(fmt, 2);
+			channels = readLE(fmt + 2, 2);
+			rate = readLE(fmt + 4, 4);
+			block_align = readLE(fmt + 12, 2);
+			bits = readLE(fmt + 14, 2);
+			// the sub format is the first two bytes of the guid
+			if(format == WAVE_FORMAT_EXTENSIBLE && n >= 26)
+				format = readLE(fmt + 24, 2);
+			fseek(f, size - n + (size & 1), SEEK_CUR);
+		} break;
+		case ID_DATA:
+			data_size = size;
+			data = true;
+			break;
+		default:
+			fseek(f, size + (size & 1), SEEK_CUR);
+			break;
+		}
+	}
+
+	// The samples may be padded, e.g. 24 bits in 32 bit containers. The size
+	// of the container comes from the frame size, the valid bits are aligned
+	// to its top.
+	unsigned int bytes = channels > 0 ? block_align / channels : 0;
+	if(bytes == 0) bytes = (bits + 7) / 8;
+	bool pcm = format == WAVE_FORMAT_PCM && bytes >= 1 && bytes <= 4 &&
+			bits <= 8 * bytes;
+	bool ieee = format == WAVE_FORMAT_IEEE_FLOAT && bytes == 4;
+	if(!data || channels == 0 || rate == 0 || rate > MAX_WAVE_RATE ||
+			(!pcm && !ieee)) {
+		fclose(f);
+		log(LEVEL_ERROR, "%s: %s has unsupported format", STR_ERRORS[E_FILE],
+				file.c_str());
+		return E_FILE;
+	}
+
+	// The data may be declared longer than the file, e.g. by a recorder
+	// which didn't finish it. Only the samples of the longest impulse
+	// response are read.
+	unsigned int frame = bytes * channels;
+	long left = file_size - ftell(f);
+	if(left < 0) left = 0;
+	if(data_size > (unsigned long) left) data_size = left;
+	unsigned long long limit = (unsigned long long)
+			ConvolutionEffect::MAX_IR_SECONDS * rate * frame;
+	if(data_size > limit) data_size = limit;
+
+	std::vector<unsigned char> raw(data_size);
+	unsigned int frames = 0;
+	if(data_size > 0) frames = fread(&raw[0], 1, data_size, f) / frame;
+	fclose(f);
+
+	samples.resize(frames);
+	for(unsigned int i = 0; i < frames; i++) {
+		unsigned int v = readLE(&raw[i * frame], bytes);
+		if(ieee) {
+			float s;
+			memcpy(&s, &v, sizeof(s));
+			samples[i] = s;
+		}
+		else if(bytes == 1) {
+			// 8 bit samples are unsigned
+			samples[i] = ((int) v - 128) / 128.0f;
+		}
+		else {
+			// sign extend to 32 bits, the padding bits below are zero
+			int s = (int) (v << (32 - 8 * bytes));
+			samples[i] = s / 2147483648.0f;
+		}
+	}
+
+	return E_OK;
+}
+
+/* ************************************************************************** */
+
+const char* const ConvolutionEffect::DEFAULT_DIRECTORY =
+		"/data/local/tmp/soundalchemy";
+std::string ConvolutionEffect::directory_(DEFAULT_DIRECTORY);
+TailWorker* volatile ConvolutionEffect::tail_worker_ = NULL;
+
+ConvolutionEffect::ConvolutionEffect(llaudio::TSampleRate sample_rate):
+		NativeEffect(sample_rate, "Convolution"), convolver_(NULL),
+		gain_(1.0f) {
+	addParam(new NativeParam("level", 0.0f, -24.0f, 24.0f));
+	addPort(new NativePort(INPUT_PORT, "input"));
+	addPort(new NativePort(OUTPUT_PORT, "output"));
+}
+
+ConvolutionEffect::~ConvolutionEffect() {
+	delete convolver_;
+}
+
+NativeEffect* ConvolutionEffect::create(llaudio::TSampleRate sample_rate) {
+	return new ConvolutionEffect(sample_rate);
+}
+
+void ConvolutionEffect::paramChanged(Param& param) {
+	gain_ = pow(10.0, param.getValue() / 20.0);
+}
+
+void ConvolutionEffect::setSampleRate(llaudio::TSampleRate srate) {
+	NativeEffect::setSampleRate(srate);
+	if(!file_.empty()) loadFile(file_);
+}
+
+TAlchemyError ConvolutionEffect::loadFile(const std::string& file) {
+	std::vector<float> samples;
+	unsigned int rate;
+
+	// the relative names don't depend on the working directory
+	std::string path = file;
+	if(!file.empty() && file[0] != '/' && !directory_.empty())
+		path = directory_ + "/" + file;
+
+	TAlchemyError ret = readWave(path, samples, rate);
+	if(ret != E_OK) return ret;
+	if(samples.empty()) {
+		log(LEVEL_ERROR, "%s: %s is empty", STR_ERRORS[E_FILE], path.c_str());
+		return E_FILE;
+	}
+
+	// linear resampling to the rate of the processing
+	std::vector<float> ir;
+	double step = (double) rate / sample_rate_;
+	unsigned int length = (samples.size() - 1) / step + 1;
+	if(length > MAX_IR_SECONDS * sample_rate_)
+		length = MAX_IR_SECONDS * sample_rate_;
+
+	ir.resize(length);
+	for(unsigned int i = 0; i < length; i++) {
+		double t = i * step;
+		unsigned int n = t;
+		double frac = t - n;
+		float next = n + 1 < samples.size() ? samples[n + 1] : 0.0f;
+		ir[i] = samples[n] + frac * (next - samples[n]);
+	}
+
+	// the impulse response is scaled to keep the loudness of the resampled one
+	if(rate != sample_rate_) {
+		for(unsigned int i = 0; i < length; i++) ir[i] *= step;
+	}
+
+	Convolver *conv = new Convolver(ir, tail_worker_);
+
+	mutex_->lock();
+	Convolver *old = convolver_;
+	convolver_ = conv;
+	tail_length_ = length;
+	mutex_->unlock();
+
+	delete old;
+	file_ = file;
+	return E_OK;
+}
+
+void ConvolutionEffect::process(unsigned int sample_count) {
+	TSample *in = inputs_[0]->getBuffer();
+	TSample *out = outputs_[0]->getBuffer();
+	if(in == NULL || out == NULL) return;
+
+	if(convolver_ == NULL) {
+		if(in != out) memcpy(out, in, sample_count * sizeof(TSample));
+		return;
+	}
+
+	convolver_->process(in, out, sample_count);
+
+	if(gain_ != 1.0f) {
+		for(unsigned int i = 0; i < sample_count; i++) out[i] *= gain_;
+	}
+}
+
+} /* namespace soundalchemy */
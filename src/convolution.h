@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef CONVOLUTION_H_
+#define CONVOLUTION_H_
+
+#include "nativeeffect.h"
+#include "fft.h"
+#include "thread.h"
+#include <vector>
+
+namespace soundalchemy {
+
+class Convolver;
+
+/**
+ * @brief Computes the tails of the convolvers in a single thread.
+ *
+ * The convolvers attach themselves to a worker when they have a tail. The
+ * processing thread only posts the worker when a tail block is complete, the
+ * worker computes the pending blocks of every attached convolver. The thread
+ * is started by the first attach and runs until the worker is destroyed, the
+ * convolvers have to be destroyed before it.
+ */
+class TailWorker: public Runnable {
+public:
+	TailWorker();
+	~TailWorker();
+
+	/**
+	 * Adds a convolver to the served ones.
+	 * @return Returns E_OK or E_THREAD if the thread can't be started.
+	 */
+	TAlchemyError attach(Convolver* convolver);
+
+	/// Removes a convolver, it isn't served any more when this returns.
+	void detach(Convolver* convolver);
+
+	/// Wakes the worker, called by the processing thread without locking.
+	void post(void) { work_.post(); }
+
+	void* run(void);
+
+private:
+	// guards the convolvers against the attaches and the detaches, it's
+	// never locked by the processing thread
+	Mutex *mutex_;
+	std::vector<Convolver*> convolvers_;
+
+	Thread *thread_;
+	volatile bool running_;
+
+	// Posted with every submitted block and on exit. The processing thread
+	// wakes the worker without locking.
+	Semaphore work_;
+};
+
+/**
+ * @brief Zero latency convolution with long impulse responses.
+ *
+ * The impulse response is cut into three segments:
+ * - the head of HEAD_SIZE taps is computed in direct form, so the output has
+ *   no latency,
+ * - the body up to 2*TAIL_BLOCK taps is computed with uniformly partitioned
+ *   FFT convolution with HEAD_SIZE long partitions in the processing thread,
+ * - the rest is computed with TAIL_BLOCK long partitions by a TailWorker.
+ *
+ * The worker gets a block of TAIL_BLOCK input samples when it's complete and
+ * has the time of one more block to compute the result, as the tail only
+ * starts 2*TAIL_BLOCK samples later. The blocks are handed over through rings
+ * of three slots indexed by sequence counters. If the worker is late, the
+ * processing thread computes the block due itself, or waits for it while the
+ * worker is computing it, and counts it in getTailMisses().
+ */
+class Convolver {
+public:
+
+	/// Length of the direct form head and of the body partitions
+	static const unsigned int HEAD_SIZE = 64;
+
+	/// Length of the partitions computed by the worker thread
+	static const unsigned int TAIL_BLOCK = 1024;
+
+	/**
+	 * Prepares the partitions of the impulse response and attaches it to a
+	 * worker if the response is long enough to have a tail.
+	 * @param ir The impulse response at the sample rate of the processing.
+	 * @param worker The worker of the tail. If it's NULL the convolver
+	 * starts a worker of its own.
+	 */
+	Convolver(const std::vector<float>& ir, TailWorker* worker = NULL);
+
+	/// Detaches from the worker.
+	~Convolver();
+
+	/**
+	 * Convolves the input with the impulse response.
+	 * @param in Input samples.
+	 * @param out Output samples, it can be the same buffer as the input.
+	 * @param sample_count Count of the samples.
+	 */
+	void process(const float* in, float* out, unsigned int sample_count);
+
+	/// @return Returns the count of the tail blocks the worker was late with.
+	unsigned int getTailMisses(void) { return tail_misses_; }
+
+	/// Computes the tail blocks submitted since the last call, called by
+	/// the worker.
+	void serveTail(void);
+
+private:
+
+	/**
+	 * Uniformly partitioned overlap-save convolution with a frequency domain
+	 * delay line.
+	 */
+	class Partitions {
+	public:
+		/**
+		 * @param ir Taps of the filter.
+		 * @param length Count of the taps.
+		 * @param block Length of a partition.
+		 */
+		Partitions(const float* ir, unsigned int length, unsigned int block);
+
+		/**
+		 * Convolves a block.
+		 * @param in The previous and the current input block after each other.
+		 * @param out The block output of the filter for the current block.
+		 */
+		void process(const float* in, float* out);
+
+	private:
+		unsigned int block_;
+		unsigned int bins_;
+		unsigned int count_;
+		FFT fft_;
+
+		// spectra of the partitions and the delay line of the input spectra,
+		// count_*bins_ values each
+		std::vector<float> h_re_, h_im_;
+		std::vector<float> x_re_, x_im_;
+		unsigned int x_pos_;
+
+		std::vector<float> acc_re_, acc_im_;
+		std::vector<float> time_;
+	};
+
+	// slots of the tail rings
+	static const unsigned int TAIL_SLOTS = 3;
+
+	// the longest wait of the processing thread for a block the worker
+	// computes before it checks it again
+	static const int TAIL_WAIT_MS = 1;
+
+	/**
+	 * Computes the submitted tail blocks before a sequence number, if the
+	 * other thread doesn't compute one of them.
+	 * @param until The sequence number of the first block left.
+	 * @return Returns false if the other thread is computing a block.
+	 */
+	bool computeTail(unsigned int until);
+
+	void processTail(unsigned int block);
+
+	// the head taps in reverse order for the direct form
+	std::vector<float> head_;
+
+	// the previous and the current block of the input
+	std::vector<float> input_;
+	unsigned int pos_;
+
+	Partitions *body_;
+	std::vector<float> body_out_;
+
+	Partitions *tail_;
+	std::vector<float> tail_in_;
+	std::vector<float> tail_out_;
+	std::vector<float> tail_work_;
+
+	// sequence numbers of the tail blocks
+	volatile unsigned int tail_submitted_;
+	volatile unsigned int tail_done_;
+
+	// set by the thread computing a tail block. The worker posts tail_wait_
+	// after a block while the processing thread waits for it.
+	volatile int tail_busy_;
+	volatile bool tail_waiting_;
+	Semaphore tail_wait_;
+
+	unsigned int tail_pos_;
+	bool tail_ready_;
+	volatile unsigned int tail_misses_;
+
+	// the worker of the tail, NULL if there is no tail or it can't be
+	// computed. own_worker_ is set if the worker is owned by this convolver.
+	TailWorker *worker_;
+	bool own_worker_;
+};
+
+/**
+ * A mono effect convolving the signal with an impulse response loaded from a
+ * wave file, e.g. a guitar cabinet response. The response is resampled
+ * linearly if its sample rate differs from the processing. A relative file
+ * name is looked up in the directory set by setDirectory().
+ */
+class ConvolutionEffect: public NativeEffect {
+public:
+
+	/// Impulse responses are cut at this length
+	static const unsigned int MAX_IR_SECONDS = 10;
+
+	/// The directory of the impulse responses if none is set
+	static const char* const DEFAULT_DIRECTORY;
+
+	/**
+	 * Sets the directory the relative file names are looked up in.
+	 */
+	static void setDirectory(const std::string& directory) {
+		directory_ = directory;
+	}
+
+	/**
+	 * Sets the worker computing the tails of the effects created after it.
+	 * @param worker The worker, or NULL to give every effect its own.
+	 */
+	static void setTailWorker(TailWorker* worker) { tail_worker_ = worker; }
+
+	ConvolutionEffect(llaudio::TSampleRate sample_rate);
+	~ConvolutionEffect();
+
+	static NativeEffect* create(llaudio::TSampleRate sample_rate);
+
+	void process(unsigned int sample_count);
+
+	void setSampleRate(llaudio::TSampleRate srate);
+
+	TAlchemyError loadFile(const std::string& file);
+
+	/// @return Returns the count of the tail blocks the worker was late with.
+	unsigned int getTailMisses(void) {
+		return convolver_ != NULL ? convolver_->getTailMisses() : 0;
+	}
+
+protected:
+
+	void paramChanged(Param& param);
+
+private:
+
+	static std::string directory_;
+	static TailWorker* volatile tail_worker_;
+
+	Convolver *convolver_;
+	std::string file_;
+
+	// linear gain of the level parameter
+	float gain_;
+};
+
+} /* namespace soundalchemy */
+#endif /* CONVOLUTION_H_ */
@@ -33,125 +33,157 @@ unsigned char effects_json[] = {
   0x73, 0x2e, 0x73, 0x6f, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70,
   0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61,
   0x6d, 0x22, 0x3a, 0x20, 0x09, 0x22, 0x41, 0x6d, 0x70, 0x56, 0x54, 0x53,
-  0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x6f, 0x70, 0x74, 0x69, 0x6f,
+  0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x74, 0x61, 0x69, 0x6c, 0x22,
+  0x3a, 0x09, 0x09, 0x09, 0x09, 0x30, 0x2e, 0x31, 0x2c, 0x0a, 0x09, 0x09,
+  0x09, 0x22, 0x6f, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x73, 0x22, 0x3a, 0x20,
+  0x09, 0x09, 0x09, 0x7b, 0x0a, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09,
+  0x09, 0x09, 0x22, 0x70, 0x61, 0x72, 0x61, 0x6d, 0x22, 0x3a, 0x20, 0x22,
+  0x74, 0x6f, 0x6e, 0x65, 0x73, 0x74, 0x61, 0x63, 0x6b, 0x22, 0x2c, 0x0a,
+  0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x22, 0x76, 0x61,
+  0x6c, 0x75, 0x65, 0x73, 0x22, 0x3a, 0x20, 0x5b, 0x22, 0x62, 0x61, 0x73,
+  0x73, 0x77, 0x6f, 0x6d, 0x61, 0x6e, 0x22, 0x2c, 0x20, 0x22, 0x74, 0x77,
+  0x69, 0x6e, 0x22, 0x2c, 0x20, 0x22, 0x77, 0x6f, 0x6f, 0x6b, 0x69, 0x65,
+  0x22, 0x2c, 0x20, 0x22, 0x44, 0x43, 0x20, 0x33, 0x30, 0x22, 0x2c, 0x20,
+  0x22, 0x6a, 0x75, 0x69, 0x63, 0x65, 0x20, 0x38, 0x30, 0x30, 0x22, 0x2c,
+  0x20, 0x22, 0x73, 0x74, 0x61, 0x6e, 0x66, 0x6f, 0x72, 0x64, 0x22, 0x2c,
+  0x20, 0x22, 0x48, 0x4b, 0x20, 0x32, 0x30, 0x22, 0x2c, 0x20, 0x22, 0x6e,
+  0x69, 0x68, 0x6f, 0x6e, 0x20, 0x61, 0x63, 0x65, 0x22, 0x2c, 0x20, 0x22,
+  0x70, 0x6f, 0x72, 0x6b, 0x79, 0x22, 0x5d, 0x0a, 0x09, 0x09, 0x09, 0x09,
+  0x09, 0x09, 0x09, 0x09, 0x7d, 0x0a, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09,
+  0x09, 0x09, 0x0a, 0x09, 0x09, 0x7d, 0x2c, 0x0a, 0x09, 0x09, 0x7b, 0x20,
+  0x09, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a,
+  0x20, 0x09, 0x09, 0x09, 0x22, 0x43, 0x2a, 0x20, 0x47, 0x75, 0x69, 0x74,
+  0x61, 0x72, 0x20, 0x41, 0x6d, 0x70, 0x20, 0x6d, 0x6f, 0x64, 0x65, 0x6c,
+  0x73, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x20, 0x20, 0x09, 0x22, 0x73, 0x68,
+  0x6f, 0x72, 0x74, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x20, 0x09,
+  0x09, 0x22, 0x63, 0x61, 0x70, 0x73, 0x5f, 0x74, 0x6f, 0x6e, 0x65, 0x73,
+  0x74, 0x61, 0x63, 0x6b, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x64,
+  0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a,
+  0x20, 0x09, 0x09, 0x22, 0x47, 0x75, 0x69, 0x74, 0x61, 0x72, 0x20, 0x61,
+  0x6d, 0x70, 0x6c, 0x69, 0x66, 0x69, 0x65, 0x72, 0x20, 0x73, 0x69, 0x6d,
+  0x75, 0x6c, 0x61, 0x74, 0x6f, 0x72, 0x20, 0x77, 0x69, 0x74, 0x68, 0x20,
+  0x64, 0x69, 0x66, 0x66, 0x65, 0x72, 0x65, 0x6e, 0x74, 0x20, 0x61, 0x6d,
+  0x70, 0x20, 0x6d, 0x6f, 0x64, 0x65, 0x6c, 0x73, 0x20, 0x28, 0x74, 0x6f,
+  0x6e, 0x65, 0x73, 0x74, 0x61, 0x63, 0x6b, 0x29, 0x20, 0x66, 0x6f, 0x72,
+  0x6d, 0x20, 0x74, 0x68, 0x65, 0x20, 0x43, 0x41, 0x50, 0x53, 0x20, 0x70,
+  0x61, 0x63, 0x6b, 0x61, 0x67, 0x65, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09,
+  0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x74, 0x79, 0x70, 0x65,
+  0x22, 0x3a, 0x20, 0x09, 0x09, 0x22, 0x4c, 0x41, 0x44, 0x53, 0x50, 0x41,
+  0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69,
+  0x6e, 0x5f, 0x66, 0x69, 0x6c, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x63,
+  0x61, 0x70, 0x73, 0x2e, 0x73, 0x6f, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09,
+  0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x70, 0x72, 0x6f, 0x67,
+  0x72, 0x61, 0x6d, 0x22, 0x3a, 0x20, 0x09, 0x22, 0x54, 0x6f, 0x6e, 0x65,
+  0x53, 0x74, 0x61, 0x63, 0x6b, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22,
+  0x74, 0x61, 0x69, 0x6c, 0x22, 0x3a, 0x09, 0x09, 0x09, 0x09, 0x30, 0x2e,
+  0x31, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x6f, 0x70, 0x74, 0x69, 0x6f,
   0x6e, 0x73, 0x22, 0x3a, 0x20, 0x09, 0x09, 0x09, 0x7b, 0x0a, 0x09, 0x09,
   0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x22, 0x70, 0x61, 0x72, 0x61,
-  0x6d, 0x22, 0x3a, 0x20, 0x22, 0x74, 0x6f, 0x6e, 0x65, 0x73, 0x74, 0x61,
-  0x63, 0x6b, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09,
-  0x09, 0x09, 0x22, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x73, 0x22, 0x3a, 0x20,
-  0x5b, 0x22, 0x62, 0x61, 0x73, 0x73, 0x77, 0x6f, 0x6d, 0x61, 0x6e, 0x22,
-  0x2c, 0x20, 0x22, 0x74, 0x77, 0x69, 0x6e, 0x22, 0x2c, 0x20, 0x22, 0x77,
-  0x6f, 0x6f, 0x6b, 0x69, 0x65, 0x22, 0x2c, 0x20, 0x22, 0x44, 0x43, 0x20,
-  0x33, 0x30, 0x22, 0x2c, 0x20, 0x22, 0x6a, 0x75, 0x69, 0x63, 0x65, 0x20,
-  0x38, 0x30, 0x30, 0x22, 0x2c, 0x20, 0x22, 0x73, 0x74, 0x61, 0x6e, 0x66,
-  0x6f, 0x72, 0x64, 0x22, 0x2c, 0x20, 0x22, 0x48, 0x4b, 0x20, 0x32, 0x30,
-  0x22, 0x2c, 0x20, 0x22, 0x6e, 0x69, 0x68, 0x6f, 0x6e, 0x20, 0x61, 0x63,
-  0x65, 0x22, 0x2c, 0x20, 0x22, 0x70, 0x6f, 0x72, 0x6b, 0x79, 0x22, 0x5d,
-  0x0a, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x7d, 0x0a, 0x09,
-  0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x0a, 0x09, 0x09, 0x7d, 0x2c,
-  0x0a, 0x09, 0x09, 0x7b, 0x20, 0x09, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x6e,
-  0x61, 0x6d, 0x65, 0x22, 0x3a, 0x20, 0x09, 0x09, 0x09, 0x22, 0x43, 0x2a,
-  0x20, 0x47, 0x75, 0x69, 0x74, 0x61, 0x72, 0x20, 0x41, 0x6d, 0x70, 0x20,
-  0x6d, 0x6f, 0x64, 0x65, 0x6c, 0x73, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x20,
-  0x20, 0x09, 0x22, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x5f, 0x6e, 0x61, 0x6d,
-  0x65, 0x22, 0x3a, 0x20, 0x09, 0x09, 0x22, 0x63, 0x61, 0x70, 0x73, 0x5f,
-  0x74, 0x6f, 0x6e, 0x65, 0x73, 0x74, 0x61, 0x63, 0x6b, 0x22, 0x2c, 0x0a,
+  0x6d, 0x22, 0x3a, 0x20, 0x22, 0x6d, 0x6f, 0x64, 0x65, 0x6c, 0x22, 0x2c,
+  0x0a, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x22, 0x76,
+  0x61, 0x6c, 0x75, 0x65, 0x73, 0x22, 0x3a, 0x20, 0x5b, 0x22, 0x62, 0x61,
+  0x73, 0x73, 0x77, 0x6f, 0x6d, 0x61, 0x6e, 0x22, 0x2c, 0x20, 0x22, 0x74,
+  0x77, 0x69, 0x6e, 0x22, 0x2c, 0x20, 0x22, 0x77, 0x6f, 0x6f, 0x6b, 0x69,
+  0x65, 0x22, 0x2c, 0x20, 0x22, 0x44, 0x43, 0x20, 0x33, 0x30, 0x22, 0x2c,
+  0x20, 0x22, 0x6a, 0x75, 0x69, 0x63, 0x65, 0x20, 0x38, 0x30, 0x30, 0x22,
+  0x2c, 0x20, 0x22, 0x73, 0x74, 0x61, 0x6e, 0x66, 0x6f, 0x72, 0x64, 0x22,
+  0x2c, 0x20, 0x22, 0x48, 0x4b, 0x20, 0x32, 0x30, 0x22, 0x2c, 0x20, 0x22,
+  0x6e, 0x69, 0x68, 0x6f, 0x6e, 0x20, 0x61, 0x63, 0x65, 0x22, 0x2c, 0x20,
+  0x22, 0x70, 0x6f, 0x72, 0x6b, 0x79, 0x22, 0x5d, 0x0a, 0x09, 0x09, 0x09,
+  0x09, 0x09, 0x09, 0x09, 0x09, 0x7d, 0x0a, 0x09, 0x09, 0x09, 0x09, 0x09,
+  0x09, 0x09, 0x09, 0x0a, 0x09, 0x09, 0x7d, 0x0a, 0x0a, 0x09, 0x5d, 0x2c,
+  0x0a, 0x0a, 0x09, 0x22, 0x63, 0x61, 0x62, 0x69, 0x6e, 0x65, 0x74, 0x5f,
+  0x6d, 0x6f, 0x64, 0x65, 0x6c, 0x73, 0x22, 0x3a, 0x20, 0x5b, 0x0a, 0x09,
+  0x09, 0x7b, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22,
+  0x3a, 0x20, 0x09, 0x09, 0x09, 0x22, 0x43, 0x2a, 0x20, 0x43, 0x61, 0x62,
+  0x69, 0x6e, 0x65, 0x74, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x73,
+  0x68, 0x6f, 0x72, 0x74, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x09,
+  0x09, 0x22, 0x63, 0x61, 0x70, 0x73, 0x5f, 0x63, 0x61, 0x62, 0x69, 0x6e,
+  0x65, 0x74, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x64, 0x65, 0x73,
+  0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x09, 0x09,
+  0x22, 0x47, 0x75, 0x69, 0x74, 0x61, 0x72, 0x20, 0x63, 0x61, 0x62, 0x69,
+  0x6e, 0x65, 0x74, 0x20, 0x6d, 0x6f, 0x64, 0x65, 0x6c, 0x20, 0x66, 0x72,
+  0x6f, 0x6d, 0x20, 0x74, 0x68, 0x65, 0x20, 0x43, 0x41, 0x50, 0x53, 0x20,
+  0x70, 0x61, 0x63, 0x6b, 0x61, 0x67, 0x65, 0x22, 0x2c, 0x0a, 0x09, 0x09,
+  0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x74, 0x79, 0x70,
+  0x65, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x4c, 0x41, 0x44, 0x53, 0x50, 0x41,
+  0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69,
+  0x6e, 0x5f, 0x66, 0x69, 0x6c, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x63,
+  0x61, 0x70, 0x73, 0x2e, 0x73, 0x6f, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09,
+  0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x70, 0x72, 0x6f, 0x67,
+  0x72, 0x61, 0x6d, 0x22, 0x3a, 0x09, 0x22, 0x43, 0x61, 0x62, 0x69, 0x6e,
+  0x65, 0x74, 0x49, 0x56, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x74,
+  0x61, 0x69, 0x6c, 0x22, 0x3a, 0x09, 0x09, 0x09, 0x09, 0x30, 0x2e, 0x31,
+  0x0a, 0x09, 0x09, 0x7d, 0x2c, 0x0a, 0x09, 0x09, 0x7b, 0x0a, 0x09, 0x09,
+  0x09, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x09, 0x09,
+  0x22, 0x49, 0x6d, 0x70, 0x75, 0x6c, 0x73, 0x65, 0x20, 0x72, 0x65, 0x73,
+  0x70, 0x6f, 0x6e, 0x73, 0x65, 0x20, 0x63, 0x61, 0x62, 0x69, 0x6e, 0x65,
+  0x74, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x73, 0x68, 0x6f, 0x72,
+  0x74, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x69,
+  0x72, 0x5f, 0x63, 0x61, 0x62, 0x69, 0x6e, 0x65, 0x74, 0x22, 0x2c, 0x0a,
   0x09, 0x09, 0x09, 0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74,
-  0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x20, 0x09, 0x09, 0x22, 0x47, 0x75, 0x69,
-  0x74, 0x61, 0x72, 0x20, 0x61, 0x6d, 0x70, 0x6c, 0x69, 0x66, 0x69, 0x65,
-  0x72, 0x20, 0x73, 0x69, 0x6d, 0x75, 0x6c, 0x61, 0x74, 0x6f, 0x72, 0x20,
-  0x77, 0x69, 0x74, 0x68, 0x20, 0x64, 0x69, 0x66, 0x66, 0x65, 0x72, 0x65,
-  0x6e, 0x74, 0x20, 0x61, 0x6d, 0x70, 0x20, 0x6d, 0x6f, 0x64, 0x65, 0x6c,
-  0x73, 0x20, 0x28, 0x74, 0x6f, 0x6e, 0x65, 0x73, 0x74, 0x61, 0x63, 0x6b,
-  0x29, 0x20, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x74, 0x68, 0x65, 0x20, 0x43,
-  0x41, 0x50, 0x53, 0x20, 0x70, 0x61, 0x63, 0x6b, 0x61, 0x67, 0x65, 0x22,
-  0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e,
-  0x5f, 0x74, 0x79, 0x70, 0x65, 0x22, 0x3a, 0x20, 0x09, 0x09, 0x22, 0x4c,
-  0x41, 0x44, 0x53, 0x50, 0x41, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22,
-  0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x66, 0x69, 0x6c, 0x65, 0x22,
-  0x3a, 0x09, 0x09, 0x22, 0x63, 0x61, 0x70, 0x73, 0x2e, 0x73, 0x6f, 0x22,
-  0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e,
-  0x5f, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x22, 0x3a, 0x20, 0x09,
-  0x22, 0x54, 0x6f, 0x6e, 0x65, 0x53, 0x74, 0x61, 0x63, 0x6b, 0x22, 0x2c,
-  0x0a, 0x09, 0x09, 0x09, 0x22, 0x6f, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x73,
-  0x22, 0x3a, 0x20, 0x09, 0x09, 0x09, 0x7b, 0x0a, 0x09, 0x09, 0x09, 0x09,
-  0x09, 0x09, 0x09, 0x09, 0x09, 0x22, 0x70, 0x61, 0x72, 0x61, 0x6d, 0x22,
-  0x3a, 0x20, 0x22, 0x6d, 0x6f, 0x64, 0x65, 0x6c, 0x22, 0x2c, 0x0a, 0x09,
-  0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x22, 0x76, 0x61, 0x6c,
-  0x75, 0x65, 0x73, 0x22, 0x3a, 0x20, 0x5b, 0x22, 0x62, 0x61, 0x73, 0x73,
-  0x77, 0x6f, 0x6d, 0x61, 0x6e, 0x22, 0x2c, 0x20, 0x22, 0x74, 0x77, 0x69,
-  0x6e, 0x22, 0x2c, 0x20, 0x22, 0x77, 0x6f, 0x6f, 0x6b, 0x69, 0x65, 0x22,
-  0x2c, 0x20, 0x22, 0x44, 0x43, 0x20, 0x33, 0x30, 0x22, 0x2c, 0x20, 0x22,
-  0x6a, 0x75, 0x69, 0x63, 0x65, 0x20, 0x38, 0x30, 0x30, 0x22, 0x2c, 0x20,
-  0x22, 0x73, 0x74, 0x61, 0x6e, 0x66, 0x6f, 0x72, 0x64, 0x22, 0x2c, 0x20,
-  0x22, 0x48, 0x4b, 0x20, 0x32, 0x30, 0x22, 0x2c, 0x20, 0x22, 0x6e, 0x69,
-  0x68, 0x6f, 0x6e, 0x20, 0x61, 0x63, 0x65, 0x22, 0x2c, 0x20, 0x22, 0x70,
-  0x6f, 0x72, 0x6b, 0x79, 0x22, 0x5d, 0x0a, 0x09, 0x09, 0x09, 0x09, 0x09,
-  0x09, 0x09, 0x09, 0x7d, 0x0a, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09,
-  0x09, 0x0a, 0x09, 0x09, 0x7d, 0x0a, 0x0a, 0x09, 0x5d, 0x2c, 0x0a, 0x0a,
-  0x09, 0x22, 0x63, 0x61, 0x62, 0x69, 0x6e, 0x65, 0x74, 0x5f, 0x6d, 0x6f,
-  0x64, 0x65, 0x6c, 0x73, 0x22, 0x3a, 0x20, 0x5b, 0x0a, 0x09, 0x09, 0x7b,
-  0x0a, 0x09, 0x09, 0x09, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x20,
-  0x09, 0x09, 0x09, 0x22, 0x43, 0x2a, 0x20, 0x43, 0x61, 0x62, 0x69, 0x6e,
-  0x65, 0x74, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x73, 0x68, 0x6f,
-  0x72, 0x74, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x22,
-  0x63, 0x61, 0x70, 0x73, 0x5f, 0x63, 0x61, 0x62, 0x69, 0x6e, 0x65, 0x74,
-  0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x64, 0x65, 0x73, 0x63, 0x72,
-  0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x47,
-  0x75, 0x69, 0x74, 0x61, 0x72, 0x20, 0x63, 0x61, 0x62, 0x69, 0x6e, 0x65,
-  0x74, 0x20, 0x6d, 0x6f, 0x64, 0x65, 0x6c, 0x20, 0x66, 0x72, 0x6f, 0x6d,
-  0x20, 0x74, 0x68, 0x65, 0x20, 0x43, 0x41, 0x50, 0x53, 0x20, 0x70, 0x61,
-  0x63, 0x6b, 0x61, 0x67, 0x65, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22,
-  0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x74, 0x79, 0x70, 0x65, 0x22,
-  0x3a, 0x09, 0x09, 0x22, 0x4c, 0x41, 0x44, 0x53, 0x50, 0x41, 0x22, 0x2c,
-  0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f,
-  0x66, 0x69, 0x6c, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x63, 0x61, 0x70,
-  0x73, 0x2e, 0x73, 0x6f, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70,
-  0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61,
-  0x6d, 0x22, 0x3a, 0x09, 0x22, 0x43, 0x61, 0x62, 0x69, 0x6e, 0x65, 0x74,
-  0x49, 0x56, 0x22, 0x0a, 0x09, 0x09, 0x7d, 0x0a, 0x09, 0x5d, 0x2c, 0x0a,
-  0x09, 0x0a, 0x09, 0x22, 0x64, 0x69, 0x73, 0x74, 0x6f, 0x72, 0x74, 0x69,
-  0x6f, 0x6e, 0x73, 0x22, 0x3a, 0x20, 0x5b, 0x0a, 0x09, 0x09, 0x7b, 0x0a,
-  0x09, 0x09, 0x09, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x20, 0x09,
-  0x09, 0x09, 0x22, 0x43, 0x41, 0x50, 0x53, 0x20, 0x64, 0x69, 0x73, 0x74,
-  0x6f, 0x72, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09,
-  0x22, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x22,
-  0x3a, 0x09, 0x09, 0x22, 0x63, 0x61, 0x70, 0x73, 0x5f, 0x64, 0x69, 0x73,
-  0x74, 0x6f, 0x72, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x2c, 0x0a, 0x09, 0x09,
-  0x09, 0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f,
-  0x6e, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x53, 0x61, 0x74, 0x75, 0x72, 0x61,
-  0x74, 0x65, 0x20, 0x64, 0x69, 0x73, 0x74, 0x6f, 0x72, 0x74, 0x69, 0x6f,
-  0x6e, 0x20, 0x6d, 0x6f, 0x64, 0x65, 0x6c, 0x20, 0x66, 0x72, 0x6f, 0x6d,
-  0x20, 0x74, 0x68, 0x65, 0x20, 0x43, 0x41, 0x50, 0x53, 0x20, 0x70, 0x61,
-  0x63, 0x6b, 0x61, 0x67, 0x65, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22,
-  0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x74, 0x79, 0x70, 0x65, 0x22,
-  0x3a, 0x09, 0x09, 0x22, 0x4c, 0x41, 0x44, 0x53, 0x50, 0x41, 0x22, 0x2c,
-  0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f,
-  0x66, 0x69, 0x6c, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x63, 0x61, 0x70,
-  0x73, 0x2e, 0x73, 0x6f, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70,
-  0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61,
-  0x6d, 0x22, 0x3a, 0x09, 0x22, 0x53, 0x61, 0x74, 0x75, 0x72, 0x61, 0x74,
-  0x65, 0x22, 0x0a, 0x09, 0x09, 0x7d, 0x2c, 0x0a, 0x09, 0x09, 0x7b, 0x0a,
-  0x09, 0x09, 0x09, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x20, 0x09,
-  0x09, 0x09, 0x22, 0x43, 0x41, 0x50, 0x53, 0x20, 0x6d, 0x6f, 0x6e, 0x6f,
-  0x20, 0x63, 0x6f, 0x6d, 0x70, 0x72, 0x65, 0x73, 0x73, 0x6f, 0x72, 0x22,
-  0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x5f,
-  0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x63, 0x61, 0x70,
-  0x73, 0x5f, 0x6d, 0x6f, 0x6e, 0x6f, 0x5f, 0x63, 0x6f, 0x6d, 0x70, 0x72,
-  0x65, 0x73, 0x73, 0x6f, 0x72, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22,
+  0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x47, 0x75, 0x69, 0x74,
+  0x61, 0x72, 0x20, 0x63, 0x61, 0x62, 0x69, 0x6e, 0x65, 0x74, 0x20, 0x66,
+  0x72, 0x6f, 0x6d, 0x20, 0x61, 0x20, 0x72, 0x65, 0x63, 0x6f, 0x72, 0x64,
+  0x65, 0x64, 0x20, 0x69, 0x6d, 0x70, 0x75, 0x6c, 0x73, 0x65, 0x20, 0x72,
+  0x65, 0x73, 0x70, 0x6f, 0x6e, 0x73, 0x65, 0x20, 0x28, 0x63, 0x61, 0x62,
+  0x69, 0x6e, 0x65, 0x74, 0x2e, 0x77, 0x61, 0x76, 0x29, 0x22, 0x2c, 0x0a,
+  0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x74,
+  0x79, 0x70, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x4e, 0x41, 0x54, 0x49,
+  0x56, 0x45, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75,
+  0x67, 0x69, 0x6e, 0x5f, 0x66, 0x69, 0x6c, 0x65, 0x22, 0x3a, 0x09, 0x09,
+  0x22, 0x63, 0x61, 0x62, 0x69, 0x6e, 0x65, 0x74, 0x2e, 0x77, 0x61, 0x76,
+  0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69,
+  0x6e, 0x5f, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x22, 0x3a, 0x09,
+  0x22, 0x63, 0x6f, 0x6e, 0x76, 0x6f, 0x6c, 0x75, 0x74, 0x69, 0x6f, 0x6e,
+  0x22, 0x0a, 0x09, 0x09, 0x7d, 0x0a, 0x09, 0x5d, 0x2c, 0x0a, 0x09, 0x0a,
+  0x09, 0x22, 0x64, 0x69, 0x73, 0x74, 0x6f, 0x72, 0x74, 0x69, 0x6f, 0x6e,
+  0x73, 0x22, 0x3a, 0x20, 0x5b, 0x0a, 0x09, 0x09, 0x7b, 0x0a, 0x09, 0x09,
+  0x09, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x20, 0x09, 0x09, 0x09,
+  0x22, 0x43, 0x41, 0x50, 0x53, 0x20, 0x64, 0x69, 0x73, 0x74, 0x6f, 0x72,
+  0x74, 0x69, 0x6f, 0x6e, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x73,
+  0x68, 0x6f, 0x72, 0x74, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x09,
+  0x09, 0x22, 0x63, 0x61, 0x70, 0x73, 0x5f, 0x64, 0x69, 0x73, 0x74, 0x6f,
+  0x72, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22,
   0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22,
-  0x3a, 0x09, 0x09, 0x22, 0x4d, 0x6f, 0x6e, 0x6f, 0x20, 0x63, 0x6f, 0x6d,
-  0x70, 0x72, 0x65, 0x73, 0x73, 0x6f, 0x72, 0x20, 0x66, 0x72, 0x6f, 0x6d,
-  0x20, 0x74, 0x68, 0x65, 0x20, 0x43, 0x41, 0x50, 0x53, 0x20, 0x70, 0x61,
-  0x63, 0x6b, 0x61, 0x67, 0x65, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22,
-  0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x74, 0x79, 0x70, 0x65, 0x22,
-  0x3a, 0x09, 0x09, 0x22, 0x4c, 0x41, 0x44, 0x53, 0x50, 0x41, 0x22, 0x2c,
+  0x3a, 0x09, 0x09, 0x22, 0x53, 0x61, 0x74, 0x75, 0x72, 0x61, 0x74, 0x65,
+  0x20, 0x64, 0x69, 0x73, 0x74, 0x6f, 0x72, 0x74, 0x69, 0x6f, 0x6e, 0x20,
+  0x6d, 0x6f, 0x64, 0x65, 0x6c, 0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x74,
+  0x68, 0x65, 0x20, 0x43, 0x41, 0x50, 0x53, 0x20, 0x70, 0x61, 0x63, 0x6b,
+  0x61, 0x67, 0x65, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c,
+  0x75, 0x67, 0x69, 0x6e, 0x5f, 0x74, 0x79, 0x70, 0x65, 0x22, 0x3a, 0x09,
+  0x09, 0x22, 0x4c, 0x41, 0x44, 0x53, 0x50, 0x41, 0x22, 0x2c, 0x0a, 0x09,
+  0x09, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x66, 0x69,
+  0x6c, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x63, 0x61, 0x70, 0x73, 0x2e,
+  0x73, 0x6f, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75,
+  0x67, 0x69, 0x6e, 0x5f, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x22,
+  0x3a, 0x09, 0x22, 0x53, 0x61, 0x74, 0x75, 0x72, 0x61, 0x74, 0x65, 0x22,
+  0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x74, 0x61, 0x69, 0x6c, 0x22, 0x3a,
+  0x09, 0x09, 0x09, 0x09, 0x30, 0x2e, 0x30, 0x35, 0x2c, 0x0a, 0x09, 0x09,
+  0x09, 0x22, 0x6f, 0x76, 0x65, 0x72, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x69,
+  0x6e, 0x67, 0x22, 0x3a, 0x09, 0x09, 0x34, 0x0a, 0x09, 0x09, 0x7d, 0x2c,
+  0x0a, 0x09, 0x09, 0x7b, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x6e, 0x61, 0x6d,
+  0x65, 0x22, 0x3a, 0x20, 0x09, 0x09, 0x09, 0x22, 0x43, 0x41, 0x50, 0x53,
+  0x20, 0x6d, 0x6f, 0x6e, 0x6f, 0x20, 0x63, 0x6f, 0x6d, 0x70, 0x72, 0x65,
+  0x73, 0x73, 0x6f, 0x72, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x73,
+  0x68, 0x6f, 0x72, 0x74, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x09,
+  0x09, 0x22, 0x63, 0x61, 0x70, 0x73, 0x5f, 0x6d, 0x6f, 0x6e, 0x6f, 0x5f,
+  0x63, 0x6f, 0x6d, 0x70, 0x72, 0x65, 0x73, 0x73, 0x6f, 0x72, 0x22, 0x2c,
+  0x0a, 0x09, 0x09, 0x09, 0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70,
+  0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x4d, 0x6f, 0x6e,
+  0x6f, 0x20, 0x63, 0x6f, 0x6d, 0x70, 0x72, 0x65, 0x73, 0x73, 0x6f, 0x72,
+  0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x74, 0x68, 0x65, 0x20, 0x43, 0x41,
+  0x50, 0x53, 0x20, 0x70, 0x61, 0x63, 0x6b, 0x61, 0x67, 0x65, 0x22, 0x2c,
   0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f,
-  0x66, 0x69, 0x6c, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x63, 0x61, 0x70,
-  0x73, 0x2e, 0x73, 0x6f, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70,
-  0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61,
-  0x6d, 0x22, 0x3a, 0x09, 0x22, 0x43, 0x6f, 0x6d, 0x70, 0x72, 0x65, 0x73,
-  0x73, 0x22, 0x0a, 0x09, 0x09, 0x7d, 0x0a, 0x09, 0x5d, 0x2c, 0x0a, 0x09,
+  0x74, 0x79, 0x70, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x4c, 0x41, 0x44,
+  0x53, 0x50, 0x41, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c,
+  0x75, 0x67, 0x69, 0x6e, 0x5f, 0x66, 0x69, 0x6c, 0x65, 0x22, 0x3a, 0x09,
+  0x09, 0x22, 0x63, 0x61, 0x70, 0x73, 0x2e, 0x73, 0x6f, 0x22, 0x2c, 0x0a,
+  0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x70,
+  0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x22, 0x3a, 0x09, 0x22, 0x43, 0x6f,
+  0x6d, 0x70, 0x72, 0x65, 0x73, 0x73, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09,
+  0x22, 0x74, 0x61, 0x69, 0x6c, 0x22, 0x3a, 0x09, 0x09, 0x09, 0x09, 0x30,
+  0x2e, 0x31, 0x0a, 0x09, 0x09, 0x7d, 0x0a, 0x09, 0x5d, 0x2c, 0x0a, 0x09,
   0x0a, 0x09, 0x22, 0x61, 0x6d, 0x62, 0x69, 0x65, 0x6e, 0x74, 0x5f, 0x70,
   0x72, 0x6f, 0x63, 0x65, 0x73, 0x73, 0x6f, 0x72, 0x73, 0x22, 0x3a, 0x20,
   0x5b, 0x0a, 0x09, 0x09, 0x7b, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x6e, 0x61,
@@ -173,92 +205,143 @@ unsigned char effects_json[] = {
   0x22, 0x3a, 0x09, 0x09, 0x22, 0x63, 0x61, 0x70, 0x73, 0x2e, 0x73, 0x6f,
   0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69,
   0x6e, 0x5f, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x22, 0x3a, 0x09,
-  0x22, 0x50, 0x6c, 0x61, 0x74, 0x65, 0x22, 0x0a, 0x09, 0x09, 0x7d, 0x2c,
-  0x0a, 0x09, 0x09, 0x7b, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x6e, 0x61, 0x6d,
-  0x65, 0x22, 0x3a, 0x09, 0x09, 0x09, 0x09, 0x22, 0x53, 0x63, 0x61, 0x70,
-  0x65, 0x20, 0x44, 0x65, 0x6c, 0x61, 0x79, 0x22, 0x2c, 0x0a, 0x09, 0x09,
-  0x09, 0x22, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x5f, 0x6e, 0x61, 0x6d, 0x65,
-  0x22, 0x3a, 0x09, 0x09, 0x22, 0x73, 0x63, 0x61, 0x70, 0x65, 0x5f, 0x64,
-  0x65, 0x6c, 0x61, 0x79, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x64,
-  0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a,
-  0x09, 0x09, 0x22, 0x41, 0x20, 0x76, 0x65, 0x72, 0x73, 0x61, 0x74, 0x69,
-  0x6c, 0x65, 0x20, 0x64, 0x65, 0x6c, 0x61, 0x79, 0x20, 0x66, 0x72, 0x6f,
-  0x6d, 0x20, 0x74, 0x68, 0x65, 0x20, 0x43, 0x41, 0x50, 0x53, 0x20, 0x70,
-  0x61, 0x63, 0x6b, 0x61, 0x67, 0x65, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09,
-  0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x74, 0x79, 0x70, 0x65,
-  0x22, 0x3a, 0x09, 0x09, 0x22, 0x4c, 0x41, 0x44, 0x53, 0x50, 0x41, 0x22,
+  0x22, 0x50, 0x6c, 0x61, 0x74, 0x65, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09,
+  0x22, 0x74, 0x61, 0x69, 0x6c, 0x22, 0x3a, 0x09, 0x09, 0x09, 0x09, 0x31,
+  0x30, 0x0a, 0x09, 0x09, 0x7d, 0x2c, 0x0a, 0x09, 0x09, 0x7b, 0x0a, 0x09,
+  0x09, 0x09, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x09,
+  0x09, 0x22, 0x53, 0x63, 0x61, 0x70, 0x65, 0x20, 0x44, 0x65, 0x6c, 0x61,
+  0x79, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x73, 0x68, 0x6f, 0x72,
+  0x74, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x73,
+  0x63, 0x61, 0x70, 0x65, 0x5f, 0x64, 0x65, 0x6c, 0x61, 0x79, 0x22, 0x2c,
+  0x0a, 0x09, 0x09, 0x09, 0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70,
+  0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x41, 0x20, 0x76,
+  0x65, 0x72, 0x73, 0x61, 0x74, 0x69, 0x6c, 0x65, 0x20, 0x64, 0x65, 0x6c,
+  0x61, 0x79, 0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x74, 0x68, 0x65, 0x20,
+  0x43, 0x41, 0x50, 0x53, 0x20, 0x70, 0x61, 0x63, 0x6b, 0x61, 0x67, 0x65,
+  0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69,
+  0x6e, 0x5f, 0x74, 0x79, 0x70, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x4c,
+  0x41, 0x44, 0x53, 0x50, 0x41, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22,
+  0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x66, 0x69, 0x6c, 0x65, 0x22,
+  0x3a, 0x09, 0x09, 0x22, 0x63, 0x61, 0x70, 0x73, 0x2e, 0x73, 0x6f, 0x22,
   0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e,
-  0x5f, 0x66, 0x69, 0x6c, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x63, 0x61,
-  0x70, 0x73, 0x2e, 0x73, 0x6f, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22,
-  0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x70, 0x72, 0x6f, 0x67, 0x72,
-  0x61, 0x6d, 0x22, 0x3a, 0x09, 0x22, 0x53, 0x63, 0x61, 0x70, 0x65, 0x22,
-  0x0a, 0x09, 0x09, 0x7d, 0x0a, 0x09, 0x5d, 0x2c, 0x0a, 0x0a, 0x09, 0x22,
-  0x6d, 0x6f, 0x64, 0x75, 0x6c, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x73, 0x22,
-  0x3a, 0x20, 0x5b, 0x0a, 0x09, 0x09, 0x7b, 0x0a, 0x09, 0x09, 0x20, 0x20,
-  0x20, 0x09, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x20, 0x20, 0x20,
-  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x4d,
-  0x6f, 0x6e, 0x6f, 0x20, 0x50, 0x68, 0x61, 0x73, 0x65, 0x72, 0x22, 0x2c,
-  0x0a, 0x09, 0x09, 0x20, 0x20, 0x20, 0x09, 0x22, 0x73, 0x68, 0x6f, 0x72,
-  0x74, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x20, 0x20, 0x20, 0x20,
-  0x20, 0x20, 0x20, 0x22, 0x6d, 0x6f, 0x6e, 0x6f, 0x5f, 0x70, 0x68, 0x61,
-  0x73, 0x65, 0x72, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x20, 0x20, 0x20, 0x09,
-  0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e,
-  0x22, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x4d, 0x6f, 0x6e,
-  0x6f, 0x20, 0x70, 0x68, 0x61, 0x73, 0x65, 0x72, 0x20, 0x66, 0x72, 0x6f,
-  0x6d, 0x20, 0x74, 0x68, 0x65, 0x20, 0x43, 0x41, 0x50, 0x53, 0x20, 0x70,
-  0x61, 0x63, 0x6b, 0x61, 0x67, 0x65, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x20,
-  0x20, 0x20, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x74,
-  0x79, 0x70, 0x65, 0x22, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22,
-  0x4c, 0x41, 0x44, 0x53, 0x50, 0x41, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x20,
-  0x20, 0x20, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x66,
-  0x69, 0x6c, 0x65, 0x22, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22,
-  0x63, 0x61, 0x70, 0x73, 0x2e, 0x73, 0x6f, 0x22, 0x2c, 0x0a, 0x09, 0x09,
-  0x20, 0x20, 0x20, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f,
-  0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x22, 0x3a, 0x20, 0x20, 0x20,
-  0x22, 0x50, 0x68, 0x61, 0x73, 0x65, 0x72, 0x49, 0x49, 0x22, 0x0a, 0x09,
-  0x09, 0x7d, 0x2c, 0x0a, 0x09, 0x09, 0x7b, 0x0a, 0x09, 0x09, 0x09, 0x22,
-  0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x09, 0x09, 0x22, 0x43,
-  0x68, 0x6f, 0x72, 0x75, 0x73, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22,
-  0x73, 0x68, 0x6f, 0x72, 0x74, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a,
-  0x09, 0x09, 0x22, 0x6d, 0x6f, 0x6e, 0x6f, 0x5f, 0x63, 0x68, 0x6f, 0x72,
-  0x75, 0x73, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x64, 0x65, 0x73,
-  0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x20, 0x20,
-  0x20, 0x20, 0x20, 0x20, 0x22, 0x4d, 0x6f, 0x6e, 0x6f, 0x20, 0x63, 0x68,
-  0x6f, 0x72, 0x75, 0x73, 0x2f, 0x66, 0x6c, 0x61, 0x6e, 0x67, 0x65, 0x72,
-  0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x74, 0x68, 0x65, 0x20, 0x43, 0x41,
-  0x50, 0x53, 0x20, 0x70, 0x61, 0x63, 0x6b, 0x61, 0x67, 0x65, 0x22, 0x2c,
-  0x0a, 0x09, 0x09, 0x20, 0x20, 0x20, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67,
-  0x69, 0x6e, 0x5f, 0x74, 0x79, 0x70, 0x65, 0x22, 0x3a, 0x20, 0x20, 0x20,
-  0x20, 0x20, 0x20, 0x22, 0x4c, 0x41, 0x44, 0x53, 0x50, 0x41, 0x22, 0x2c,
+  0x5f, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x22, 0x3a, 0x09, 0x22,
+  0x53, 0x63, 0x61, 0x70, 0x65, 0x22, 0x0a, 0x09, 0x09, 0x7d, 0x0a, 0x09,
+  0x5d, 0x2c, 0x0a, 0x0a, 0x09, 0x22, 0x6d, 0x6f, 0x64, 0x75, 0x6c, 0x61,
+  0x74, 0x69, 0x6f, 0x6e, 0x73, 0x22, 0x3a, 0x20, 0x5b, 0x0a, 0x09, 0x09,
+  0x7b, 0x0a, 0x09, 0x09, 0x20, 0x20, 0x20, 0x09, 0x22, 0x6e, 0x61, 0x6d,
+  0x65, 0x22, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x22, 0x4d, 0x6f, 0x6e, 0x6f, 0x20, 0x50, 0x68,
+  0x61, 0x73, 0x65, 0x72, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x20, 0x20, 0x20,
+  0x09, 0x22, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x5f, 0x6e, 0x61, 0x6d, 0x65,
+  0x22, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x6d, 0x6f,
+  0x6e, 0x6f, 0x5f, 0x70, 0x68, 0x61, 0x73, 0x65, 0x72, 0x22, 0x2c, 0x0a,
+  0x09, 0x09, 0x20, 0x20, 0x20, 0x09, 0x22, 0x64, 0x65, 0x73, 0x63, 0x72,
+  0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x22, 0x4d, 0x6f, 0x6e, 0x6f, 0x20, 0x70, 0x68, 0x61, 0x73,
+  0x65, 0x72, 0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x74, 0x68, 0x65, 0x20,
+  0x43, 0x41, 0x50, 0x53, 0x20, 0x70, 0x61, 0x63, 0x6b, 0x61, 0x67, 0x65,
+  0x22, 0x2c, 0x0a, 0x09, 0x09, 0x20, 0x20, 0x20, 0x09, 0x22, 0x70, 0x6c,
+  0x75, 0x67, 0x69, 0x6e, 0x5f, 0x74, 0x79, 0x70, 0x65, 0x22, 0x3a, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x4c, 0x41, 0x44, 0x53, 0x50, 0x41,
+  0x22, 0x2c, 0x0a, 0x09, 0x09, 0x20, 0x20, 0x20, 0x09, 0x22, 0x70, 0x6c,
+  0x75, 0x67, 0x69, 0x6e, 0x5f, 0x66, 0x69, 0x6c, 0x65, 0x22, 0x3a, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x63, 0x61, 0x70, 0x73, 0x2e, 0x73,
+  0x6f, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x20, 0x20, 0x20, 0x09, 0x22, 0x70,
+  0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61,
+  0x6d, 0x22, 0x3a, 0x20, 0x20, 0x20, 0x22, 0x50, 0x68, 0x61, 0x73, 0x65,
+  0x72, 0x49, 0x49, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x20, 0x20, 0x20, 0x09,
+  0x22, 0x74, 0x61, 0x69, 0x6c, 0x22, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x31, 0x0a, 0x09, 0x09,
+  0x7d, 0x2c, 0x0a, 0x09, 0x09, 0x7b, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x6e,
+  0x61, 0x6d, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x09, 0x09, 0x22, 0x43, 0x68,
+  0x6f, 0x72, 0x75, 0x73, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x73,
+  0x68, 0x6f, 0x72, 0x74, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x09,
+  0x09, 0x22, 0x6d, 0x6f, 0x6e, 0x6f, 0x5f, 0x63, 0x68, 0x6f, 0x72, 0x75,
+  0x73, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x64, 0x65, 0x73, 0x63,
+  0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x22, 0x4d, 0x6f, 0x6e, 0x6f, 0x20, 0x63, 0x68, 0x6f,
+  0x72, 0x75, 0x73, 0x2f, 0x66, 0x6c, 0x61, 0x6e, 0x67, 0x65, 0x72, 0x20,
+  0x66, 0x72, 0x6f, 0x6d, 0x20, 0x74, 0x68, 0x65, 0x20, 0x43, 0x41, 0x50,
+  0x53, 0x20, 0x70, 0x61, 0x63, 0x6b, 0x61, 0x67, 0x65, 0x22, 0x2c, 0x0a,
+  0x09, 0x09, 0x20, 0x20, 0x20, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69,
+  0x6e, 0x5f, 0x74, 0x79, 0x70, 0x65, 0x22, 0x3a, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x22, 0x4c, 0x41, 0x44, 0x53, 0x50, 0x41, 0x22, 0x2c, 0x0a,
+  0x09, 0x09, 0x20, 0x20, 0x20, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69,
+  0x6e, 0x5f, 0x66, 0x69, 0x6c, 0x65, 0x22, 0x3a, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x22, 0x63, 0x61, 0x70, 0x73, 0x2e, 0x73, 0x6f, 0x22, 0x2c,
   0x0a, 0x09, 0x09, 0x20, 0x20, 0x20, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67,
-  0x69, 0x6e, 0x5f, 0x66, 0x69, 0x6c, 0x65, 0x22, 0x3a, 0x20, 0x20, 0x20,
-  0x20, 0x20, 0x20, 0x22, 0x63, 0x61, 0x70, 0x73, 0x2e, 0x73, 0x6f, 0x22,
-  0x2c, 0x0a, 0x09, 0x09, 0x20, 0x20, 0x20, 0x09, 0x22, 0x70, 0x6c, 0x75,
+  0x69, 0x6e, 0x5f, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x22, 0x3a,
+  0x20, 0x20, 0x20, 0x22, 0x43, 0x68, 0x6f, 0x72, 0x75, 0x73, 0x49, 0x22,
+  0x2c, 0x0a, 0x09, 0x09, 0x20, 0x20, 0x20, 0x09, 0x22, 0x74, 0x61, 0x69,
+  0x6c, 0x22, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x30, 0x2e, 0x35, 0x0a, 0x09, 0x09, 0x7d, 0x2c,
+  0x0a, 0x09, 0x09, 0x7b, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x6e, 0x61, 0x6d,
+  0x65, 0x22, 0x3a, 0x09, 0x09, 0x09, 0x09, 0x22, 0x4d, 0x75, 0x6c, 0x74,
+  0x69, 0x20, 0x43, 0x68, 0x6f, 0x72, 0x75, 0x73, 0x22, 0x2c, 0x0a, 0x09,
+  0x09, 0x09, 0x22, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x5f, 0x6e, 0x61, 0x6d,
+  0x65, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x6d, 0x75, 0x6c, 0x74, 0x69, 0x5f,
+  0x63, 0x68, 0x6f, 0x72, 0x75, 0x73, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09,
+  0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e,
+  0x22, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x4d, 0x75, 0x6c,
+  0x74, 0x69, 0x76, 0x6f, 0x69, 0x63, 0x65, 0x20, 0x63, 0x68, 0x6f, 0x72,
+  0x75, 0x73, 0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x74, 0x68, 0x65, 0x20,
+  0x43, 0x41, 0x50, 0x53, 0x20, 0x70, 0x61, 0x63, 0x6b, 0x61, 0x67, 0x65,
+  0x22, 0x2c, 0x0a, 0x09, 0x09, 0x20, 0x20, 0x20, 0x09, 0x22, 0x70, 0x6c,
+  0x75, 0x67, 0x69, 0x6e, 0x5f, 0x74, 0x79, 0x70, 0x65, 0x22, 0x3a, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x4c, 0x41, 0x44, 0x53, 0x50, 0x41,
+  0x22, 0x2c, 0x0a, 0x09, 0x09, 0x20, 0x20, 0x20, 0x09, 0x22, 0x70, 0x6c,
+  0x75, 0x67, 0x69, 0x6e, 0x5f, 0x66, 0x69, 0x6c, 0x65, 0x22, 0x3a, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x63, 0x61, 0x70, 0x73, 0x2e, 0x73,
+  0x6f, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x20, 0x20, 0x20, 0x09, 0x22, 0x70,
+  0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61,
+  0x6d, 0x22, 0x3a, 0x20, 0x20, 0x20, 0x22, 0x43, 0x68, 0x6f, 0x72, 0x75,
+  0x73, 0x49, 0x49, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x20, 0x20, 0x20, 0x09,
+  0x22, 0x74, 0x61, 0x69, 0x6c, 0x22, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x30, 0x2e, 0x35, 0x0a,
+  0x09, 0x09, 0x7d, 0x0a, 0x09, 0x09, 0x0a, 0x09, 0x5d, 0x2c, 0x0a, 0x0a,
+  0x09, 0x22, 0x6f, 0x74, 0x68, 0x65, 0x72, 0x5f, 0x65, 0x66, 0x66, 0x65,
+  0x63, 0x74, 0x73, 0x22, 0x3a, 0x20, 0x5b, 0x0a, 0x09, 0x09, 0x7b, 0x0a,
+  0x09, 0x09, 0x09, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x20, 0x09,
+  0x09, 0x09, 0x22, 0x50, 0x61, 0x72, 0x61, 0x6d, 0x65, 0x74, 0x72, 0x69,
+  0x63, 0x20, 0x45, 0x51, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x73,
+  0x68, 0x6f, 0x72, 0x74, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x09,
+  0x09, 0x22, 0x70, 0x61, 0x72, 0x61, 0x6d, 0x65, 0x74, 0x72, 0x69, 0x63,
+  0x5f, 0x65, 0x71, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x64, 0x65,
+  0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x09,
+  0x09, 0x22, 0x46, 0x6f, 0x75, 0x72, 0x20, 0x62, 0x61, 0x6e, 0x64, 0x20,
+  0x65, 0x71, 0x75, 0x61, 0x6c, 0x69, 0x7a, 0x65, 0x72, 0x20, 0x77, 0x69,
+  0x74, 0x68, 0x20, 0x6c, 0x6f, 0x77, 0x20, 0x73, 0x68, 0x65, 0x6c, 0x66,
+  0x2c, 0x20, 0x74, 0x77, 0x6f, 0x20, 0x70, 0x65, 0x61, 0x6b, 0x69, 0x6e,
+  0x67, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x68, 0x69, 0x67, 0x68, 0x20, 0x73,
+  0x68, 0x65, 0x6c, 0x66, 0x20, 0x62, 0x61, 0x6e, 0x64, 0x73, 0x22, 0x2c,
+  0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f,
+  0x74, 0x79, 0x70, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x4e, 0x41, 0x54,
+  0x49, 0x56, 0x45, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c,
+  0x75, 0x67, 0x69, 0x6e, 0x5f, 0x66, 0x69, 0x6c, 0x65, 0x22, 0x3a, 0x09,
+  0x09, 0x22, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75,
   0x67, 0x69, 0x6e, 0x5f, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x22,
-  0x3a, 0x20, 0x20, 0x20, 0x22, 0x43, 0x68, 0x6f, 0x72, 0x75, 0x73, 0x49,
-  0x22, 0x0a, 0x09, 0x09, 0x7d, 0x2c, 0x0a, 0x09, 0x09, 0x7b, 0x0a, 0x09,
-  0x09, 0x09, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x09,
-  0x09, 0x22, 0x4d, 0x75, 0x6c, 0x74, 0x69, 0x20, 0x43, 0x68, 0x6f, 0x72,
-  0x75, 0x73, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x73, 0x68, 0x6f,
-  0x72, 0x74, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x22,
-  0x6d, 0x75, 0x6c, 0x74, 0x69, 0x5f, 0x63, 0x68, 0x6f, 0x72, 0x75, 0x73,
-  0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x64, 0x65, 0x73, 0x63, 0x72,
-  0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x20, 0x20, 0x20, 0x20,
-  0x20, 0x20, 0x22, 0x4d, 0x75, 0x6c, 0x74, 0x69, 0x76, 0x6f, 0x69, 0x63,
-  0x65, 0x20, 0x63, 0x68, 0x6f, 0x72, 0x75, 0x73, 0x20, 0x66, 0x72, 0x6f,
-  0x6d, 0x20, 0x74, 0x68, 0x65, 0x20, 0x43, 0x41, 0x50, 0x53, 0x20, 0x70,
-  0x61, 0x63, 0x6b, 0x61, 0x67, 0x65, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x20,
-  0x20, 0x20, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x74,
-  0x79, 0x70, 0x65, 0x22, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22,
-  0x4c, 0x41, 0x44, 0x53, 0x50, 0x41, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x20,
-  0x20, 0x20, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x66,
-  0x69, 0x6c, 0x65, 0x22, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22,
-  0x63, 0x61, 0x70, 0x73, 0x2e, 0x73, 0x6f, 0x22, 0x2c, 0x0a, 0x09, 0x09,
-  0x20, 0x20, 0x20, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f,
-  0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x22, 0x3a, 0x20, 0x20, 0x20,
-  0x22, 0x43, 0x68, 0x6f, 0x72, 0x75, 0x73, 0x49, 0x49, 0x22, 0x0a, 0x09,
-  0x09, 0x7d, 0x0a, 0x09, 0x09, 0x0a, 0x09, 0x5d, 0x2c, 0x0a, 0x0a, 0x09,
-  0x22, 0x6f, 0x74, 0x68, 0x65, 0x72, 0x5f, 0x65, 0x66, 0x66, 0x65, 0x63,
-  0x74, 0x73, 0x22, 0x3a, 0x20, 0x5b, 0x0a, 0x09, 0x5d, 0x0a, 0x7d, 0x0a
+  0x3a, 0x09, 0x22, 0x70, 0x61, 0x72, 0x61, 0x6d, 0x65, 0x74, 0x72, 0x69,
+  0x63, 0x5f, 0x65, 0x71, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x74,
+  0x61, 0x69, 0x6c, 0x22, 0x3a, 0x09, 0x09, 0x09, 0x09, 0x30, 0x2e, 0x31,
+  0x0a, 0x09, 0x09, 0x7d, 0x2c, 0x0a, 0x09, 0x09, 0x7b, 0x0a, 0x09, 0x09,
+  0x09, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x20, 0x09, 0x09, 0x09,
+  0x22, 0x54, 0x75, 0x6e, 0x65, 0x72, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09,
+  0x22, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x5f, 0x6e, 0x61, 0x6d, 0x65, 0x22,
+  0x3a, 0x09, 0x09, 0x22, 0x74, 0x75, 0x6e, 0x65, 0x72, 0x22, 0x2c, 0x0a,
+  0x09, 0x09, 0x09, 0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74,
+  0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x47, 0x75, 0x69, 0x74,
+  0x61, 0x72, 0x20, 0x74, 0x75, 0x6e, 0x65, 0x72, 0x20, 0x6d, 0x75, 0x74,
+  0x69, 0x6e, 0x67, 0x20, 0x74, 0x68, 0x65, 0x20, 0x6f, 0x75, 0x74, 0x70,
+  0x75, 0x74, 0x20, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x20, 0x69, 0x74, 0x27,
+  0x73, 0x20, 0x6f, 0x6e, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x70,
+  0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x74, 0x79, 0x70, 0x65, 0x22, 0x3a,
+  0x09, 0x09, 0x22, 0x4e, 0x41, 0x54, 0x49, 0x56, 0x45, 0x22, 0x2c, 0x0a,
+  0x09, 0x09, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x66,
+  0x69, 0x6c, 0x65, 0x22, 0x3a, 0x09, 0x09, 0x22, 0x22, 0x2c, 0x0a, 0x09,
+  0x09, 0x09, 0x22, 0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x5f, 0x70, 0x72,
+  0x6f, 0x67, 0x72, 0x61, 0x6d, 0x22, 0x3a, 0x09, 0x22, 0x74, 0x75, 0x6e,
+  0x65, 0x72, 0x22, 0x2c, 0x0a, 0x09, 0x09, 0x09, 0x22, 0x74, 0x61, 0x69,
+  0x6c, 0x22, 0x3a, 0x09, 0x09, 0x09, 0x09, 0x30, 0x0a, 0x09, 0x09, 0x7d,
+  0x0a, 0x09, 0x5d, 0x0a, 0x7d, 0x0a
 };
-unsigned int effects_json_len = 3012;
+unsigned int effects_json_len = 4002;
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "driftbuffer.h"
+#include <cmath>
+#include <cstring>
+#include <time.h>
+
+using namespace llaudio;
+
+namespace soundalchemy {
+
+const float DriftBuffer::BANDWIDTH = 0.5f;
+const float DriftBuffer::MAX_CORRECTION = 0.005f;
+
+// damping of the control loop
+static const float DAMPING = 0.8f;
+
+DriftBuffer::DriftBuffer(): rate_(0), nominal_(1.0), channels_(0), frames_(0), mask_(0),
+		write_pos_(0), read_pos_(0), read_time_(0), primed_(false),
+		target_(0), kp_(0.0f), ki_(0.0f), alpha_(0.0f), average_(0.0f),
+		integral_(0.0f), settled_(false), ratio_(1.0), xruns_(0) {
+}
+
+DriftBuffer::~DriftBuffer() {
+	for(unsigned int c = 0; c < resamplers_.size(); c++) delete resamplers_[c];
+}
+
+unsigned long DriftBuffer::now(void) {
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1000000ul + t.tv_nsec / 1000;
+}
+
+void DriftBuffer::prepare(TSampleRate in_rate, TSampleRate out_rate,
+		unsigned int channels, unsigned int frames) {
+	rate_ = out_rate;
+	nominal_ = (double) out_rate / in_rate;
+	channels_ = channels;
+	frames_ = frames;
+
+	// the target leaves room for a cycle of both threads and for their jitter
+	target_ = (unsigned int) (1.5 * (frames + frames * nominal_));
+	unsigned int size = 1;
+	while(size < 4 * target_) size <<= 1;
+	mask_ = size - 1;
+
+	ring_.assign(channels_, std::vector<float>(size, 0.0f));
+	scratch_.resize(Resampler::getMaxOutput(frames,
+			nominal_ * (1.0 + MAX_CORRECTION)));
+
+	for(unsigned int c = 0; c < resamplers_.size(); c++) delete resamplers_[c];
+	resamplers_.resize(channels_);
+	for(unsigned int c = 0; c < channels_; c++) {
+		resamplers_[c] = new Resampler(frames);
+		resamplers_[c]->setRates(in_rate, out_rate);
+		// switches to the variable ratio here as it allocates
+		resamplers_[c]->setRatio(nominal_);
+	}
+
+	// The gains of a critically damped loop for the fill level measured in
+	// cycles. The average of the fill filters the jitter of the threads,
+	// it's much faster than the loop.
+	float w = BANDWIDTH * frames / rate_;
+	kp_ = 2.0f * DAMPING * w;
+	ki_ = w * w;
+	alpha_ = 4.0f * w < 0.5f ? 4.0f * w : 0.5f;
+	integral_ = 0.0f;
+	settled_ = false;
+	ratio_ = nominal_;
+
+	write_pos_ = read_pos_ = 0;
+	read_time_ = now();
+	primed_ = false;
+}
+
+double DriftBuffer::getLatency(void) {
+	if(rate_ == 0) return 0.0;
+	return 1000.0 * (target_ + Resampler::TAPS / 2) / rate_;
+}
+
+void DriftBuffer::push(float** samples, unsigned int frames) {
+	unsigned int fill = write_pos_ - read_pos_;
+	__sync_synchronize();
+
+	// The resamplers give the same count for every channel. The free space
+	// is checked with the first one, and the cycle is dropped before the ring
+	// is touched if it doesn't fit, the frames being pulled aren't overwritten.
+	unsigned int count = 0;
+	bool drop = false;
+	for(unsigned int c = 0; c < channels_; c++) {
+		count = resamplers_[c]->process(samples[c], frames, &scratch_[0]);
+		if(c == 0) drop = fill + count > mask_ + 1;
+		if(drop) continue;
+
+		unsigned int pos = write_pos_;
+		for(unsigned int i = 0; i < count; i++, pos++) {
+			ring_[c][pos & mask_] = scratch_[i];
+		}
+	}
+
+	if(drop) {
+		// nothing pulls, the samples are dropped
+		__sync_add_and_fetch(&xruns_, 1);
+	}
+	else {
+		__sync_synchronize();
+		write_pos_ += count;
+		fill += count;
+	}
+
+	control(fill);
+}
+
+void DriftBuffer::control(unsigned int fill) {
+	if(!primed_) {
+		settled_ = false;
+		return;
+	}
+
+	// The fill drops by a whole cycle on every pull. The samples pulled
+	// since the last pull are subtracted, so the fill is measured as if
+	// they were taken continuously.
+	float played = (float) (now() - read_time_) * rate_ / 1000000.0f;
+	float level = fill - played;
+
+	if(!settled_) {
+		average_ = level;
+		settled_ = true;
+	}
+	average_ += alpha_ * (level - average_);
+
+	float error = (average_ - target_) / frames_;
+	float correction = kp_ * error + ki_ * (integral_ + error);
+
+	// the integral stops while the correction is limited
+	if(fabs(correction) < MAX_CORRECTION) integral_ += error;
+	else correction = correction > 0.0f ? MAX_CORRECTION : -MAX_CORRECTION;
+
+	// more samples than the target have to be pulled faster than they come
+	ratio_ = nominal_ * (1.0 - correction);
+	for(unsigned int c = 0; c < channels_; c++) resamplers_[c]->setRatio(ratio_);
+}
+
+void DriftBuffer::pull(float** samples, unsigned int frames) {
+	unsigned int fill = write_pos_ - read_pos_;
+	__sync_synchronize();
+
+	if(!primed_ && fill >= target_) primed_ = true;
+	else if(primed_ && fill < frames) {
+		__sync_add_and_fetch(&xruns_, 1);
+		primed_ = false;
+	}
+
+	if(!primed_) {
+		for(unsigned int c = 0; c < channels_; c++) {
+			memset(samples[c], 0, frames * sizeof(float));
+		}
+	}
+	else {
+		for(unsigned int c = 0; c < channels_; c++) {
+			unsigned int pos = read_pos_;
+			for(unsigned int i = 0; i < frames; i++, pos++) {
+				samples[c][i] = ring_[c][pos & mask_];
+			}
+		}
+		__sync_synchronize();
+		read_pos_ += frames;
+	}
+
+	read_time_ = now();
+}
+
+} /* namespace soundalchemy */
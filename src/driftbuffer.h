@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef DRIFTBUFFER_H_
+#define DRIFTBUFFER_H_
+
+#include "resampler.h"
+#include "llaudio/llaudio.h"
+#include <vector>
+
+namespace soundalchemy {
+
+/**
+ * @brief A ring buffer between two threads running on different clocks.
+ *
+ * One thread pushes the samples in the cycle of its clock and another one
+ * pulls them in the cycle of its own. The two clocks drift apart slowly, so
+ * the pushed samples are resampled with a ratio set by a PI controller which
+ * keeps the fill level of the ring at a constant target. The ratio follows
+ * the drift and the buffer adds a bounded latency of about the target fill.
+ *
+ * There has to be only one pushing and one pulling thread.
+ */
+class DriftBuffer {
+public:
+
+	/// Bandwidth of the control loop in rad/s
+	static const float BANDWIDTH;
+
+	/// The largest deviation of the resampling ratio from 1
+	static const float MAX_CORRECTION;
+
+	DriftBuffer();
+	~DriftBuffer();
+
+	/**
+	 * Allocates the buffer and resets the controller. Has to be called while
+	 * none of the threads uses the buffer.
+	 * @param in_rate The nominal sample rate of the pushed samples.
+	 * @param out_rate The sample rate of the pulled samples.
+	 * @param channels The count of the channels.
+	 * @param frames The longest cycle pushed or pulled.
+	 */
+	void prepare(llaudio::TSampleRate in_rate, llaudio::TSampleRate out_rate,
+			unsigned int channels, unsigned int frames);
+
+	/**
+	 * Resamples a cycle into the ring buffer and updates the ratio. An
+	 * overflow drops the cycle.
+	 * @param samples Non-interleaved samples of every channel.
+	 * @param frames The length of the cycle, at most the prepared one.
+	 */
+	void push(float** samples, unsigned int frames);
+
+	/**
+	 * Copies a cycle from the ring buffer. The samples are given out only
+	 * after the ring is filled up to the target, silence is given until then
+	 * and after an underflow.
+	 * @param samples Non-interleaved samples of every channel.
+	 * @param frames The length of the cycle, at most the prepared one.
+	 */
+	void pull(float** samples, unsigned int frames);
+
+	/**
+	 * @return Returns the current ratio of the output and the input rate of
+	 * the resampling, it follows the drift around the nominal ratio.
+	 */
+	double getRatio(void) { return ratio_; }
+
+	/**
+	 * @return Returns the latency of the target fill and of the resampler in
+	 * milliseconds.
+	 */
+	double getLatency(void);
+
+	/**
+	 * @return Returns the overflows and underflows of the ring since it was
+	 * created.
+	 */
+	unsigned long getXrunCount(void) { return xruns_; }
+
+	unsigned int getChannels(void) { return channels_; }
+
+private:
+
+	// Updates the resampling ratio from the fill level of the ring.
+	void control(unsigned int fill);
+
+	// the time of the monotonic clock in microseconds, may wrap around
+	static unsigned long now(void);
+
+	llaudio::TSampleRate rate_;
+	double nominal_;
+	unsigned int channels_;
+	unsigned int frames_;
+
+	// Ring buffer with a power of two size for each channel. The positions
+	// run freely, the index is the position masked with size - 1. write_pos_
+	// is written by the pushing thread, read_pos_ and read_time_ by the
+	// pulling thread.
+	std::vector< std::vector<float> > ring_;
+	std::vector<float> scratch_;
+	std::vector<Resampler*> resamplers_;
+	unsigned int mask_;
+	volatile unsigned int write_pos_;
+	volatile unsigned int read_pos_;
+	volatile unsigned long read_time_;
+
+	// The pull starts when the ring is filled up to the target. An underflow
+	// stops it until the target is reached again.
+	volatile bool primed_;
+	unsigned int target_;
+
+	// state of the controller
+	float kp_;
+	float ki_;
+	float alpha_;
+	float average_;
+	float integral_;
+	bool settled_;
+	double ratio_;
+
+	// counted by both threads
+	volatile unsigned long xruns_;
+};
+
+} /* namespace soundalchemy */
+#endif /* DRIFTBUFFER_H_ */
@@ -11,8 +11,15 @@
 #include <cstdarg>
 #include <unistd.h>
 #include <string>
+#include <map>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <time.h>
 #include "dspserver.h"
 #include "ladspaeffect.h"
+#include "simd.h"
+#include "latencyprobe.h"
 
 
 
@@ -44,6 +51,8 @@ public:
 	}
 } llaEH;
 
+const float DspServer::DEFAULT_TUNE_MARGIN = 0.25f;
+
 // Instantiation of the device manager
 llaDeviceManager& DspServer::lla_devman_ = llaDeviceManager::getInstance(llaEH);
 EffectDatabase* DspServer::database_ = EffectDatabase::buildDatabase();
@@ -54,7 +63,29 @@ DspServer::DspServer():
 		dsp_process_(effect_chain_),
 		effect_chain_(),
 		clients_count_(0),
-		messagequeue_(NULL)
+		messagequeue_(NULL),
+		measured_latency_ms_(-1.0),
+		load_watcher_(*this),
+		watcher_thread_(Thread::getNewThread()),
+		meter_timer_(*this),
+		meter_thread_(Thread::getNewThread()),
+		meter_subscribers_(0),
+		analyzer_worker_(*this),
+		analyzer_thread_(Thread::getNewThread()),
+		spectrum_subscribers_(0),
+		spectrum_point_(0),
+		tuner_listener_(*this),
+		overrun_watcher_(*this),
+		overrun_thread_(Thread::getNewThread()),
+		param_worker_(*this),
+		param_thread_(Thread::getNewThread()),
+		tune_worker_(*this),
+		tune_thread_(Thread::getNewThread()),
+		auto_tune_(false),
+		tune_margin_(DEFAULT_TUNE_MARGIN),
+		tuning_(false),
+		tune_running_(false),
+		tune_channel_(0)
 		 {
 
 	// initialize all client connectors to NULL
@@ -63,6 +94,10 @@ DspServer::DspServer():
 
 	// allocate a thread object for this thread
 	this_thread_ = Thread::getCurrent();
+
+	Tuner::setListener(&tuner_listener_);
+	overrun_thread_->run(overrun_watcher_);
+	param_thread_->run(param_worker_);
 }
 
 
@@ -70,9 +105,44 @@ DspServer::DspServer():
 // DspServer Destructor
 DspServer::~DspServer() {
 
-	// stop the processing
+	// stop the processing and the load watcher
 	stop();
+	closeSharedControl();
+	for(unsigned int i = 0; i < exports_.size(); i++) {
+		effect_chain_.removeExport(exports_[i]);
+		delete exports_[i];
+	}
+	Tuner::setListener(NULL);
+	setAutoTune(false, tune_margin_);
+	if(tuning_) {
+		tune_worker_.exit();
+		tune_worker_.served();
+		tune_thread_->join();
+	}
+	if(meter_subscribers_ != 0) {
+		meter_timer_.exit();
+		meter_thread_->join();
+	}
+	if(spectrum_subscribers_ != 0) {
+		analyzer_worker_.exit();
+		analyzer_thread_->join();
+		effect_chain_.setAnalyzerTap(NULL, 0);
+	}
+
+	overrun_watcher_.exit();
+	effect_chain_.wakeOverrunWaiter();
+	overrun_thread_->join();
+
+	param_worker_.exit();
+	effect_chain_.wakeParamWaiter();
+	param_thread_->join();
 
+	delete watcher_thread_;
+	delete meter_thread_;
+	delete analyzer_thread_;
+	delete overrun_thread_;
+	delete param_thread_;
+	delete tune_thread_;
 	delete this_thread_;
 	delete messagequeue_;
 
@@ -87,7 +157,14 @@ DspServer::~DspServer() {
 }
 
 void DspServer::stop() {
-	return dsp_process_.stopProcessing();
+	dsp_process_.stopProcessing();
+
+	// the processing thread doesn't write the status any more
+	if(shared_control_.isOpen()) {
+		SharedControlBlock::Status& status = shared_control_.beginStatus();
+		status.state = getState();
+		shared_control_.endStatus();
+	}
 }
 
 TAlchemyError DspServer::start() {
@@ -135,20 +212,35 @@ TAlchemyError DspServer::listenOn(ClientConnector& client) {
 	return ret;
 }
 
+// collect the information about one audio device
+static void describeDevice(AudioInf& devicelist, llaDevice* device) {
+	devicelist.beginDevice(device->getName(), device->getName(true));
+
+	// the drivers answer the capabilities from their cache
+	llaStream::Capabilities caps;
+	for(llaDevice::IStreamIterator i = device->getInputStreamIterator(); !i.end(); i++) {
+		bool known = i->getCapabilities(caps) == llaudio::E_OK;
+		devicelist.stream(i->getId(), i->getName(), true, known ? &caps : NULL);
+
+	}
+	devicelist.endDevice();
+	for(llaDevice::OStreamIterator i = device->getOutputStreamIterator(); !i.end(); i++) {
+		bool known = i->getCapabilities(caps) == llaudio::E_OK;
+		devicelist.stream(i->getId(), i->getName(), false, known ? &caps : NULL);
+	}
+	devicelist.endDevice();
+}
+
 // collect the information about the audio devices
 void DspServer::getDeviceList(AudioInf& devicelist, bool redetect) {
 	if(redetect) lla_devman_.refresh();
 	for( llaDeviceIterator devices = lla_devman_.getDeviceIterator(); !devices.end(); devices++) {
-		devicelist.beginDevice(devices->getName(), devices->getName(true));
-		for(llaDevice::IStreamIterator i = devices->getInputStreamIterator(); !i.end(); i++) {
-			devicelist.stream(i->getId(), i->getName(), true);
+		describeDevice(devicelist, *devices);
+	}
 
-		}
-		devicelist.endDevice();
-		for(llaDevice::OStreamIterator i = devices->getOutputStreamIterator(); !i.end(); i++) {
-			devicelist.stream(i->getId(), i->getName(), false);
-		}
-		devicelist.endDevice();
+	// the aggregate devices are kept over a redetection
+	for( llaDeviceIterator devices = lla_devman_.getUserDeviceIterator(); !devices.end(); devices++) {
+		describeDevice(devicelist, *devices);
 	}
 }
 
@@ -165,13 +257,20 @@ void DspServer::startListening(void) {
 	while(!exit_) {
 
 		// this call blocks if the queue is empty
-		// allowing a passive waiting for a message and process it while
-		// other messages are buffered in the queue.
-		instruction = messagequeue_->popFront();
-		if(instruction != NULL) {
-			reply = instruction->instruct(*this);
-			broadcastMessage(*reply);
+		// allowing a passive waiting for messages. All the messages arrived
+		// meanwhile are processed in one batch.
+		instruction = messagequeue_->popAll();
+		while(instruction != NULL) {
+			InboundMessage* next = instruction->getNext();
+
+			// the messages after an exit are dropped, some messages have
+			// nothing to broadcast
+			if(!exit_) {
+				reply = instruction->instruct(*this);
+				if(reply != NULL) broadcastMessage(*reply);
+			}
 			delete instruction;
+			instruction = next;
 		}
 	}
 }
@@ -186,6 +285,8 @@ void DspServer::clientOut(Message::TChannelID client) {
 	}
 	else {
 		unsigned int index = client - 1;
+		subscribeMeters(client, false);
+		subscribeSpectrum(client, false, 0, 0, 0.0f, 0);
 		clients_[index]->stopWatching();
 		//delete clients_[client];
 		clients_[index] = NULL;
@@ -234,14 +335,552 @@ TAlchemyError DspServer::setOutputStream(TDeviceId device, TStreamId id) {
 }
 
 
+TAlchemyError DspServer::createAggregateDevice(const char* name,
+		const TAggregateMembers& inputs, const TAggregateMembers& outputs) {
+	if(inputs.empty() && outputs.empty()) return E_AGGREGATE;
+
+	// the members are looked up again when the streams are opened, this just
+	// catches the typos early
+	for(unsigned int i = 0; i < inputs.size() + outputs.size(); i++) {
+		const AggregateMember& m = i < inputs.size() ?
+				inputs[i] : outputs[i - inputs.size()];
+		if(lla_devman_.getDevice(m.device.c_str()).isNull()) {
+			log(LEVEL_ERROR, "No device is found with the name %s",
+					m.device.c_str());
+			return E_AGGREGATE;
+		}
+	}
+
+	AggregateDevice* device = new AggregateDevice(name, inputs, outputs);
+	if(lla_devman_.addDevice(device) != llaudio::E_OK) {
+		delete device;
+		return E_AGGREGATE;
+	}
+
+	log(LEVEL_INFO, "Aggregate device %s is created, its clock master is %s",
+			name, device->getClockMaster());
+	return E_OK;
+}
+
+TAlchemyError DspServer::removeAggregateDevice(const char* name) {
+	llaDevice& device = lla_devman_.getDevice(name);
+	if(device.isNull()) return E_AGGREGATE;
+
+	// the streams of the chain can't be deleted under it
+	if(&effect_chain_.getInput().getOwner() == &device ||
+			&effect_chain_.getOutput().getOwner() == &device) {
+		return E_AGGREGATE;
+	}
+
+	return lla_devman_.removeDevice(name) == llaudio::E_OK ? E_OK : E_AGGREGATE;
+}
+
 void DspServer::setBufferSize(TSize buffer_size) {
 	dsp_process_.setBufferSize(buffer_size);
 }
 
 void DspServer::setSampleRate(TSampleRate sample_rate) {
+	effect_chain_.setSampleRate(sample_rate);
+	retune();
+}
+
+TAlchemyError DspServer::addEffect(std::string effect_name) {
+	TAlchemyError ret = effect_chain_.addEffect(effect_name);
+	if(ret == E_OK) retune();
+	return ret;
+}
+
+void DspServer::retune() {
+	// the tune worker starts from the current size and steps it down while
+	// the chain stays stable, so a lighter chain gets a smaller buffer again
+	if(auto_tune_ && !tuning_ && getState() == ST_RUNNING) {
+		autoTuneBufferSize(tune_margin_, 0);
+	}
+}
+
+TAlchemyError DspServer::autoTuneBufferSize(float margin,
+		Message::TChannelID channel) {
+	if(tuning_) {
+		log(LEVEL_ERROR, "%s A tuning is running already.",
+				STR_ERRORS[E_BUFFER_SIZE]);
+		return E_BUFFER_SIZE;
+	}
+
+	if(margin < 0.0f) margin = 0.0f;
+	if(margin > 0.9f) margin = 0.9f;
+
+	unsigned int size = dsp_process_.getBufferSize();
+	if(size < TUNE_MIN_FRAMES) size = TUNE_MIN_FRAMES;
+	if(size > TUNE_MAX_FRAMES) size = TUNE_MAX_FRAMES;
+
+	tune_running_ = getState() == ST_RUNNING;
+	tune_channel_ = channel;
+	tuning_ = true;
+	dsp_process_.setLoadLimit(1.0f - margin);
+
+	tune_worker_.reset(size);
+	if(tune_thread_->run(tune_worker_) != E_OK) {
+		tuning_ = false;
+		return E_THREAD;
+	}
+	return E_OK;
+}
+
+void DspServer::tryBufferSize(unsigned int frames) {
+	stop();
+	dsp_process_.setBufferSize(frames);
+	start();
+	tune_worker_.served();
+}
+
+TAlchemyError DspServer::finishTuning(unsigned int frames, bool stable,
+		Message::TChannelID& channel) {
+	tune_thread_->join();
+
+	stop();
+	dsp_process_.setBufferSize(frames);
+	tuning_ = false;
+	channel = tune_channel_;
+
+	TAlchemyError ret = E_OK;
+	if(stable) log(LEVEL_INFO, "Buffer size tuned to %u frames", frames);
+	else {
+		log(LEVEL_ERROR, "%s Using %u frames.", STR_ERRORS[E_BUFFER_SIZE],
+				frames);
+		ret = E_BUFFER_SIZE;
+	}
+
+	if(tune_running_) start();
+	return ret;
+}
+
+void DspServer::setAutoTune(bool enabled, float margin) {
+	tune_margin_ = margin;
+	dsp_process_.setLoadLimit(1.0f - margin);
+	if(enabled == auto_tune_) return;
+
+	auto_tune_ = enabled;
+	if(enabled) {
+		load_watcher_.reset();
+		watcher_thread_->run(load_watcher_);
+	}
+	else {
+		load_watcher_.exit();
+		watcher_thread_->join();
+	}
+}
+
+TAlchemyError DspServer::growBufferSize(unsigned int& frames) {
+	TAlchemyError ret = E_OK;
+	frames = dsp_process_.getBufferSize();
+
+	if(auto_tune_ && getState() == ST_RUNNING) {
+		if(frames >= TUNE_MAX_FRAMES) {
+			log(LEVEL_ERROR, "%s The load is too high even with %u frames.",
+					STR_ERRORS[E_BUFFER_SIZE], frames);
+			ret = E_BUFFER_SIZE;
+		}
+		else {
+			frames = frames * 2 < TUNE_MAX_FRAMES ? frames * 2 : TUNE_MAX_FRAMES;
+			stop();
+			dsp_process_.setBufferSize(frames);
+			start();
+			log(LEVEL_WARNING, "Buffer size grown to %u frames on high load",
+					frames);
+		}
+	}
+
+	load_watcher_.served();
+	return ret;
+}
+
+void* DspServer::TuneWorker::run(void) {
+	// grow until the chain runs stable, then step down while it does
+	unsigned int size = size_;
+	bool stable;
+	while(!(stable = isStable(size)) && size < TUNE_MAX_FRAMES && !exit_) {
+		size = size * 2 < TUNE_MAX_FRAMES ? size * 2 : TUNE_MAX_FRAMES;
+	}
+	if(stable) {
+		while(size / 2 >= TUNE_MIN_FRAMES && isStable(size / 2)) size /= 2;
+	}
+
+	if(!exit_) {
+		server_.processMessage(*InboundMessage::newMsgBufferSizeTuned(size,
+				stable));
+	}
+	return NULL;
+}
+
+bool DspServer::TuneWorker::isStable(unsigned int frames) {
+	if(exit_) return false;
+	server_.processMessage(*InboundMessage::newMsgTryBufferSize(frames));
+	tried_.wait();
+	if(exit_) return false;
+
+	DspProcess::LoadStats begin, end;
+	usleep(TUNE_SETTLE_MS * 1000);
+	server_.dsp_process_.getLoadStats(begin);
+	usleep(TUNE_WINDOW_MS * 1000);
+	server_.dsp_process_.getLoadStats(end);
+
+	bool stable = server_.getState() == ST_RUNNING &&
+			end.cycles != begin.cycles && end.xruns == begin.xruns &&
+			end.overloads == begin.overloads;
+
+	unsigned long period = end.period_us - begin.period_us;
+	log(LEVEL_DEBUG, "Buffer size %u frames: %s, %lu xruns, load %.0f%%",
+			frames, stable ? "stable" : "unstable", end.xruns - begin.xruns,
+			period ? 100.0 * (end.busy_us - begin.busy_us) / period : 0.0);
+	return stable;
+}
+
+void* DspServer::LoadWatcher::run(void) {
+	DspProcess::LoadStats last, now;
+	unsigned int overloaded = 0;
+	server_.dsp_process_.getLoadStats(last);
+
+	while(!exit_) {
+		usleep(WATCH_PERIOD_MS * 1000);
+		server_.dsp_process_.getLoadStats(now);
+
+		unsigned long cycles = now.cycles - last.cycles;
+		unsigned long period = now.period_us - last.period_us;
+
+		// the time of a tuning, a pending request or a stopped processing
+		// tells nothing about the load
+		if(server_.tuning_ || pending_ || cycles == 0 || period == 0) {
+			overloaded = 0;
+		}
+		else {
+			float load = (float) (now.busy_us - last.busy_us) / period;
+			bool high = now.xruns != last.xruns ||
+					(now.overloads - last.overloads) * 20 > cycles ||
+					load > 1.0f - server_.tune_margin_;
+			overloaded = high ? overloaded + 1 : 0;
+		}
+		last = now;
+
+		if(overloaded >= GROW_WINDOWS) {
+			overloaded = 0;
+			pending_ = true;
+			server_.processMessage(*InboundMessage::newMsgGrowBufferSize());
+		}
+	}
+
+	return NULL;
+}
+
+TAlchemyError DspServer::subscribeMeters(Message::TChannelID client,
+		bool subscribe, unsigned int rate) {
+	if(client == 0 || client > CLIENTS_MAX || clients_[client-1] == NULL)
+		return E_INDEX;
+
+	unsigned int before = meter_subscribers_;
+	if(subscribe) {
+		if(rate == 0) rate = DEFAULT_METER_RATE;
+		if(rate > MAX_METER_RATE) rate = MAX_METER_RATE;
+		meter_timer_.setRate(rate);
+		meter_subscribers_ |= 1u << (client - 1);
+	}
+	else meter_subscribers_ &= ~(1u << (client - 1));
+
+	if(before == 0 && meter_subscribers_ != 0) {
+		effect_chain_.setMetering(true);
+		meter_timer_.reset();
+		meter_thread_->run(meter_timer_);
+	}
+	else if(before != 0 && meter_subscribers_ == 0) {
+		meter_timer_.exit();
+		meter_thread_->join();
+		effect_chain_.setMetering(shared_control_.isOpen());
+	}
+
+	return E_OK;
+}
+
+void DspServer::publishMeters(void) {
+	meter_timer_.served();
+
+	// nothing is sent while the processing is stopped
+	MeterBank::Frame frame;
+	if(meter_subscribers_ == 0 || !effect_chain_.readMeters(frame)) return;
+
+	OutboundMessage *msg = OutboundMessage::MsgMeters(frame.count, frame.peak,
+			frame.rms);
+	for (int i = 0; i < CLIENTS_MAX; i++) {
+		if (clients_[i] != NULL && (meter_subscribers_ & (1u << i)))
+			clients_[i]->send(*msg);
+	}
+	delete msg;
+}
+
+void* DspServer::MeterTimer::run(void) {
+	while(!exit_) {
+		usleep(period_us_);
+		if(exit_ || pending_) continue;
+
+		pending_ = true;
+		server_.processMessage(*InboundMessage::newMsgPublishMeters());
+	}
+
+	return NULL;
+}
+
+TAlchemyError DspServer::subscribeSpectrum(Message::TChannelID client,
+		bool subscribe, SoundEffect::TEffectID point, unsigned int size,
+		float overlap, unsigned int bins) {
+	if(client == 0 || client > CLIENTS_MAX || clients_[client-1] == NULL)
+		return E_INDEX;
+	if(subscribe && point > effect_chain_.getEffectsCount() + 1)
+		return E_INDEX;
+
+	// the analysis is stopped while it's set up again
+	if(spectrum_subscribers_ != 0) {
+		analyzer_worker_.exit();
+		analyzer_thread_->join();
+		effect_chain_.setAnalyzerTap(NULL, 0);
+	}
+
+	if(subscribe) {
+		spectrum_subscribers_ |= 1u << (client - 1);
+		spectrum_point_ = point;
+		analyzer_.configure(size, overlap, bins,
+				effect_chain_.getSampleRate());
+	}
+	else spectrum_subscribers_ &= ~(1u << (client - 1));
+
+	if(spectrum_subscribers_ != 0) {
+		effect_chain_.setAnalyzerTap(&analyzer_.getRing(), spectrum_point_);
+		analyzer_worker_.reset();
+		analyzer_thread_->run(analyzer_worker_);
+	}
+
+	return E_OK;
+}
+
+void DspServer::publishSpectrum(void) {
+	analyzer_worker_.served();
+	if(spectrum_subscribers_ == 0) return;
+
+	std::vector<unsigned char> levels;
+	analyzer_.getFrame(levels);
+	if(levels.empty()) return;
+
+	OutboundMessage *msg = OutboundMessage::MsgSpectrum(spectrum_point_,
+			&levels[0], levels.size());
+	for (int i = 0; i < CLIENTS_MAX; i++) {
+		if (clients_[i] != NULL && (spectrum_subscribers_ & (1u << i)))
+			clients_[i]->send(*msg);
+	}
+	delete msg;
+}
+
+void* DspServer::AnalyzerWorker::run(void) {
+	while(!exit_) {
+		if(!server_.analyzer_.analyze()) {
+			usleep(IDLE_MS * 1000);
+			continue;
+		}
+		if(pending_) continue;
+
+		pending_ = true;
+		server_.processMessage(*InboundMessage::newMsgPublishSpectrum());
+	}
+
+	return NULL;
+}
+
+TAlchemyError DspServer::findEffect(SoundEffect* effect,
+		SoundEffect::TEffectID& effect_id) {
+	return effect_chain_.findEffect(effect, effect_id);
+}
+
+void* DspServer::OverrunWatcher::run(void) {
+	while(!exit_) {
+		server_.effect_chain_.waitOverrun();
+
+		SoundEffect *effect;
+		float time_us, budget_us;
+		while(server_.effect_chain_.takeOverrun(effect, time_us, budget_us)) {
+			server_.processMessage(*InboundMessage::newMsgEffectOverrun(effect,
+					time_us, budget_us));
+		}
+	}
+	return NULL;
+}
+
+void* DspServer::ParamWorker::run(void) {
+	while(!exit_) {
+		server_.effect_chain_.waitParams();
+		server_.effect_chain_.applyParams();
+	}
+	return NULL;
+}
+
+void DspServer::TunerListener::tuned(SoundEffect* tuner,
+		const Tuner::Reading& reading) {
+	server_.processMessage(*InboundMessage::newMsgTunerReading(tuner,
+			reading.frequency, reading.cents, reading.note,
+			reading.confidence));
+}
+
+TAlchemyError DspServer::openSharedControl(const char* path) {
+	bool running = getState() == ST_RUNNING;
+	if(running) stop();
+
+	closeSharedControl();
+	TAlchemyError ret = shared_control_.open(path);
+	if(ret == E_OK) {
+		SharedControlBlock::Status& status = shared_control_.beginStatus();
+		status.state = getState();
+		shared_control_.endStatus();
+
+		effect_chain_.setSharedControl(&shared_control_);
+		effect_chain_.setMetering(true);
+		dsp_process_.setSharedControl(&shared_control_);
+	}
+
+	if(running) start();
+	return ret;
+}
+
+void DspServer::closeSharedControl(void) {
+	if(!shared_control_.isOpen()) return;
+
+	bool running = getState() == ST_RUNNING;
+	if(running) stop();
+
+	dsp_process_.setSharedControl(NULL);
+	effect_chain_.setSharedControl(NULL);
+	effect_chain_.setMetering(meter_subscribers_ != 0);
+	shared_control_.close();
+
+	if(running) start();
+}
+
+TAlchemyError DspServer::exportSignal(SoundEffect::TEffectID point,
+		const char* path, unsigned int channels, unsigned int frames) {
+	if(point > effect_chain_.getEffectsCount() + 1) return E_INDEX;
+
+	// a path is exported once
+	removeExport(path);
+
+	AudioExport *signal = new AudioExport();
+	TAlchemyError ret = signal->open(path, channels, frames,
+			effect_chain_.getSampleRate());
+	if(ret == E_OK) ret = effect_chain_.addExport(signal, point);
+	if(ret != E_OK) {
+		delete signal;
+		return ret;
+	}
+
+	exports_.push_back(signal);
+	return E_OK;
+}
+
+TAlchemyError DspServer::removeExport(const char* path) {
+	for(unsigned int i = 0; i < exports_.size(); i++) {
+		AudioExport *signal = exports_[i];
+		if(signal->getPath() != path) continue;
+
+		effect_chain_.removeExport(signal);
+		delete signal;
+		exports_.erase(exports_.begin() + i);
+		return E_OK;
+	}
+	return E_INDEX;
+}
+
+// the streams report an infinite latency if they can't tell it
+static double knownLatency(double ms) {
+	return ms < HUGE_VAL ? ms : -1.0;
+}
+
+void DspServer::getLatency(Latency& latency) {
+	latency.input_ms = knownLatency(effect_chain_.getInput().getLatency());
+	latency.output_ms = knownLatency(dsp_process_.getSink().getLatency());
+	latency.processing_ms = effect_chain_.getLatency();
+	latency.measured_ms = measured_latency_ms_;
+	latency.control_ms = effect_chain_.getControlDelay();
+	latency.queue_ms = messagequeue_ != NULL ?
+			messagequeue_->getWakeupDelay() : -1.0;
+
+	unsigned long start_us = dsp_process_.getStartTime();
+	unsigned long stop_us = dsp_process_.getStopTime();
+	latency.start_ms = start_us > 0 ? start_us / 1000.0 : -1.0;
+	latency.stop_ms = stop_us > 0 ? stop_us / 1000.0 : -1.0;
+}
+
+TAlchemyError DspServer::measureLatency(double& latency_ms) {
+	bool running = getState() == ST_RUNNING;
+	if(running) stop();
+
+	LatencyProbe probe;
+	TAlchemyError ret = probe.measure(effect_chain_.getInput(),
+			effect_chain_.getOutput(), dsp_process_.getBufferSize(), latency_ms);
+	if(ret == E_OK) measured_latency_ms_ = latency_ms;
+
+	if(running) start();
+	return ret;
+}
+
+void DspServer::bypass(bool bypassed) {
+	effect_chain_.bypass(bypassed);
+}
+
+TAlchemyError DspServer::bypassEffect(SoundEffect::TEffectID effect_id,
+		bool bypassed) {
+	return effect_chain_.bypassEffect(effect_id, bypassed);
+}
+
+TAlchemyError DspServer::setEffectParam(SoundEffect::TEffectID effect_id,
+		SoundEffect::TParamID param_id, SoundEffect::TParamValue value) {
+	return effect_chain_.setEffectParam(effect_id, param_id, value);
+}
+
+TAlchemyError DspServer::getEffectParam(SoundEffect::TEffectID effect_id,
+		SoundEffect::TParamID param_id, SoundEffect::TParamValue& value) {
+	return effect_chain_.getEffectParam(effect_id, param_id, value);
+}
+
+void DspServer::setCrossfadeLength(unsigned int samples) {
+	effect_chain_.setCrossfadeLength(samples);
+}
+
+void DspServer::bindControl(TControlId control,
+		SoundEffect::TEffectID effect_id, SoundEffect::TParamID param_id) {
+	control_map_.bind(control, effect_id, param_id);
+}
+
+void DspServer::learnControl(SoundEffect::TEffectID effect_id,
+		SoundEffect::TParamID param_id) {
+	control_map_.learn(effect_id, param_id);
+}
+
+TAlchemyError DspServer::unbindControl(SoundEffect::TEffectID effect_id,
+		SoundEffect::TParamID param_id) {
+	return control_map_.unbind(effect_id, param_id) > 0 ? E_OK : E_INDEX;
 }
 
-void DspServer::addEffect(std::string effect_name) {
+bool DspServer::controlChanged(TControlId control, float position,
+		unsigned long time, ControlMap::Binding& binding) {
+	bool learned;
+	if(!control_map_.find(control, binding, learned)) return false;
+
+	// the parameter is looked up only when the layout of the chain changed
+	if(!effect_chain_.isResolved(binding)) {
+		effect_chain_.resolveControl(binding);
+		control_map_.setHandle(control, binding);
+	}
+
+	ControlEvent event;
+	event.binding = binding;
+	event.position = position;
+	event.time = time;
+	effect_chain_.pushControl(event);
+
+	return learned;
 }
 
 void DspServer::broadcastMessage(OutboundMessage& message) {
@@ -257,7 +896,10 @@ void DspServer::broadcastMessage(OutboundMessage& message) {
 // Constructor of the DspProcess class
 DspServer::DspProcess::DspProcess(ProcessingGraph& graph) :
 		graph_(graph), proc_thread_(Thread::getNewThread()),
-		state_(proc_thread_) {
+		state_(), start_us_(0), stop_us_(0), device_rate_(0),
+		bridged_(false), cycles_(0),
+		overloads_(0),
+		busy_us_(0), period_us_(0), load_limit_(1.0f), shared_(NULL) {
 	callback_counter_ = 0;
 	state_.val = ST_STOPPED;
 	state_.state_requested_ = ST_STOPPED;
@@ -278,12 +920,42 @@ void* DspServer::DspProcess::run() {
 	TErrors e = llaudio::E_OK;
 	TProcessingState st;
 
+	// the tails of the effects decay into denormals which would make the
+	// processing many times slower when the input goes silent
+	simd::disableDenormals();
+
+	// The streams are asked for the rate of the graph but the devices may
+	// apply a different one. They are opened here to get the actual rates,
+	// connectStreams() keeps them open.
+	llaInputStream& input = graph_.getInput();
+	llaOutputStream& output = graph_.getOutput();
+	input.setSampleRate(graph_.getSampleRate());
+	output.setSampleRate(graph_.getSampleRate());
+	input.open();
+	output.open();
+	graph_.setStreamSampleRates(input.getSampleRate(), output.getSampleRate());
+	device_rate_ = input.getSampleRate();
+
+	// all the buffers of the graph are allocated before the processing starts
+	graph_.setBufferLength(getBufferLength());
 	graph_.activate();
 
+	// Streams of different devices run on their own clocks, the output is
+	// played through the bridge which follows the clock of the output.
+	// Streams without a device, like files, have no clock of their own.
+	bridged_ = !input.getOwner().isNull() && !output.getOwner().isNull() &&
+			&input.getOwner() != &output.getOwner();
+	if(bridged_) {
+		bridge_.prepare(output, getBufferLength());
+		log(LEVEL_INFO, "The input and the output are on different devices, "
+				"the output is bridged");
+	}
+
 	// This thread will consume most of its life in the connectStream function
 	// in which the processing is done. It calls the onSamplesReady method
 	// whenever samples are ready to be processed
-	e = connectStreams(graph_.getInput(), graph_.getOutput());
+	e = connectStreams(input, getSink());
+	bridged_ = false;
 
 	graph_.deactivate();
 
@@ -300,52 +972,81 @@ void* DspServer::DspProcess::run() {
 	// stopped due to an error.
 	if (e != llaudio::E_OK || st != ST_STOPPED) {
 		unlock();
-		proc_thread_->wakeUp();
 		log(LEVEL_ERROR, "Alchemy server stopped unexpectedly");
 	}
 	else unlock();
 
+	// a start waiting for the first cycles fails
+	started_.post();
 	return NULL;
 }
 
 // this method starts the processing of the audio signal
 TAlchemyError DspServer::DspProcess::startProcessing(void) {
-	TAlchemyError retval = E_OK;
 	lock();
-	TAlchemyError ret;
-	switch (state_.val) {
-	case ST_STOPPED:
-		ret = proc_thread_->run(*this);
-		if (ret == E_THREAD) {
-			retval = E_START;
-			log(LEVEL_ERROR, STR_ERRORS[retval]);
-			unlock();
-			return retval;
-		}
-
-		waitFor();
+	TProcessingState state = state_.val;
+	unlock();
+	if(state != ST_STOPPED) return E_OK;
+
+	timespec begin, end;
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+
+	// A deadline without a period gets the period of a cycle, the
+	// processing may take half of it.
+	Thread::Scheduling scheduling =
+			Thread::getDefaultScheduling(Thread::THREAD_DSP);
+	if(scheduling.policy == Thread::POLICY_DEADLINE &&
+			scheduling.period_us == 0 && graph_.getSampleRate() > 0) {
+		scheduling.period_us = 1000000ul * getBufferLength() /
+				graph_.getSampleRate();
+		if(scheduling.runtime_us == 0)
+			scheduling.runtime_us = scheduling.period_us / 2;
+	}
+	proc_thread_->setScheduling(scheduling);
 
-		if (state_.val != ST_RUNNING) {
-			log(LEVEL_ERROR, STR_ERRORS[E_START]);
-			retval = E_START;
-		}
-		break;
-	default:
-		break;
+	// a post left by a failed start is dropped
+	started_.reset();
+	if(proc_thread_->run(*this) == E_THREAD) {
+		log(LEVEL_ERROR, STR_ERRORS[E_START]);
+		return E_START;
 	}
 
+	bool responded = started_.wait(START_TIMEOUT_MS);
+
+	lock();
+	state = state_.val;
 	unlock();
 
-	return retval;
+	if(!responded || state != ST_RUNNING) {
+		log(LEVEL_ERROR, "%s: %s", STR_ERRORS[E_START], responded ?
+				"the processing stopped" : "no response from the processing");
+		stopProcessing();
+		return E_START;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	start_us_ = (end.tv_sec - begin.tv_sec) * 1000000 +
+			(end.tv_nsec - begin.tv_nsec) / 1000;
+	log(LEVEL_INFO, "The processing started in %lu us", start_us_);
+	return E_OK;
 }
 
 // stop the processing
 void DspServer::DspProcess::stopProcessing(void) {
+	timespec begin, end;
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+
 	lock();
 	state_.state_requested_ = ST_STOPPED;
 	unlock();
-	if(proc_thread_->isRunning()) proc_thread_->join();
+	if(!proc_thread_->isRunning()) return;
+	proc_thread_->join();
 	//clearBuffers();
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	stop_us_ = (end.tv_sec - begin.tv_sec) * 1000000 +
+			(end.tv_nsec - begin.tv_nsec) / 1000;
+	log(LEVEL_INFO, "The processing stopped in %lu us", stop_us_);
 }
 
 bool DspServer::DspProcess::stop(void) {
@@ -370,7 +1071,7 @@ void DspServer::DspProcess::onSamplesReady(void) {
 		// call that the processing goes well and it can continue broadcasting
 		// this fact to clients
 		if (callback_counter_ == 2)
-			proc_thread_->wakeUp();
+			started_.post();
 	} else {
 		unlock();
 		return;
@@ -391,11 +1092,53 @@ void DspServer::DspProcess::onSamplesReady(void) {
 	graph_.setInputBuffer(i_samples, getInputBuffer().getChannels());
 	graph_.setOutputBuffer(o_samples, getOutputBuffer().getChannels());
 
+	timespec begin, end;
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+
 	graph_.traverse(this->lastwrite_);
 
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
 	getOutputBuffer().writeSamples();
 
 	callback_counter_++;
+
+	// load statistics, a failed read gives a negative count
+	unsigned long busy = (end.tv_sec - begin.tv_sec) * 1000000 +
+			(end.tv_nsec - begin.tv_nsec) / 1000;
+	unsigned long period = 0;
+	if(this->lastwrite_ <= getBufferLength() && device_rate_ > 0) {
+		period = 1000000ul * this->lastwrite_ / device_rate_;
+		busy_us_ += busy;
+		period_us_ += period;
+		if(busy > load_limit_ * period) overloads_++;
+		cycles_++;
+	}
+
+	if(shared_ != NULL) {
+		SharedControlBlock::Status& status = shared_->beginStatus();
+		status.state = ST_RUNNING;
+		status.sample_rate = device_rate_;
+		status.buffer_size = getBufferLength();
+		status.cycles = cycles_;
+		status.overloads = overloads_;
+		status.xruns = graph_.getInput().getXrunCount() +
+				graph_.getOutput().getXrunCount() + bridge_.getRingXrunCount();
+		status.busy_us = busy_us_;
+		status.period_us = period_us_;
+		status.cycle_busy_us = busy;
+		status.cycle_period_us = period;
+		shared_->endStatus();
+	}
+}
+
+void DspServer::DspProcess::getLoadStats(LoadStats& stats) {
+	stats.cycles = cycles_;
+	stats.overloads = overloads_;
+	stats.busy_us = busy_us_;
+	stats.period_us = period_us_;
+	stats.xruns = graph_.getInput().getXrunCount() +
+			graph_.getOutput().getXrunCount() + bridge_.getRingXrunCount();
 }
 
 // Processing Graph ////////////////////////////////////////////////////////////
@@ -430,11 +1173,28 @@ DspServer::EffectChain::Output::Output() : MixerEffect("output"),
 	addPort(pr);
 }
 
+const SoundEffect::TSample DspServer::EffectChain::SILENCE_LEVEL = 1e-5f;
+
 DspServer::EffectChain::EffectChain() :
 		input_(), output_(), mutex_(Thread::getMutex()),
-		sample_rate_(SR_CD_QUALITY_44100), bypassed_(false)
+		sample_rate_(SR_CD_QUALITY_44100),
+		xfade_length_(DEFAULT_XFADE_LENGTH), buffer_length_(0), dry_(NULL),
+		silence_(NULL), active_(false), input_rate_(0), output_rate_(0),
+		resampling_(false), device_frames_(0), in_resampler_(NULL),
+		chain_in_(NULL), fifo_fill_(0), fifo_size_(0), device_out_(NULL),
+		device_out_channels_(0), layout_(1), control_delay_us_(-1.0f),
+		scan_posted_(false), metering_(false), tap_ring_(NULL), tap_point_(0), shared_(NULL),
+		exports_count_(0)
 		 {
 
+	out_resampler_[0] = out_resampler_[1] = NULL;
+	fifo_[0] = fifo_[1] = NULL;
+
+	bypass_xfade_.setLength(xfade_length_);
+
+	// the convolution effects created from now on share the worker
+	ConvolutionEffect::setTailWorker(&tail_worker_);
+
 	// set up the inputs of the output node
 	output_.setInputsCount(input_.getOutputsCount());
 
@@ -443,48 +1203,149 @@ DspServer::EffectChain::EffectChain() :
 	// implemented yet. The function addEffect()
 
 	// TODO adding effects is done with the UI
-	SoundEffect *e[] = {
-
-//
-//			database_->getEffect("caps_amp", sample_rate_),
-//			database_->getEffect("caps_cabinet", sample_rate_),
-			database_->getEffect("mono_phaser", sample_rate_),
-			database_->getEffect("plate_reverb", sample_rate_),
-
+//	addEffect("caps_amp");
+//	addEffect("caps_cabinet");
+	addEffect("mono_phaser");
+	addEffect("plate_reverb");
 
-	};
-
-//	e[0]->getParam("tonestack")->setValue(7.0f);
-//	e[0]->getParam("gain")->setValue(0.60f);
-//	e[0]->getParam("treble")->setValue(1.0f);
-//	e[0]->getParam("mid")->setValue(0.5f);
-//	e[1]->getParam("model")->setValue(9.0f);
+}
 
-	addEffect(e[0],-1);
-	addEffect(e[1],-1);
+DspServer::EffectChain::~EffectChain() {
+	for(TEffectStackIt it = effectstack_.begin(); it != effectstack_.end(); it++)
+		delete *it;
+	ConvolutionEffect::setTailWorker(NULL);
 
+	freeBuffers();
+	delete mutex_;
 }
 
-void DspServer::EffectChain::setSampleRate() {
-	// TODO set the sample rate off all effects in a for loop
-}
+void DspServer::EffectChain::setSampleRate(TSampleRate sample_rate) {
+	if(sample_rate == sample_rate_) return;
+
+	// The effects are created for the new rate before the chain is locked,
+	// loading plug-ins and files must not stop the processing.
+	std::vector<SoundEffect*> created(effectstack_.size(), NULL);
+	for(unsigned int i = 0; i < effectstack_.size(); i++) {
+		EffectSlot *slot = effectstack_[i];
+		if(slot->name.empty()) continue;
+
+		SoundEffect *effect = database_->getEffect(slot->name, sample_rate,
+				slot->oversampling);
+		if(effect == NULL) {
+			log(LEVEL_WARNING, "%s: %s", STR_ERRORS[soundalchemy::E_DATABASE],
+					slot->name.c_str());
+			continue;
+		}
 
-TAlchemyError
-DspServer::EffectChain::addEffect(SoundEffect* effect, int position ) {
-	bool add_after = position < 0;
+		SoundEffect *old = slot->effect;
+		old->getMutex()->lock();
+		for(unsigned int p = 0; p < old->getParamsCount() &&
+				p < effect->getParamsCount(); p++) {
+			effect->getParam(p)->setValue(old->getParam(p)->getValue());
+		}
+		old->getMutex()->unlock();
 
-	unsigned int index;
-	if(effectstack_.empty()) index = 0;
-	else index = add_after ? effectstack_.size() + position : position;
+		if(active_) effect->activate();
+		created[i] = effect;
+	}
 
-	SoundEffect *effect_before = index == 0 ? &input_ : effectstack_[index];
-	SoundEffect *effect_after = NULL;
+	// the effects which couldn't be created again have to follow the rate
+	for(unsigned int i = 0; i < effectstack_.size(); i++) {
+		if(created[i] == NULL) effectstack_[i]->effect->setSampleRate(sample_rate);
+	}
 
-	if(effectstack_.empty()) {
-		effect_after = &output_;
+	mutex_->lock();
+	for(unsigned int i = 0; i < effectstack_.size(); i++) {
+		if(created[i] != NULL) std::swap(effectstack_[i]->effect, created[i]);
 	}
-	else if (add_after) effect_after = index == effectstack_.size()-1 ? &output_ : effectstack_[index+1];
-	else effect_after = effectstack_[index];
+	layout_++;
+	sample_rate_ = sample_rate;
+	for(unsigned int i = 0; i < exports_count_; i++)
+		exports_[i].signal->setSampleRate(sample_rate);
+	allocBuffers();
+	mutex_->unlock();
+
+	// the replaced effects are in the created list now
+	for(unsigned int i = 0; i < created.size(); i++) {
+		if(created[i] == NULL) continue;
+		if(active_) created[i]->deactivate();
+		delete created[i];
+	}
+}
+
+double DspServer::EffectChain::getLatency(void) {
+	mutex_->lock();
+	double latency = 0.0;
+	for(TEffectStackIt it = effectstack_.begin(); it != effectstack_.end(); it++) {
+		if(!(*it)->asleep) latency += (*it)->effect->getLatency();
+	}
+	latency = 1000.0 * latency / sample_rate_;
+
+	if(resampling_) {
+		latency += 1000.0 * in_resampler_->getLatency() / sample_rate_;
+		latency += 1000.0 * fifo_fill_ / (output_rate_ ? output_rate_ : sample_rate_);
+	}
+	mutex_->unlock();
+	return latency;
+}
+
+void DspServer::EffectChain::setStreamSampleRates(TSampleRate input,
+		TSampleRate output) {
+	mutex_->lock();
+	input_rate_ = input;
+	output_rate_ = output;
+	if(input != sample_rate_ || output != sample_rate_) {
+		log(LEVEL_INFO, "Resampling between the streams (%lu Hz, %lu Hz) and "
+				"the chain (%lu Hz)", input, output, sample_rate_);
+	}
+	allocBuffers();
+	mutex_->unlock();
+}
+
+TAlchemyError DspServer::EffectChain::addEffect(const std::string& name,
+		unsigned int oversampling, int position) {
+	SoundEffect *effect = database_->getEffect(name, sample_rate_, oversampling);
+	if(effect == NULL) {
+		log(LEVEL_ERROR, "%s: %s", STR_ERRORS[soundalchemy::E_DATABASE],
+				name.c_str());
+		return soundalchemy::E_DATABASE;
+	}
+
+	if(active_) effect->activate();
+
+	TAlchemyError ret = addEffect(effect, position);
+	if(ret != E_OK) {
+		if(active_) effect->deactivate();
+		delete effect;
+		return ret;
+	}
+
+	for(TEffectStackIt it = effectstack_.begin(); it != effectstack_.end(); it++) {
+		if((*it)->effect == effect) {
+			(*it)->name = name;
+			(*it)->oversampling = oversampling;
+		}
+	}
+
+	return E_OK;
+}
+
+TAlchemyError
+DspServer::EffectChain::addEffect(SoundEffect* effect, int position ) {
+	bool add_after = position < 0;
+
+	unsigned int index;
+	if(effectstack_.empty()) index = 0;
+	else index = add_after ? effectstack_.size() + position : position;
+
+	SoundEffect *effect_before = index == 0 ? &input_ : effectstack_[index]->effect;
+	SoundEffect *effect_after = NULL;
+
+	if(effectstack_.empty()) {
+		effect_after = &output_;
+	}
+	else if (add_after) effect_after = index == effectstack_.size()-1 ? &output_ : effectstack_[index+1]->effect;
+	else effect_after = effectstack_[index]->effect;
 
 
 	if( effect->getInputsCount() != effect_before->getOutputsCount() ) {
@@ -499,15 +1360,22 @@ DspServer::EffectChain::addEffect(SoundEffect* effect, int position ) {
 		return soundalchemy::E_PORTS_INCOMPATIBLE;
 	}
 
+	EffectSlot *slot = new EffectSlot(effect);
+	slot->xfade.setLength(xfade_length_);
+
 	mutex_->lock();
 
 	// inserting the effect to the effect stack. This is a painful operation
 	// but effect addition is assumed to be less frequent
 	//bool found = false;
 	TEffectStackIt pos = effectstack_.begin();
-	for(; pos != effectstack_.end() && *pos != effect_after; pos++) ;
+	for(; pos != effectstack_.end() && (*pos)->effect != effect_after; pos++) ;
+
+	effectstack_.insert(pos, slot);
+	layout_++;
 
-	effectstack_.insert(pos, effect);
+	// the new effect may have more outputs than the scratch buffers
+	allocScratch();
 
 	mutex_->unlock();
 	return E_OK;
@@ -517,67 +1385,688 @@ void DspServer::EffectChain::removeEffect(SoundEffect::TEffectID id) {
 
 }
 
-void DspServer::EffectChain::bypass(void) {
+void DspServer::EffectChain::bypass(bool bypassed) {
+	mutex_->lock();
+	bypass_xfade_.setWet(!bypassed);
+	if(!bypassed) {
+		// wake up the effects which were put to sleep by the global bypass
+		for(TEffectStackIt it = effectstack_.begin(); it != effectstack_.end();
+				it++) {
+			if((*it)->xfade.isWetRequested()) (*it)->asleep = false;
+		}
+	}
+	mutex_->unlock();
+}
+
+TAlchemyError DspServer::EffectChain::bypassEffect(TEffectID id, bool bypassed) {
+	TAlchemyError ret = E_OK;
+	mutex_->lock();
+	EffectSlot *slot = getSlotById(id);
+	if(slot == NULL) ret = E_INDEX;
+	else {
+		slot->xfade.setWet(!bypassed);
+		if(!bypassed) {
+			slot->asleep = false;
+			slot->cycles = 0;
+			slot->overruns = 0;
+			slot->overran = false;
+			slot->reported = true;
+		}
+	}
+	mutex_->unlock();
+	return ret;
+}
+
+bool DspServer::EffectChain::takeOverrun(SoundEffect*& effect, float& time_us,
+		float& budget_us) {
+	bool ret = false;
+	mutex_->lock();
+	for(TEffectStackIt it = effectstack_.begin(); it != effectstack_.end();
+			it++) {
+		EffectSlot *slot = *it;
+		if(slot->overran && !slot->reported) {
+			slot->reported = true;
+			effect = slot->effect;
+			time_us = slot->overrun_us;
+			budget_us = slot->budget_us;
+			ret = true;
+			break;
+		}
+	}
+	mutex_->unlock();
+	return ret;
+}
+
+void DspServer::EffectChain::checkBudget(EffectSlot *slot, float time_us,
+		unsigned int sample_count) {
+	float period_us = 1000000.0f * sample_count / sample_rate_;
+
+	// The time is learned per sample, the count of samples changes with the
+	// buffer size and with resampling. The first cycles only learn it.
+	float sample_us = time_us / sample_count;
+	if(slot->cycles < WARMUP_CYCLES) {
+		slot->sample_us = slot->cycles == 0 ? sample_us :
+				slot->sample_us + (sample_us - slot->sample_us) / 32;
+		slot->cycles++;
+		return;
+	}
+
+	float budget = BUDGET_FACTOR * slot->sample_us * sample_count;
+	if(budget < period_us * BUDGET_MIN_PERCENT / 100) {
+		budget = period_us * BUDGET_MIN_PERCENT / 100;
+	}
+	if(budget > period_us) budget = period_us;
+
+	slot->overruns <<= 1;
+	if(time_us <= budget) {
+		slot->sample_us += (sample_us - slot->sample_us) / 32;
+		return;
+	}
+	slot->overruns |= 1;
+
+	// A single overrun is expected from a preemption or a page fault, a
+	// runaway effect is faded out before it ruins every cycle.
+	if((unsigned int) __builtin_popcount(slot->overruns) >= OVERRUN_LIMIT) {
+		slot->xfade.setWet(false);
+		slot->overran = true;
+		slot->overrun_us = time_us;
+		slot->budget_us = budget;
+		slot->reported = false;
+		overrun_.post();
+	}
+}
+
+void DspServer::EffectChain::setCrossfadeLength(unsigned int samples) {
+	mutex_->lock();
+	xfade_length_ = samples;
+	bypass_xfade_.setLength(samples);
+	for(TEffectStackIt it = effectstack_.begin(); it != effectstack_.end(); it++)
+		(*it)->xfade.setLength(samples);
+	mutex_->unlock();
+}
+
+void DspServer::EffectChain::resolveControl(ControlMap::Binding& binding) {
+	mutex_->lock();
+	findParam(binding);
+	mutex_->unlock();
+}
+
+void DspServer::EffectChain::pushControl(const ControlEvent& event) {
+	// A full queue means that the parameter worker is stalled, the event is
+	// dropped.
+	if(controls_.push(event)) params_.post();
+}
+
+void DspServer::EffectChain::applyParams(void) {
+	mutex_->lock();
+	applyControls();
+	if(shared_ != NULL) {
+		// cleared first, a change after the scan is posted again
+		scan_posted_ = false;
+		__sync_synchronize();
+		applySharedParams();
+	}
+	mutex_->unlock();
+}
+
+double DspServer::EffectChain::getControlDelay(void) {
+	float delay = control_delay_us_;
+	return delay < 0.0f ? -1.0 : delay / 1000.0;
+}
+
+void DspServer::EffectChain::findParam(ControlMap::Binding& binding) {
+	binding.target = NULL;
+	binding.handle = NULL;
+	binding.layout = layout_;
+
+	// checked here, getEffectById() would log from the processing thread
+	if(binding.effect > effectstack_.size() + 1) return;
+
+	SoundEffect *effect = getEffectById(binding.effect);
+	if(binding.param >= effect->getParamsCount()) return;
+
+	binding.target = effect;
+	binding.handle = effect->getParam(binding.param);
+}
+
+void DspServer::EffectChain::applyControl(ControlEvent& event) {
+	ControlMap::Binding& binding = event.binding;
+	if(binding.layout != layout_) findParam(binding);
+	if(binding.handle == NULL) return;
+
+	binding.target->getMutex()->lock();
+	binding.handle->setValue(ControlMap::scale(*binding.handle, event.position));
+	binding.target->getMutex()->unlock();
+}
+
+void DspServer::EffectChain::applyControls(void) {
+	ControlEvent event;
+	if(!controls_.pop(event)) return;
+
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	unsigned long now = ts.tv_sec * 1000000ul + ts.tv_nsec / 1000;
+
+	do {
+		applyControl(event);
+
+		// the delay of a sweep is averaged over about 10 events
+		float delay = (float) (now - event.time);
+		float average = control_delay_us_;
+		control_delay_us_ = average < 0.0f ? delay :
+				average + 0.1f * (delay - average);
+	} while(controls_.pop(event));
+}
+
+void DspServer::EffectChain::applySharedParams(void) {
+	if(!shared_->beginParamScan()) return;
+
+	SharedControl::TParam param;
+	for(unsigned int slot = 0; slot < SharedControlBlock::MAX_PARAMS; slot++) {
+		if(!shared_->readParam(slot, param)) continue;
+
+		// checked here, getEffectById() would log every stale slot
+		if(param.effect_id > effectstack_.size() + 1) continue;
+		SoundEffect *effect = getEffectById(param.effect_id);
+		if(param.param_id >= effect->getParamsCount()) continue;
+
+		effect->getMutex()->lock();
+		effect->getParam(param.param_id)->setValue(param.value);
+		effect->getMutex()->unlock();
+	}
+
+	shared_->endParamScan();
+}
+
+TAlchemyError DspServer::EffectChain::addExport(AudioExport* signal,
+		TEffectID point) {
+	TAlchemyError ret = E_INDEX;
+	mutex_->lock();
+	if(point <= effectstack_.size() + 1 && exports_count_ < MAX_EXPORTS) {
+		signal->setSampleRate(sample_rate_);
+		exports_[exports_count_].signal = signal;
+		exports_[exports_count_].point = point;
+		exports_count_++;
+		ret = E_OK;
+	}
+	mutex_->unlock();
+	return ret;
+}
+
+void DspServer::EffectChain::removeExport(AudioExport* signal) {
+	mutex_->lock();
+	for(unsigned int i = 0; i < exports_count_; i++) {
+		if(exports_[i].signal == signal) {
+			exports_[i] = exports_[--exports_count_];
+			break;
+		}
+	}
+	mutex_->unlock();
+}
+
+void DspServer::EffectChain::setSharedControl(SharedControl* shared) {
+	mutex_->lock();
+	shared_ = shared;
+	mutex_->unlock();
+}
+
+void DspServer::EffectChain::setBufferLength(unsigned int frames) {
 	mutex_->lock();
-	bypassed_ = !bypassed_;
+	device_frames_ = frames;
+	allocBuffers();
 	mutex_->unlock();
 }
 
+void DspServer::EffectChain::allocBuffers(void) {
+	freeBuffers();
+	if(device_frames_ == 0) return;
+
+	TSampleRate in_rate = input_rate_ ? input_rate_ : sample_rate_;
+	TSampleRate out_rate = output_rate_ ? output_rate_ : sample_rate_;
+	resampling_ = in_rate != sample_rate_ || out_rate != sample_rate_;
+
+	buffer_length_ = device_frames_;
+	if(resampling_) {
+		// the chain gets the most samples the input conversion can produce
+		buffer_length_ = Resampler::getMaxOutput(device_frames_,
+				(double) sample_rate_ / in_rate);
+		in_resampler_ = new Resampler(device_frames_);
+		in_resampler_->setRates(in_rate, sample_rate_);
+		chain_in_ = new TSample[buffer_length_];
+
+		unsigned int out_max = Resampler::getMaxOutput(buffer_length_,
+				(double) out_rate / sample_rate_);
+		fifo_size_ = device_frames_ + out_max + FIFO_MARGIN;
+
+		for(unsigned int c = 0; c < 2; c++) {
+			out_resampler_[c] = new Resampler(buffer_length_);
+			out_resampler_[c]->setRates(sample_rate_, out_rate);
+			fifo_[c] = new TSample[fifo_size_];
+			for(unsigned int i = 0; i < fifo_size_; i++) fifo_[c][i] = 0.0f;
+		}
+
+		// the fifos start with silence for the delay of the resamplers as
+		// the first cycles produce that much fewer samples
+		fifo_fill_ = (unsigned int) (in_resampler_->getLatency() *
+				(double) out_rate / sample_rate_) +
+				out_resampler_[0]->getLatency() + FIFO_MARGIN;
+	}
+
+	dry_ = new TSample[buffer_length_];
+	silence_ = new TSample[buffer_length_];
+	for(unsigned int i = 0; i < buffer_length_; i++) silence_[i] = 0.0f;
+
+	allocScratch();
+}
+
+void DspServer::EffectChain::allocScratch(void) {
+	if(buffer_length_ == 0) return;
+
+	unsigned int channels = 0;
+	for(TEffectStackIt it = effectstack_.begin(); it != effectstack_.end(); it++)
+		if((*it)->effect->getOutputsCount() > channels)
+			channels = (*it)->effect->getOutputsCount();
+
+	while(scratch_.size() < channels)
+		scratch_.push_back(new TSample[buffer_length_]);
+
+	while(resampling_ && chain_io_.size() < 2*channels)
+		chain_io_.push_back(new TSample[buffer_length_]);
+}
+
+void DspServer::EffectChain::freeBuffers(void) {
+	delete [] dry_;
+	delete [] silence_;
+	dry_ = silence_ = NULL;
+
+	for(unsigned int c = 0; c < scratch_.size(); c++) delete [] scratch_[c];
+	scratch_.clear();
+	buffer_length_ = 0;
+
+	delete in_resampler_;
+	delete [] chain_in_;
+	in_resampler_ = NULL;
+	chain_in_ = NULL;
+
+	for(unsigned int c = 0; c < 2; c++) {
+		delete out_resampler_[c];
+		delete [] fifo_[c];
+		out_resampler_[c] = NULL;
+		fifo_[c] = NULL;
+	}
+	fifo_fill_ = fifo_size_ = 0;
+
+	for(unsigned int c = 0; c < chain_io_.size(); c++) delete [] chain_io_[c];
+	chain_io_.clear();
+	resampling_ = false;
+}
+
+void DspServer::EffectChain::connectInputs(SoundEffect *effect,
+		SoundEffect *previous) {
+	unsigned int outs = previous->getOutputsCount();
+	for(unsigned int p = 0; p < effect->getInputsCount(); p++) {
+		SoundEffect::Port *port = previous->getOutputPort(p < outs ? p : outs-1);
+		effect->getInputPort(p)->connect(*port);
+	}
+}
+
+void DspServer::EffectChain::flushTail(EffectSlot *slot,
+		unsigned int sample_count) {
+	SoundEffect *effect = slot->effect;
+	MixerEffect::MixerPort silence(SoundEffect::INPUT_PORT, "", silence_);
+
+	for(unsigned int p = 0; p < effect->getInputsCount(); p++)
+		effect->getInputPort(p)->connect(silence);
+
+	for(unsigned int p = 0; p < effect->getOutputsCount(); p++) {
+		MixerEffect::MixerPort scratch(SoundEffect::OUTPUT_PORT, "", scratch_[p]);
+		effect->getOutputPort(p)->connect(scratch);
+	}
+
+	effect->getMutex()->lock();
+	effect->process(sample_count);
+	effect->getMutex()->unlock();
+
+	// find the peak of the dropped output
+	TSample peak = 0.0f;
+	for(unsigned int p = 0; p < effect->getOutputsCount(); p++) {
+		TSample s = simd::peak(scratch_[p], sample_count);
+		if(s > peak) peak = s;
+	}
+
+	slot->tail_samples += sample_count;
+	if(peak < SILENCE_LEVEL ||
+			slot->tail_samples > TAIL_MAX_SECONDS*sample_rate_) {
+		slot->asleep = true;
+		slot->tail_samples = 0;
+	}
+}
+
+bool DspServer::EffectChain::isDecayed(EffectSlot *slot,
+		unsigned int sample_count) {
+	SoundEffect *effect = slot->effect;
+	unsigned int tail = effect->getTailLength();
+	if(tail == SoundEffect::TAIL_UNKNOWN) return false;
+
+	TSample peak = 0.0f;
+	for(unsigned int p = 0; p < effect->getInputsCount(); p++) {
+		// several ports may share the same buffer
+		TSample *buffer = effect->getInputPort(p)->getBuffer();
+		if(p > 0 && buffer == effect->getInputPort(p-1)->getBuffer()) continue;
+
+		TSample s = simd::peak(buffer, sample_count);
+		if(s > peak) peak = s;
+	}
+
+	if(peak >= SILENCE_LEVEL) {
+		slot->silent_samples = 0;
+		return false;
+	}
+
+	// the output of this cycle depends on the samples before it
+	if(slot->silent_samples < (unsigned long) tail + sample_count)
+		slot->silent_samples += sample_count;
+
+	return slot->silent_samples >= (unsigned long) tail + sample_count;
+}
+
 void DspServer::EffectChain::traverse(unsigned int sample_count) {
 	mutex_->lock();
 
-	SoundEffect *previous = &input_;
-	if(!bypassed_) {
+	// the parameters of the clients are set by the parameter worker
+	if(shared_ != NULL && !scan_posted_ && shared_->hasParamChanges()) {
+		scan_posted_ = true;
+		params_.post();
+	}
 
-		// The host has to ensure that the output_ effect has min 2 allocated
-		// output ports
-		input_.getOutputPort(0)->connect(*(output_.getOutputPort(0)));
-		input_.getMutex()->lock();
-		input_.process(sample_count);
-		input_.getMutex()->unlock();
+	if(!resampling_) {
+		// the buffers of the chain are not bigger than this
+		if(sample_count > buffer_length_) sample_count = buffer_length_;
 
-		for (TEffectStackIt it = effectstack_.begin(); it != effectstack_.end();
-				it++) {
-			for(unsigned int p = 0; p < (*it)->getInputsCount(); p++) {
-				(*it)->getInputPort(p)->connect(*(previous->getOutputPort(p)));
+		processInput(sample_count);
+		processChain(sample_count);
+	}
+	else {
+		if(sample_count > device_frames_) sample_count = device_frames_;
+
+		processInput(sample_count);
+
+		// convert the mono input to the rate of the chain
+		unsigned int chain_count = in_resampler_->process(
+				input_.getOutputPort(0)->getBuffer(), sample_count, chain_in_);
+
+		// the effects write to the buffers of input_ and output_, those are
+		// replaced by buffers of the chain's length
+		MixerEffect::MixerPort in(SoundEffect::OUTPUT_PORT, "", chain_in_);
+		input_.getOutputPort(0)->connect(in);
+		for(unsigned int c = 0; 2*c < chain_io_.size(); c++) {
+			if(c < input_.getInputsCount()) {
+				MixerEffect::MixerPort p(SoundEffect::INPUT_PORT, "", chain_io_[2*c]);
+				input_.getInputPort(c)->connect(p);
+			}
+			if(c < output_.getOutputsCount()) {
+				MixerEffect::MixerPort p(SoundEffect::OUTPUT_PORT, "", chain_io_[2*c+1]);
+				output_.getOutputPort(c)->connect(p);
 			}
+		}
+
+		processChain(chain_count);
+		convertOutput(chain_count, sample_count);
+	}
+
+	output_.getMutex()->lock();
+	output_.process(sample_count);
+	output_.getMutex()->unlock();
+
+	if(resampling_) consumeOutput(sample_count);
+
+	// the output is metered as it goes to the device
+	if(metering_) {
+		TEffectID last = effectstack_.size() + 1;
+		meterOutputs(last, &output_, sample_count);
+
+		if(shared_ != NULL) {
+			SharedControlBlock::Meters& meters = shared_->beginMeters();
+			meters.count = meters_.readCycle(meters.peak, meters.rms, last + 1);
+			shared_->endMeters();
+		}
+		meters_.publish(last + 1);
+	}
+
+	mutex_->unlock();
+}
+
+TAlchemyError DspServer::EffectChain::findEffect(SoundEffect* effect,
+		TEffectID& id) {
+	TAlchemyError ret = E_INDEX;
+	mutex_->lock();
+	for(TEffectStackIt it = effectstack_.begin(); it != effectstack_.end(); it++) {
+		if((*it)->effect == effect) {
+			id = it - effectstack_.begin() + 1;
+			ret = E_OK;
+			break;
+		}
+	}
+	mutex_->unlock();
+	return ret;
+}
+
+void DspServer::EffectChain::setAnalyzerTap(SampleRing* ring,
+		TEffectID point) {
+	mutex_->lock();
+	tap_ring_ = ring;
+	tap_point_ = point;
+	mutex_->unlock();
+}
+
+void DspServer::EffectChain::meterOutputs(unsigned int meter,
+		SoundEffect* effect, unsigned int sample_count) {
+	for(unsigned int p = 0; p < effect->getOutputsCount(); p++) {
+		TSample *buffer = effect->getOutputPort(p)->getBuffer();
+		if(p > 0 && buffer == effect->getOutputPort(p-1)->getBuffer()) continue;
+		meters_.add(meter, buffer, sample_count);
+	}
+}
 
-			(*it)->getOutputPort(0)->connect(*(previous->getInputPort(0)));
-			if((*it)->getOutputsCount() == 2) {
-				if(previous->getInputsCount() == 1 ) {
-					// previous effect had 1 input. A buffer from the output
-					// port of the output effect will be used
-					(*it)->getOutputPort(1)->connect(*(output_.getOutputPort(1)));
-				}
-				else {
-					(*it)->getOutputPort(1)->connect(*(previous->getInputPort(1)));
-				}
+void DspServer::EffectChain::processInput(unsigned int sample_count) {
+	// The host has to ensure that the output_ effect has min 2 allocated
+	// output ports
+	input_.getOutputPort(0)->connect(*(output_.getOutputPort(0)));
+	input_.getMutex()->lock();
+	input_.process(sample_count);
+	input_.getMutex()->unlock();
+
+	if(metering_) meters_.add(0, input_.getOutputPort(0)->getBuffer(),
+			sample_count);
+}
+
+void DspServer::EffectChain::processChain(unsigned int sample_count) {
+	// keep the dry signal for the bypass. The input's output buffer will be
+	// overwritten by the effects.
+	memcpy(dry_, input_.getOutputPort(0)->getBuffer(),
+			sample_count*sizeof(TSample));
+	tap(0, dry_, sample_count);
+	if(exports_count_ != 0) exportPorts(0, &input_, sample_count);
+
+	SoundEffect *previous = &input_;
+	bool chain_on = !bypass_xfade_.isDry();
+
+	for (TEffectStackIt it = effectstack_.begin(); it != effectstack_.end();
+			it++) {
+		EffectSlot *slot = *it;
+		SoundEffect *effect = slot->effect;
+
+		if(slot->asleep) continue;
+
+		// A bypassed effect is skipped in the chain but it's fed with
+		// silence until its tail decays to be ready for a click-free restart
+		if(!chain_on || slot->xfade.isDry()) {
+			flushTail(slot, sample_count);
+			continue;
+		}
+
+		connectInputs(effect, previous);
+
+		effect->getOutputPort(0)->connect(*(previous->getInputPort(0)));
+		for(unsigned int p = 1; p < effect->getOutputsCount(); p++) {
+			if(p >= previous->getInputsCount()) {
+				// previous effect had fewer inputs. A buffer from the output
+				// port of the output effect will be used
+				effect->getOutputPort(p)->connect(*(output_.getOutputPort(p)));
+			}
+			else {
+				effect->getOutputPort(p)->connect(*(previous->getInputPort(p)));
 			}
+		}
 
-			(*it)->getMutex()->lock();
-			(*it)->process(sample_count);
-			(*it)->getMutex()->unlock();
-			previous = (*it);
+		if(isDecayed(slot, sample_count)) {
+			for(unsigned int p = 0; p < effect->getOutputsCount(); p++) {
+				memset(effect->getOutputPort(p)->getBuffer(), 0,
+						sample_count*sizeof(TSample));
+			}
+		}
+		else {
+			timespec begin, end;
+			effect->getMutex()->lock();
+			clock_gettime(CLOCK_MONOTONIC, &begin);
+			effect->process(sample_count);
+			clock_gettime(CLOCK_MONOTONIC, &end);
+			effect->getMutex()->unlock();
+
+			// the effects being faded out are let go
+			if(slot->xfade.isWetRequested() && sample_count > 0 &&
+					sample_rate_ > 0) {
+				checkBudget(slot, (end.tv_sec - begin.tv_sec) * 1000000.0f +
+						(end.tv_nsec - begin.tv_nsec) / 1000.0f, sample_count);
+			}
 		}
 
-		for(unsigned int p = 0; p < output_.getInputsCount(); p++) {
-			output_.getInputPort(p)->connect(*(previous->getOutputPort(p)));
+		// fade between the input and the output of the effect
+		if(!slot->xfade.isWet()) {
+			unsigned int ins = effect->getInputsCount();
+			for(unsigned int p = 0; p < effect->getOutputsCount(); p++) {
+				slot->xfade.mix(effect->getInputPort(p < ins ? p : ins-1)->getBuffer(),
+						effect->getOutputPort(p)->getBuffer(), sample_count);
+			}
+			slot->xfade.advance(sample_count);
 		}
 
+		TEffectID id = it - effectstack_.begin() + 1;
+		if(metering_) meterOutputs(id, effect, sample_count);
+		tap(id, effect->getOutputPort(0)->getBuffer(), sample_count);
+		if(exports_count_ != 0) exportPorts(id, effect, sample_count);
+
+		previous = effect;
+	}
+
+	if(chain_on) {
+		connectInputs(&output_, previous);
+
+		if(!bypass_xfade_.isWet()) {
+			for(unsigned int p = 0; p < output_.getInputsCount(); p++) {
+				// several ports may share the same buffer, mix only once
+				TSample *buffer = output_.getInputPort(p)->getBuffer();
+				if(p > 0 && buffer == output_.getInputPort(p-1)->getBuffer())
+					continue;
+				bypass_xfade_.mix(dry_, buffer, sample_count);
+			}
+			bypass_xfade_.advance(sample_count);
+		}
 	} else {
-		// don't use the input mixer effect. Connect all input ports of the input
-		// effect to the inputs of the output mixer and go
-		output_.setInputsCount(input_.getInputsCount());
+		// don't use the effects, connect the dry input to all the inputs of
+		// the output mixer and go
+		MixerEffect::MixerPort dry(SoundEffect::OUTPUT_PORT, "", dry_);
 		for(unsigned int p = 0; p < output_.getInputsCount(); p++) {
-			output_.getInputPort(p)->connect(*(input_.getInputPort(p)));
+			output_.getInputPort(p)->connect(dry);
 		}
+	}
+
+	// the output is tapped at the rate of the chain
+	tap(effectstack_.size() + 1, output_.getInputPort(0)->getBuffer(),
+			sample_count);
+	if(exports_count_ != 0)
+		exportPorts(effectstack_.size() + 1, &output_, sample_count);
+}
+
+void DspServer::EffectChain::exportPorts(TEffectID point, SoundEffect* effect,
+		unsigned int sample_count) {
+	TSample *buffers[AudioExport::MAX_CHANNELS];
+	unsigned int count = 0;
 
+	if(effect == &input_) {
+		// the input is mono, its output is overwritten by the effects
+		buffers[count++] = dry_;
 	}
+	else if(effect == &output_) {
+		for(; count < output_.getInputsCount() &&
+				count < AudioExport::MAX_CHANNELS; count++)
+			buffers[count] = output_.getInputPort(count)->getBuffer();
+	}
+	else {
+		for(; count < effect->getOutputsCount() &&
+				count < AudioExport::MAX_CHANNELS; count++)
+			buffers[count] = effect->getOutputPort(count)->getBuffer();
+	}
+	if(count == 0) return;
 
-	output_.getMutex()->lock();
-	output_.process(sample_count);
-	output_.getMutex()->unlock();
-	mutex_->unlock();
+	for(unsigned int i = 0; i < exports_count_; i++) {
+		if(exports_[i].point == point)
+			exports_[i].signal->write(buffers, count, sample_count);
+	}
+}
+
+void DspServer::EffectChain::convertOutput(unsigned int sample_count,
+		unsigned int frames) {
+	unsigned int channels = output_.getInputsCount();
+	if(channels > 2) channels = 2;
+
+	// make room for the converted samples if the output stream falls behind
+	unsigned int space = fifo_size_ - fifo_fill_;
+	unsigned int needed = Resampler::getMaxOutput(sample_count,
+			out_resampler_[0]->getRatio());
+	if(needed > space) {
+		unsigned int drop = needed - space;
+		for(unsigned int c = 0; c < 2; c++) {
+			memmove(fifo_[c], fifo_[c] + drop,
+					(fifo_fill_ - drop)*sizeof(TSample));
+		}
+		fifo_fill_ -= drop;
+	}
+
+	unsigned int produced = 0;
+	for(unsigned int p = 0; p < channels; p++) {
+		produced = out_resampler_[p]->process(
+				output_.getInputPort(p)->getBuffer(), sample_count,
+				fifo_[p] + fifo_fill_);
+	}
+	fifo_fill_ += produced;
+
+	// if the fifos run out, the rest of the cycle is silence
+	for(unsigned int p = 0; p < channels; p++) {
+		for(unsigned int i = fifo_fill_; i < frames; i++) fifo_[p][i] = 0.0f;
+
+		MixerEffect::MixerPort fifo(SoundEffect::OUTPUT_PORT, "", fifo_[p]);
+		output_.getInputPort(p)->connect(fifo);
+	}
+
+	// the output is written to the device again
+	for(unsigned int c = 0; c < device_out_channels_; c++) {
+		MixerEffect::MixerPort p(SoundEffect::OUTPUT_PORT, "", device_out_[c]);
+		output_.getOutputPort(c)->connect(p);
+	}
+}
+
+void DspServer::EffectChain::consumeOutput(unsigned int frames) {
+	if(frames >= fifo_fill_) {
+		fifo_fill_ = 0;
+		return;
+	}
+
+	for(unsigned int c = 0; c < 2; c++) {
+		memmove(fifo_[c], fifo_[c] + frames,
+				(fifo_fill_ - frames)*sizeof(TSample));
+	}
+	fifo_fill_ -= frames;
 }
 
 void DspServer::EffectChain::setInputBuffer(SoundEffect::TSample** buffer,
@@ -596,6 +2085,8 @@ void DspServer::EffectChain::setOutputBuffer(SoundEffect::TSample **buffer,
 		unsigned int channels) {
 
 	output_.setOutputsCount(channels);
+	device_out_ = buffer;
+	device_out_channels_ = channels;
 
 	for(unsigned int c = 0; c < channels; c++) {
 		MixerEffect::MixerPort p(SoundEffect::OUTPUT_PORT, "", buffer[c]);
@@ -604,146 +2095,214 @@ void DspServer::EffectChain::setOutputBuffer(SoundEffect::TSample **buffer,
 
 }
 
+DspServer::EffectChain::EffectSlot*
+DspServer::EffectChain::getSlotById(SoundEffect::TEffectID id) {
+	if(id == 0 || id > effectstack_.size()) {
+		log(LEVEL_WARNING, "%s: %s", STR_ERRORS[soundalchemy::E_INDEX],
+				"No effect with the given index");
+		return NULL;
+	}
+
+	return effectstack_[id-1];
+}
+
 SoundEffect* DspServer::EffectChain::getEffectById(SoundEffect::TEffectID id) {
 	SoundEffect *effect = NULL;
 
-	if(id > effectstack_.size()) {
-		log(LEVEL_WARNING, "%: %", STR_ERRORS[soundalchemy::E_INDEX],
+	if(id > effectstack_.size()+1) {
+		log(LEVEL_WARNING, "%s: %s", STR_ERRORS[soundalchemy::E_INDEX],
 				"No effect with the given index");
 	}
 	else if ( id == 0 ) {
 		effect = &input_;
-	} else if( id == effectstack_.size()) {
+	} else if( id == effectstack_.size()+1) {
 		effect = &output_;
 	}
-	else effect = effectstack_[id-1];
+	else effect = effectstack_[id-1]->effect;
 
 	return effect;
 }
 
-void DspServer::EffectChain::setEffectParam(SoundEffect::TEffectID id,
-		std::string param, SoundEffect::TParamValue value) {
-	setEffectParam<std::string>(id, param, value);
+TAlchemyError DspServer::EffectChain::setEffectParam(SoundEffect::TEffectID id,
+		std::string param_name, SoundEffect::TParamValue value) {
+	return setEffectParam<std::string>(id, param_name, value);
 }
 
-void DspServer::EffectChain::setEffectParam(SoundEffect::TEffectID id,
+TAlchemyError DspServer::EffectChain::setEffectParam(SoundEffect::TEffectID id,
 		SoundEffect::TParamID param, SoundEffect::TParamValue value) {
-	setEffectParam<SoundEffect::TParamID>(id, param, value);
+	return setEffectParam<SoundEffect::TParamID>(id, param, value);
 }
 
-SoundEffect::TParamValue
-DspServer::EffectChain::getEffectParam(SoundEffect::TEffectID id,
-		SoundEffect::TParamID param) {
-	return getEffectParam<SoundEffect::TParamID>(id, param);
+TAlchemyError DspServer::EffectChain::getEffectParam(SoundEffect::TEffectID id,
+		SoundEffect::TParamID param, SoundEffect::TParamValue& value) {
+	return getEffectParam<SoundEffect::TParamID>(id, param, value);
 }
 
-SoundEffect::TParamValue
-DspServer::EffectChain::getEffectParam(SoundEffect::TEffectID id,
-				std::string param_name) {
-	return getEffectParam<std::string>(id, param_name);
+TAlchemyError DspServer::EffectChain::getEffectParam(SoundEffect::TEffectID id,
+		std::string param_name, SoundEffect::TParamValue& value) {
+	return getEffectParam<std::string>(id, param_name, value);
 }
 
 void DspServer::EffectChain::activate(void) {
 	for(TEffectStackIt it = effectstack_.begin(); it != effectstack_.end(); it++) {
-		(*it)->activate();
+		(*it)->effect->activate();
 	}
+	active_ = true;
 }
 
 void DspServer::EffectChain::deactivate(void) {
 	for(TEffectStackIt it = effectstack_.begin(); it != effectstack_.end(); it++) {
-		(*it)->deactivate();
+		(*it)->effect->deactivate();
+	}
+	active_ = false;
+}
+
+// Crossfade ///////////////////////////////////////////////////////////////////
+//
+void DspServer::EffectChain::Crossfade::mix(const TSample* dry, TSample* wet,
+		unsigned int samples) {
+	float g = gain_;
+	for(unsigned int i = 0; i < samples; i++) {
+		if(g < target_) { g += step_; if(g > target_) g = target_; }
+		else if(g > target_) { g -= step_; if(g < target_) g = target_; }
+		wet[i] = dry[i] + g*(wet[i] - dry[i]);
 	}
 }
 
+void DspServer::EffectChain::Crossfade::advance(unsigned int samples) {
+	float delta = step_*samples;
+	if(gain_ < target_) { gain_ += delta; if(gain_ > target_) gain_ = target_; }
+	else if(gain_ > target_) { gain_ -= delta; if(gain_ < target_) gain_ = target_; }
+}
+
 /* ************************************************************************** */
-DspServer::MessageQueue::MessageQueue() {
-	monitor_ = Thread::getNewThread();
-	writemutex_ = Thread::getMutex();
-	waiters_ = 0;
-	enabled_ = true;
+DspServer::MessageQueue::MessageQueue(): head_(NULL), posted_us_(0),
+		wakeup_us_(-1.0f), enabled_(true) {
 }
 
 DspServer::MessageQueue::~MessageQueue() {
-	writemutex_->lock();
-	cond_var_.lock();
 	enabled_ = false;
-	cond_var_.unlock();
-	writemutex_->unlock();
-// delete remaining messages
-	InboundMessage* temp;
-	while (!cond_var_.queue_base_.empty()) {
-		temp = cond_var_.queue_base_.front();
-		delete temp;
-		cond_var_.queue_base_.pop();
+
+	// delete remaining messages
+	InboundMessage* message = __sync_lock_test_and_set(&head_,
+			(InboundMessage*) NULL);
+	while(message != NULL) {
+		InboundMessage* next = message->getNext();
+		delete message;
+		message = next;
 	}
-	delete writemutex_;
-	delete monitor_;
 }
 
-InboundMessage* DspServer::MessageQueue::popFront(void) {
-	if (!enabled_)
-		return NULL;
+InboundMessage* DspServer::MessageQueue::popAll(void) {
+	InboundMessage* list;
+	while(enabled_) {
+		list = __sync_lock_test_and_set(&head_, (InboundMessage*) NULL);
+		if(list != NULL) {
+			// the post of a batch taken without waiting is left over, its
+			// time mustn't be taken for a wake up later
+			posted_us_ = 0;
+			break;
+		}
 
-	cond_var_.lock();
-	writemutex_->lock();
-	if (cond_var_.queue_base_.empty()) {
-		writemutex_->unlock();
-		waiters_++;
-		monitor_->waitOn(cond_var_);
-	} else
-		writemutex_->unlock();
-
-	cond_var_.unlock();
-	InboundMessage* ret = cond_var_.queue_base_.front();
-	cond_var_.queue_base_.pop();
-	return ret;
+		// The semaphore is posted by the push which found the queue empty.
+		// The post may be left from a message taken already, then the queue
+		// is checked again.
+		wakeup_.wait();
+
+		// The delay of the wake ups is averaged over about 10 of them. A
+		// left over post has no time, the idle time isn't a delay.
+		unsigned long posted = __sync_lock_test_and_set(&posted_us_, 0ul);
+		if(posted == 0) continue;
+		float delay = (float) (now() - posted);
+		float average = wakeup_us_;
+		wakeup_us_ = average < 0.0f ? delay : average + 0.1f * (delay - average);
+	}
+	if(!enabled_) return NULL;
+
+	// the list is linked from the latest message
+	InboundMessage* first = NULL;
+	while(list != NULL) {
+		InboundMessage* next = list->getNext();
+		list->setNext(first);
+		first = list;
+		list = next;
+	}
+
+	return coalesce(first);
 }
-void DspServer::MessageQueue::pushBack(InboundMessage* message) {
-	if (!enabled_)
-		return;
 
-	unsigned int waiters;
-	cond_var_.lock();
-	writemutex_->lock();
-	waiters = waiters_;
-	cond_var_.queue_base_.push(message);
-	writemutex_->unlock();
-	cond_var_.unlock();
-	if (waiters > 0) {
-		if (monitor_->wakeUp()) {
-			log(LEVEL_ERROR,
-					"%s. No thread is waiting on the queue when attempt to wake up",
-					STR_ERRORS[E_QUEUE]);
-		} else
-			waiters_--;
+InboundMessage* DspServer::MessageQueue::coalesce(InboundMessage* first) {
+	std::map<InboundMessage::TCoalescingKey, InboundMessage*> latest;
+	InboundMessage::TCoalescingKey key;
+
+	// the last message kept
+	InboundMessage* prev = NULL;
+
+	InboundMessage* message = first;
+	while(message != NULL) {
+		if(!message->getCoalescingKey(key)) {
+			prev = message;
+			message = message->getNext();
+			continue;
+		}
+
+		// The messages are coalesced in runs, any other message between them
+		// is processed in its place, e.g. a read of a parameter gets the
+		// value set before it.
+		latest.clear();
+		InboundMessage* end = message;
+		while(end != NULL && end->getCoalescingKey(key)) {
+			latest[key] = end;
+			end = end->getNext();
+		}
+
+		// only the latest message of each key is kept from the run
+		while(message != end) {
+			InboundMessage* next = message->getNext();
+			message->getCoalescingKey(key);
+			if(latest[key] == message) {
+				if(prev != NULL) prev->setNext(message);
+				else first = message;
+				prev = message;
+			}
+			else delete message;
+			message = next;
+		}
+		if(prev != NULL) prev->setNext(end);
+		else first = end;
 	}
+
+	return first;
 }
 
-unsigned int DspServer::MessageQueue::getSize(void) {
+void DspServer::MessageQueue::pushBack(InboundMessage* message) {
 	if (!enabled_)
-		return 0;
+		return;
 
-	unsigned int size;
-	cond_var_.lock();
-	writemutex_->lock();
-	size = cond_var_.queue_base_.size();
-	writemutex_->unlock();
-	cond_var_.unlock();
-	return size;
+	InboundMessage* head;
+	do {
+		head = head_;
+		message->setNext(head);
+	} while(!__sync_bool_compare_and_swap(&head_, head, message));
+
+	// only the first message wakes up the consumer, the later ones are
+	// taken in the same batch
+	if(head == NULL) {
+		posted_us_ = now();
+		wakeup_.post();
+	}
 }
-bool DspServer::MessageQueue::isEmpty(void) {
-	if (!enabled_)
-		return true;
 
-	bool empty;
-	cond_var_.lock();
-	writemutex_->lock();
-	empty = cond_var_.queue_base_.empty();
-	writemutex_->unlock();
-	cond_var_.unlock();
-	return empty;
+double DspServer::MessageQueue::getWakeupDelay(void) {
+	float delay = wakeup_us_;
+	return delay < 0.0f ? -1.0 : delay / 1000.0;
 }
 
+unsigned long DspServer::MessageQueue::now(void) {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000ul + ts.tv_nsec / 1000;
+}
 
 }
 
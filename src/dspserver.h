@@ -17,8 +17,17 @@
 #include "thread.h"
 #include "soundeffect.h"
 #include "effectdatabase.h"
+#include "resampler.h"
+#include "clockbridge.h"
+#include "aggregatedevice.h"
+#include "controlmap.h"
+#include "meters.h"
+#include "analyzer.h"
+#include "tuner.h"
+#include "convolution.h"
+#include "sharedcontrol.h"
+#include "audioexport.h"
 
-#include <queue>
 #include <signal.h>
 #include "llaudio/llaudio.h"
 
@@ -78,6 +87,27 @@ public:
 	 */
 	TAlchemyError setOutputStream(TDeviceId device, TStreamId id);
 
+	/**
+	 * Declares a device made of the streams of other devices. Its streams can
+	 * be set as the input or the output like the streams of any other device.
+	 * @param name The name of the new device, it has to be unique.
+	 * @param inputs The input streams of the members, the first one's device
+	 * gives the clock of the aggregate.
+	 * @param outputs The output streams of the members.
+	 * @return Returns E_OK or E_AGGREGATE if a member is not found or the name
+	 * is already used.
+	 */
+	TAlchemyError createAggregateDevice(const char* name,
+			const TAggregateMembers& inputs, const TAggregateMembers& outputs);
+
+	/**
+	 * Removes a device declared by createAggregateDevice().
+	 * @param name The name of the device.
+	 * @return Returns E_OK or E_AGGREGATE if there is no such device or its
+	 * streams are used by the effect chain.
+	 */
+	TAlchemyError removeAggregateDevice(const char* name);
+
 	/**
 	 *
 	 * @return
@@ -97,16 +127,302 @@ public:
 	void setBufferSize(TSize buffer_size);
 
 	/**
-	 *
-	 * @param sample_rate
+	 * Starts finding the smallest buffer size the current effect chain runs
+	 * with without xruns. The chain is run with every tried size for
+	 * TUNE_WINDOW_MS and a size is stable if no xrun occurs and no cycle
+	 * takes more than (1 - margin) of its period. The size grows from the
+	 * current one until it's stable, then halves while it stays stable.
+	 * The sizes are judged by the tune worker, the message loop only
+	 * restarts the processing with them. The result is broadcast when the
+	 * tuning ends, see finishTuning().
+	 * @param margin The part of the period kept free, between 0 and 1.
+	 * @param channel The client asking for the tuning, the result is sent
+	 * with its channel.
+	 * @return Returns E_OK, E_BUFFER_SIZE if a tuning is running already or
+	 * E_THREAD if the tune worker can't be started.
+	 */
+	TAlchemyError autoTuneBufferSize(float margin, Message::TChannelID channel);
+
+	/**
+	 * Restarts the processing with a buffer size tried by the tuning. Called
+	 * on the request of the tune worker.
+	 */
+	void tryBufferSize(unsigned int frames);
+
+	/**
+	 * Ends the tuning with the size found by the tune worker. The processing
+	 * is restarted with it if it was running when the tuning started.
+	 * @param frames The buffer size found.
+	 * @param stable False if no stable size was found up to TUNE_MAX_FRAMES.
+	 * @param channel The channel of the client which asked for the tuning.
+	 * @return Returns E_OK or E_BUFFER_SIZE if the size isn't stable.
+	 */
+	TAlchemyError finishTuning(unsigned int frames, bool stable,
+			Message::TChannelID& channel);
+
+	/**
+	 * Starts the tune worker for the changed chain if the automatic tuning is
+	 * on, the processing runs and no tuning is running yet.
+	 */
+	void retune();
+
+	/**
+	 * Switches the automatic tuning on or off. While it's on, the buffer
+	 * size is doubled when the load stays above the margin for GROW_WINDOWS
+	 * watch periods, and adding an effect or changing the sample rate starts
+	 * the tune worker again beside the message loop. Its result is sent to
+	 * every client.
+	 * @param enabled True to keep the buffer size tuned.
+	 * @param margin The part of the period kept free, between 0 and 1.
+	 */
+	void setAutoTune(bool enabled, float margin);
+
+	/**
+	 * Doubles the buffer size and restarts the processing. Called on the
+	 * request of the load watcher when the automatic tuning is on.
+	 * @param frames The new buffer size.
+	 * @return Returns E_OK or E_BUFFER_SIZE if it can't grow any more.
+	 */
+	TAlchemyError growBufferSize(unsigned int& frames);
+
+	/// Buffer sizes tried by the tuning
+	static const unsigned int TUNE_MIN_FRAMES = 32;
+	static const unsigned int TUNE_MAX_FRAMES = 4096;
+
+	/// A tried size runs TUNE_SETTLE_MS before it's watched for TUNE_WINDOW_MS
+	static const unsigned int TUNE_SETTLE_MS = 300;
+	static const unsigned int TUNE_WINDOW_MS = 2000;
+
+	/// The load watcher of the automatic tuning checks the processing in
+	/// every WATCH_PERIOD_MS and grows the buffer after GROW_WINDOWS
+	/// overloaded periods in a row.
+	static const unsigned int WATCH_PERIOD_MS = 1000;
+	static const unsigned int GROW_WINDOWS = 3;
+
+	/// The margin used if a client doesn't give one
+	static const float DEFAULT_TUNE_MARGIN;
+
+	/**
+	 * Sets the sample rate of the processing. The effects of the chain are
+	 * instantiated again for the new rate in the calling thread and swapped
+	 * in with their parameter values. If the streams run at a different rate
+	 * the signal is resampled between the streams and the chain.
+	 * @param sample_rate The new sample rate.
 	 */
 	void setSampleRate(TSampleRate sample_rate);
 
 	/**
-	 *
-	 * @param effect
+	 * Adds an effect from the effect database to the end of the chain.
+	 * @param effect_name The short name of the effect in the database.
+	 * @return Returns E_OK, E_DATABASE if there is no such effect or
+	 * E_PORTS_INCOMPATIBLE if it can't be connected to the chain.
+	 */
+	TAlchemyError addEffect(std::string effect_name);
+
+	/**
+	 * Bypasses the whole effect chain or switches it back on. The change is
+	 * done with a crossfade between the dry and the processed signal.
+	 * @param bypassed True to bypass, false to switch the processing on.
+	 */
+	void bypass(bool bypassed);
+
+	/**
+	 * Bypasses a single effect of the chain or switches it back on.
+	 * @param effect_id The ID of the effect in the chain.
+	 * @param bypassed True to bypass, false to switch the effect on.
+	 * @return Returns E_OK or E_INDEX if there is no such effect.
 	 */
-	void addEffect(std::string effect_name);
+	TAlchemyError bypassEffect(SoundEffect::TEffectID effect_id, bool bypassed);
+
+	/**
+	 * Sets a parameter of an effect.
+	 * @param effect_id The ID of the effect in the chain, 0 is the input.
+	 * @param param_id The ID of the parameter of the effect.
+	 * @param value The new value.
+	 * @return Returns E_OK or E_INDEX if there is no such effect or parameter.
+	 */
+	TAlchemyError setEffectParam(SoundEffect::TEffectID effect_id,
+			SoundEffect::TParamID param_id, SoundEffect::TParamValue value);
+
+	/**
+	 * Gets a parameter of an effect.
+	 * @param effect_id The ID of the effect in the chain, 0 is the input.
+	 * @param param_id The ID of the parameter of the effect.
+	 * @param value The value is returned here.
+	 * @return Returns E_OK or E_INDEX if there is no such effect or parameter.
+	 */
+	TAlchemyError getEffectParam(SoundEffect::TEffectID effect_id,
+			SoundEffect::TParamID param_id, SoundEffect::TParamValue& value);
+
+	/**
+	 * Sets the length of the bypass crossfades.
+	 * @param samples The length of the fade given in samples.
+	 */
+	void setCrossfadeLength(unsigned int samples);
+
+	/**
+	 * Binds a MIDI controller to a parameter of an effect.
+	 * @param control The controller, see ControlMap::makeId().
+	 * @param effect_id The ID of the effect in the chain.
+	 * @param param_id The ID of the parameter of the effect.
+	 */
+	void bindControl(TControlId control, SoundEffect::TEffectID effect_id,
+			SoundEffect::TParamID param_id);
+
+	/**
+	 * Binds the next MIDI controller moved to a parameter of an effect.
+	 * @param effect_id The ID of the effect in the chain.
+	 * @param param_id The ID of the parameter of the effect.
+	 */
+	void learnControl(SoundEffect::TEffectID effect_id,
+			SoundEffect::TParamID param_id);
+
+	/**
+	 * Removes the controllers bound to a parameter of an effect.
+	 * @return Returns E_OK or E_INDEX if no controller was bound to it.
+	 */
+	TAlchemyError unbindControl(SoundEffect::TEffectID effect_id,
+			SoundEffect::TParamID param_id);
+
+	/**
+	 * Called by the MIDI connectors when a controller moved. If it's bound,
+	 * the event is queued without locking and the parameter worker sets the
+	 * parameter, the processing thread is never blocked by it.
+	 * @param control The controller.
+	 * @param position The position of the controller between 0 and 1.
+	 * @param time The arrival of the event in microseconds of the monotonic
+	 * clock.
+	 * @param binding The parameter the controller is bound to.
+	 * @return Returns true if the controller has just been learned.
+	 */
+	bool controlChanged(TControlId control, float position, unsigned long time,
+			ControlMap::Binding& binding);
+
+	/// The meter frames are sent at this rate if a client doesn't give one
+	static const unsigned int DEFAULT_METER_RATE = 30;
+	static const unsigned int MAX_METER_RATE = 100;
+
+	/**
+	 * Subscribes a client to the meter frames or unsubscribes it. The
+	 * processing is metered and the frames are sent while any client is
+	 * subscribed.
+	 * @param client The channel of the client.
+	 * @param subscribe True to subscribe, false to unsubscribe.
+	 * @param rate The count of frames a second, 0 is DEFAULT_METER_RATE.
+	 * It's common for all the clients, the latest subscription sets it.
+	 * @return Returns E_OK or E_INDEX if there is no such client.
+	 */
+	TAlchemyError subscribeMeters(Message::TChannelID client, bool subscribe,
+			unsigned int rate = DEFAULT_METER_RATE);
+
+	/**
+	 * Sends the levels metered since the previous frame to the subscribed
+	 * clients. Called on the requests of the meter timer.
+	 */
+	void publishMeters(void);
+
+	/**
+	 * Subscribes a client to the spectrum of a point of the chain or
+	 * unsubscribes it. The signal is analyzed and the frames are sent while
+	 * any client is subscribed. The point and the analysis are common for
+	 * all the clients, the latest subscription sets them.
+	 * @param client The channel of the client.
+	 * @param subscribe True to subscribe, false to unsubscribe.
+	 * @param point The ID of the effect whose output is analyzed, the input
+	 * is 0 and the output is the last one.
+	 * @param size The count of samples of an analyzed window.
+	 * @param overlap The part of a window overlapping the next one.
+	 * @param bins The count of the bins of a frame.
+	 * @return Returns E_OK or E_INDEX if there is no such client or point.
+	 * @see SpectrumAnalyzer
+	 */
+	TAlchemyError subscribeSpectrum(Message::TChannelID client, bool subscribe,
+			SoundEffect::TEffectID point, unsigned int size, float overlap,
+			unsigned int bins);
+
+	/**
+	 * Sends the latest spectrum to the subscribed clients. Called on the
+	 * requests of the analyzer thread.
+	 */
+	void publishSpectrum(void);
+
+	/**
+	 * Finds the ID of an effect in the chain.
+	 * @param effect The effect.
+	 * @param effect_id The ID is returned here.
+	 * @return Returns E_OK or E_INDEX if the effect isn't in the chain.
+	 */
+	TAlchemyError findEffect(SoundEffect* effect,
+			SoundEffect::TEffectID& effect_id);
+
+	/**
+	 * Opens the shared control block for the local clients. The parameters
+	 * written to it are applied and the status and the meters are published
+	 * through it in every cycle of the processing. If the processing runs
+	 * it's restarted.
+	 * @param path The path of the file mapped by the server and the clients.
+	 * @return Returns E_OK or E_FILE if the block can't be created.
+	 * @see SharedControlBlock
+	 */
+	TAlchemyError openSharedControl(const char* path);
+
+	/**
+	 * Closes the shared control block and removes its file.
+	 */
+	void closeSharedControl(void);
+
+	/**
+	 * Exports the signal of a point of the chain to other local processes
+	 * through a ring in a shared file. The processing writes the ring in
+	 * every cycle and never waits for the readers.
+	 * @param point The ID of the effect whose outputs are exported, the
+	 * input is 0 and the output is the last one.
+	 * @param path The path of the file of the ring.
+	 * @param channels The count of the exported channels. If the point has
+	 * fewer outputs the last one is repeated.
+	 * @param frames The frames of the ring, 0 is the default.
+	 * @return Returns E_OK, E_INDEX if there is no such point or too many
+	 * signals are exported or E_FILE if the file can't be created.
+	 * @see AudioExportHeader
+	 */
+	TAlchemyError exportSignal(SoundEffect::TEffectID point, const char* path,
+			unsigned int channels, unsigned int frames);
+
+	/**
+	 * Stops an export and removes its file.
+	 * @param path The path the signal was exported to.
+	 * @return Returns E_OK or E_INDEX if nothing is exported there.
+	 */
+	TAlchemyError removeExport(const char* path);
+
+	/**
+	 * Latencies in milliseconds. The values are negative if unknown.
+	 */
+	struct Latency {
+		double input_ms;      //!< Reported by the input stream
+		double output_ms;     //!< Reported by the output stream
+		double processing_ms; //!< Delay of the effects and the resamplers
+		double measured_ms;   //!< Result of the last loopback measurement
+		double control_ms;    //!< Average delay of the controller events
+		double queue_ms;      //!< Average wake up delay of the message queue
+		double start_ms;      //!< Duration of the last start of the processing
+		double stop_ms;       //!< Duration of the last stop of the processing
+	};
+
+	/**
+	 * Collects the latencies of the streams and of the effect chain.
+	 * @param latency The place of the results.
+	 */
+	void getLatency(Latency& latency);
+
+	/**
+	 * Measures the round trip latency of the output and input streams with a
+	 * LatencyProbe. The output has to be looped back to the input. If the
+	 * processing runs it's stopped for the time of the measurement.
+	 * @param latency_ms The measured latency in milliseconds.
+	 * @return Returns E_OK or the error of the measurement.
+	 */
+	TAlchemyError measureLatency(double& latency_ms);
 
 	/**
 	 *
@@ -150,7 +466,9 @@ public:
 private:
 
 	/**
-	 * Sending a message or reply to all the client connectors
+	 * Sending a message or reply to all the client connectors. The message
+	 * is serialized once for each protocol, the connectors queue the same
+	 * shared buffer.
 	 * @param message
 	 */
 	void broadcastMessage(OutboundMessage& message);
@@ -204,6 +522,32 @@ private:
 			 */
 			virtual llaOutputStream& getOutput(void) = 0;
 
+			/**
+			 * @return Returns the sample rate the graph processes at. The
+			 * streams are requested to run at this rate.
+			 */
+			virtual TSampleRate getSampleRate(void) = 0;
+
+			/**
+			 * Tells the graph the sample rates applied by the opened streams.
+			 * If they differ from the rate of the graph, it has to convert the
+			 * signal between them. Called before setBufferLength().
+			 * @param input The sample rate of the input stream.
+			 * @param output The sample rate of the output stream.
+			 */
+			virtual void setStreamSampleRates(TSampleRate input,
+					TSampleRate output) = 0;
+
+			/**
+			 * Tells the graph the maximal count of samples which will be
+			 * passed to traverse(), given at the rate of the streams. All the
+			 * internal buffers of the graph have to be allocated here as
+			 * traverse() runs in the real time thread and must not allocate
+			 * memory.
+			 * @param frames The maximal sample count of one processing cycle.
+			 */
+			virtual void setBufferLength(unsigned int frames) = 0;
+
 			/**
 			 * Several real time audio plug-ins have to be activated before
 			 * they are used for processing. This method has to activate all
@@ -246,18 +590,76 @@ private:
 		 */
 		void* run(void);
 
+		/// The longest wait for the first cycles of the processing
+		static const int START_TIMEOUT_MS = 3000;
+
 		/**
 		 * This method will start the processing in a separate thred of execution.
 		 * @return Returns an error code from TAlchemyError or E_OK if the
-		 * processing started without problem. The function will block for a
-		 * short period of time to wait for a response from the processing thread.
+		 * processing started without problem. The function will block until
+		 * the processing thread runs its first cycles, at most for
+		 * START_TIMEOUT_MS. The processing is stopped if it doesn't start.
 		 */
 		TAlchemyError startProcessing(void);
 
+		/**
+		 * @return Returns the time the last start and stop of the
+		 * processing took in microseconds, 0 if not known yet.
+		 */
+		unsigned long getStartTime(void) { return start_us_; }
+		unsigned long getStopTime(void) { return stop_us_; }
+
 		void setBufferSize(unsigned int frames) {
 			llaAudioPipe::setBufferLength(frames);
 		}
 
+		unsigned int getBufferSize(void) {
+			return llaAudioPipe::getBufferLength();
+		}
+
+		/**
+		 * Load statistics of the processing. The counters only grow while
+		 * the processing runs, so the load of a period is the difference of
+		 * two snapshots. The time values are in microseconds and may wrap
+		 * around, unsigned subtraction gives the right difference.
+		 */
+		struct LoadStats {
+			unsigned long cycles;    //!< processed cycles
+			unsigned long overloads; //!< cycles above the load limit
+			unsigned long xruns;     //!< over- and underruns of the streams
+			unsigned long busy_us;   //!< time spent in the graph
+			unsigned long period_us; //!< audio time of the processed cycles
+		};
+
+		/**
+		 * Takes a snapshot of the load statistics. It can be called from
+		 * any thread.
+		 * @param stats The place of the snapshot.
+		 */
+		void getLoadStats(LoadStats& stats);
+
+		/**
+		 * @return Returns the stream the processing writes to. It's the
+		 * output of the graph or the clock bridge in front of it if the
+		 * input and the output are on different devices.
+		 */
+		llaOutputStream& getSink(void) {
+			return bridged_ ? bridge_ : graph_.getOutput();
+		}
+
+		/**
+		 * Sets the load a cycle is counted as an overload above.
+		 * @param limit The limit as the part of the period of the cycle.
+		 */
+		void setLoadLimit(float limit) { load_limit_ = limit; }
+
+		/**
+		 * Sets the shared control block the status is published to in
+		 * every cycle. It must not be changed while the processing runs.
+		 * @param shared The block or NULL.
+		 */
+		void setSharedControl(SharedControl* shared) { shared_ = shared; }
+
 		/**
 		 * Stops the processing.
 		 */
@@ -280,9 +682,6 @@ private:
 		// stopProcessing() method.
 		bool stop(void);
 
-		// waits for the proc. thread for a response.
-		void waitFor() { proc_thread_->waitOn(state_); };
-
 		// the processing graph
 		ProcessingGraph& graph_;
 
@@ -291,12 +690,9 @@ private:
 
 		// Synchronization facility for the state of the processing
 		class State: public ConditionVariable {
-			Thread *thread_;
 		public:
-			State(Thread* th): thread_(th) {}
 			TProcessingState val;
 			TProcessingState state_requested_;
-			bool isTrue(void) { return thread_->isRunning(); }
 		} state_;
 
 		// counter for the onSamplesReady method. If called
@@ -304,6 +700,33 @@ private:
 		// and ready to send a response to the caller of startProcessing.
 		unsigned int callback_counter_;
 
+		// Posted by the processing thread when it has run its first cycles
+		// or when it exits. startProcessing() waits for it.
+		Semaphore started_;
+
+		// the duration of the last start and stop in microseconds
+		volatile unsigned long start_us_;
+		volatile unsigned long stop_us_;
+
+		// the sample rate of the input stream while the processing runs
+		TSampleRate device_rate_;
+
+		// Plays the output on its own clock if it's on another device than
+		// the input. bridged_ is true while the processing writes to it.
+		ClockBridge bridge_;
+		volatile bool bridged_;
+
+		// Counters of the load statistics. They are written by the processing
+		// thread only.
+		volatile unsigned long cycles_;
+		volatile unsigned long overloads_;
+		volatile unsigned long busy_us_;
+		volatile unsigned long period_us_;
+		volatile float load_limit_;
+
+		// the shared control block of the local clients or NULL
+		SharedControl* shared_;
+
 	} dsp_process_;
 
 	/**
@@ -316,9 +739,92 @@ private:
 	 */
 	class EffectChain : public DspProcess::ProcessingGraph {
 
+		typedef SoundEffect::TSample TSample;
+
+		// A linear gain ramp between the dry and the processed (wet) signal.
+		// The gain moves towards its target by a fixed step in every sample so
+		// switching an effect on or off does not produce a click.
+		class Crossfade {
+			float gain_;
+			float target_;
+			float step_;
+		public:
+			Crossfade(): gain_(1.0f), target_(1.0f), step_(1.0f) {}
+
+			// The length of a complete fade given in samples.
+			void setLength(unsigned int samples) {
+				step_ = samples > 0 ? 1.0f / samples : 1.0f;
+			}
+
+			void setWet(bool wet) { target_ = wet ? 1.0f : 0.0f; }
+			bool isWetRequested(void) { return target_ == 1.0f; }
+
+			// True if the fade is over and the output is the processed signal
+			bool isWet(void) { return gain_ == 1.0f && target_ == 1.0f; }
+
+			// True if the fade is over and the output is the dry signal
+			bool isDry(void) { return gain_ == 0.0f && target_ == 0.0f; }
+
+			// Mixes the dry signal into the wet buffer in place. The ramp
+			// starts from the current gain for every channel, call advance()
+			// when all the channels of a cycle are mixed.
+			void mix(const TSample* dry, TSample* wet, unsigned int samples);
+
+			// Moves the gain forward with the given count of samples.
+			void advance(unsigned int samples);
+		};
+
+		// A place of an effect in the effect stack. Besides the effect it
+		// holds the state needed for the click-free bypass.
+		class EffectSlot {
+		public:
+			EffectSlot(SoundEffect* e): effect(e), oversampling(0),
+				asleep(false), tail_samples(0), silent_samples(0),
+				cycles(0), sample_us(0.0f), overruns(0), overrun_us(0.0f),
+				budget_us(0.0f), overran(false), reported(true) {}
+
+			SoundEffect *effect;
+
+			// The short name and the oversampling the effect was created with
+			// from the database. The name is empty if the effect wasn't
+			// created from the database.
+			std::string name;
+			unsigned int oversampling;
+
+			// crossfade between the input and the output of the effect
+			Crossfade xfade;
+
+			// The effect is bypassed and its tail has decayed. It is not
+			// processed at all until it's switched on again.
+			bool asleep;
+
+			// count of samples the effect is fed with silence after bypass
+			unsigned long tail_samples;
+
+			// count of samples the input of the effect has been silent for
+			unsigned long silent_samples;
+
+			// The cycles processed since the effect was switched on and the
+			// average processing time of a sample in the cycles within the
+			// budget. overruns has a bit for each of the last 32 cycles, set
+			// if the cycle overran the budget.
+			unsigned long cycles;
+			float sample_us;
+			uint32_t overruns;
+
+			// the time and the budget of the overrun which bypassed the effect
+			float overrun_us;
+			float budget_us;
+
+			// The effect was bypassed by the chain for overrunning its
+			// budget. It's reported once to the clients.
+			bool overran;
+			bool reported;
+		};
+
 		// typedef for the list data structure which is an stl vector for a
 		// constant complexity of reaching the effects.
-		typedef std::vector<SoundEffect*> TEffectStack;
+		typedef std::vector<EffectSlot*> TEffectStack;
 
 		// Iterator for the list.
 		typedef TEffectStack::iterator TEffectStackIt;
@@ -353,45 +859,217 @@ private:
 		// The sample rate used in the processing.
 		TSampleRate sample_rate_;
 
-		// A switch for bypass.
-		bool bypassed_;
+		// crossfade between the input and the output of the whole chain
+		Crossfade bypass_xfade_;
+
+		// The length of the bypass crossfades in samples
+		unsigned int xfade_length_;
+
+		// Buffers allocated by setBufferLength(). dry_ holds a copy of the
+		// chain's input for the global bypass, silence_ is an all zero buffer
+		// for feeding bypassed effects until their tail decays and the output
+		// of those effects is dropped to the scratch_ buffers.
+		unsigned int buffer_length_;
+		TSample *dry_;
+		TSample *silence_;
+		std::vector<TSample*> scratch_;
+
+		// True while the effects are activated
+		bool active_;
+
+		// Sample rates applied by the streams. If one of them differs from
+		// sample_rate_ the input is converted to the rate of the chain and
+		// the output back to the rate of the output stream.
+		TSampleRate input_rate_;
+		TSampleRate output_rate_;
+		bool resampling_;
+
+		// The frames of a device cycle. With resampling the chain processes
+		// a varying count of samples, buffer_length_ is the most of them.
+		unsigned int device_frames_;
+
+		// chain_in_ holds the converted input. The chain_io_ buffers replace
+		// the device buffers on the ports of input_ and output_ while the
+		// effects run: the even ones are for the inputs of input_ and the
+		// odd ones are for the outputs of output_. The fifos collect the
+		// converted output until a device cycle can be filled.
+		Resampler *in_resampler_;
+		Resampler *out_resampler_[2];
+		TSample *chain_in_;
+		std::vector<TSample*> chain_io_;
+		TSample *fifo_[2];
+		unsigned int fifo_fill_;
+		unsigned int fifo_size_;
+
+		// the device output buffers of the current cycle
+		TSample **device_out_;
+		unsigned int device_out_channels_;
+
+		// The layout of the effects changes when an effect is added or the
+		// effects are instantiated again. The parameters resolved for the
+		// controllers are valid only in the layout they were resolved in.
+		volatile unsigned long layout_;
+
+		// controller events on the way to the parameter worker and their
+		// average delay in microseconds, negative if unknown
+		ControlQueue controls_;
+		volatile float control_delay_us_;
+
+		// Posted when controller events are queued or the processing
+		// notices new parameters in the shared control block. A scan of
+		// the block is posted once until the worker takes it.
+		Semaphore params_;
+		volatile bool scan_posted_;
+
+		// The levels of the signals, the meter of an effect has the index
+		// of its ID. The processing thread meters only while metering_ is
+		// set.
+		MeterBank meters_;
+		volatile bool metering_;
+
+		// Meters all the output ports of an effect. Ports sharing a buffer
+		// are metered once.
+		void meterOutputs(unsigned int meter, SoundEffect* effect,
+				unsigned int sample_count);
+
+		// The point of the chain copied to the spectrum analyzer, the ID of
+		// an effect. Nothing is copied if tap_ring_ is NULL.
+		SampleRing* tap_ring_;
+		TEffectID tap_point_;
+
+		// Copies the samples of a point to the analyzer if it's tapped.
+		void tap(TEffectID point, const TSample* samples,
+				unsigned int sample_count) {
+			if(tap_ring_ != NULL && point == tap_point_)
+				tap_ring_->write(samples, sample_count);
+		}
+
+		// The shared control block of the local clients or NULL. Its
+		// meters are written in every cycle, its parameters are applied by
+		// the parameter worker.
+		SharedControl* shared_;
+
+		// Applies the parameters written to the shared control block since
+		// the last scan. Called with mutex_ locked.
+		void applySharedParams(void);
+
+		// The signals exported to other processes and their points, at most
+		// MAX_EXPORTS at once
+		static const unsigned int MAX_EXPORTS = 4;
+		struct Export {
+			AudioExport* signal;
+			TEffectID point;
+		};
+		Export exports_[MAX_EXPORTS];
+		unsigned int exports_count_;
+
+		// Writes the output ports of an effect, or the input ports of
+		// output_, to the exports of its point.
+		void exportPorts(TEffectID point, SoundEffect* effect,
+				unsigned int sample_count);
+
+		// Allocates the buffers of the chain and the resamplers for the
+		// current frames and rates. Called with mutex_ locked.
+		void allocBuffers(void);
+
+		// Allocates the scratch buffers to be able to hold the outputs of
+		// every effect in the stack. Called with mutex_ locked.
+		void allocScratch(void);
+		void freeBuffers(void);
+
+		// Mixes the device input to mono into the first output buffer.
+		void processInput(unsigned int sample_count);
+
+		// Runs the effects and leaves their output on the inputs of output_.
+		void processChain(unsigned int sample_count);
+
+		// Converts the output of the chain to the rate of the output stream
+		// and connects a cycle of frames from the fifos to output_.
+		void convertOutput(unsigned int sample_count, unsigned int frames);
+
+		// Drops the frames played from the fifos.
+		void consumeOutput(unsigned int frames);
+
+		// Connects the input ports of an effect to the outputs of the previous
+		// one. If the previous effect has fewer outputs, the last one is
+		// reused for the remaining inputs.
+		void connectInputs(SoundEffect *effect, SoundEffect *previous);
+
+		// Measures the processing time of an effect against its budget and
+		// bypasses the effect if it overruns the budget repeatedly.
+		void checkBudget(EffectSlot *slot, float time_us,
+				unsigned int sample_count);
+
+		// posted when an effect is bypassed for overrunning its budget
+		Semaphore overrun_;
+
+		// computes the tails of the convolution effects of the chain in a
+		// single thread
+		TailWorker tail_worker_;
+
+		// Processes a bypassed effect with silence on its input and drops the
+		// output. When the output decays the slot is put to sleep.
+		void flushTail(EffectSlot *slot, unsigned int sample_count);
+
+		// Follows the silence on the input of an effect. Returns true if the
+		// input has been silent for longer than the tail of the effect, so
+		// the output of this cycle is silence without processing.
+		bool isDecayed(EffectSlot *slot, unsigned int sample_count);
+
+		// Returns the slot by effect ID or NULL if not found.
+		EffectSlot* getSlotById(TEffectID id);
 
 		// Returns a SoundEffect object by the ID. ID 0 is the input effect
 		SoundEffect* getEffectById(TEffectID id);
 
+		// Resolves the parameter of a binding in the current layout. Called
+		// with mutex_ locked.
+		void findParam(ControlMap::Binding& binding);
+
+		// Sets the parameter of a controller event. Called with mutex_
+		// locked, never in the processing thread.
+		void applyControl(ControlEvent& event);
+
+		// Applies the controller events queued since the last call. Called
+		// with mutex_ locked.
+		void applyControls(void);
+
 		// Set the value of the effect parameter by the parameter's ID or name
 		template<class T>
-		void setEffectParam(TEffectID id, T param,
+		TAlchemyError setEffectParam(TEffectID id, T param,
 				SoundEffect::TParamValue value) {
 
+			TAlchemyError ret = E_INDEX;
+			mutex_->lock();
 			SoundEffect *effect = getEffectById(id);
-			if( effect == NULL ) return;
-
-			SoundEffect::Param *p = effect->getParam(param);
+			SoundEffect::Param *p = effect ? effect->getParam(param) : NULL;
 			if (p) {
 				effect->getMutex()->lock();
 				p->setValue(value);
 				effect->getMutex()->unlock();
+				ret = E_OK;
 			}
+			mutex_->unlock();
+			return ret;
 		}
 
 		// Same for getting the parameter's value.
 		template<class T>
-		SoundEffect::TParamValue getEffectParam(SoundEffect::TEffectID id,
-						T param) {
+		TAlchemyError getEffectParam(SoundEffect::TEffectID id, T param,
+				SoundEffect::TParamValue& value) {
 
-			SoundEffect::TParamValue val = 0.0;
+			TAlchemyError ret = E_INDEX;
+			mutex_->lock();
 			SoundEffect *effect = getEffectById(id);
-			if( effect == NULL ) return val;
-
-			SoundEffect::Param *p = effect->getParam(param);
+			SoundEffect::Param *p = effect ? effect->getParam(param) : NULL;
 			if(p) {
 				effect->getMutex()->lock();
-				val = p->getValue();
+				value = p->getValue();
 				effect->getMutex()->unlock();
+				ret = E_OK;
 			}
-
-			return val;
+			mutex_->unlock();
+			return ret;
 		}
 
 	public:
@@ -400,8 +1078,32 @@ private:
 
 		};
 
+		/// The default length of the bypass crossfades in samples
+		static const unsigned int DEFAULT_XFADE_LENGTH = 256;
+
+		/// Signals below this level are treated as silence. A bypassed effect
+		/// whose output stays above it is flushed at most for
+		/// TAIL_MAX_SECONDS before it's put to sleep.
+		static const TSample SILENCE_LEVEL;
+		static const unsigned int TAIL_MAX_SECONDS = 10;
+
+		/// The budget of an effect is BUDGET_FACTOR times its average
+		/// processing time of the samples of a cycle, at least
+		/// BUDGET_MIN_PERCENT of the cycle and at most the whole cycle. The
+		/// average is learned in WARMUP_CYCLES after the effect is switched
+		/// on, it's bypassed if it overruns the budget in OVERRUN_LIMIT of
+		/// the last 32 cycles.
+		static const unsigned int BUDGET_FACTOR = 2;
+		static const unsigned int BUDGET_MIN_PERCENT = 5;
+		static const unsigned int WARMUP_CYCLES = 256;
+		static const unsigned int OVERRUN_LIMIT = 4;
+
+		/// Samples of the output fifo kept on top of the delay of the
+		/// resamplers to absorb the varying count of samples per cycle
+		static const unsigned int FIFO_MARGIN = 4;
+
 		EffectChain();
-		~EffectChain() { delete mutex_; }
+		~EffectChain();
 
 		/// See the ProcessingGraph class for more description.
 		void setInput(llaInputStream& input) { input_.llainput = &input; }
@@ -410,36 +1112,128 @@ private:
 		void setInputBuffer(SoundEffect::TSample **buffer, unsigned int channels);
 		void setOutputBuffer(SoundEffect::TSample **buffer, unsigned int channels);
 
-		void setSampleRate();
+		// Instantiates the effects for the new rate off the processing
+		// thread and swaps them in with the values of their parameters.
+		void setSampleRate(TSampleRate sample_rate);
 		TSampleRate getSampleRate() { return sample_rate_; }
 
+		void setStreamSampleRates(TSampleRate input, TSampleRate output);
+
+		// Returns the delay of the effects and the resamplers in ms.
+		double getLatency(void);
+
 		unsigned int getInputChannelsCount() { return input_.getInputsCount(); }
 		unsigned int getOutputChannelsCount() { return output_.getOutputsCount(); }
 
 		llaInputStream& getInput(void) { return *(input_.llainput); }
 		llaOutputStream& getOutput(void) { return *(output_.llaoutput); }
 
+		void setBufferLength(unsigned int frames);
+
 		void traverse(unsigned int sample_count) ;
 
 		// position 0 means insert at the beginning
 		// position -1 is the end of the effect list
 		TAlchemyError addEffect(SoundEffect* effect, int position = -1 );
 
+		// Creates an effect from the database and adds it to the chain.
+		TAlchemyError addEffect(const std::string& name,
+				unsigned int oversampling = 0, int position = -1);
+
 		void removeEffect(TEffectID id);
 
-		void setEffectParam(TEffectID id, std::string param,
+		// The parameters return E_INDEX if there is no such effect or
+		// parameter.
+		TAlchemyError setEffectParam(TEffectID id, std::string param_name,
 				SoundEffect::TParamValue value);
 
-		void setEffectParam(TEffectID id, SoundEffect::TParamID param_name,
+		TAlchemyError setEffectParam(TEffectID id, SoundEffect::TParamID param,
 						SoundEffect::TParamValue value);
 
-		SoundEffect::TParamValue getEffectParam(TEffectID id,
-				SoundEffect::TParamID param);
+		TAlchemyError getEffectParam(TEffectID id, SoundEffect::TParamID param,
+				SoundEffect::TParamValue& value);
+
+		TAlchemyError getEffectParam(TEffectID id, std::string param_name,
+				SoundEffect::TParamValue& value);
+
+		// Bypasses the whole chain. The output is faded to the dry input.
+		void bypass(bool bypassed = true);
 
-		SoundEffect::TParamValue getEffectParam(TEffectID id,
-						std::string param_name);
+		// Bypasses a single effect given with its ID. Switching an effect
+		// on learns its processing time again, an effect bypassed for its
+		// overruns gets its new time as its average.
+		TAlchemyError bypassEffect(TEffectID id, bool bypassed = true);
 
-		void bypass(void);
+		// Waits until an effect is bypassed for overrunning its budget.
+		// Returns false if the timeout in ms expired.
+		bool waitOverrun(int timeout = -1) { return overrun_.wait(timeout); }
+
+		// Wakes the thread waiting in waitOverrun().
+		void wakeOverrunWaiter(void) { overrun_.post(); }
+
+		// Takes an effect bypassed for its overruns which hasn't been
+		// reported yet. Returns false if there is none.
+		bool takeOverrun(SoundEffect*& effect, float& time_us,
+				float& budget_us);
+
+		// Sets the length of the bypass crossfades in samples.
+		void setCrossfadeLength(unsigned int samples);
+
+		// Returns true if the parameter of a binding is resolved in the
+		// current layout of the chain.
+		bool isResolved(const ControlMap::Binding& binding) {
+			return binding.layout == layout_;
+		}
+
+		// Resolves the parameter of a binding in the current layout.
+		void resolveControl(ControlMap::Binding& binding);
+
+		// Passes a controller event to the parameter worker.
+		void pushControl(const ControlEvent& event);
+
+		// Waits until controller events or shared parameters are to be
+		// applied. Returns false if the timeout in ms expired.
+		bool waitParams(int timeout = -1) { return params_.wait(timeout); }
+
+		// Wakes the thread waiting in waitParams().
+		void wakeParamWaiter(void) { params_.post(); }
+
+		// Sets the parameters of the queued controller events and the ones
+		// written to the shared control block. Called by the parameter
+		// worker, the parameters are changed like the ones set by messages.
+		void applyParams(void);
+
+		// Returns the average delay of the controller events from their
+		// arrival to setting the parameter in ms, negative if unknown.
+		double getControlDelay(void);
+
+		// Switches the metering of the processing on or off.
+		void setMetering(bool metering) { metering_ = metering; }
+
+		// Reads the levels metered since the previous read. Returns false
+		// if nothing has been processed since then.
+		bool readMeters(MeterBank::Frame& frame) { return meters_.read(frame); }
+
+		// Copies the output of an effect to a ring of the spectrum analyzer,
+		// the input is point 0 and the output is the last one. NULL stops
+		// the copying.
+		void setAnalyzerTap(SampleRing* ring, TEffectID point);
+
+		// Returns the count of the effects in the chain.
+		unsigned int getEffectsCount(void) { return effectstack_.size(); }
+
+		// Sets the shared control block used by the processing, NULL to
+		// stop using it.
+		void setSharedControl(SharedControl* shared);
+
+		// Writes the signal of a point to an export in every cycle. Returns
+		// E_INDEX if there is no such point or MAX_EXPORTS are used.
+		TAlchemyError addExport(AudioExport* signal, TEffectID point);
+		void removeExport(AudioExport* signal);
+
+		// Finds the ID of an effect of the chain. Returns E_INDEX if it
+		// isn't in the chain.
+		TAlchemyError findEffect(SoundEffect* effect, TEffectID& id);
 
 		void activate(void);
 		void deactivate(void);
@@ -451,10 +1245,17 @@ private:
 
 	/**
 	 * @class MessageQueue
-	 * @brief A queue class which can be used by multiple threads. This type
-	 * of queue is known as a blocking queue which blocks if the popFront()
-	 * method is called for an empty queue until another process pushes an
-	 * element in the queue.
+	 * @brief A lock-free queue of messages with many producers and one
+	 * consumer. The connectors push their messages without locking and the
+	 * thread of the server takes all the pending ones at once, blocking on
+	 * a futex semaphore while the queue is empty.
+	 *
+	 * The messages are linked through themselves and they are allocated
+	 * from the fixed pool of Message, so the nodes of the queue are
+	 * recycled when popAll() deletes the coalesced messages and when the
+	 * server deletes the processed ones. The messages replacing each other,
+	 * e.g. the values of a moving fader, are coalesced when they are taken,
+	 * see InboundMessage::getCoalescingKey().
 	 */
 	class MessageQueue {
 
@@ -463,50 +1264,60 @@ private:
 		~MessageQueue();
 
 		/**
-		 * @brief Pops out the first message and removes it from the queue
+		 * @brief Takes all the messages of the queue.
 		 * @details If the queue is empty this operation will block the calling
-		 * thread until another thread pushes a message at the back of the
-		 * queue. The message obtained is a pointer to a Message class and after
-		 * interpreting its content it has to be deleted properly with delete.
-		 * @return Returns a pointer to soundalchemy::Message object.
+		 * thread until another thread pushes a message. The messages are
+		 * given in the order of their arrival, linked by getNext(). Of the
+		 * consecutive messages with the same coalescing key only the latest
+		 * one is given, the others are deleted. After
+		 * interpreting their content they have to be deleted properly with
+		 * delete. Only one thread may call this method.
+		 * @return Returns the first message or NULL if the queue is disabled.
 		 */
-		InboundMessage* popFront(void);
+		InboundMessage* popAll(void);
 
 		/**
-		 * @brief Pushes a message at the end of the queue.
+		 * @brief Pushes a message at the end of the queue. It can be called
+		 * from any thread.
 		 * @param message Pointer to a soundalchemy::Message object.
 		 */
 		void pushBack(InboundMessage* message);
 
 		/**
-		 * @brief The number of messages in the queue.
-		 * @return An unsigned integer representing the number of messages.
+		 * @return Returns true if the queue is empty.
 		 */
-		unsigned int getSize(void);
+		bool isEmpty(void) { return head_ == NULL; }
 
 		/**
-		 *
-		 * @return Returns true if the queue is false otherwise.
+		 * @return Returns the average delay between a push to the empty
+		 * queue and the wake up of the consumer in milliseconds, negative
+		 * if unknown.
 		 */
-		bool isEmpty(void);
-
+		double getWakeupDelay(void);
 
 	private:
 
-		Thread *monitor_;
-		Mutex *writemutex_;
+		// The pushed messages linked from the latest one. popAll() takes the
+		// whole list and reverses it.
+		InboundMessage* volatile head_;
 
-		unsigned int waiters_;
-		typedef std::queue<InboundMessage*> TMessageQueue;
+		// Deletes the messages replaced by a later one with the same key
+		// from a list of messages. Returns the new first message.
+		static InboundMessage* coalesce(InboundMessage* first);
 
-		class QCondition: public ConditionVariable {
-		public:
-			virtual bool isTrue(void) { return queue_base_.empty(); }
+		// posted when a message is pushed to the empty queue
+		Semaphore wakeup_;
 
-			TMessageQueue queue_base_;
-		}cond_var_;
+		// The time of the last post, 0 once a wake up took it or the batch
+		// was taken without waiting, and the average delay of the wake ups
+		// in microseconds, negative if unknown
+		volatile unsigned long posted_us_;
+		volatile float wakeup_us_;
 
-		bool enabled_;
+		// the time of the monotonic clock in microseconds
+		static unsigned long now(void);
+
+		volatile bool enabled_;
 	}; // end of MessageQueue
 
 	Thread *this_thread_;
@@ -524,6 +1335,226 @@ private:
 	// The effect database
 	static EffectDatabase* database_;
 
+	// the result of the last latency measurement, negative if none
+	double measured_latency_ms_;
+
+	// the bindings of the MIDI controllers
+	ControlMap control_map_;
+
+	/**
+	 * Watches the load of the processing while the automatic tuning is on
+	 * and asks the server to grow the buffer size through the message queue
+	 * if the load stays high.
+	 */
+	class LoadWatcher: public Runnable {
+	public:
+		LoadWatcher(DspServer& server): server_(server), exit_(false),
+				pending_(false) {}
+
+		void* run(void);
+
+		// prepares the watcher to be run by a thread again
+		void reset(void) { exit_ = false; pending_ = false; }
+
+		// stops the watcher, the thread running it exits in WATCH_PERIOD_MS
+		void exit(void) { exit_ = true; }
+
+		// clears the request sent by the watcher when it's been served
+		void served(void) { pending_ = false; }
+
+	private:
+		DspServer& server_;
+		volatile bool exit_;
+		volatile bool pending_;
+	} load_watcher_;
+
+	Thread *watcher_thread_;
+
+	/**
+	 * Asks the server to publish the meters at the rate of the
+	 * subscriptions through the message queue. A new request isn't sent
+	 * until the previous one is served.
+	 */
+	class MeterTimer: public Runnable {
+	public:
+		MeterTimer(DspServer& server): server_(server),
+				period_us_(1000000 / DEFAULT_METER_RATE), exit_(false),
+				pending_(false) {}
+
+		void* run(void);
+
+		// prepares the timer to be run by a thread again
+		void reset(void) { exit_ = false; pending_ = false; }
+
+		void setRate(unsigned int rate) { period_us_ = 1000000 / rate; }
+
+		// stops the timer, the thread running it exits in one period
+		void exit(void) { exit_ = true; }
+
+		// clears the request sent by the timer when it's been served
+		void served(void) { pending_ = false; }
+
+	private:
+		DspServer& server_;
+		volatile unsigned int period_us_;
+		volatile bool exit_;
+		volatile bool pending_;
+	} meter_timer_;
+
+	Thread *meter_thread_;
+
+	// the channels subscribed to the meters, bit n is channel n + 1
+	unsigned int meter_subscribers_;
+
+	/**
+	 * Runs the spectrum analysis and asks the server to publish the frames
+	 * through the message queue. A new request isn't sent until the previous
+	 * one is served, the frames made meanwhile are only kept as the latest.
+	 */
+	class AnalyzerWorker: public Runnable {
+	public:
+		/// The time the worker sleeps if no window is complete
+		static const unsigned int IDLE_MS = 5;
+
+		AnalyzerWorker(DspServer& server): server_(server), exit_(false),
+				pending_(false) {}
+
+		void* run(void);
+
+		// prepares the worker to be run by a thread again
+		void reset(void) { exit_ = false; pending_ = false; }
+
+		// stops the worker, the thread running it exits in IDLE_MS
+		void exit(void) { exit_ = true; }
+
+		// clears the request sent by the worker when it's been served
+		void served(void) { pending_ = false; }
+
+	private:
+		DspServer& server_;
+		volatile bool exit_;
+		volatile bool pending_;
+	} analyzer_worker_;
+
+	Thread *analyzer_thread_;
+	SpectrumAnalyzer analyzer_;
+
+	// the block of the local clients, used by the processing while it's open
+	SharedControl shared_control_;
+
+	// the signals exported to other processes
+	std::vector<AudioExport*> exports_;
+
+	// the channels subscribed to the spectrum and the analyzed point
+	unsigned int spectrum_subscribers_;
+	SoundEffect::TEffectID spectrum_point_;
+
+	/**
+	 * Passes the readings of the tuners to the clients through the message
+	 * queue.
+	 */
+	class TunerListener: public Tuner::Listener {
+	public:
+		TunerListener(DspServer& server): server_(server) {}
+
+		void tuned(SoundEffect* tuner, const Tuner::Reading& reading);
+
+	private:
+		DspServer& server_;
+	} tuner_listener_;
+
+	/**
+	 * Reports the effects bypassed by the chain for overrunning their
+	 * budgets to the clients through the message queue.
+	 */
+	class OverrunWatcher: public Runnable {
+	public:
+		OverrunWatcher(DspServer& server): server_(server), exit_(false) {}
+
+		void* run(void);
+
+		// stops the watcher, the effect chain has to wake it up
+		void exit(void) { exit_ = true; }
+
+	private:
+		DspServer& server_;
+		volatile bool exit_;
+	} overrun_watcher_;
+
+	Thread *overrun_thread_;
+
+	/**
+	 * Sets the parameters of the controllers and the shared control block
+	 * outside the processing thread, paramChanged() of an effect may take
+	 * long and the mutex of the effect may be held by the control side.
+	 */
+	class ParamWorker: public Runnable {
+	public:
+		ParamWorker(DspServer& server): server_(server), exit_(false) {}
+
+		void* run(void);
+
+		// stops the worker, the effect chain has to wake it up
+		void exit(void) { exit_ = true; }
+
+	private:
+		DspServer& server_;
+		volatile bool exit_;
+	} param_worker_;
+
+	Thread *param_thread_;
+
+	/**
+	 * Searches the buffer size of autoTuneBufferSize(). Every tried size is
+	 * set by the message loop on the request of the worker, the worker
+	 * waits for it and watches the load of the processing with it, so the
+	 * message loop isn't blocked by the tuning windows.
+	 */
+	class TuneWorker: public Runnable {
+	public:
+		TuneWorker(DspServer& server): server_(server), size_(0),
+				exit_(false) {}
+
+		void* run(void);
+
+		// prepares the worker to search from a buffer size
+		void reset(unsigned int size) {
+			size_ = size;
+			exit_ = false;
+			tried_.reset();
+		}
+
+		// stops the search at the next tried size, the worker has to be
+		// woken up by served()
+		void exit(void) { exit_ = true; }
+
+		// tells the worker that the size it asked for has been set
+		void served(void) { tried_.post(); }
+
+	private:
+		// Asks the server to run the processing with a buffer size and
+		// watches it for a tuning window. Returns true if the chain ran
+		// without xruns and overloads.
+		bool isStable(unsigned int frames);
+
+		DspServer& server_;
+		unsigned int size_;
+		volatile bool exit_;
+		Semaphore tried_;
+	} tune_worker_;
+
+	Thread *tune_thread_;
+
+	// state of the automatic buffer size tuning. tuning_ is true while the
+	// tune worker runs, the watcher doesn't judge that time. The processing
+	// is restarted after the tuning if tune_running_ is set, the result is
+	// sent with tune_channel_.
+	bool auto_tune_;
+	float tune_margin_;
+	volatile bool tuning_;
+	bool tune_running_;
+	Message::TChannelID tune_channel_;
+
 	// the unique name of the sound device used for processing
 	const char* device_name_;
 	bool exit_;
@@ -16,6 +16,8 @@
 #include "logs.h"
 
 #include "ladspaeffect.h"
+#include "nativeeffect.h"
+#include "oversampler.h"
 #include "database.h"
 
 
@@ -60,6 +62,14 @@ class JsonEffectDatabase: public EffectDatabase {
 			return effect_["plugin_file"].asString();
 		}
 
+		virtual unsigned int getOversampling() {
+			return effect_.get("oversampling", 1).asUInt();
+		}
+
+		virtual double getTailLength() {
+			return effect_.get("tail", -1.0).asDouble();
+		}
+
 		virtual std::string getPluginProgram() {
 			return effect_["plugin_program"].asString();
 		}
@@ -151,28 +161,53 @@ public:
 
 	bool isValid(void) { return !fail_; }
 
-	SoundEffect* getEffect(const std::string shortname, unsigned int sample_rate) {
+	SoundEffect* getEffect(const std::string shortname, unsigned int sample_rate,
+			unsigned int oversampling) {
 
 		Effect* e = NULL;
 		SoundEffect *effect = NULL;
 		for(unsigned int t = 0; e == NULL && t < EFFECT_TYPES; t++) {
 			Iterator bank = getEffects((TEffectType) t);
 			e = bank.get(shortname);
+			if(e == NULL) continue;
+
+			unsigned int factor = oversampling ? oversampling : e->getOversampling();
+			if(factor > 1 && !OversampledEffect::isValidFactor(factor)) {
+				log(LEVEL_WARNING, "Invalid oversampling factor %u for %s",
+						factor, shortname.c_str());
+				factor = 1;
+			}
 
-			if (e) switch(e->getPluginType()) {
+			// the effect itself runs at the oversampled rate
+			unsigned int rate = factor > 1 ? sample_rate * factor : sample_rate;
+
+			switch(e->getPluginType()) {
 			case PLUGIN_LADSPA: {
 				effect = LADSPAEffect::loadPlugin(
 						e->getPluginFileName().c_str(),
 						e->getPluginProgram().c_str(),
-						sample_rate);
+						rate);
+			} break;
+			case PLUGIN_NATIVE: {
+				NativeEffect *native = NativeEffect::create(
+						e->getPluginProgram(), rate);
+				if(native != NULL && !e->getPluginFileName().empty() &&
+						native->loadFile(e->getPluginFileName()) != E_OK) {
+					delete native;
+					native = NULL;
+				}
+				effect = native;
 			} break;
 			default:
 				break;
 			}
 
-		}
-
+			if(effect != NULL && factor > 1)
+				effect = new OversampledEffect(effect, factor, sample_rate);
 
+			if(effect != NULL && e->getTailLength() >= 0.0)
+				effect->setTailLength(e->getTailLength() * sample_rate);
+		}
 
 		return effect;
 	}
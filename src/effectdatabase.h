@@ -46,6 +46,10 @@ public:
 		virtual TPluginType getPluginType() = 0;
 		virtual std::string getPluginFileName() = 0;
 		virtual std::string getPluginProgram() = 0;
+		/// @return Returns the oversampling factor of the effect, 1 if none.
+		virtual unsigned int getOversampling() = 0;
+		/// @return Returns the tail length in seconds, negative if unknown.
+		virtual double getTailLength() = 0;
 		virtual std::string getDescription() = 0;
 	};
 
@@ -79,8 +83,17 @@ public:
 
 	virtual ~EffectDatabase() { }
 
+	/**
+	 * Instantiates an effect of the database.
+	 * @param shortname The short name of the effect.
+	 * @param sample_rate The sample rate of the processing.
+	 * @param oversampling The oversampling factor (2, 4 or 8) or 1 to run the
+	 * effect at the sample rate of the processing. If 0, the factor given in
+	 * the database is used.
+	 * @return Returns the new effect or NULL on error.
+	 */
 	virtual SoundEffect * getEffect(const std::string shortname,
-			unsigned int sample_rate) = 0;
+			unsigned int sample_rate, unsigned int oversampling = 0) = 0;
 
 
 	static EffectDatabase* buildDatabase(void);
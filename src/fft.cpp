@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "fft.h"
+#include <cmath>
+
+namespace soundalchemy {
+
+FFT::FFT(unsigned int size): size_(size), half_(size / 2),
+		bitrev_(half_), cos_(half_ / 2), sin_(half_ / 2),
+		rcos_(half_ + 1), rsin_(half_ + 1), wre_(half_), wim_(half_) {
+
+	unsigned int bits = 0;
+	while((1u << bits) < half_) bits++;
+
+	for(unsigned int i = 0; i < half_; i++) {
+		unsigned int r = 0;
+		for(unsigned int b = 0; b < bits; b++) {
+			if(i & (1u << b)) r |= 1u << (bits - 1 - b);
+		}
+		bitrev_[i] = r;
+	}
+
+	for(unsigned int i = 0; i < half_ / 2; i++) {
+		cos_[i] = cos(2.0 * M_PI * i / half_);
+		sin_[i] = sin(2.0 * M_PI * i / half_);
+	}
+
+	for(unsigned int i = 0; i <= half_; i++) {
+		rcos_[i] = cos(2.0 * M_PI * i / size_);
+		rsin_[i] = sin(2.0 * M_PI * i / size_);
+	}
+}
+
+// iterative radix-2 decimation in time
+void FFT::transform(float* re, float* im, bool inverse) {
+	for(unsigned int i = 0; i < half_; i++) {
+		unsigned int j = bitrev_[i];
+		if(j > i) {
+			float t = re[i]; re[i] = re[j]; re[j] = t;
+			t = im[i]; im[i] = im[j]; im[j] = t;
+		}
+	}
+
+	float sign = inverse ? 1.0f : -1.0f;
+	for(unsigned int len = 2; len <= half_; len <<= 1) {
+		unsigned int h = len / 2;
+		unsigned int step = half_ / len;
+		for(unsigned int i = 0; i < half_; i += len) {
+			for(unsigned int j = 0; j < h; j++) {
+				float wr = cos_[j * step];
+				float wi = sign * sin_[j * step];
+				unsigned int a = i + j;
+				unsigned int b = a + h;
+				float vr = re[b] * wr - im[b] * wi;
+				float vi = re[b] * wi + im[b] * wr;
+				re[b] = re[a] - vr;
+				im[b] = im[a] - vi;
+				re[a] += vr;
+				im[a] += vi;
+			}
+		}
+	}
+}
+
+void FFT::forward(const float* in, float* re, float* im) {
+	float *zr = &wre_[0];
+	float *zi = &wim_[0];
+
+	// the even samples go to the real, the odd ones to the imaginary part
+	for(unsigned int k = 0; k < half_; k++) {
+		zr[k] = in[2 * k];
+		zi[k] = in[2 * k + 1];
+	}
+
+	transform(zr, zi, false);
+
+	// split the spectra of the even and odd samples and merge them into the
+	// spectrum of the real signal
+	for(unsigned int k = 0; k <= half_; k++) {
+		unsigned int a = k % half_;
+		unsigned int b = (half_ - k) % half_;
+
+		float er = 0.5f * (zr[a] + zr[b]);
+		float ei = 0.5f * (zi[a] - zi[b]);
+		float or_ = 0.5f * (zi[a] + zi[b]);
+		float oi = -0.5f * (zr[a] - zr[b]);
+
+		float c = rcos_[k];
+		float s = rsin_[k];
+		re[k] = er + c * or_ + s * oi;
+		im[k] = ei + c * oi - s * or_;
+	}
+}
+
+void FFT::inverse(const float* re, const float* im, float* out) {
+	float *zr = &wre_[0];
+	float *zi = &wim_[0];
+	float scale = 1.0f / half_;
+
+	for(unsigned int k = 0; k < half_; k++) {
+		unsigned int b = half_ - k;
+
+		float er = 0.5f * (re[k] + re[b]);
+		float ei = 0.5f * (im[k] - im[b]);
+		float dr = 0.5f * (re[k] - re[b]);
+		float di = 0.5f * (im[k] + im[b]);
+
+		float c = rcos_[k];
+		float s = rsin_[k];
+		float or_ = dr * c - di * s;
+		float oi = dr * s + di * c;
+
+		zr[k] = (er - oi) * scale;
+		zi[k] = (ei + or_) * scale;
+	}
+
+	transform(zr, zi, true);
+
+	for(unsigned int k = 0; k < half_; k++) {
+		out[2 * k] = zr[k];
+		out[2 * k + 1] = zi[k];
+	}
+}
+
+} /* namespace soundalchemy */
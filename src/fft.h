@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef FFT_H_
+#define FFT_H_
+
+#include <vector>
+
+namespace soundalchemy {
+
+/**
+ * Fast Fourier transform of real signals with a power of two size.
+ *
+ * A real signal of N samples is transformed through a complex FFT of N/2
+ * points. The spectrum is stored in split format, the real and the imaginary
+ * parts in separate arrays of N/2+1 bins, which is the layout the complex
+ * multiplications of the convolution engine vectorize best on.
+ *
+ * Every table is computed in the constructor, so forward() and inverse() can
+ * be called from the processing thread.
+ */
+class FFT {
+public:
+
+	/**
+	 * @param size Count of the real samples, a power of two and at least 4.
+	 */
+	FFT(unsigned int size);
+
+	unsigned int getSize(void) { return size_; }
+
+	/// @return Returns the count of the spectrum bins, size/2+1.
+	unsigned int getBins(void) { return half_ + 1; }
+
+	/**
+	 * Transforms size samples to getBins() complex bins.
+	 * @param in Real input of size samples.
+	 * @param re Real parts of the spectrum.
+	 * @param im Imaginary parts of the spectrum.
+	 */
+	void forward(const float* in, float* re, float* im);
+
+	/**
+	 * Transforms getBins() complex bins back to size real samples. The result
+	 * is scaled, so inverse(forward(x)) gives x.
+	 * @param re Real parts of the spectrum.
+	 * @param im Imaginary parts of the spectrum.
+	 * @param out Real output of size samples.
+	 */
+	void inverse(const float* re, const float* im, float* out);
+
+private:
+
+	// in place complex FFT of half_ points
+	void transform(float* re, float* im, bool inverse);
+
+	unsigned int size_;
+	unsigned int half_;
+
+	std::vector<unsigned int> bitrev_;
+
+	// twiddles of the half_ point complex transform
+	std::vector<float> cos_;
+	std::vector<float> sin_;
+
+	// twiddles for splitting/merging the real spectrum
+	std::vector<float> rcos_;
+	std::vector<float> rsin_;
+
+	// work buffers of the complex transform
+	std::vector<float> wre_;
+	std::vector<float> wim_;
+};
+
+} /* namespace soundalchemy */
+#endif /* FFT_H_ */
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "jitterprobe.h"
+#include <algorithm>
+#include <time.h>
+
+namespace soundalchemy {
+
+JitterProbe::JitterProbe(): period_us_(0) {
+}
+
+TAlchemyError JitterProbe::measure(const Thread::Scheduling& scheduling,
+		unsigned int period_us, unsigned int cycles, Result& result) {
+	result.cycles = 0;
+	result.p50 = result.p90 = result.p99 = result.p999 = result.max = 0.0;
+	if(period_us == 0 || cycles == 0) return E_OK;
+
+	Thread::Scheduling s = scheduling;
+	if(s.policy == Thread::POLICY_DEADLINE && s.period_us == 0) {
+		s.period_us = period_us;
+		if(s.runtime_us == 0) s.runtime_us = period_us / 2;
+	}
+
+	delays_.assign(cycles, 0.0);
+	period_us_ = period_us;
+
+	Thread* thread = Thread::getNewThread();
+	thread->setScheduling(s);
+	TAlchemyError ret = thread->run(*this);
+	if(ret != E_THREAD) thread->join();
+	delete thread;
+	if(ret != E_OK) return ret;
+
+	std::sort(delays_.begin(), delays_.end());
+	unsigned int last = cycles - 1;
+	result.cycles = cycles;
+	result.p50 = delays_[last * 50 / 100];
+	result.p90 = delays_[last * 90 / 100];
+	result.p99 = delays_[last * 99 / 100];
+	result.p999 = delays_[(unsigned int) (last * 999ull / 1000)];
+	result.max = delays_[last];
+	return E_OK;
+}
+
+void* JitterProbe::run(void) {
+	timespec next, now;
+	clock_gettime(CLOCK_MONOTONIC, &next);
+
+	for(unsigned int i = 0; i < delays_.size(); i++) {
+		next.tv_nsec += period_us_ * 1000l;
+		while(next.tv_nsec >= 1000000000l) {
+			next.tv_sec++;
+			next.tv_nsec -= 1000000000l;
+		}
+
+		while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) != 0)
+			;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		delays_[i] = (now.tv_sec - next.tv_sec) * 1000000.0 +
+				(now.tv_nsec - next.tv_nsec) / 1000.0;
+	}
+	return NULL;
+}
+
+} /* namespace soundalchemy */
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef JITTERPROBE_H_
+#define JITTERPROBE_H_
+
+#include "logs.h"
+#include "thread.h"
+#include <vector>
+
+namespace soundalchemy {
+
+/**
+ * @brief Measures the wake up latency of a thread with a scheduling.
+ *
+ * A thread with the scheduling sleeps until the next period like the
+ * processing waits for the next cycle, and it records how late it wakes
+ * up. The percentiles of the delays show how much of a cycle the scheduling
+ * costs under the load of the system.
+ */
+class JitterProbe: private Runnable {
+public:
+
+	/// The delays of the wake ups in microseconds
+	struct Result {
+		unsigned int cycles;
+		double p50;
+		double p90;
+		double p99;
+		double p999;
+		double max;
+	};
+
+	JitterProbe();
+
+	/**
+	 * Runs a thread with the scheduling and measures its wake ups. The call
+	 * blocks for about period_us * cycles.
+	 * @param scheduling The scheduling of the thread. A deadline without a
+	 * period gets the period of the probe and half of it as runtime.
+	 * @param period_us The time between the wake ups.
+	 * @param cycles The count of the wake ups.
+	 * @param result The percentiles of the delays.
+	 * @return Returns E_OK, E_THREAD if the thread couldn't be started or
+	 * E_REALTIME if the scheduling isn't permitted.
+	 */
+	TAlchemyError measure(const Thread::Scheduling& scheduling,
+			unsigned int period_us, unsigned int cycles, Result& result);
+
+private:
+
+	void* run(void);
+
+	std::vector<double> delays_;
+	unsigned int period_us_;
+};
+
+} /* namespace soundalchemy */
+#endif /* JITTERPROBE_H_ */
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "latencyprobe.h"
+#include "fft.h"
+#include <cmath>
+
+using namespace llaudio;
+
+namespace soundalchemy {
+
+// feedback taps of a maximal length Galois LFSR of MLS_ORDER bits:
+// x^13 + x^4 + x^3 + x + 1
+static const unsigned int MLS_TAPS = 0x100D;
+
+// the correlation peak has to be this many times above the rms of the
+// correlation to be accepted
+static const float PEAK_TO_RMS = 10.0f;
+
+LatencyProbe::LatencyProbe(): warmup_(0), position_(0), level_(0.25f) {
+	unsigned int length = (1u << MLS_ORDER) - 1;
+	unsigned int lfsr = 1;
+
+	mls_.resize(length);
+	for(unsigned int i = 0; i < length; i++) {
+		mls_[i] = (lfsr & 1) ? 1.0f : -1.0f;
+		lfsr = (lfsr & 1) ? (lfsr >> 1) ^ MLS_TAPS : lfsr >> 1;
+	}
+}
+
+TAlchemyError LatencyProbe::measure(llaInputStream& input,
+		llaOutputStream& output, unsigned int frames, double& latency_ms) {
+
+	// the streams are opened to get their rates, connectStreams() keeps them
+	if(input.open() != llaudio::E_OK || output.open() != llaudio::E_OK) {
+		input.close();
+		output.close();
+		log(LEVEL_ERROR, STR_ERRORS[E_AUDIO]);
+		return E_AUDIO;
+	}
+
+	TSampleRate rate = input.getSampleRate();
+	if(rate == 0 || rate != output.getSampleRate()) {
+		input.close();
+		output.close();
+		log(LEVEL_ERROR, "%s: the sample rates of the streams differ",
+				STR_ERRORS[E_AUDIO]);
+		return E_AUDIO;
+	}
+
+	warmup_ = rate * WARMUP_MS / 1000;
+	recording_.assign(warmup_ + mls_.size() + rate * MAX_DELAY_MS / 1000, 0.0f);
+	position_ = 0;
+
+	setBufferLength(frames);
+	getInputBuffer().channelsRequested = CH_MONO;
+	getOutputBuffer().channelsRequested = CH_STEREO;
+
+	TErrors e = connectStreams(input, output);
+	if(e != llaudio::E_OK || position_ < recording_.size()) {
+		log(LEVEL_ERROR, STR_ERRORS[E_AUDIO]);
+		return E_AUDIO;
+	}
+
+	unsigned int delay;
+	if(!findDelay(delay)) {
+		log(LEVEL_ERROR, STR_ERRORS[E_LOOPBACK]);
+		return E_LOOPBACK;
+	}
+
+	latency_ms = 1000.0 * delay / rate;
+	log(LEVEL_INFO, "Round trip latency: %u frames, %.2f ms", delay, latency_ms);
+	return E_OK;
+}
+
+void LatencyProbe::onSamplesReady(void) {
+	float **in = getInputBuffer().getSamples();
+	float **out = getOutputBuffer().getSamples();
+	unsigned int channels = getOutputBuffer().getChannels();
+
+	// a failed read gives a negative count
+	unsigned int count = lastwrite_ > getBufferLength() ? 0 : lastwrite_;
+
+	for(unsigned int i = 0; i < count; i++) {
+		unsigned int t = position_ + i;
+
+		float s = 0.0f;
+		if(t >= warmup_ && t - warmup_ < mls_.size())
+			s = level_ * mls_[t - warmup_];
+		for(unsigned int c = 0; c < channels; c++) out[c][i] = s;
+
+		if(t < recording_.size()) recording_[t] = in[0][i];
+	}
+	position_ += count;
+
+	getOutputBuffer().writeSamples();
+}
+
+bool LatencyProbe::stop(void) {
+	return position_ >= recording_.size();
+}
+
+bool LatencyProbe::findDelay(unsigned int& delay) {
+	unsigned int length = mls_.size();
+	unsigned int size = 4;
+	while(size < recording_.size() + length) size <<= 1;
+
+	FFT fft(size);
+	unsigned int bins = fft.getBins();
+	std::vector<float> x(size, 0.0f), y(size, 0.0f);
+	std::vector<float> x_re(bins), x_im(bins), y_re(bins), y_im(bins);
+
+	for(unsigned int i = 0; i < recording_.size(); i++) x[i] = recording_[i];
+	for(unsigned int i = 0; i < length; i++) y[i] = mls_[i];
+	fft.forward(&x[0], &x_re[0], &x_im[0]);
+	fft.forward(&y[0], &y_re[0], &y_im[0]);
+
+	// the cross-correlation is the spectrum of the recording multiplied by
+	// the conjugate spectrum of the sequence
+	for(unsigned int k = 0; k < bins; k++) {
+		float re = x_re[k] * y_re[k] + x_im[k] * y_im[k];
+		float im = x_im[k] * y_re[k] - x_re[k] * y_im[k];
+		x_re[k] = re;
+		x_im[k] = im;
+	}
+	fft.inverse(&x_re[0], &x_im[0], &x[0]);
+
+	// the sequence starts after the warm-up, the loop may invert the signal
+	unsigned int end = recording_.size() - length;
+	unsigned int peak_pos = warmup_;
+	float peak = 0.0f;
+	double energy = 0.0;
+	for(unsigned int k = warmup_; k <= end; k++) {
+		float c = fabs(x[k]);
+		energy += c * c;
+		if(c > peak) {
+			peak = c;
+			peak_pos = k;
+		}
+	}
+
+	float rms = sqrt(energy / (end - warmup_ + 1));
+	if(peak == 0.0f || peak < PEAK_TO_RMS * rms) return false;
+
+	delay = peak_pos - warmup_;
+	return true;
+}
+
+} /* namespace soundalchemy */
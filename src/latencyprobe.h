@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef LATENCYPROBE_H_
+#define LATENCYPROBE_H_
+
+#include "logs.h"
+#include "llaudio/llaudio.h"
+#include <vector>
+
+namespace soundalchemy {
+
+/**
+ * @brief Measures the round trip latency of an output and an input stream.
+ *
+ * A maximum length sequence is played on the output and recorded on the
+ * input in the same read/write cycle the processing uses. The position of the
+ * sequence in the recording is found by cross-correlation, so the result is
+ * the delay a sample played by the processing needs to come back on the
+ * input: the buffers of both streams, the converters and the analog path.
+ *
+ * The output has to be connected to the input, by a cable or by a loopback
+ * device like the snd-aloop module of ALSA.
+ */
+class LatencyProbe: private llaudio::llaAudioPipe {
+public:
+
+	/// Order of the maximum length sequence, it is 2^MLS_ORDER-1 long
+	static const unsigned int MLS_ORDER = 13;
+
+	/// The longest round trip which can be measured
+	static const unsigned int MAX_DELAY_MS = 1000;
+
+	/// Silence played before the sequence to let the streams settle
+	static const unsigned int WARMUP_MS = 250;
+
+	LatencyProbe();
+
+	/**
+	 * Plays the sequence and records it. The call blocks until the recording
+	 * is complete, which is about WARMUP_MS + MAX_DELAY_MS.
+	 * @param input The stream the output is looped back to.
+	 * @param output The stream the sequence is played on.
+	 * @param frames The buffer length of the processing.
+	 * @param latency_ms The measured round trip in milliseconds.
+	 * @return Returns E_OK, E_AUDIO if the streams couldn't be used or
+	 * E_LOOPBACK if the sequence wasn't found in the recording.
+	 */
+	TAlchemyError measure(llaudio::llaInputStream& input,
+			llaudio::llaOutputStream& output, unsigned int frames,
+			double& latency_ms);
+
+private:
+
+	void onSamplesReady(void);
+	bool stop(void);
+
+	// Finds the delay of the sequence in the recording by FFT correlation.
+	// Returns false if there is no clear peak.
+	bool findDelay(unsigned int& delay);
+
+	// the sequence as +1/-1 values
+	std::vector<float> mls_;
+	std::vector<float> recording_;
+
+	unsigned int warmup_;
+	unsigned int position_;
+	float level_;
+};
+
+} /* namespace soundalchemy */
+#endif /* LATENCYPROBE_H_ */
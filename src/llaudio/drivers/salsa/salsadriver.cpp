@@ -12,6 +12,7 @@
 #include "salsadevice.h"
 #include <sstream>
 #include <cstdio>
+#include <cstdlib>
 
 using namespace std;
 
@@ -19,7 +20,8 @@ namespace llaudio {
 
 void _trim(string& str);
 
-SalsaDriver::SalsaDriver() {
+SalsaDriver::SalsaDriver(): capabilities_loaded_(false),
+		capabilities_changed_(false) {
 	detectDevices();
 
 }
@@ -39,6 +41,12 @@ TErrors SalsaDriver::detectDevices() {
 	istreamcache_.clear();
 	ostreamcache_.clear();
 
+	// the capabilities probed in a previous run
+	if(!capabilities_loaded_) {
+		loadCapabilities();
+		capabilities_loaded_ = true;
+	}
+
 #ifdef USE_EXCEPTIONS
 	TErrors e = E_OK;
 	try {
@@ -52,258 +60,237 @@ TErrors SalsaDriver::detectDevices() {
 	if( e == E_OK ) e = findDevices();
 #endif
 
+	if(capabilities_changed_) saveCapabilities();
+
 	return e;
 }
 
+bool SalsaDriver::readProcFile(const char* path, string& content) {
+	FILE * file = fopen(path, "r");
+	if(file == NULL) return false;
+
+	char buffer[4096];
+	size_t n;
+	while((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		content.append(buffer, n);
+	fclose(file);
+	return true;
+}
+
 TErrors SalsaDriver::findDevices(void)
 {
-	TErrors errstate = E_OK;
-
-	FILE * cards;
-	cards = fopen("/proc/asound/cards", "r");
-	if(cards == NULL )
+	string cards_content;
+	if(!readProcFile("/proc/asound/cards", cards_content))
 	{
 		LOGGER().error(E_DETECT_DEVICES, "Cannot access ALSA driver");
 		return E_DETECT_DEVICES;
 	}
 
-	string cards_content;
-
-	char buffer[20];
-	while( fgets(buffer, 20, cards)!=NULL) cards_content.append(buffer);
-	fclose(cards);
-
 	LOGGER().debug(cards_content.c_str());
 
-	enum e_parserstates
-	{
-		CARD_NUM,
-		CARD_SHORTNAME,
-		CARD_FULL_NAME,
-		DDOT,
-		JUNK,
-		CREATE_DEVICE
-	} state = CARD_NUM;
-
-	string card_num;
-	string card_shortname;
-	string card_fullname;
-	SalsaDevice* device = NULL;
-
-	for(string::iterator it=cards_content.begin(); it != cards_content.end(); it++ )
+	// A card is described in two lines, the first one is like
+	// " 0 [PCH            ]: HDA-Intel - HDA Intel PCH"
+	size_t begin = 0;
+	while(begin < cards_content.size())
 	{
-		switch(state)
+		size_t end = cards_content.find('\n', begin);
+		if(end == string::npos) end = cards_content.size();
+		string line = cards_content.substr(begin, end - begin);
+		begin = end + 1;
+
+		size_t first = line.find_first_not_of(' ');
+		size_t open = line.find('[');
+		size_t close = line.find("]:", open);
+		if(first == string::npos || line[first] < '0' || line[first] > '9' ||
+				open == string::npos || close == string::npos) continue;
+
+		int card = atoi(line.c_str() + first);
+		string card_shortname = line.substr(open + 1, close - open - 1);
+		string card_fullname = line.substr(close + 2);
+		_trim(card_shortname);
+		_trim(card_fullname);
+
+		SalsaDevice* device = new SalsaDevice(card_shortname, card, card_fullname);
+
+		pair<TOsIt, TOsIt> ret = ostreamcache_.equal_range(device->getId());
+		for(TOsIt it = ret.first; it != ret.second; it++)
 		{
-		case CARD_NUM:
-			if(*it == ' ') continue;
-			else if(*it >= '0' && *it <= '9' ) card_num.push_back(*it);
-			else if(*it == '[') state = CARD_SHORTNAME;
-			break;
-		case CARD_SHORTNAME:
-			if(*it == ':') state = DDOT;
-			else if(*it != ' ' && *it != ']') card_shortname.push_back(*it);
-			break;
-		case DDOT:
-			if(*it == ' ') continue;
-			else
-			{
-				card_fullname.push_back(*it);
-				state=CARD_FULL_NAME;
-			}
-			break;
-		case CARD_FULL_NAME:
-			if(*it != '\n') card_fullname.push_back(*it);
-			else state = CREATE_DEVICE;
-			break;
-		case JUNK:
-			if(*it != '\n') continue;
-			else state = CARD_NUM;
-			break;
-		case CREATE_DEVICE:
-			break;
+			SalsaStream * os = it->second;
+			os->setOwner(*device);
+			applyCapabilities(card_shortname, os, false);
+			device->getOutputList()->add(os->getId(), os);
 		}
 
-		if(state == CREATE_DEVICE)
+		pair<TIsIt, TIsIt> ret_in = istreamcache_.equal_range(device->getId());
+		for(TIsIt it = ret_in.first; it != ret_in.second; it++)
 		{
-			int card;
-			istringstream(card_num) >> card;
-			device = new SalsaDevice(card_shortname, card, card_fullname);
-
-			pair<TOsIt, TOsIt> ret;
-			TOsIt it;
-			ret = ostreamcache_.equal_range(device->getId());
-			SalsaStream * os;
-
-
-			for(it = ret.first; it != ret.second && it != ostreamcache_.end(); it++)
-			{
-				os = it->second;
-				os->setOwner(*device);
-				device->getOutputList()->add(os->getId(), os);
-			}
-
-			pair<TIsIt, TIsIt> ret_in;
-			TIsIt it_in;
-			ret_in = istreamcache_.equal_range(device->getId());
-			SalsaStream * is;
-
-			for(it_in = ret_in.first; it_in != ret_in.second && it != istreamcache_.end(); it_in++)
-			{
-				is = it_in->second;
-				is->setOwner(*device);
-				device->getInputList()->add(is->getId(), is);
-			}
-
-			//(*store)[card_shortname] = device;
-			devlist_->add(card_shortname.c_str(), device);
-
-			card_fullname.clear();
-			card_shortname.clear();
-			card_num.clear();
-			state = JUNK;
+			SalsaStream * is = it->second;
+			is->setOwner(*device);
+			applyCapabilities(card_shortname, is, true);
+			device->getInputList()->add(is->getId(), is);
 		}
+
+		devlist_->add(card_shortname.c_str(), device);
 	}
 
-	return errstate;
+	return E_OK;
 }
 
 TErrors SalsaDriver::cacheStreams(void)
 {
-	TErrors errstate = E_OK;
 	string pcms_content;
-	string card_num;
-	string dev_num;
-	string dev_id ;
-	string dev_name;
-	string isplayback;
-	string iscapture;
-	bool playback = false, capture = false;
-	TAlsaCardId card = -1, dev = -1;
-
-	if( pcms_content.empty() )
+	if(!readProcFile("/proc/asound/pcm", pcms_content))
 	{
-		FILE * pcms;
-		pcms = fopen("/proc/asound/pcm", "r");
-		if(pcms == NULL)
-		{
-			LOGGER().error(E_DETECT_STREAMS, "Kernel driver maybe not present!");
-			return E_DETECT_STREAMS;
-		}
-		char buffer[20];
-		while( fgets(buffer, 20, pcms)!=NULL) pcms_content.append(buffer);
-		fclose(pcms);
-		LOGGER().debug( pcms_content.c_str());
+		LOGGER().error(E_DETECT_STREAMS, "Kernel driver maybe not present!");
+		return E_DETECT_STREAMS;
 	}
+	LOGGER().debug( pcms_content.c_str());
 
-	enum e_parserstates
-	{
-		CARD_NUM,
-		DEV_NUM,
-		STREAM_ID,
-		STREAM_NAME,
-		PLAYBACK,
-		CAPTURE,
-	} state = CARD_NUM;
-	bool save_data = 0;
-
-	for( string::iterator it=pcms_content.begin();
-	     it != pcms_content.end() && errstate == E_OK;
-	     it++
-	   )
+	// A PCM is described in a line like
+	// "00-00: ALC892 Analog : ALC892 Analog : playback 1 : capture 1"
+	size_t begin = 0;
+	while(begin < pcms_content.size())
 	{
-		switch(state)
+		size_t end = pcms_content.find('\n', begin);
+		if(end == string::npos) end = pcms_content.size();
+		string line = pcms_content.substr(begin, end - begin);
+		begin = end + 1;
+		if(line.empty()) continue;
+
+		int card, dev, n = 0;
+		if(sscanf(line.c_str(), "%d-%d:%n", &card, &dev, &n) != 2 || n == 0)
 		{
-		case CARD_NUM:
-			if( *it >= '0' && *it <= '9') card_num.push_back(*it);
-			else if( *it == '-' ) state = DEV_NUM;
-			else errstate= E_DETECT_STREAMS;
-			break;
-		case DEV_NUM:
-			if( *it >= '0' && *it <= '9') dev_num.push_back(*it);
-			else if( *it == ':' ) state = STREAM_ID;
-			else errstate = E_DETECT_STREAMS;
-			break;
-		case STREAM_ID:
-			if( *it != ':' ) dev_id.push_back(*it);
-			else state = STREAM_NAME;
-			break;
-		case STREAM_NAME:
-			if( *it != ':' ) dev_name.push_back(*it);
-			else state = PLAYBACK;
-			break;
-		case PLAYBACK:
-			if(*it >= '0' && *it <= '9') continue;
-			else if( *it != ':' && *it != '\n') isplayback.push_back(*it);
-			else if (*it == '\n')
-			{
-				save_data = true;
-				break;
-			}
-			else if ( *it == ':' ) state = CAPTURE;
-			else errstate = E_DETECT_STREAMS;
-			break;
-		case CAPTURE:
-			if(*it >= '0' && *it <= '9') continue;
-			if( *it != '\n' ) iscapture.push_back(*it);
-			else save_data = true;
-			break;
+			LOGGER().error(E_DETECT_STREAMS, "Cannot parse /proc/asound/pcm");
+			return E_DETECT_STREAMS;
 		}
 
-		if( errstate != E_OK)
+		// the fields are the id, the name and the directions
+		string fields[4];
+		unsigned int count = 0;
+		size_t pos = n;
+		while(count < 4 && pos <= line.size())
 		{
-			LOGGER().error(errstate, "Cannot parse /proc/asound/cards");
-			break;
+			size_t colon = line.find(':', pos);
+			if(colon == string::npos) colon = line.size();
+			fields[count] = line.substr(pos, colon - pos);
+			_trim(fields[count]);
+			count++;
+			pos = colon + 1;
 		}
 
-		if(save_data)
+		bool playback = false, capture = false;
+		for(unsigned int i = 2; i < count; i++)
 		{
-			istringstream(card_num) >> card;
-			istringstream(dev_num) >> dev;
-			_trim(dev_id);
-			_trim(dev_name);
-			_trim(isplayback);
-			_trim(iscapture);
-
-			if( !isplayback.compare("playback") ) playback = true;
-			else playback = false;
-			if( !iscapture.compare("capture") ) capture = true;
-			else capture = false;
-			if(playback)
+			if(fields[i].compare(0, 8, "playback") == 0) playback = true;
+			else if(fields[i].compare(0, 7, "capture") == 0) capture = true;
+		}
+
+		if(playback)
 			ostreamcache_.insert(
 					OStreamCache::value_type( card,
-						new SalsaStream( dev_name.c_str(), dev_id.c_str(), card,
-								dev, SalsaStream::OUTPUT_STREAM)
+						new SalsaStream( fields[1].c_str(), fields[0].c_str(),
+								card, dev, SalsaStream::OUTPUT_STREAM)
 					)
 			);
 
-			if(capture)
-				istreamcache_.insert(
-						IStreamCache::value_type( card,
-						new SalsaStream( dev_name.c_str(), dev_id.c_str(),
+		if(capture)
+			istreamcache_.insert(
+					IStreamCache::value_type( card,
+						new SalsaStream( fields[1].c_str(), fields[0].c_str(),
 								card, dev, SalsaStream::INPUT_STREAM)
-						)
-				);
-			save_data = false;
-
-			dev_id.clear();
-			dev_name.clear();
-			card = -1;
-			dev = -1;
-			playback = false;
-			capture = false;
-			isplayback.clear();
-			iscapture.clear();
-			card_num.clear();
-			dev_num.clear();
-			state = CARD_NUM;
-		}
+					)
+			);
+	}
+
+	return E_OK;
+}
 
+void SalsaDriver::applyCapabilities(const string& card_id,
+		SalsaStream* stream, bool input)
+{
+	ostringstream key;
+	key << card_id << ',' << stream->getId() << ',' << (input ? 'c' : 'p');
+
+	TCapabilityCache::iterator it = capabilities_.find(key.str());
+	if(it != capabilities_.end())
+	{
+		stream->setCapabilities(it->second);
+		return;
+	}
+
+	// a PCM used by another process is probed later when it's asked for
+	llaStream::Capabilities caps;
+	if(stream->probe() == E_OK && stream->getCapabilities(caps) == E_OK)
+	{
+		capabilities_[key.str()] = caps;
+		capabilities_changed_ = true;
+	}
+}
+
+// The cache file has a line for every PCM: the key and the fields of its
+// capabilities.
+void SalsaDriver::loadCapabilities(void)
+{
+	const char* path = llaDeviceManager::getCapabilityCache();
+	if(*path == '\0') return;
+
+	FILE * file = fopen(path, "r");
+	if(file == NULL) return;
+
+	char line[256];
+	char key[128];
+	while(fgets(line, sizeof(line), file) != NULL)
+	{
+		llaStream::Capabilities caps;
+		unsigned long rate_min, rate_max;
+		if(line[0] == '#' || sscanf(line, "%127s %lu %lu %u %u %u %u %u %u %u",
+				key, &rate_min, &rate_max, &caps.channels_min,
+				&caps.channels_max, &caps.formats, &caps.period_min,
+				&caps.period_max, &caps.buffer_min, &caps.buffer_max) != 10)
+			continue;
+
+		caps.rate_min = rate_min;
+		caps.rate_max = rate_max;
+		capabilities_[key] = caps;
+	}
+	fclose(file);
+}
+
+void SalsaDriver::saveCapabilities(void)
+{
+	capabilities_changed_ = false;
 
+	const char* path = llaDeviceManager::getCapabilityCache();
+	if(*path == '\0') return;
 
+	// the file is replaced at once, a reader never sees a partial one
+	string temp(path);
+	temp.append(".tmp");
+	FILE * file = fopen(temp.c_str(), "w");
+	if(file == NULL)
+	{
+		LOGGER().warning(E_DRIVER, "Cannot write the capability cache");
+		return;
 	}
 
-	return errstate;
+	fprintf(file, "# card,device,direction rate channels formats period buffer\n");
+	for(TCapabilityCache::iterator it = capabilities_.begin();
+			it != capabilities_.end(); it++)
+	{
+		const llaStream::Capabilities& caps = it->second;
+		fprintf(file, "%s %lu %lu %u %u %u %u %u %u %u\n", it->first.c_str(),
+				(unsigned long) caps.rate_min, (unsigned long) caps.rate_max,
+				caps.channels_min, caps.channels_max, caps.formats,
+				caps.period_min, caps.period_max, caps.buffer_min,
+				caps.buffer_max);
+	}
 
+	bool written = fclose(file) == 0;
+	if(!written || rename(temp.c_str(), path) != 0)
+	{
+		LOGGER().warning(E_DRIVER, "Cannot write the capability cache");
+		remove(temp.c_str());
+	}
 }
 /* Salsa driver: END ******************************************************** */
 
@@ -313,15 +300,15 @@ TErrors SalsaDriver::cacheStreams(void)
  */
 void _trim(string& str)
 {
-	string::iterator it = str.begin();
-	while((*it == ' ' || *it == '\n' || *it == '\t' || *it == '\r' )
-		  && it != str.end() ) { str.erase(it); it++; }
-
-	it = str.end();
-	it--;
-	while((*it == ' ' || *it == '\n' || *it == '\t' || *it == '\r' )
-			&& it != str.begin() ) { str.erase(it); it--; }
-
+	static const char* SPACES = " \n\t\r";
+	size_t first = str.find_first_not_of(SPACES);
+	if(first == string::npos)
+	{
+		str.clear();
+		return;
+	}
+	size_t last = str.find_last_not_of(SPACES);
+	str = str.substr(first, last - first + 1);
 }
 
 }
@@ -15,6 +15,7 @@
 #include "salsastream.h"
 #include "salsadevice.h"
 #include <map>
+#include <string>
 
 namespace llaudio {
 typedef int TAlsaDeviceId;
@@ -35,9 +36,28 @@ private:
 	IStreamCache istreamcache_;
 	OStreamCache ostreamcache_;
 
+	// The capabilities of the streams by "card id,device,direction". They
+	// are probed once, kept over the detections and in the cache file of
+	// the device manager.
+	typedef std::map<std::string, llaStream::Capabilities> TCapabilityCache;
+	TCapabilityCache capabilities_;
+	bool capabilities_loaded_;
+	bool capabilities_changed_;
+
 	TErrors findDevices(void);
 	TErrors cacheStreams(void);
 
+	// Gives the capabilities of a stream of a card from the cache or probes
+	// the stream.
+	void applyCapabilities(const std::string& card_id, SalsaStream* stream,
+			bool input);
+
+	void loadCapabilities(void);
+	void saveCapabilities(void);
+
+	// Reads a whole file of /proc at once.
+	static bool readProcFile(const char* path, std::string& content);
+
 };
 
 }
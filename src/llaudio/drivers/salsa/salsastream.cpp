@@ -27,6 +27,7 @@ SalsaStream::SalsaStream(const char* name, const char * id, int card_number,
 		int devnum, TDirections direction) {
 
 	pcm_state_ = CLOSED;
+	xruns_ = 0;
 	name_.assign(name);
 	id_.assign(id);
 	device_number_ = devnum;
@@ -39,6 +40,7 @@ SalsaStream::SalsaStream(const char* name, const char * id, int card_number,
 	format_ = lla2alsaFormat(llaAudioPipe::FORMAT_DEFAULT);
 	buffer_size_ = 0;
 	period_size_ = 0;
+	probed_ = false;
 }
 
 SalsaStream::~SalsaStream() {
@@ -100,6 +102,75 @@ TErrors SalsaStream::_open(int mode) {
 		return E_OK;
 }
 
+TErrors SalsaStream::probe(void) {
+	snd_pcm_t *pcm = pcm_;
+	if(pcm_state_ == CLOSED) {
+		char cname[24];
+		sprintf(cname, "hw:%d,%d", card_number_, device_number_);
+		int err = snd_pcm_open(&pcm, cname, direction_, SND_PCM_NONBLOCK);
+		if(err) {
+			LOGGER().warning(E_OPEN_STREAM, snd_strerror(err));
+			return E_OPEN_STREAM;
+		}
+	}
+
+	snd_pcm_hw_params_t *params;
+	snd_pcm_hw_params_alloca(&params);
+	int err = snd_pcm_hw_params_any(pcm, params);
+
+	Capabilities caps;
+	if(err >= 0) {
+		unsigned int u;
+		snd_pcm_uframes_t frames;
+		int dir;
+		if(!snd_pcm_hw_params_get_rate_min(params, &u, &dir)) caps.rate_min = u;
+		if(!snd_pcm_hw_params_get_rate_max(params, &u, &dir)) caps.rate_max = u;
+		if(!snd_pcm_hw_params_get_channels_min(params, &u)) caps.channels_min = u;
+		if(!snd_pcm_hw_params_get_channels_max(params, &u)) caps.channels_max = u;
+		if(!snd_pcm_hw_params_get_period_size_min(params, &frames, &dir))
+			caps.period_min = frames;
+		if(!snd_pcm_hw_params_get_period_size_max(params, &frames, &dir))
+			caps.period_max = frames;
+		if(!snd_pcm_hw_params_get_buffer_size_min(params, &frames))
+			caps.buffer_min = frames;
+		if(!snd_pcm_hw_params_get_buffer_size_max(params, &frames))
+			caps.buffer_max = frames;
+
+		static const struct {
+			snd_pcm_format_t format;
+			unsigned int bit;
+		} formats[] = {
+			{ SND_PCM_FORMAT_S16, Capabilities::FORMAT_S16 },
+			{ SND_PCM_FORMAT_S24, Capabilities::FORMAT_S24 },
+			{ SND_PCM_FORMAT_S32, Capabilities::FORMAT_S32 },
+			{ SND_PCM_FORMAT_FLOAT, Capabilities::FORMAT_FLOAT },
+			{ SND_PCM_FORMAT_FLOAT64, Capabilities::FORMAT_FLOAT64 }
+		};
+		for(unsigned int i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+			if(!snd_pcm_hw_params_test_format(pcm, params, formats[i].format))
+				caps.formats |= formats[i].bit;
+		}
+	}
+
+	if(pcm_state_ == CLOSED) snd_pcm_close(pcm);
+	if(err < 0) {
+		LOGGER().error(E_STREAM_CONFIG, snd_strerror(err));
+		return E_STREAM_CONFIG;
+	}
+
+	setCapabilities(caps);
+	return E_OK;
+}
+
+TErrors SalsaStream::getCapabilities(Capabilities& caps) {
+	if(!probed_) {
+		TErrors e = probe();
+		if(e != E_OK) return e;
+	}
+	caps = caps_;
+	return E_OK;
+}
+
 TErrors SalsaStream::open(void) {
 	return _open(0);
 }
@@ -175,7 +246,15 @@ TErrors SalsaStream::setSampleRate(TSampleRate sample_rate) {
 
 		snd_pcm_hw_params(pcm_, hw_config_);
 	}
-	else rate_ = sample_rate;
+	else {
+		// the rate is applied on open, the known range tells the rate it
+		// will get without opening the device
+		rate_ = sample_rate;
+		if(probed_ && caps_.rate_max != 0) {
+			if(rate_ < caps_.rate_min) rate_ = caps_.rate_min;
+			if(rate_ > caps_.rate_max) rate_ = caps_.rate_max;
+		}
+	}
 
 
 	return E_OK;
@@ -206,7 +285,15 @@ TErrors SalsaStream::setChannelCount(TChannels channels) {
 
 		snd_pcm_hw_params(pcm_, hw_config_);
 	}
-	else channels_ = channels;
+	else {
+		channels_ = channels;
+		if(probed_ && caps_.channels_max != 0) {
+			if(channels_ < caps_.channels_min)
+				channels_ = (TChannels) caps_.channels_min;
+			if(channels_ > caps_.channels_max)
+				channels_ = (TChannels) caps_.channels_max;
+		}
+	}
 
 	return E_OK;
 }
@@ -217,6 +304,20 @@ TSampleRate SalsaStream::getSampleRate(void) {
 	return rate_;
 }
 
+double SalsaStream::getLatency(void) {
+	if(pcm_state_ == CLOSED || buffer_size_ == 0 || rate_ == 0)
+		return llaStream::getLatency();
+
+	refreshState();
+
+	snd_pcm_sframes_t frames = 0;
+	if(pcm_state_ != RUNNING || snd_pcm_delay(pcm_, &frames) != 0 || frames < 0) {
+		frames = (direction_ == OUTPUT_STREAM) ? buffer_size_ : period_size_;
+	}
+
+	return 1000.0 * frames / rate_;
+}
+
 TChannels SalsaStream::getChannelCount(void) {
 	if(pcm_state_ != CLOSED) refreshState();
 	// TODO implement safely
@@ -250,6 +351,7 @@ TErrors SalsaStream::read(llaAudioPipe& buffer) {
 	setBufferLastWrite(buffer, rc);
 	if (rc == -EPIPE) {
 	  /* EPIPE means underrun */
+	  xruns_++;
 	  snd_pcm_prepare(pcm_);
 	} else if (rc < 0) {
 		LOGGER().warning(E_READ_STREAM, snd_strerror(rc));
@@ -455,6 +557,7 @@ TErrors SalsaStream::updateSettings(llaAudioPipe& buffer) {
 		// TODO check and renew settings
 		break;
 	case XRUN:
+		xruns_++;
 		snd_pcm_prepare(pcm_);
 		break;
 	};
@@ -497,6 +600,7 @@ TErrors SalsaStream::write(llaAudioPipe& buffer) {
 
 	if (rc == -EPIPE) {
 	  /* EPIPE means underrun */
+	  xruns_++;
 	  snd_pcm_prepare(pcm_);
 	} else if (rc < 0) {
 		LOGGER().warning(E_WRITE_STREAM, snd_strerror(rc));
@@ -512,6 +616,10 @@ TErrors SalsaStream::connect( llaOutputStream* output, llaAudioPipe& buffer) {
 
 
 	TErrors ret = _open(SND_PCM_NONBLOCK);
+
+	// the stream may have been opened in blocking mode before
+	if( ret == E_OK ) snd_pcm_nonblock(pcm_, 1);
+
 	// Update pcm settings
 	if( ret != E_OK || (ret = updateSettings(buffer)) != E_OK ) return ret;
 
@@ -561,6 +669,7 @@ TErrors SalsaStream::connect( llaOutputStream* output, llaAudioPipe& buffer) {
 		if ((err = snd_pcm_wait (pcm_, -1)) < 0) {
 			if (err == -EPIPE) {
 			  /* EPIPE means xrun */
+			  xruns_++;
 			  snd_pcm_prepare(pcm_);
 			} else if (err < 0) {
 				LOGGER().error(E_READ_STREAM, snd_strerror(err));
@@ -602,6 +711,7 @@ TErrors SalsaStream::connect( llaOutputStream* output, llaAudioPipe& buffer) {
 		// detect errors
 		if (rc == -EPIPE) {
 		  /* EPIPE means underrun */
+		  xruns_++;
 		  snd_pcm_prepare(pcm_);
 		} else if (rc < 0) {
 			LOGGER().warning(E_READ_STREAM, snd_strerror(rc));
@@ -63,6 +63,37 @@ public:
 	TSampleRate getSampleRate(void);
 	TChannels getChannelCount(void);
 
+	/**
+	 * The delay of the samples in the ring buffer of the device. While the
+	 * stream runs it's given by the driver, before that it's the whole
+	 * playback buffer or a capture period.
+	 * @return Returns the latency in milliseconds.
+	 */
+	double getLatency(void);
+
+	unsigned long getXrunCount(void) { return xruns_; }
+
+	/**
+	 * The capabilities are probed on the first call unless the driver gave
+	 * them from its cache.
+	 */
+	TErrors getCapabilities(Capabilities& caps);
+
+	/// Sets the capabilities known from a previous probing.
+	void setCapabilities(const Capabilities& caps) {
+		caps_ = caps;
+		probed_ = true;
+	}
+
+	bool isProbed(void) { return probed_; }
+
+	/**
+	 * Opens the PCM without blocking and reads the ranges of its hardware
+	 * parameters. An open stream is probed through its own handle.
+	 * @return Returns E_OK or E_OPEN_STREAM if the PCM can't be opened,
+	 * e.g. it's used by another process.
+	 */
+	TErrors probe(void);
 
 	/* implementable methods from llaInputStream: */
 	TErrors read(llaAudioPipe& buffer);
@@ -102,6 +133,13 @@ private:
 
 	TState pcm_state_;
 	TDirections direction_;
+
+	// counter of the xruns, written by the processing thread only
+	volatile unsigned long xruns_;
+
+	// the ranges of the hardware parameters, valid if probed_ is set
+	Capabilities caps_;
+	bool probed_;
 };
 
 }
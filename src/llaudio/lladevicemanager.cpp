@@ -33,6 +33,7 @@ bool llaudio::isBigEndianArch(void) {
 llaDeviceManager* llaDeviceManager::m_pInstance_ = NULL;
 llaErrorHandler *llaDeviceManager::errorHandler_ = NULL;
 bool llaDeviceManager::errorhandler_builtin_ = false;
+std::string llaDeviceManager::cache_path_(DEFAULT_CAPABILITY_CACHE);
 
 
 llaDeviceManager& llaDeviceManager::getInstance(llaErrorHandler& errhandl,
@@ -103,6 +104,9 @@ llaDeviceManager::~llaDeviceManager() __LLATHROW
 	//delete DRIVER_;
 	if(errorhandler_builtin_) delete errorHandler_;
 	m_pInstance_ = NULL;
+
+	// the added devices may use the streams of the detected ones
+	delete userdevlist_;
 	if(driver_ != NULL) delete driver_;
 
 	delete fstreamlist_;
@@ -146,11 +150,40 @@ llaDevice& llaDeviceManager::getDevice(TDeviceId id) {
 		return LLA_NULL_DEVICE;
 	}
 	llaDevice* d = driver_->getDeviceList().find(id);
+	if(d == NULL ) d = userdevlist_->find(id);
 	if(d == NULL ) return LLA_NULL_DEVICE;
 
 	return *d;
 }
 
+TErrors llaDeviceManager::addDevice(llaDevice* device) {
+	TDeviceId id = device->getName();
+	if(userdevlist_->find(id) != NULL || (driver_ != NULL &&
+			driver_->getDeviceList().find(id) != NULL)) {
+		LOGGER().error(E_INDEX_RANGE, "A device exists with the given name!");
+		return E_INDEX_RANGE;
+	}
+
+	userdevlist_->add(id, device);
+	return E_OK;
+}
+
+TErrors llaDeviceManager::removeDevice(TDeviceId id) {
+	llaDevice* d = userdevlist_->find(id);
+	if(d == NULL) {
+		LOGGER().error(E_INDEX_RANGE, "No device is found with the given id!");
+		return E_INDEX_RANGE;
+	}
+
+	userdevlist_->remove(id);
+	delete d;
+	return E_OK;
+}
+
+llaDeviceIterator llaDeviceManager::getUserDeviceIterator(void) {
+	return userdevlist_->getIterator();
+}
+
 llaDevice& llaDeviceManager::getDefaultDevice(void) {
 	if(driver_ == NULL ) {
 		LOGGER().error(E_DRIVER, "No llaudio driver is available!");
@@ -182,6 +215,8 @@ llaOutputStream& llaDeviceManager::getOutputStream(TDeviceId device, TStreamId i
 }
 
 llaDeviceManager::llaDeviceManager() {
+	driver_ = NULL;
+	userdevlist_ = new DefaultDeviceContainer();
 	fstreamlist_ = new FileStreamContainer();
 }
 
@@ -14,6 +14,7 @@
 #include "predef.h"
 #include "llacontainer.h"
 #include "llaerrorhandler.h"
+#include <string>
 
 namespace llaudio {
 
@@ -39,6 +40,28 @@ public:
 
 	llaDeviceIterator getDeviceIterator(void);
 	llaDevice& getDevice(TDeviceId id);
+
+	/**
+	 * Adds a device implemented outside of the driver, e.g. one which is
+	 * built from the streams of other devices. The device is found by
+	 * getDevice() like the detected ones and it's kept over a refresh().
+	 * The manager takes the ownership of the device.
+	 * @param device The device, its name has to be unique.
+	 * @return Returns E_OK or E_INDEX_RANGE if the name is already used.
+	 */
+	TErrors addDevice(llaDevice* device);
+
+	/**
+	 * Removes and deletes a device added by addDevice().
+	 * @param id The name of the device.
+	 * @return Returns E_OK or E_INDEX_RANGE if there is no such device.
+	 */
+	TErrors removeDevice(TDeviceId id);
+
+	/**
+	 * @return Returns an iterator over the devices added by addDevice().
+	 */
+	llaDeviceIterator getUserDeviceIterator(void);
 	llaDevice& getDefaultDevice(void);
 
 	llaInputStream& getInputStream(TDeviceId device,
@@ -52,6 +75,15 @@ public:
 
 	TErrors refresh();
 
+	/**
+	 * Sets the file the drivers keep the probed capabilities of the streams
+	 * in between runs. It's read when the devices are detected first, so
+	 * it's set before the first getInstance(). An empty path keeps them in
+	 * memory only.
+	 */
+	static void setCapabilityCache(const char* path) { cache_path_ = path; }
+	static const char* getCapabilityCache(void) { return cache_path_.c_str(); }
+
 	static void destroy(void) __LLATHROW;
 
 	~llaDeviceManager() __LLATHROW;
@@ -74,8 +106,10 @@ private:
 	static llaDeviceManager* m_pInstance_;
 	static llaErrorHandler *errorHandler_;
 	static bool errorhandler_builtin_;
+	static std::string cache_path_;
 
 	llaDriver *driver_;
+	llaDeviceList * userdevlist_;
 	llaFileStreamList * fstreamlist_;
 };
 }
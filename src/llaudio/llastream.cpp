@@ -61,6 +61,7 @@ llaudio::llaFileStream::llaFileStream(const char* file) {
 }
 
 TErrors llaudio::llaFileStream::open(void) {
+	if(file_ != NULL) return E_OK;
 
 	file_ = fopen(filename_.c_str(), "rwb");
 	if(file_ == NULL) {
@@ -38,6 +38,36 @@ protected:
 
 public:
 
+	/**
+	 * The configurations supported by a stream. The ranges are inclusive,
+	 * 0 is unknown.
+	 */
+	struct Capabilities {
+
+		/// Bits of the sample formats
+		enum e_formats {
+			FORMAT_S16 = 1,
+			FORMAT_S24 = 2,
+			FORMAT_S32 = 4,
+			FORMAT_FLOAT = 8,
+			FORMAT_FLOAT64 = 16
+		};
+
+		TSampleRate rate_min;
+		TSampleRate rate_max;
+		unsigned int channels_min;
+		unsigned int channels_max;
+		unsigned int formats;      //!< e_formats bits
+		TSize period_min;          //!< frames of a period
+		TSize period_max;
+		TSize buffer_min;          //!< frames of the ring buffer
+		TSize buffer_max;
+
+		Capabilities(): rate_min(0), rate_max(0), channels_min(0),
+			channels_max(0), formats(0), period_min(0), period_max(0),
+			buffer_min(0), buffer_max(0) {}
+	};
+
 	llaStream():owner_(&LLA_NULL_DEVICE) {}
 
 	/**
@@ -109,6 +139,15 @@ public:
 		return 1.0 / 0.0;
 	}
 
+	/**
+	 * Returns the count of the over- and underruns of the stream since it was
+	 * created. It can be read from any thread while the stream runs.
+	 * @return The count of xruns or 0 if the stream can't detect them.
+	 */
+	virtual unsigned long getXrunCount(void) {
+		return 0;
+	}
+
 	/**
 	 * Get the range of supported sample rates.
 	 * @param min Place-holder for the minimal sample rate value.
@@ -116,8 +155,13 @@ public:
 	 * @return Returns E_OK or a TErros error code on failure.
 	 */
 	TErrors getSampleRateRange(TSampleRate& min, TSampleRate& max) {
-		//LOGGER().warning(E_UNIMPLEMENTED, "getSampleRateRange");
-		return E_UNIMPLEMENTED;
+		Capabilities caps;
+		TErrors e = getCapabilities(caps);
+		if(e == E_OK) {
+			min = caps.rate_min;
+			max = caps.rate_max;
+		}
+		return e;
 	}
 
 	/**
@@ -127,7 +171,24 @@ public:
 	 * @return Returns E_OK or a TErros error code on failure.
 	 */
 	TErrors getChannelCountRange(TChannels& min, TChannels& max) {
-		//LOGGER().warning(E_UNIMPLEMENTED, "getChannelCountRange");
+		Capabilities caps;
+		TErrors e = getCapabilities(caps);
+		if(e == E_OK) {
+			min = (TChannels) caps.channels_min;
+			max = (TChannels) caps.channels_max;
+		}
+		return e;
+	}
+
+	/**
+	 * Get the configurations supported by the stream. The drivers probe
+	 * them once and answer from a cache later, the stream doesn't have to
+	 * be opened.
+	 * @param caps The capabilities are returned here.
+	 * @return Returns E_OK, E_UNIMPLEMENTED if the stream can't tell them or
+	 * a TErrors code if the probing failed.
+	 */
+	virtual TErrors getCapabilities(Capabilities& caps) {
 		return E_UNIMPLEMENTED;
 	}
 
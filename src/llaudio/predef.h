@@ -131,6 +131,9 @@ const TDrivers DEFAULT_DRIVER = DRIVER_SALSA;
 const TSize DEFAULT_BUFFER_SIZE = 512;
 const TChannels CH_DEFAULT = CH_MONO;
 
+/// The file the probed capabilities of the streams are kept in
+const char* const DEFAULT_CAPABILITY_CACHE = "/data/local/tmp/llaudio-pcm.cache";
+
 extern llaNullDevice LLA_NULL_DEVICE;
 extern llaNullStream LLA_NULL_STREAM;
 
@@ -59,6 +59,10 @@ typedef enum e_errors
 	E_THREAD,
 	E_PORTS_INCOMPATIBLE,
 	E_DATABASE,
+	E_FILE,
+	E_LOOPBACK,
+	E_BUFFER_SIZE,
+	E_AGGREGATE,
 	NUMERR,
 } TAlchemyError;
 
@@ -75,6 +79,10 @@ const char *const STR_ERRORS[NUMERR] = {
 		"Cannot start thread!",
 		"Effects cannot be connected, port count doesn't match!",
 		"Cannot load database!",
+		"Cannot read the specified file!",
+		"No loopback signal detected on the input!",
+		"Cannot find a stable buffer size!",
+		"Cannot create or remove the aggregate device!",
 };
 
 
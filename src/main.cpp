@@ -10,11 +10,387 @@
  */
 #include "dspserver.h"
 #include "androidconnector.h"
+#include "midiconnector.h"
+#include "socketconnector.h"
+#include "jitterprobe.h"
+#include "parametriceq.h"
+#include "ladspaeffect.h"
+#include "binaryprotocol.h"
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <time.h>
 
 using namespace soundalchemy;
 using namespace std;
 
+#ifndef DEBUG_LLAUDIO
+/**
+ * Splits a "device[:stream]" argument. The stream is 0 if not given.
+ */
+static string parseStream(const char* arg, int& stream) {
+	string device(arg);
+	size_t colon = device.rfind(':');
+	stream = 0;
+	if(colon != string::npos) {
+		stream = atoi(device.c_str() + colon + 1);
+		device.erase(colon);
+	}
+	return device;
+}
+
+/**
+ * Measures the round trip latency from the output to the input device and
+ * prints it in milliseconds. Meant for scripted runs with a loopback device.
+ * @return Returns the exit code of the process.
+ */
+static int measureLatency(const char* input_arg, const char* output_arg) {
+	int in_stream, out_stream;
+	string input = parseStream(input_arg, in_stream);
+	string output = parseStream(output_arg, out_stream);
+
+	DspServer dspserver;
+	if(dspserver.setInputStream(input.c_str(), in_stream) != soundalchemy::E_OK ||
+			dspserver.setOutputStream(output.c_str(), out_stream) != soundalchemy::E_OK) {
+		return 2;
+	}
+
+	double latency_ms;
+	if(dspserver.measureLatency(latency_ms) != soundalchemy::E_OK) return 1;
+
+	cout << latency_ms << endl;
+	return 0;
+}
+
+/**
+ * Parses a "policy[:priority]" argument, the policy is other, fifo, rr or
+ * deadline. A deadline takes "deadline[:runtime_us:period_us]", without a
+ * period it's derived from the buffer size.
+ * @return Returns false if the policy is unknown.
+ */
+static bool parseScheduling(const char* arg, Thread::Scheduling& scheduling) {
+	string policy(arg);
+	string params;
+	size_t colon = policy.find(':');
+	if(colon != string::npos) {
+		params = policy.substr(colon + 1);
+		policy.erase(colon);
+	}
+
+	if(policy == "other") scheduling.policy = Thread::POLICY_OTHER;
+	else if(policy == "fifo") scheduling.policy = Thread::POLICY_FIFO;
+	else if(policy == "rr") scheduling.policy = Thread::POLICY_RR;
+	else if(policy == "deadline") scheduling.policy = Thread::POLICY_DEADLINE;
+	else return false;
+
+	if(params.empty()) return true;
+	if(scheduling.policy == Thread::POLICY_DEADLINE) {
+		char *end;
+		scheduling.runtime_us = strtoul(params.c_str(), &end, 10);
+		scheduling.period_us = *end == ':' ? strtoul(end + 1, NULL, 10) : 0;
+	}
+	else scheduling.priority = atoi(params.c_str());
+	return true;
+}
+
+/**
+ * Parses a CPU list like "0,2-3" into a mask.
+ */
+static unsigned long parseCpus(const char* arg) {
+	unsigned long mask = 0;
+	const char* p = arg;
+	while(*p != '\0') {
+		char *end;
+		unsigned long first = strtoul(p, &end, 10);
+		unsigned long last = first;
+		if(*end == '-') last = strtoul(end + 1, &end, 10);
+		for(unsigned long cpu = first; cpu <= last && cpu < 8 * sizeof(mask); cpu++)
+			mask |= 1ul << cpu;
+		if(end == p || *end != ',') break;
+		p = end + 1;
+	}
+	return mask;
+}
+
+/**
+ * Measures the wake up latency of a thread with each policy and prints the
+ * percentiles in microseconds. The priority and the CPUs are taken from
+ * the scheduling of the processing.
+ * @return Returns the exit code of the process.
+ */
+static int measureJitter(const char* period_arg) {
+	static const unsigned int CYCLES = 10000;
+	static const char* NAMES[] = { "other", "fifo", "rr", "deadline" };
+
+	unsigned int period_us = atoi(period_arg);
+	if(period_us == 0) return 2;
+
+	Thread::Scheduling dsp =
+			Thread::getDefaultScheduling(Thread::THREAD_DSP);
+	int ret = 0;
+	cout << "policy\tp50\tp90\tp99\tp99.9\tmax" << endl;
+	for(int policy = Thread::POLICY_OTHER; policy <= Thread::POLICY_DEADLINE;
+			policy++) {
+		Thread::Scheduling s;
+		s.policy = (Thread::TPolicy) policy;
+		s.priority = dsp.priority > 0 ? dsp.priority : 99;
+		s.cpus = dsp.cpus;
+		s.prefault = Thread::DEFAULT_PREFAULT;
+
+		JitterProbe probe;
+		JitterProbe::Result r;
+		if(probe.measure(s, period_us, CYCLES, r) != soundalchemy::E_OK) {
+			cout << NAMES[policy] << "\tnot permitted" << endl;
+			ret = 1;
+			continue;
+		}
+		cout << NAMES[policy] << "\t" << r.p50 << "\t" << r.p90 << "\t" <<
+				r.p99 << "\t" << r.p999 << "\t" << r.max << endl;
+	}
+	return ret;
+}
+
+/**
+ * Processes noise with an effect for BENCH_SECONDS of audio in cycles of
+ * the given frames.
+ * @return Returns the average processing time of a cycle in microseconds.
+ */
+static double benchmarkEffect(SoundEffect& effect, unsigned int frames,
+		unsigned int sample_rate) {
+	static const unsigned int BENCH_SECONDS = 10;
+	static const unsigned int WARMUP_CYCLES = 100;
+
+	std::vector<SoundEffect::TSample> input(frames);
+	for(unsigned int i = 0; i < frames; i++)
+		input[i] = (float) rand() / RAND_MAX - 0.5f;
+	std::vector<SoundEffect::TSample> output(frames * effect.getOutputsCount());
+
+	MixerEffect::MixerPort in(SoundEffect::INPUT_PORT, "", &input[0]);
+	for(unsigned int p = 0; p < effect.getInputsCount(); p++)
+		effect.getInputPort(p)->connect(in);
+	for(unsigned int p = 0; p < effect.getOutputsCount(); p++) {
+		MixerEffect::MixerPort out(SoundEffect::OUTPUT_PORT, "",
+				&output[p * frames]);
+		effect.getOutputPort(p)->connect(out);
+	}
+
+	effect.activate();
+	for(unsigned int i = 0; i < WARMUP_CYCLES; i++) effect.process(frames);
+
+	unsigned int cycles = BENCH_SECONDS * sample_rate / frames;
+	timespec begin, end;
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	for(unsigned int i = 0; i < cycles; i++) effect.process(frames);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	effect.deactivate();
+
+	double us = (end.tv_sec - begin.tv_sec) * 1e6 +
+			(end.tv_nsec - begin.tv_nsec) / 1e3;
+	return us / cycles;
+}
+
+/**
+ * Compares the native parametric equalizer with the 10 band equalizer of
+ * CAPS on the same noise and prints their time of a cycle in microseconds
+ * and the part of the cycle they take. The native one runs mono with its
+ * scalar cascade and with a channel in every SIMD lane.
+ * @return Returns the exit code of the process.
+ */
+static int benchmarkEq(const char* frames_arg, const char* caps_file) {
+	static const unsigned int SAMPLE_RATE = 48000;
+
+	// the label of the equalizer was Eq before CAPS 0.9
+	static const char* CAPS_LABELS[] = { "Eq10", "Eq" };
+
+	unsigned int frames = atoi(frames_arg);
+	if(frames == 0) return 2;
+	double period_us = 1e6 * frames / SAMPLE_RATE;
+
+	int ret = 0;
+	cout << "effect\tchannels\tbands\tus\tload%" << endl;
+
+	// the native one runs with the bands of CAPS too
+	static const unsigned int CHANNELS[] = { 1, simd::LANES };
+	static const unsigned int BANDS[] = { ParametricEq::DEFAULT_BANDS, 10 };
+	for(unsigned int i = 0; i < 2; i++) {
+		for(unsigned int j = 0; j < 2; j++) {
+			ParametricEq eq(SAMPLE_RATE, BANDS[j], CHANNELS[i]);
+			double us = benchmarkEffect(eq, frames, SAMPLE_RATE);
+			cout << "native\t" << CHANNELS[i] << "\t" << BANDS[j] << "\t" <<
+					us << "\t" << 100.0 * us / period_us << endl;
+		}
+	}
+
+	LADSPAEffect *caps = NULL;
+	for(unsigned int i = 0; caps == NULL && i < 2; i++)
+		caps = LADSPAEffect::loadPlugin(caps_file, CAPS_LABELS[i], SAMPLE_RATE);
+	if(caps != NULL) {
+		double us = benchmarkEffect(*caps, frames, SAMPLE_RATE);
+		cout << "caps\t1\t10\t" << us << "\t" << 100.0 * us / period_us <<
+				endl;
+		delete caps;
+	}
+	else {
+		cout << "caps\tnot found" << endl;
+		ret = 1;
+	}
+	return ret;
+}
+
+/**
+ * Processes noise with 8 and then with 16 convolution effects of the same
+ * impulse response in real time cycles of the given frames. The effects
+ * share a tail worker like in the server. Prints the average and the longest
+ * time of a cycle in microseconds, the part of the cycle the average takes
+ * and the count of the tail blocks the worker was late with.
+ * @return Returns the exit code of the process.
+ */
+static int benchmarkIr(const char* frames_arg, const char* file) {
+	static const unsigned int SAMPLE_RATE = 48000;
+	static const unsigned int BENCH_SECONDS = 10;
+	static const unsigned int COUNTS[] = { 8, 16 };
+
+	unsigned int frames = atoi(frames_arg);
+	if(frames == 0) return 2;
+	long period_ns = 1000000000l / SAMPLE_RATE * frames;
+
+	std::vector<SoundEffect::TSample> input(frames);
+	for(unsigned int i = 0; i < frames; i++)
+		input[i] = (float) rand() / RAND_MAX - 0.5f;
+	std::vector<SoundEffect::TSample> output(frames);
+
+	TailWorker worker;
+	ConvolutionEffect::setTailWorker(&worker);
+
+	int ret = 0;
+	cout << "irs\tus\tmax_us\tload%\tmisses" << endl;
+	for(unsigned int c = 0; ret == 0 && c < 2; c++) {
+		std::vector<ConvolutionEffect*> effects;
+		for(unsigned int n = 0; n < COUNTS[c]; n++) {
+			ConvolutionEffect *effect = new ConvolutionEffect(SAMPLE_RATE);
+			effects.push_back(effect);
+			if(effect->loadFile(file) != soundalchemy::E_OK) {
+				ret = 1;
+				break;
+			}
+
+			MixerEffect::MixerPort in(SoundEffect::INPUT_PORT, "", &input[0]);
+			MixerEffect::MixerPort out(SoundEffect::OUTPUT_PORT, "",
+					&output[0]);
+			effect->getInputPort(0)->connect(in);
+			effect->getOutputPort(0)->connect(out);
+			effect->activate();
+		}
+
+		// the cycles start at the pace of a device, the worker has the rest
+		// of the period
+		unsigned int cycles = 0;
+		if(ret == 0) cycles = BENCH_SECONDS * SAMPLE_RATE / frames;
+		double total = 0.0, longest = 0.0;
+		timespec next, begin, end;
+		clock_gettime(CLOCK_MONOTONIC, &next);
+		for(unsigned int i = 0; i < cycles; i++) {
+			clock_gettime(CLOCK_MONOTONIC, &begin);
+			for(unsigned int n = 0; n < effects.size(); n++)
+				effects[n]->process(frames);
+			clock_gettime(CLOCK_MONOTONIC, &end);
+
+			double us = (end.tv_sec - begin.tv_sec) * 1e6 +
+					(end.tv_nsec - begin.tv_nsec) / 1e3;
+			total += us;
+			if(us > longest) longest = us;
+
+			next.tv_nsec += period_ns;
+			while(next.tv_nsec >= 1000000000l) {
+				next.tv_sec++;
+				next.tv_nsec -= 1000000000l;
+			}
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+		}
+
+		unsigned int misses = 0;
+		for(unsigned int n = 0; n < effects.size(); n++) {
+			misses += effects[n]->getTailMisses();
+			effects[n]->deactivate();
+			delete effects[n];
+		}
+
+		if(cycles > 0) {
+			double us = total / cycles;
+			cout << COUNTS[c] << "\t" << us << "\t" << longest << "\t" <<
+					100.0 * us / (period_ns / 1e3) << "\t" << misses << endl;
+		}
+	}
+
+	ConvolutionEffect::setTailWorker(NULL);
+	return ret;
+}
+
+/**
+ * Takes a request setting a parameter through the path of a socket client in
+ * JSON and then in binary: it's parsed, the acknowledgement of it is made and
+ * serialized. Prints the messages handled in a second.
+ * @return Returns the exit code of the process.
+ */
+static int benchmarkMessages(const char* count_arg) {
+	unsigned int count = atoi(count_arg);
+	if(count == 0) return 2;
+
+	std::ostringstream json;
+	json << "{\"type\":" << Message::MSG_SET_EFFECT_PARAM << ",\"effect_id\":1,"
+			"\"param_id\":2,\"value\":0.5}" << SocketConnector::DELIMITER;
+	std::string request = json.str();
+
+	// the same request as a frame, the effect, the parameter and the value
+	char frame[BinaryProtocol::HEADER_SIZE + 12] = {
+			BinaryProtocol::MAGIC_0, BinaryProtocol::MAGIC_1,
+			BinaryProtocol::VERSION, 0, Message::MSG_SET_EFFECT_PARAM, 0, 0, 0,
+			12, 0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0 };
+	float value = 0.5f;
+	memcpy(frame + BinaryProtocol::HEADER_SIZE + 8, &value, 4);
+
+	cout << "protocol	messages/s" << endl;
+	for(int binary = 0; binary < 2; binary++) {
+		timespec begin, end;
+		clock_gettime(CLOCK_MONOTONIC, &begin);
+		for(unsigned int i = 0; i < count; i++) {
+			InboundMessage* message;
+			if(binary) {
+				unsigned int type, length;
+				BinaryProtocol::parseHeader(frame, type, length);
+				message = InboundMessage::unserialize(type,
+						frame + BinaryProtocol::HEADER_SIZE, length);
+			}
+			else {
+				std::istringstream stream(request);
+				message = InboundMessage::unserialize(Message::PROTOCOL_JSON,
+						stream, SocketConnector::DELIMITER);
+			}
+			if(message == NULL) return 1;
+
+			OutboundMessage* reply = OutboundMessage::AckSetEffectParam(NULL,
+					1, 2, value);
+			reply->setChannelId(1);
+			SharedBuffer* buffer = reply->getSerialized(binary ?
+					Message::PROTOCOL_BINARY : Message::PROTOCOL_JSON,
+					SocketConnector::DELIMITER);
+			buffer->release();
+			delete reply;
+			delete message;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+
+		double s = (end.tv_sec - begin.tv_sec) +
+				(end.tv_nsec - begin.tv_nsec) / 1e9;
+		cout << (binary ? "binary" : "json") << "\t" << count / s << endl;
+	}
+	return 0;
+}
+#endif
+
 int main(int argc, const char * argv[] )
 {
 #ifdef DEBUG_LLAUDIO
@@ -55,6 +431,75 @@ int main(int argc, const char * argv[] )
 
 	initLogs();
 	//enableDebug();
+
+	// The options applied before the server is created:
+	//   --sched policy[:priority]  of the processing thread, e.g. fifo:80
+	//   --cpus list                CPUs of the processing thread, e.g. 2-3
+	//   --worker-sched, --worker-cpus  the same for the device bridges
+	//   --mlock on                 locks the memory of the process
+	//   --ir-dir path              the directory of the impulse responses
+	for(int i = 1; i + 1 < argc; i += 2) {
+		// --worker-sched is --sched of the workers
+		string option(argv[i]);
+		bool worker = option.compare(0, 9, "--worker-") == 0;
+		if(worker) option = "--" + option.substr(9);
+		Thread::TThreadClass thread_class = worker ?
+				Thread::THREAD_WORKER : Thread::THREAD_DSP;
+		Thread::Scheduling s = Thread::getDefaultScheduling(thread_class);
+
+		if(option == "--sched") {
+			if(!parseScheduling(argv[i + 1], s))
+				log(LEVEL_WARNING, "unknown scheduling: %s", argv[i + 1]);
+			else Thread::setDefaultScheduling(thread_class, s);
+		}
+		else if(option == "--cpus") {
+			s.cpus = parseCpus(argv[i + 1]);
+			Thread::setDefaultScheduling(thread_class, s);
+		}
+		else if(worker) {
+			log(LEVEL_ERROR, "unknown option: %s", argv[i]);
+			freeLogs();
+			return 2;
+		}
+		else if(strcmp(argv[i], "--mlock") == 0 &&
+				strcmp(argv[i + 1], "on") == 0) {
+			Thread::lockMemory();
+		}
+		else if(strcmp(argv[i], "--ir-dir") == 0) {
+			ConvolutionEffect::setDirectory(argv[i + 1]);
+		}
+	}
+
+	if(argc >= 3 && strcmp(argv[1], "--bench-eq") == 0) {
+		int ret = benchmarkEq(argv[2], argc >= 4 ? argv[3] : "caps.so");
+		freeLogs();
+		return ret;
+	}
+
+	if(argc >= 3 && strcmp(argv[1], "--bench-ir") == 0) {
+		int ret = benchmarkIr(argv[2], argc >= 4 ? argv[3] : "cabinet.wav");
+		freeLogs();
+		return ret;
+	}
+
+	if(argc >= 3 && strcmp(argv[1], "--bench-messages") == 0) {
+		int ret = benchmarkMessages(argv[2]);
+		freeLogs();
+		return ret;
+	}
+
+	if(argc >= 3 && strcmp(argv[1], "--measure-jitter") == 0) {
+		int ret = measureJitter(argv[2]);
+		freeLogs();
+		return ret;
+	}
+
+	if(argc == 4 && strcmp(argv[1], "--measure-latency") == 0) {
+		int ret = measureLatency(argv[2], argv[3]);
+		freeLogs();
+		return ret;
+	}
+
 	log(LEVEL_INFO, "Sound Alchemy started in service mode");
 	log(LEVEL_INFO, "buffer size: %d", llaudio::DEFAULT_BUFFER_SIZE);
 	DspServer dspserver;
@@ -62,7 +507,33 @@ int main(int argc, const char * argv[] )
 	AndroidConnector android;
 	dspserver.listenOn(android);
 
+	// Further front ends given as options:
+	//   --midi hw:card,device  the controllers of a MIDI device
+	//   --socket path          a Unix domain socket, '@' for abstract names
+	//   --tcp port             a TCP port on the loopback interface
+	//   --shm path             a shared control block for local clients
+	MidiConnector* midi = NULL;
+	SocketConnector sockets;
+	bool sockets_used = false;
+	for(int i = 1; i + 1 < argc; i += 2) {
+		if(strcmp(argv[i], "--midi") == 0 && midi == NULL) {
+			midi = MidiConnector::openRawMidi(argv[i + 1]);
+			if(midi != NULL) dspserver.listenOn(*midi);
+		}
+		else if(strcmp(argv[i], "--socket") == 0) {
+			if(sockets.listenUnix(argv[i + 1]) == soundalchemy::E_OK) sockets_used = true;
+		}
+		else if(strcmp(argv[i], "--tcp") == 0) {
+			if(sockets.listenTcp(atoi(argv[i + 1])) == soundalchemy::E_OK) sockets_used = true;
+		}
+		else if(strcmp(argv[i], "--shm") == 0) {
+			dspserver.openSharedControl(argv[i + 1]);
+		}
+	}
+	if(sockets_used) dspserver.listenOn(sockets);
+
 	dspserver.startListening();
+	delete midi;
 
 	freeLogs();
 #endif
@@ -11,7 +11,11 @@
 #include "message.h"
 #include "logs.h"
 #include "dspserver.h"
+#include "binaryprotocol.h"
 #include <cstdlib>
+#include <cstdarg>
+#include <cstring>
+#include <sstream>
 #include <json/json.h>
 
 using namespace std;
@@ -101,11 +105,19 @@ public:
 		current_device_["output_streams"] = Json::Value(Json::arrayValue);
 	}
 
-	virtual void stream(int id, const char* name, bool input)  {
-		AudioInf::stream(id, name, input);
+	virtual void stream(int id, const char* name, bool input,
+			const llaudio::llaStream::Capabilities* caps)  {
+		AudioInf::stream(id, name, input, caps);
 		Json::Value stream;
 		stream["id"] = id;
 		stream["name"] = name;
+		if(caps != NULL) {
+			addRange(stream["rates"], caps->rate_min, caps->rate_max);
+			addRange(stream["channels"], caps->channels_min, caps->channels_max);
+			addRange(stream["period"], caps->period_min, caps->period_max);
+			addRange(stream["buffer"], caps->buffer_min, caps->buffer_max);
+			stream["formats"] = caps->formats;
+		}
 		if(input)
 			current_device_["input_streams"].append(stream);
 		else current_device_["output_streams"].append(stream);
@@ -116,6 +128,16 @@ public:
 		dataroot_[getCurrent().name_] = current_device_;
 	}
 
+private:
+
+	// a range is a [min, max] array
+	static void addRange(Json::Value& range, unsigned long min,
+			unsigned long max) {
+		range = Json::Value(Json::arrayValue);
+		range.append((Json::UInt) min);
+		range.append((Json::UInt) max);
+	}
+
 };
 
 /**
@@ -147,6 +169,92 @@ public:
 	}
 };
 
+// MSG_METERS //////////////////////////////////////////////////////////////////
+//
+/**
+ * @brief The levels of the meters sent to the subscribed clients. The meter
+ * of an effect has the index of its ID, the input is the first and the
+ * output is the last one.
+ */
+class MsgMeterFrame: public OutboundMessage {
+public:
+	MsgMeterFrame(unsigned int count, const float* peak, const float* rms):
+		OutboundMessage(MSG_UNINITIALIZED) {
+		dataroot_["type"] = MSG_METERS;
+		Json::Value& peaks = dataroot_["peak"] = Json::Value(Json::arrayValue);
+		Json::Value& levels = dataroot_["rms"] = Json::Value(Json::arrayValue);
+		for(unsigned int m = 0; m < count; m++) {
+			peaks.append(peak[m]);
+			levels.append(rms[m]);
+		}
+	}
+
+	TMessageType getFrameType(void) { return MSG_METERS; }
+};
+
+// MSG_SPECTRUM ////////////////////////////////////////////////////////////////
+//
+/**
+ * @brief The spectrum sent to the subscribed clients. The levels of the bins
+ * are 8 bit values from the lowest frequency, they are sent as a string of
+ * two hexadecimal digits for each bin.
+ */
+class MsgSpectrumFrame: public OutboundMessage {
+public:
+	MsgSpectrumFrame(unsigned long effect_id, const unsigned char* levels,
+			unsigned int count): OutboundMessage(MSG_UNINITIALIZED) {
+		static const char digits[] = "0123456789abcdef";
+		std::string hex(2 * count, '0');
+		for(unsigned int b = 0; b < count; b++) {
+			hex[2*b] = digits[levels[b] >> 4];
+			hex[2*b + 1] = digits[levels[b] & 0x0F];
+		}
+
+		dataroot_["type"] = MSG_SPECTRUM;
+		dataroot_["effect_id"] = (Json::UInt) effect_id;
+		dataroot_["levels"] = hex;
+	}
+
+	TMessageType getFrameType(void) { return MSG_SPECTRUM; }
+};
+
+// MSG_TUNER ///////////////////////////////////////////////////////////////////
+//
+/**
+ * @brief A reading of a tuner effect. The frequency is 0 if no pitch is
+ * detected, the note is a MIDI note number.
+ */
+class MsgTunerFrame: public OutboundMessage {
+public:
+	MsgTunerFrame(unsigned long effect_id, float frequency, float cents,
+			int note, float confidence): OutboundMessage(MSG_UNINITIALIZED) {
+		dataroot_["type"] = MSG_TUNER;
+		dataroot_["effect_id"] = (Json::UInt) effect_id;
+		dataroot_["frequency"] = frequency;
+		dataroot_["cents"] = cents;
+		dataroot_["note"] = note;
+		dataroot_["confidence"] = confidence;
+	}
+};
+
+// MSG_EFFECT_OVERRUN //////////////////////////////////////////////////////////
+//
+/**
+ * @brief An effect was faded out and bypassed because it overran its budget
+ * of processing time repeatedly. The time of the last overrun and the budget
+ * are in microseconds. The effect is switched on again with MSG_SET_BYPASS.
+ */
+class MsgEffectOverrunFrame: public OutboundMessage {
+public:
+	MsgEffectOverrunFrame(unsigned long effect_id, float time_us,
+			float budget_us): OutboundMessage(MSG_UNINITIALIZED) {
+		dataroot_["type"] = MSG_EFFECT_OVERRUN;
+		dataroot_["effect_id"] = (Json::UInt) effect_id;
+		dataroot_["time"] = time_us;
+		dataroot_["budget"] = budget_us;
+	}
+};
+
 // MSG_GET_STREAM //////////////////////////////////////////////////////////////
 //
 class MsgGetStream: public InboundMessage {
@@ -199,49 +307,673 @@ public:
 
 		OutboundMessage * reply = OutboundMessage::AckSetStream(error);
 		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+};
+
+// MSG_GET_STATE ///////////////////////////////////////////////////////////////
+//
+class MsgGetState: public InboundMessage {
+public:
+	OutboundMessage* instruct(DspServer& server) {
+		OutboundMessage *reply = OutboundMessage::AckGetState(server.getState());
+		reply->setChannelId(getChannelId());
+		setReply(reply);
 		return reply;
 	}
 };
 
-// MSG_GET_STATE ///////////////////////////////////////////////////////////////
-//
-class MsgGetState: public InboundMessage {
+// MSG_CLIENT_OUT //////////////////////////////////////////////////////////////
+//
+class MsgClientOut: public InboundMessage {
+public:
+	OutboundMessage* instruct(DspServer& server) {
+		server.clientOut(getChannelId());
+		OutboundMessage *reply = OutboundMessage::AckClientOut();
+		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+
+	bool isClientOutMessage(void) { return true; }
+};
+
+// MSG_SET_BUFFER_SIZE /////////////////////////////////////////////////////////
+//
+
+class MsgSetBufferSize: public InboundMessage {
+	unsigned int buffer_size_;
+public:
+	MsgSetBufferSize(unsigned int buffer_size): buffer_size_(buffer_size) {}
+
+	OutboundMessage* instruct(DspServer& server) {
+		server.setBufferSize(buffer_size_);
+		OutboundMessage *reply = OutboundMessage::AckSetBufferSize();
+		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+};
+
+// MSG_SET_BYPASS //////////////////////////////////////////////////////////////
+//
+
+/**
+ * @brief Incoming MSG_SET_BYPASS message. Effect ID 0 stands for the whole
+ * effect chain.
+ */
+class MsgSetBypass: public InboundMessage {
+	SoundEffect::TEffectID effect_id_;
+	bool bypass_;
+public:
+	MsgSetBypass(SoundEffect::TEffectID effect_id, bool bypass):
+		effect_id_(effect_id), bypass_(bypass) {}
+
+	OutboundMessage* instruct(DspServer& server) {
+		const char* error = NULL;
+		if(effect_id_ == 0) server.bypass(bypass_);
+		else {
+			TAlchemyError err = server.bypassEffect(effect_id_, bypass_);
+			if(err != E_OK) error = STR_ERRORS[err];
+		}
+
+		OutboundMessage *reply = OutboundMessage::AckSetBypass(error);
+		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+};
+
+// MSG_GET_LATENCY /////////////////////////////////////////////////////////////
+//
+class MsgGetLatency: public InboundMessage {
+public:
+	OutboundMessage* instruct(DspServer& server) {
+		DspServer::Latency latency;
+		server.getLatency(latency);
+		OutboundMessage *reply = OutboundMessage::AckGetLatency(
+				latency.input_ms, latency.output_ms, latency.processing_ms,
+				latency.measured_ms, latency.control_ms, latency.queue_ms,
+				latency.start_ms, latency.stop_ms);
+		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+};
+
+// MSG_MEASURE_LATENCY /////////////////////////////////////////////////////////
+//
+/**
+ * @brief Incoming MSG_MEASURE_LATENCY message. The output stream has to be
+ * looped back to the input stream. The processing is stopped for the time of
+ * the measurement.
+ */
+class MsgMeasureLatency: public InboundMessage {
+public:
+	OutboundMessage* instruct(DspServer& server) {
+		const char* error = NULL;
+		double measured = -1.0;
+		TAlchemyError err = server.measureLatency(measured);
+		if(err != E_OK) error = STR_ERRORS[err];
+
+		OutboundMessage *reply = OutboundMessage::AckMeasureLatency(error,
+				measured);
+		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+};
+
+// MSG_AUTO_TUNE_BUFFER_SIZE ///////////////////////////////////////////////////
+//
+/**
+ * @brief Incoming MSG_AUTO_TUNE_BUFFER_SIZE message. The buffer size is tuned
+ * once and if auto is set it's grown when the load is high. The reply is
+ * sent when the tuning ends, only an error is replied at once.
+ */
+class MsgAutoTuneBufferSize: public InboundMessage {
+	bool auto_;
+	float margin_;
+public:
+	MsgAutoTuneBufferSize(bool automatic, float margin): auto_(automatic),
+		margin_(margin) {}
+
+	OutboundMessage* instruct(DspServer& server) {
+		server.setAutoTune(auto_, margin_);
+		TAlchemyError err = server.autoTuneBufferSize(margin_, getChannelId());
+		if(err == E_OK) return NULL;
+
+		OutboundMessage *reply = OutboundMessage::AckAutoTuneBufferSize(
+				STR_ERRORS[err], 0);
+		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+};
+
+/**
+ * @brief Sent by the tune worker of the server itself to try a buffer size.
+ * Nothing is replied.
+ */
+class MsgTryBufferSize: public InboundMessage {
+	unsigned int frames_;
+public:
+	MsgTryBufferSize(unsigned int frames): frames_(frames) {}
+
+	OutboundMessage* instruct(DspServer& server) {
+		server.tryBufferSize(frames_);
+		return NULL;
+	}
+};
+
+/**
+ * @brief Sent by the tune worker of the server itself when the tuning
+ * ended. The reply is sent with the channel of the client which asked for
+ * the tuning.
+ */
+class MsgBufferSizeTuned: public InboundMessage {
+	unsigned int frames_;
+	bool stable_;
+public:
+	MsgBufferSizeTuned(unsigned int frames, bool stable): frames_(frames),
+		stable_(stable) {}
+
+	OutboundMessage* instruct(DspServer& server) {
+		const char* error = NULL;
+		TChannelID channel;
+		TAlchemyError err = server.finishTuning(frames_, stable_, channel);
+		if(err != E_OK) error = STR_ERRORS[err];
+
+		OutboundMessage *reply = OutboundMessage::AckAutoTuneBufferSize(error,
+				frames_);
+		reply->setChannelId(channel);
+		setReply(reply);
+		return reply;
+	}
+};
+
+/**
+ * @brief Sent by the load watcher of the server itself when the buffer size
+ * has to grow. The reply tells the clients the new size.
+ */
+class MsgGrowBufferSize: public InboundMessage {
+public:
+	OutboundMessage* instruct(DspServer& server) {
+		const char* error = NULL;
+		unsigned int frames = 0;
+		TAlchemyError err = server.growBufferSize(frames);
+		if(err != E_OK) error = STR_ERRORS[err];
+
+		OutboundMessage *reply = OutboundMessage::AckAutoTuneBufferSize(error,
+				frames);
+		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+};
+
+// MSG_CREATE_AGGREGATE_DEVICE /////////////////////////////////////////////////
+//
+/**
+ * @brief Incoming MSG_CREATE_AGGREGATE_DEVICE message. The members are given
+ * as arrays of {"device_id", "stream_id"} objects.
+ */
+class MsgCreateAggregateDevice: public InboundMessage {
+	std::string name_;
+	TAggregateMembers inputs_;
+	TAggregateMembers outputs_;
+public:
+	MsgCreateAggregateDevice(const char* name, const TAggregateMembers& inputs,
+			const TAggregateMembers& outputs): name_(name), inputs_(inputs),
+			outputs_(outputs) {}
+
+	OutboundMessage* instruct(DspServer& server) {
+		const char* error = NULL;
+		TAlchemyError err = server.createAggregateDevice(name_.c_str(),
+				inputs_, outputs_);
+		if(err != E_OK) error = STR_ERRORS[err];
+
+		OutboundMessage *reply = OutboundMessage::AckCreateAggregateDevice(error);
+		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+};
+
+// MSG_REMOVE_AGGREGATE_DEVICE /////////////////////////////////////////////////
+//
+class MsgRemoveAggregateDevice: public InboundMessage {
+	std::string name_;
+public:
+	MsgRemoveAggregateDevice(const char* name): name_(name) {}
+
+	OutboundMessage* instruct(DspServer& server) {
+		const char* error = NULL;
+		TAlchemyError err = server.removeAggregateDevice(name_.c_str());
+		if(err != E_OK) error = STR_ERRORS[err];
+
+		OutboundMessage *reply = OutboundMessage::AckRemoveAggregateDevice(error);
+		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+};
+
+// MSG_BIND_CONTROL ////////////////////////////////////////////////////////////
+//
+/**
+ * @brief Incoming MSG_BIND_CONTROL message. The controller is given by its
+ * channel and number or learned: the next controller moved is bound.
+ */
+class MsgBindControl: public InboundMessage {
+	SoundEffect::TEffectID effect_;
+	SoundEffect::TParamID param_;
+	bool learn_;
+	TControlId control_;
+public:
+	MsgBindControl(SoundEffect::TEffectID effect, SoundEffect::TParamID param,
+			bool learn, TControlId control): effect_(effect), param_(param),
+			learn_(learn), control_(control) {}
+
+	OutboundMessage* instruct(DspServer& server) {
+		if(learn_) server.learnControl(effect_, param_);
+		else server.bindControl(control_, effect_, param_);
+
+		OutboundMessage *reply = OutboundMessage::AckBindControl(effect_,
+				param_, learn_, control_);
+		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+};
+
+/**
+ * @brief Sent by a MIDI connector when a controller has been learned. The
+ * clients get the binding in a MSG_BIND_CONTROL reply.
+ */
+class MsgControlLearned: public InboundMessage {
+	TControlId control_;
+	SoundEffect::TEffectID effect_;
+	SoundEffect::TParamID param_;
+public:
+	MsgControlLearned(TControlId control, SoundEffect::TEffectID effect,
+			SoundEffect::TParamID param): control_(control), effect_(effect),
+			param_(param) {}
+
+	OutboundMessage* instruct(DspServer& server) {
+		OutboundMessage *reply = OutboundMessage::AckBindControl(effect_,
+				param_, false, control_);
+		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+};
+
+// MSG_UNBIND_CONTROL //////////////////////////////////////////////////////////
+//
+class MsgUnbindControl: public InboundMessage {
+	SoundEffect::TEffectID effect_;
+	SoundEffect::TParamID param_;
+public:
+	MsgUnbindControl(SoundEffect::TEffectID effect, SoundEffect::TParamID param):
+		effect_(effect), param_(param) {}
+
+	OutboundMessage* instruct(DspServer& server) {
+		const char* error = NULL;
+		TAlchemyError err = server.unbindControl(effect_, param_);
+		if(err != E_OK) error = STR_ERRORS[err];
+
+		OutboundMessage *reply = OutboundMessage::AckUnbindControl(error);
+		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+};
+
+// MSG_SET_EFFECT_PARAM ////////////////////////////////////////////////////////
+//
+/**
+ * @brief Outgoing MSG_SET_EFFECT_PARAM and MSG_GET_EFFECT_PARAM message. It's
+ * sent for each move of a control, so it's encoded from its fields without
+ * building its data store.
+ */
+class OutboundParamAck: public OutboundMessage {
+	const char* error_;
+	unsigned long effect_;
+	unsigned long param_;
+	double value_;
+	bool has_value_;
+public:
+	OutboundParamAck(TMessageType reply_for, const char* error,
+			unsigned long effect, unsigned long param, double value,
+			bool has_value): OutboundMessage(reply_for, true), error_(error),
+			effect_(effect), param_(param), value_(value),
+			has_value_(has_value) {}
+
+protected:
+	// the keys are written in the order of the Json::Value of the message
+	unsigned int encode(TProtocol protocol, char* buffer, unsigned int size,
+			int delimiter) {
+		switch(protocol) {
+		case PROTOCOL_JSON: {
+			unsigned int n = 0;
+			append(buffer, size, n, "{\"ack_for\":%d,\"channel_id\":%u,"
+					"\"effect_id\":%lu", ack_for_, getChannelId(), effect_);
+			if(error_ != NULL) {
+				append(buffer, size, n, ",\"error\":\"");
+				for(const char* c = error_; *c != 0; c++) {
+					const char* escape = strchr(ESCAPED, *c);
+					if(escape != NULL) {
+						append(buffer, size, n, "\\%c",
+								ESCAPES[escape - ESCAPED]);
+					} else if((unsigned char) *c < 0x20) {
+						append(buffer, size, n, "\\u%04X", *c);
+					} else append(buffer, size, n, "%c", *c);
+				}
+				append(buffer, size, n, "\"");
+			}
+			append(buffer, size, n, ",\"param_id\":%lu,\"type\":%d", param_,
+					MSG_ACK);
+			if(has_value_) appendDouble(buffer, size, n, ",\"value\":", value_);
+			append(buffer, size, n, "}\n%c", delimiter);
+			return n < size ? n : 0;
+		}
+		case PROTOCOL_BINARY: {
+			BinaryProtocol::Writer writer(buffer, size);
+			writer.putObject(5 + (error_ != NULL) + has_value_);
+			writer.putKey("ack_for");
+			writer.putInt(ack_for_);
+			writer.putKey("channel_id");
+			writer.putUInt(getChannelId());
+			writer.putKey("effect_id");
+			writer.putUInt(effect_);
+			if(error_ != NULL) {
+				writer.putKey("error");
+				writer.putString(error_);
+			}
+			writer.putKey("param_id");
+			writer.putUInt(param_);
+			writer.putKey("type");
+			writer.putInt(MSG_ACK);
+			if(has_value_) {
+				writer.putKey("value");
+				writer.putDouble(value_);
+			}
+			return writer.finish(MSG_ACK);
+		}
+		default:
+			return 0;
+		}
+	}
+
+private:
+	// the characters escaped by the JSON writer and their escapes
+	static const char ESCAPED[];
+	static const char ESCAPES[];
+
+	// formats after the n bytes of the buffer, n reaches size if it's full
+	static void append(char* buffer, unsigned int size, unsigned int& n,
+			const char* format, ...) {
+		va_list args;
+		va_start(args, format);
+		if(n < size) n += vsnprintf(buffer + n, size - n, format, args);
+		if(n > size) n = size;
+		va_end(args);
+	}
+
+	// the same digits as the JSON writer, 16 significant digits without the
+	// trailing zeros after the first decimal
+	static void appendDouble(char* buffer, unsigned int size, unsigned int& n,
+			const char* key, double value) {
+		char digits[32];
+		unsigned int length = snprintf(digits, sizeof(digits), "%#.16g", value);
+		if(digits[length - 1] == '0') {
+			char* last = digits + length - 1;
+			while(last > digits && *last == '0') last--;
+			char* c = last;
+			while(c >= digits && *c >= '0' && *c <= '9') c--;
+			if(c >= digits && *c == '.') last[2] = 0;
+		}
+		append(buffer, size, n, "%s%s", key, digits);
+	}
+};
+
+const char OutboundParamAck::ESCAPED[] = "\"\\\b\f\n\r\t";
+const char OutboundParamAck::ESCAPES[] = "\"\\bfnrt";
+
+/**
+ * @brief Incoming MSG_SET_EFFECT_PARAM message. The values of the same
+ * parameter waiting in the queue replace each other.
+ */
+class MsgSetEffectParam: public InboundMessage {
+	SoundEffect::TEffectID effect_;
+	SoundEffect::TParamID param_;
+	SoundEffect::TParamValue value_;
+public:
+	MsgSetEffectParam(SoundEffect::TEffectID effect, SoundEffect::TParamID param,
+			SoundEffect::TParamValue value): effect_(effect), param_(param),
+			value_(value) {}
+
+	OutboundMessage* instruct(DspServer& server) {
+		const char* error = NULL;
+		TAlchemyError err = server.setEffectParam(effect_, param_, value_);
+		if(err != E_OK) error = STR_ERRORS[err];
+
+		OutboundMessage *reply = OutboundMessage::AckSetEffectParam(error,
+				effect_, param_, value_);
+		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+
+	bool getCoalescingKey(TCoalescingKey& key) {
+		key = TCoalescingKey(effect_, param_);
+		return true;
+	}
+};
+
+// MSG_GET_EFFECT_PARAM ////////////////////////////////////////////////////////
+//
+class MsgGetEffectParam: public InboundMessage {
+	SoundEffect::TEffectID effect_;
+	SoundEffect::TParamID param_;
+public:
+	MsgGetEffectParam(SoundEffect::TEffectID effect, SoundEffect::TParamID param):
+		effect_(effect), param_(param) {}
+
+	OutboundMessage* instruct(DspServer& server) {
+		const char* error = NULL;
+		SoundEffect::TParamValue value = 0.0;
+		TAlchemyError err = server.getEffectParam(effect_, param_, value);
+		if(err != E_OK) error = STR_ERRORS[err];
+
+		OutboundMessage *reply = OutboundMessage::AckGetEffectParam(error,
+				effect_, param_, value);
+		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+};
+
+// MSG_SUBSCRIBE_METERS ////////////////////////////////////////////////////////
+//
+class MsgSubscribeMeters: public InboundMessage {
+	bool subscribe_;
+	unsigned int rate_;
+public:
+	MsgSubscribeMeters(bool subscribe, unsigned int rate):
+		subscribe_(subscribe), rate_(rate) {}
+
+	OutboundMessage* instruct(DspServer& server) {
+		const char* error = NULL;
+		TAlchemyError err = server.subscribeMeters(getChannelId(), subscribe_,
+				rate_);
+		if(err != E_OK) error = STR_ERRORS[err];
+
+		OutboundMessage *reply = OutboundMessage::AckSubscribeMeters(error,
+				subscribe_);
+		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+
+	TMessageType getSubscription(bool& subscribe) {
+		subscribe = subscribe_;
+		return MSG_METERS;
+	}
+};
+
+// MSG_SUBSCRIBE_SPECTRUM //////////////////////////////////////////////////////
+//
+class MsgSubscribeSpectrum: public InboundMessage {
+	bool subscribe_;
+	SoundEffect::TEffectID effect_;
+	unsigned int size_;
+	float overlap_;
+	unsigned int bins_;
+public:
+	MsgSubscribeSpectrum(bool subscribe, SoundEffect::TEffectID effect,
+			unsigned int size, float overlap, unsigned int bins):
+		subscribe_(subscribe), effect_(effect), size_(size),
+		overlap_(overlap), bins_(bins) {}
+
+	OutboundMessage* instruct(DspServer& server) {
+		const char* error = NULL;
+		TAlchemyError err = server.subscribeSpectrum(getChannelId(),
+				subscribe_, effect_, size_, overlap_, bins_);
+		if(err != E_OK) error = STR_ERRORS[err];
+
+		OutboundMessage *reply = OutboundMessage::AckSubscribeSpectrum(error,
+				subscribe_);
+		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+
+	TMessageType getSubscription(bool& subscribe) {
+		subscribe = subscribe_;
+		return MSG_SPECTRUM;
+	}
+};
+
+// MSG_EXPORT_SIGNAL ///////////////////////////////////////////////////////////
+//
+/**
+ * @brief Incoming MSG_EXPORT_SIGNAL message. It exports a point of the chain
+ * to a file or stops the export of the file.
+ */
+class MsgExportSignal: public InboundMessage {
+	bool export_;
+	SoundEffect::TEffectID effect_;
+	std::string path_;
+	unsigned int channels_;
+	unsigned int frames_;
+public:
+	MsgExportSignal(bool exp, SoundEffect::TEffectID effect, const char* path,
+			unsigned int channels, unsigned int frames):
+		export_(exp), effect_(effect), path_(path), channels_(channels),
+		frames_(frames) {}
+
+	OutboundMessage* instruct(DspServer& server) {
+		const char* error = NULL;
+		TAlchemyError err = export_ ?
+				server.exportSignal(effect_, path_.c_str(), channels_, frames_) :
+				server.removeExport(path_.c_str());
+		if(err != E_OK) error = STR_ERRORS[err];
+
+		OutboundMessage *reply = OutboundMessage::AckExportSignal(error,
+				path_.c_str(), export_);
+		reply->setChannelId(getChannelId());
+		setReply(reply);
+		return reply;
+	}
+};
+
+/**
+ * @brief Sent by the spectrum analyzer of the server. The frame is sent to
+ * the subscribed clients only, nothing is broadcast.
+ */
+class MsgPublishSpectrum: public InboundMessage {
+public:
+	OutboundMessage* instruct(DspServer& server) {
+		server.publishSpectrum();
+		return NULL;
+	}
+};
+
+/**
+ * @brief Sent by the meter timer of the server. The frame is sent to the
+ * subscribed clients only, nothing is broadcast.
+ */
+class MsgPublishMeters: public InboundMessage {
 public:
 	OutboundMessage* instruct(DspServer& server) {
-		OutboundMessage *reply = OutboundMessage::AckGetState(server.getState());
-		reply->setChannelId(getChannelId());
-		return reply;
+		server.publishMeters();
+		return NULL;
 	}
 };
 
-// MSG_CLIENT_OUT //////////////////////////////////////////////////////////////
-//
-class MsgClientOut: public InboundMessage {
+/**
+ * @brief Sent on the readings of a tuner effect. The reading is broadcast if
+ * the tuner is still in the chain.
+ */
+class MsgTunerReading: public InboundMessage {
+	SoundEffect* tuner_;
+	float frequency_;
+	float cents_;
+	int note_;
+	float confidence_;
 public:
+	MsgTunerReading(SoundEffect* tuner, float frequency, float cents,
+			int note, float confidence): tuner_(tuner), frequency_(frequency),
+			cents_(cents), note_(note), confidence_(confidence) {}
+
 	OutboundMessage* instruct(DspServer& server) {
-		server.clientOut(getChannelId());
-		OutboundMessage *reply = OutboundMessage::AckClientOut();
-		reply->setChannelId(getChannelId());
+		SoundEffect::TEffectID id;
+		if(server.findEffect(tuner_, id) != E_OK) return NULL;
+
+		OutboundMessage *reply = OutboundMessage::MsgTuner(id, frequency_,
+				cents_, note_, confidence_);
+		setReply(reply);
 		return reply;
 	}
 };
 
-// MSG_SET_BUFFER_SIZE /////////////////////////////////////////////////////////
-//
-
-class MsgSetBufferSize: public InboundMessage {
-	unsigned int buffer_size_;
+/**
+ * @brief Sent when the chain bypassed an effect for its overruns. It's
+ * broadcast if the effect is still in the chain.
+ */
+class MsgEffectOverrun: public InboundMessage {
+	SoundEffect* effect_;
+	float time_us_;
+	float budget_us_;
 public:
-	MsgSetBufferSize(unsigned int buffer_size): buffer_size_(buffer_size) {}
+	MsgEffectOverrun(SoundEffect* effect, float time_us, float budget_us):
+		effect_(effect), time_us_(time_us), budget_us_(budget_us) {}
 
 	OutboundMessage* instruct(DspServer& server) {
-		server.setBufferSize(buffer_size_);
-		OutboundMessage *reply = OutboundMessage::AckSetBufferSize();
-		reply->setChannelId(getChannelId());
+		SoundEffect::TEffectID id;
+		if(server.findEffect(effect_, id) != E_OK) return NULL;
+
+		log(LEVEL_WARNING, "effect %lu is bypassed, it took %.0f us of its "
+				"%.0f us budget", id, time_us_, budget_us_);
+		OutboundMessage *reply = OutboundMessage::MsgEffectOverrun(id,
+				time_us_, budget_us_);
+		setReply(reply);
 		return reply;
 	}
 };
 
+// read the members of an aggregate device from a json array
+static void readMembers(Json::Value& members, TAggregateMembers& result) {
+	for(Json::Value::UInt i = 0; i < members.size(); i++) {
+		result.push_back(AggregateMember(
+				members[i]["device_id"].asString().c_str(),
+				members[i]["stream_id"].asInt()));
+	}
+}
+
 //
 // End of Message definitions //////////////////////////////////////////////////
 
@@ -253,6 +985,14 @@ const Message::TChannelID Message::ALCHEMY_SERVER = 0;
 void soundalchemy::OutboundMessage::serialize(TProtocol protocol,
 		std::ostream& output, int delimiter) {
 
+	char buffer[ENCODE_SIZE];
+	unsigned int size = encode(protocol, buffer, sizeof(buffer), delimiter);
+	if(size > 0) {
+		output.write(buffer, size);
+		output.flush();
+		return;
+	}
+
 	switch(protocol) { // decide which protocol to use
 	case PROTOCOL_JSON: {
 		// send out the JSON data
@@ -260,6 +1000,13 @@ void soundalchemy::OutboundMessage::serialize(TProtocol protocol,
 		output.flush();
 	}
 	break;
+	case PROTOCOL_BINARY: {
+		// the frame has its length, no delimiter is needed
+		BinaryProtocol::writeFrame(output, dataroot_["type"].asUInt(),
+				dataroot_);
+		output.flush();
+	}
+	break;
 	default:
 		log(LEVEL_WARNING, "No such protocol");
 
@@ -268,6 +1015,45 @@ void soundalchemy::OutboundMessage::serialize(TProtocol protocol,
 
 }
 
+SharedBuffer* OutboundMessage::getSerialized(TProtocol protocol,
+		int delimiter) {
+	for(unsigned int i = 0; i < serialized_count_; i++) {
+		if(serialized_[i].protocol == protocol &&
+				serialized_[i].delimiter == delimiter) {
+			return serialized_[i].buffer->acquire();
+		}
+	}
+
+	SharedBuffer* buffer;
+	char bytes[ENCODE_SIZE];
+	unsigned int size = encode(protocol, bytes, sizeof(bytes), delimiter);
+	if(size > 0) {
+		buffer = SharedBuffer::create(bytes, size);
+	} else {
+		std::ostringstream stream;
+		serialize(protocol, stream, delimiter);
+		std::string str = stream.str();
+		buffer = SharedBuffer::create(str);
+	}
+
+	// a further connector gets its own buffer
+	if(serialized_count_ == MAX_SERIALIZED) return buffer;
+
+	Serialized& entry = serialized_[serialized_count_++];
+	entry.protocol = protocol;
+	entry.delimiter = delimiter;
+	entry.buffer = buffer;
+
+	return buffer->acquire();
+}
+
+void OutboundMessage::clearSerialized(void) {
+	for(unsigned int i = 0; i < serialized_count_; i++) {
+		serialized_[i].buffer->release();
+	}
+	serialized_count_ = 0;
+}
+
 // Create an input message from a byte stream
 InboundMessage* soundalchemy::InboundMessage::unserialize(TProtocol protocol,
 		std::istream& stream, int delimiter) {
@@ -324,6 +1110,288 @@ InboundMessage* soundalchemy::InboundMessage::unserialize(TProtocol protocol,
 			msg = new MsgSetBufferSize(frames);
 		}
 		break;
+	case MSG_SET_BYPASS:
+		{
+			SoundEffect::TEffectID id = jsondoc["effect_id"].asUInt();
+			bool bypass = jsondoc["bypass"].asBool();
+			msg = new MsgSetBypass(id, bypass);
+		}
+		break;
+	case MSG_GET_LATENCY:
+		msg = new MsgGetLatency();
+		break;
+	case MSG_MEASURE_LATENCY:
+		msg = new MsgMeasureLatency();
+		break;
+	case MSG_AUTO_TUNE_BUFFER_SIZE:
+		{
+			bool automatic = jsondoc["auto"].asBool();
+			float margin = jsondoc.isMember("margin") ?
+					jsondoc["margin"].asDouble() : DspServer::DEFAULT_TUNE_MARGIN;
+			msg = new MsgAutoTuneBufferSize(automatic, margin);
+		}
+		break;
+	case MSG_CREATE_AGGREGATE_DEVICE:
+		{
+			std::string name = jsondoc["name"].asString();
+			TAggregateMembers inputs, outputs;
+			readMembers(jsondoc["inputs"], inputs);
+			readMembers(jsondoc["outputs"], outputs);
+			msg = new MsgCreateAggregateDevice(name.c_str(), inputs, outputs);
+		}
+		break;
+	case MSG_REMOVE_AGGREGATE_DEVICE:
+		{
+			std::string name = jsondoc["name"].asString();
+			msg = new MsgRemoveAggregateDevice(name.c_str());
+		}
+		break;
+	case MSG_BIND_CONTROL:
+		{
+			SoundEffect::TEffectID effect = jsondoc["effect_id"].asUInt();
+			SoundEffect::TParamID param = jsondoc["param_id"].asUInt();
+			bool learn = jsondoc["learn"].asBool();
+			TControlId control = ControlMap::makeId(jsondoc["nrpn"].asBool() ?
+					ControlMap::CONTROL_NRPN : ControlMap::CONTROL_CC,
+					jsondoc["channel"].asUInt(), jsondoc["controller"].asUInt());
+			msg = new MsgBindControl(effect, param, learn, control);
+		}
+		break;
+	case MSG_UNBIND_CONTROL:
+		{
+			SoundEffect::TEffectID effect = jsondoc["effect_id"].asUInt();
+			SoundEffect::TParamID param = jsondoc["param_id"].asUInt();
+			msg = new MsgUnbindControl(effect, param);
+		}
+		break;
+	case MSG_SUBSCRIBE_METERS:
+		{
+			bool subscribe = jsondoc["subscribe"].asBool();
+			// a rate of 0 is the default rate
+			unsigned int rate = jsondoc["rate"].asUInt();
+			msg = new MsgSubscribeMeters(subscribe, rate);
+		}
+		break;
+	case MSG_SUBSCRIBE_SPECTRUM:
+		{
+			// the missing fields are 0, the defaults of the analyzer
+			bool subscribe = jsondoc["subscribe"].asBool();
+			SoundEffect::TEffectID effect = jsondoc["effect_id"].asUInt();
+			unsigned int size = jsondoc["size"].asUInt();
+			float overlap = jsondoc.isMember("overlap") ?
+					jsondoc["overlap"].asDouble() :
+					SpectrumAnalyzer::DEFAULT_OVERLAP;
+			unsigned int bins = jsondoc["bins"].asUInt();
+			msg = new MsgSubscribeSpectrum(subscribe, effect, size, overlap,
+					bins);
+		}
+		break;
+	case MSG_EXPORT_SIGNAL:
+		{
+			// 0 channels and frames are the defaults
+			bool exp = jsondoc["export"].asBool();
+			SoundEffect::TEffectID effect = jsondoc["effect_id"].asUInt();
+			std::string path = jsondoc["path"].asString();
+			unsigned int channels = jsondoc["channels"].asUInt();
+			unsigned int frames = jsondoc["frames"].asUInt();
+			msg = new MsgExportSignal(exp, effect, path.c_str(), channels,
+					frames);
+		}
+		break;
+	case MSG_SET_EFFECT_PARAM:
+		{
+			SoundEffect::TEffectID effect = jsondoc["effect_id"].asUInt();
+			SoundEffect::TParamID param = jsondoc["param_id"].asUInt();
+			SoundEffect::TParamValue value = jsondoc["value"].asDouble();
+			msg = new MsgSetEffectParam(effect, param, value);
+		}
+		break;
+	case MSG_GET_EFFECT_PARAM:
+		{
+			SoundEffect::TEffectID effect = jsondoc["effect_id"].asUInt();
+			SoundEffect::TParamID param = jsondoc["param_id"].asUInt();
+			msg = new MsgGetEffectParam(effect, param);
+		}
+		break;
+	case MSG_EXIT:
+		msg = new MsgExit( );
+		break;
+	default:
+		msg = NULL;
+		break;
+	}
+
+	return msg;
+}
+
+// Create an input message from the payload of a binary frame. The fields of
+// each type are read in the order below, see BinaryProtocol for the encoding.
+InboundMessage* soundalchemy::InboundMessage::unserialize(unsigned int type,
+		const char* payload, unsigned int length) {
+
+	BinaryProtocol::Reader reader(payload, length);
+	InboundMessage* msg;
+
+	switch(type) { // create the message
+	case MSG_START:
+		msg = new MsgStart();
+		break;
+	case MSG_STOP:
+		msg = new MsgStop();
+		break;
+	case MSG_GET_DEVICE_LIST:
+		{
+			bool redetect = reader.getU8() != 0;
+			if(reader.fail()) return NULL;
+			msg = new MsgGetDeviceList(redetect);
+		}
+		break;
+	case MSG_GET_STATE:
+		msg = new MsgGetState();
+		break;
+	case MSG_SET_STREAM:
+		{
+			TStreamDirection dir = (TStreamDirection) reader.getU8();
+			TStreamId streamid = reader.getI32();
+			char devid[BinaryProtocol::MAX_STRING + 1];
+			reader.getString(devid);
+			if(reader.fail()) return NULL;
+			msg = new MsgSetStream(devid, streamid, dir);
+		}
+		break;
+	case MSG_GET_STREAM:
+		{
+			TStreamDirection dir = (TStreamDirection) reader.getU8();
+			if(reader.fail()) return NULL;
+			msg = new MsgGetStream(dir);
+		}
+		break;
+	case MSG_SET_BUFFER_SIZE:
+		{
+			unsigned int frames = reader.getU32();
+			if(reader.fail()) return NULL;
+			msg = new MsgSetBufferSize(frames);
+		}
+		break;
+	case MSG_SET_BYPASS:
+		{
+			SoundEffect::TEffectID id = reader.getU32();
+			bool bypass = reader.getU8() != 0;
+			if(reader.fail()) return NULL;
+			msg = new MsgSetBypass(id, bypass);
+		}
+		break;
+	case MSG_GET_LATENCY:
+		msg = new MsgGetLatency();
+		break;
+	case MSG_MEASURE_LATENCY:
+		msg = new MsgMeasureLatency();
+		break;
+	case MSG_AUTO_TUNE_BUFFER_SIZE:
+		{
+			bool automatic = reader.getU8() != 0;
+			float margin = reader.getF32();
+			if(reader.fail()) return NULL;
+			msg = new MsgAutoTuneBufferSize(automatic, margin);
+		}
+		break;
+	case MSG_CREATE_AGGREGATE_DEVICE:
+		{
+			char name[BinaryProtocol::MAX_STRING + 1];
+			reader.getString(name);
+			TAggregateMembers members[2];
+			for(int m = 0; m < 2; m++) { // the inputs then the outputs
+				unsigned int count = reader.getU16();
+				for(unsigned int i = 0; i < count && !reader.fail(); i++) {
+					char devid[BinaryProtocol::MAX_STRING + 1];
+					reader.getString(devid);
+					TStreamId streamid = reader.getI32();
+					members[m].push_back(AggregateMember(devid, streamid));
+				}
+			}
+			if(reader.fail()) return NULL;
+			msg = new MsgCreateAggregateDevice(name, members[0], members[1]);
+		}
+		break;
+	case MSG_REMOVE_AGGREGATE_DEVICE:
+		{
+			char name[BinaryProtocol::MAX_STRING + 1];
+			reader.getString(name);
+			if(reader.fail()) return NULL;
+			msg = new MsgRemoveAggregateDevice(name);
+		}
+		break;
+	case MSG_BIND_CONTROL:
+		{
+			SoundEffect::TEffectID effect = reader.getU32();
+			SoundEffect::TParamID param = reader.getU32();
+			bool learn = reader.getU8() != 0;
+			unsigned int channel = reader.getU8();
+			unsigned int controller = reader.getU16();
+			bool nrpn = reader.getU8() != 0;
+			if(reader.fail()) return NULL;
+			msg = new MsgBindControl(effect, param, learn, ControlMap::makeId(
+					nrpn ? ControlMap::CONTROL_NRPN : ControlMap::CONTROL_CC,
+					channel, controller));
+		}
+		break;
+	case MSG_UNBIND_CONTROL:
+		{
+			SoundEffect::TEffectID effect = reader.getU32();
+			SoundEffect::TParamID param = reader.getU32();
+			if(reader.fail()) return NULL;
+			msg = new MsgUnbindControl(effect, param);
+		}
+		break;
+	case MSG_SUBSCRIBE_METERS:
+		{
+			bool subscribe = reader.getU8() != 0;
+			unsigned int rate = reader.getU16();
+			if(reader.fail()) return NULL;
+			msg = new MsgSubscribeMeters(subscribe, rate);
+		}
+		break;
+	case MSG_SUBSCRIBE_SPECTRUM:
+		{
+			bool subscribe = reader.getU8() != 0;
+			SoundEffect::TEffectID effect = reader.getU32();
+			unsigned int size = reader.getU16();
+			float overlap = reader.getF32();
+			unsigned int bins = reader.getU16();
+			if(reader.fail()) return NULL;
+			msg = new MsgSubscribeSpectrum(subscribe, effect, size, overlap,
+					bins);
+		}
+		break;
+	case MSG_EXPORT_SIGNAL:
+		{
+			bool exp = reader.getU8() != 0;
+			SoundEffect::TEffectID effect = reader.getU32();
+			char path[BinaryProtocol::MAX_STRING + 1];
+			reader.getString(path);
+			unsigned int channels = reader.getU8();
+			unsigned int frames = reader.getU32();
+			if(reader.fail()) return NULL;
+			msg = new MsgExportSignal(exp, effect, path, channels, frames);
+		}
+		break;
+	case MSG_SET_EFFECT_PARAM:
+		{
+			SoundEffect::TEffectID effect = reader.getU32();
+			SoundEffect::TParamID param = reader.getU32();
+			SoundEffect::TParamValue value = reader.getF32();
+			if(reader.fail()) return NULL;
+			msg = new MsgSetEffectParam(effect, param, value);
+		}
+		break;
+	case MSG_GET_EFFECT_PARAM:
+		{
+			SoundEffect::TEffectID effect = reader.getU32();
+			SoundEffect::TParamID param = reader.getU32();
+			if(reader.fail()) return NULL;
+			msg = new MsgGetEffectParam(effect, param);
+		}
+		break;
 	case MSG_EXIT:
 		msg = new MsgExit( );
 		break;
@@ -335,6 +1403,64 @@ InboundMessage* soundalchemy::InboundMessage::unserialize(TProtocol protocol,
 	return msg;
 }
 
+// /////////////////////////////////////////////////////////////////////////////
+// Pool of the messages
+// /////////////////////////////////////////////////////////////////////////////
+
+// A block of the pool, aligned for any member of a message
+union PoolBlock {
+	char bytes[Message::POOL_BLOCK_SIZE];
+	double align_double;
+	long long align_long;
+	void* align_pointer;
+
+	// the index of the next free block while the block is free
+	unsigned int next;
+};
+
+// Index of the block given back last in the low 16 bits and a tag counting
+// the pushes in the high ones, so a pop doesn't take a block which was taken
+// and given back meanwhile. All the blocks are used once before the free list.
+static const unsigned int POOL_EMPTY = 0xffff;
+static PoolBlock pool_blocks[Message::POOL_BLOCKS];
+static volatile unsigned int pool_free = POOL_EMPTY;
+static volatile unsigned int pool_fresh = 0;
+
+void* Message::operator new(size_t size) {
+	if(size <= POOL_BLOCK_SIZE) {
+		unsigned int head, index;
+		do {
+			head = pool_free;
+			index = head & 0xffff;
+			if(index == POOL_EMPTY) break;
+		} while(!__sync_bool_compare_and_swap(&pool_free, head,
+				(head & 0xffff0000u) | pool_blocks[index].next));
+		if(index != POOL_EMPTY) return &pool_blocks[index];
+
+		index = __sync_fetch_and_add(&pool_fresh, 1);
+		if(index < POOL_BLOCKS) return &pool_blocks[index];
+	}
+
+	// the messages above the block size and the ones outliving the pool
+	return ::operator new(size);
+}
+
+void Message::operator delete(void* p) {
+	PoolBlock* block = (PoolBlock*) p;
+	if(block < pool_blocks || block >= pool_blocks + POOL_BLOCKS) {
+		::operator delete(p);
+		return;
+	}
+
+	unsigned int index = block - pool_blocks;
+	unsigned int head;
+	do {
+		head = pool_free;
+		block->next = head & 0xffff;
+	} while(!__sync_bool_compare_and_swap(&pool_free, head,
+			((head & 0xffff0000u) + 0x10000u) | index));
+}
+
 // /////////////////////////////////////////////////////////////////////////////
 // Input Message Initializers
 // /////////////////////////////////////////////////////////////////////////////
@@ -343,6 +1469,47 @@ InboundMessage* InboundMessage::newMsgClientOut() {
 	return new MsgClientOut();
 }
 
+InboundMessage* InboundMessage::newMsgGrowBufferSize() {
+	return new MsgGrowBufferSize();
+}
+
+InboundMessage* InboundMessage::newMsgTryBufferSize(unsigned int frames) {
+	return new MsgTryBufferSize(frames);
+}
+
+InboundMessage* InboundMessage::newMsgBufferSizeTuned(unsigned int frames,
+		bool stable) {
+	return new MsgBufferSizeTuned(frames, stable);
+}
+
+InboundMessage* InboundMessage::newMsgControlLearned(unsigned long control,
+		unsigned long effect_id, unsigned long param_id) {
+	return new MsgControlLearned(control, effect_id, param_id);
+}
+
+InboundMessage* InboundMessage::newMsgPublishMeters() {
+	return new MsgPublishMeters();
+}
+
+InboundMessage* InboundMessage::newMsgPublishSpectrum() {
+	return new MsgPublishSpectrum();
+}
+
+InboundMessage* InboundMessage::newMsgUnsubscribe(TMessageType frames) {
+	if(frames == MSG_METERS) return new MsgSubscribeMeters(false, 0);
+	return new MsgSubscribeSpectrum(false, 0, 0, 0.0f, 0);
+}
+
+InboundMessage* InboundMessage::newMsgTunerReading(SoundEffect* tuner,
+		float frequency, float cents, int note, float confidence) {
+	return new MsgTunerReading(tuner, frequency, cents, note, confidence);
+}
+
+InboundMessage* InboundMessage::newMsgEffectOverrun(SoundEffect* effect,
+		float time_us, float budget_us) {
+	return new MsgEffectOverrun(effect, time_us, budget_us);
+}
+
 // /////////////////////////////////////////////////////////////////////////////
 // Acknowledge message initializers ////////////////////////////////////////////
 // /////////////////////////////////////////////////////////////////////////////
@@ -352,6 +1519,26 @@ OutboundMessage* OutboundMessage::MsgSendClientID( Message::TChannelID id ) {
 	return msg;
 }
 
+OutboundMessage* OutboundMessage::MsgMeters(unsigned int count,
+		const float* peak, const float* rms) {
+	return new MsgMeterFrame(count, peak, rms);
+}
+
+OutboundMessage* OutboundMessage::MsgSpectrum(unsigned long effect_id,
+		const unsigned char* levels, unsigned int count) {
+	return new MsgSpectrumFrame(effect_id, levels, count);
+}
+
+OutboundMessage* OutboundMessage::MsgTuner(unsigned long effect_id,
+		float frequency, float cents, int note, float confidence) {
+	return new MsgTunerFrame(effect_id, frequency, cents, note, confidence);
+}
+
+OutboundMessage* OutboundMessage::MsgEffectOverrun(unsigned long effect_id,
+		float time_us, float budget_us) {
+	return new MsgEffectOverrunFrame(effect_id, time_us, budget_us);
+}
+
 OutboundMessage* OutboundMessage::AckStart( const char* error) {
 	OutboundMessage *msg = new OutboundMessage(MSG_START);
 	if( error != NULL ) msg->dataroot_["error"] = std::string(error);
@@ -399,6 +1586,113 @@ OutboundMessage* OutboundMessage::AckSetBufferSize( void ) {
 	return new OutboundMessage(MSG_SET_BUFFER_SIZE);
 }
 
+OutboundMessage* OutboundMessage::AckSetBypass(const char* error) {
+	OutboundMessage *msg = new OutboundMessage(MSG_SET_BYPASS);
+	if(error != NULL) msg->dataroot_["error"] = string(error);
+	return msg;
+}
+
+OutboundMessage* OutboundMessage::AckGetLatency(double input_ms,
+		double output_ms, double processing_ms, double measured_ms,
+		double control_ms, double queue_ms, double start_ms, double stop_ms) {
+	OutboundMessage *msg = new OutboundMessage(MSG_GET_LATENCY);
+	msg->dataroot_["input"] = input_ms;
+	msg->dataroot_["output"] = output_ms;
+	msg->dataroot_["processing"] = processing_ms;
+	msg->dataroot_["measured"] = measured_ms;
+	msg->dataroot_["control"] = control_ms;
+	msg->dataroot_["queue"] = queue_ms;
+	msg->dataroot_["start"] = start_ms;
+	msg->dataroot_["stop"] = stop_ms;
+	return msg;
+}
+
+OutboundMessage* OutboundMessage::AckMeasureLatency(const char* error,
+		double measured_ms) {
+	OutboundMessage *msg = new OutboundMessage(MSG_MEASURE_LATENCY);
+	if(error != NULL) msg->dataroot_["error"] = string(error);
+	else msg->dataroot_["measured"] = measured_ms;
+	return msg;
+}
+
+OutboundMessage* OutboundMessage::AckAutoTuneBufferSize(const char* error,
+		unsigned int buffer_size) {
+	OutboundMessage *msg = new OutboundMessage(MSG_AUTO_TUNE_BUFFER_SIZE);
+	if(error != NULL) msg->dataroot_["error"] = string(error);
+	msg->dataroot_["buffer_size"] = buffer_size;
+	return msg;
+}
+
+OutboundMessage* OutboundMessage::AckCreateAggregateDevice(const char* error) {
+	OutboundMessage *msg = new OutboundMessage(MSG_CREATE_AGGREGATE_DEVICE);
+	if(error != NULL) msg->dataroot_["error"] = string(error);
+	return msg;
+}
+
+OutboundMessage* OutboundMessage::AckRemoveAggregateDevice(const char* error) {
+	OutboundMessage *msg = new OutboundMessage(MSG_REMOVE_AGGREGATE_DEVICE);
+	if(error != NULL) msg->dataroot_["error"] = string(error);
+	return msg;
+}
+
+OutboundMessage* OutboundMessage::AckBindControl(unsigned long effect_id,
+		unsigned long param_id, bool learning, unsigned long control) {
+	OutboundMessage *msg = new OutboundMessage(MSG_BIND_CONTROL);
+	msg->dataroot_["effect_id"] = (Json::UInt) effect_id;
+	msg->dataroot_["param_id"] = (Json::UInt) param_id;
+	if(learning) msg->dataroot_["learning"] = true;
+	else {
+		msg->dataroot_["channel"] = ControlMap::getChannel(control);
+		msg->dataroot_["controller"] = ControlMap::getNumber(control);
+		msg->dataroot_["nrpn"] =
+				ControlMap::getKind(control) == ControlMap::CONTROL_NRPN;
+	}
+	return msg;
+}
+
+OutboundMessage* OutboundMessage::AckUnbindControl(const char* error) {
+	OutboundMessage *msg = new OutboundMessage(MSG_UNBIND_CONTROL);
+	if(error != NULL) msg->dataroot_["error"] = string(error);
+	return msg;
+}
+
+OutboundMessage* OutboundMessage::AckSetEffectParam(const char* error,
+		unsigned long effect_id, unsigned long param_id, double value) {
+	return new OutboundParamAck(MSG_SET_EFFECT_PARAM, error, effect_id,
+			param_id, value, true);
+}
+
+OutboundMessage* OutboundMessage::AckGetEffectParam(const char* error,
+		unsigned long effect_id, unsigned long param_id, double value) {
+	return new OutboundParamAck(MSG_GET_EFFECT_PARAM, error, effect_id,
+			param_id, value, error == NULL);
+}
+
+OutboundMessage* OutboundMessage::AckSubscribeMeters(const char* error,
+		bool subscribed) {
+	OutboundMessage *msg = new OutboundMessage(MSG_SUBSCRIBE_METERS);
+	if(error != NULL) msg->dataroot_["error"] = string(error);
+	msg->dataroot_["subscribe"] = subscribed;
+	return msg;
+}
+
+OutboundMessage* OutboundMessage::AckSubscribeSpectrum(const char* error,
+		bool subscribed) {
+	OutboundMessage *msg = new OutboundMessage(MSG_SUBSCRIBE_SPECTRUM);
+	if(error != NULL) msg->dataroot_["error"] = string(error);
+	msg->dataroot_["subscribe"] = subscribed;
+	return msg;
+}
+
+OutboundMessage* OutboundMessage::AckExportSignal(const char* error,
+		const char* path, bool exported) {
+	OutboundMessage *msg = new OutboundMessage(MSG_EXPORT_SIGNAL);
+	if(error != NULL) msg->dataroot_["error"] = string(error);
+	msg->dataroot_["path"] = string(path);
+	msg->dataroot_["export"] = exported;
+	return msg;
+}
+
 }
 
 
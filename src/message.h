@@ -13,14 +13,17 @@
 
 #include <map>
 #include <list>
+#include <vector>
 #include <string>
 #include <cstdio>
 #include <json/json.h>
 #include "llaudio/llaudio.h"
+#include "sharedbuffer.h"
 
 namespace soundalchemy {
 
 class DspServer;
+class SoundEffect;
 
 typedef enum {
 	INPUT_STREAM,
@@ -51,6 +54,8 @@ protected:
 	// This is a  general purpose data store for message data.
 	typedef Json::Value MsgDataStore;
 
+public:
+
 	/**
 	 * Each message type has a named constant identifier. It stands for a
 	 * specific command to the server. The parameters of each operation are
@@ -74,11 +79,24 @@ protected:
 		MSG_GET_STATE,          //!< Obtain the processing state
 		MSG_SEND_CLIENT_ID,     //!< Sending a channel id to a new client
 		MSG_CLIENT_OUT,
-		MSG_SET_BUFFER_SIZE
+		MSG_SET_BUFFER_SIZE,
+		MSG_SET_BYPASS,         //!< Bypass the whole chain or a single effect
+		MSG_GET_LATENCY,        //!< Get the latencies of the processing
+		MSG_MEASURE_LATENCY,    //!< Measure the round trip with a loopback
+		MSG_AUTO_TUNE_BUFFER_SIZE,//!< Find the smallest stable buffer size
+		MSG_CREATE_AGGREGATE_DEVICE,//!< Declare a device made of other ones
+		MSG_REMOVE_AGGREGATE_DEVICE,//!< Remove a declared aggregate device
+		MSG_BIND_CONTROL,       //!< Bind or learn a MIDI controller
+		MSG_UNBIND_CONTROL,     //!< Remove the controllers of a parameter
+		MSG_SUBSCRIBE_METERS,   //!< Subscribe to the level meters
+		MSG_METERS,             //!< Levels sent to the subscribed clients
+		MSG_SUBSCRIBE_SPECTRUM, //!< Subscribe to the spectrum of a point
+		MSG_SPECTRUM,           //!< Spectrum sent to the subscribed clients
+		MSG_TUNER,              //!< Reading of a tuner sent to the clients
+		MSG_EXPORT_SIGNAL,      //!< Export a point to other local processes
+		MSG_EFFECT_OVERRUN      //!< An effect was bypassed for its overruns
 	} TMessageType;
 
-public:
-
 	/**
 	 * ID of the front-end sending the message
 	 */
@@ -95,8 +113,9 @@ public:
 	 * future
 	 */
 	typedef enum {
-		PROTOCOL_JSON,//!< JSON protocol
-		PROTOCOL_MIDI //!< MIDI control protocol
+		PROTOCOL_JSON,  //!< JSON protocol
+		PROTOCOL_MIDI,  //!< MIDI control protocol
+		PROTOCOL_BINARY //!< Framed binary protocol, see BinaryProtocol
 	} TProtocol;
 
 	/**
@@ -107,6 +126,20 @@ public:
 	Message():channel_id_(ALCHEMY_SERVER) {}
 	virtual ~Message() {}
 
+	/// Count and size of the blocks of the message pool
+	static const unsigned int POOL_BLOCKS = 1024;
+	static const unsigned int POOL_BLOCK_SIZE = 160;
+
+	/**
+	 * The messages are allocated from a fixed pool of blocks and their delete
+	 * gives the blocks back, so the connectors, the queue of the server and
+	 * the replies recycle them without allocating memory. A message larger
+	 * than a block or allocated while the pool is empty comes from the heap.
+	 * The pool can be used from any thread without locking.
+	 */
+	static void* operator new(size_t size);
+	static void operator delete(void* p);
+
 	/**
 	 * @brief Get the ID of the sender front-end.
 	 * @return Returns a TChannel value.
@@ -133,6 +166,14 @@ public:
 
 	/// initializers
 	static OutboundMessage* MsgSendClientID( TChannelID id );
+	static OutboundMessage* MsgMeters( unsigned int count, const float* peak,
+			const float* rms );
+	static OutboundMessage* MsgSpectrum( unsigned long effect_id,
+			const unsigned char* levels, unsigned int count );
+	static OutboundMessage* MsgTuner( unsigned long effect_id, float frequency,
+			float cents, int note, float confidence );
+	static OutboundMessage* MsgEffectOverrun( unsigned long effect_id,
+			float time_us, float budget_us );
 	static OutboundMessage* AckStart( const char* error);
 	static OutboundMessage* AckStop( const char* error );
 	static OutboundMessage* AckExit( void );
@@ -142,9 +183,32 @@ public:
 	static OutboundMessage* AckGetState( TProcessingState state);
 	static OutboundMessage* AckClientOut( void );
 	static OutboundMessage* AckSetBufferSize( void );
-
-
-	virtual ~OutboundMessage() {}
+	static OutboundMessage* AckSetBypass( const char* error );
+	static OutboundMessage* AckGetLatency( double input_ms, double output_ms,
+			double processing_ms, double measured_ms, double control_ms,
+			double queue_ms, double start_ms, double stop_ms );
+	static OutboundMessage* AckMeasureLatency( const char* error,
+			double measured_ms );
+	static OutboundMessage* AckAutoTuneBufferSize( const char* error,
+			unsigned int buffer_size );
+	static OutboundMessage* AckCreateAggregateDevice( const char* error );
+	static OutboundMessage* AckRemoveAggregateDevice( const char* error );
+	static OutboundMessage* AckBindControl( unsigned long effect_id,
+			unsigned long param_id, bool learning, unsigned long control );
+	static OutboundMessage* AckUnbindControl( const char* error );
+	static OutboundMessage* AckSetEffectParam( const char* error,
+			unsigned long effect_id, unsigned long param_id, double value );
+	static OutboundMessage* AckGetEffectParam( const char* error,
+			unsigned long effect_id, unsigned long param_id, double value );
+	static OutboundMessage* AckSubscribeMeters( const char* error,
+			bool subscribed );
+	static OutboundMessage* AckSubscribeSpectrum( const char* error,
+			bool subscribed );
+	static OutboundMessage* AckExportSignal( const char* error,
+			const char* path, bool exported );
+
+
+	virtual ~OutboundMessage() { clearSerialized(); }
 
 	/**
 	 * @brief Convert the message to a serialized byte stream.
@@ -159,20 +223,76 @@ public:
 	virtual void serialize(TProtocol protocol, std::ostream& output,
 			int delimiter = EOF);
 
+	/**
+	 * @brief Get the message serialized in a shared buffer.
+	 *
+	 * The message is serialized only once for each protocol and delimiter,
+	 * the connectors sending it get the same buffer.
+	 *
+	 * @param protocol Specifies the protocol of the byte stream
+	 * @param delimiter Specifies the delimiter character after the byte stream
+	 * @return Returns a reference to the buffer, the caller has to release it.
+	 */
+	SharedBuffer* getSerialized(TProtocol protocol, int delimiter = EOF);
+
+	/**
+	 * @return Returns MSG_METERS or MSG_SPECTRUM for a frame sent only to
+	 * the clients subscribed to it, otherwise MSG_UNINITIALIZED.
+	 */
+	virtual TMessageType getFrameType(void) { return MSG_UNINITIALIZED; }
+
 	virtual void setChannelId(TChannelID chid) {
 		Message::setChannelId(chid);
-		dataroot_["channel_id"] = getChannelId();
+		if(!dataroot_.isNull()) dataroot_["channel_id"] = getChannelId();
+		clearSerialized();
 	}
 
+	/// The size of the buffer encode() gets
+	static const unsigned int ENCODE_SIZE = 256;
+
 protected:
 
-	OutboundMessage(TMessageType reply_for):
-		ack_for_(reply_for) {
+	/**
+	 * @param reply_for The type of the message replied to.
+	 * @param from_fields The message is encoded by encode() from its own
+	 * fields, the data store is left empty.
+	 */
+	OutboundMessage(TMessageType reply_for, bool from_fields = false):
+		ack_for_(reply_for), serialized_count_(0) {
+		if(from_fields) return;
 		dataroot_["type"] = MSG_ACK;
 		dataroot_["channel_id"] = getChannelId();
 		dataroot_["ack_for"] = reply_for;
 	}
 
+	/**
+	 * @brief Encode the message from its fields without the data store.
+	 *
+	 * @param protocol Specifies the protocol of the byte stream
+	 * @param buffer The bytes are written here.
+	 * @param size The size of the buffer.
+	 * @param delimiter Specifies the delimiter character after the byte stream
+	 * @return Returns the count of the bytes written or 0 if the message is
+	 * encoded from its data store.
+	 */
+	virtual unsigned int encode(TProtocol protocol, char* buffer,
+			unsigned int size, int delimiter) { return 0; }
+
+	void clearSerialized(void);
+
+private:
+
+	// the buffers made by getSerialized(), one for each protocol and
+	// delimiter of the connectors: JSON and binary on the sockets and JSON
+	// on Android
+	static const unsigned int MAX_SERIALIZED = 3;
+	struct Serialized {
+		TProtocol protocol;
+		int delimiter;
+		SharedBuffer* buffer;
+	};
+	Serialized serialized_[MAX_SERIALIZED];
+	unsigned int serialized_count_;
 };
 
 /**
@@ -184,14 +304,48 @@ protected:
  */
 class InboundMessage: public Message {
 	OutboundMessage* reply_;
+
+	// the link of the message in the queue of the server
+	InboundMessage* next_;
 protected:
 	void setReply(OutboundMessage* reply) { delete reply_; reply_ = reply; };
 
 public:
-	InboundMessage() { reply_ = NULL; }
+	InboundMessage() { reply_ = NULL; next_ = NULL; }
+
+	/// The messages are linked through these in the queue of the server.
+	InboundMessage* getNext(void) { return next_; }
+	void setNext(InboundMessage* next) { next_ = next; }
+
+	typedef std::pair<unsigned long, unsigned long> TCoalescingKey;
+
+	/**
+	 * @brief Get the key of a message which can be replaced by a later one.
+	 *
+	 * When consecutive messages with the same key wait in the queue of the
+	 * server only the latest one is processed and acknowledged, e.g. of the
+	 * values of a fader moved quickly.
+	 *
+	 * @param key The key is returned here.
+	 * @return Returns false if the message can't be replaced.
+	 */
+	virtual bool getCoalescingKey(TCoalescingKey& key) { return false; }
 
 	/// Public input message initializers.
 	static InboundMessage* newMsgClientOut();
+	static InboundMessage* newMsgGrowBufferSize();
+	static InboundMessage* newMsgTryBufferSize(unsigned int frames);
+	static InboundMessage* newMsgBufferSizeTuned(unsigned int frames,
+			bool stable);
+	static InboundMessage* newMsgControlLearned(unsigned long control,
+			unsigned long effect_id, unsigned long param_id);
+	static InboundMessage* newMsgPublishMeters();
+	static InboundMessage* newMsgPublishSpectrum();
+	static InboundMessage* newMsgUnsubscribe(TMessageType frames);
+	static InboundMessage* newMsgTunerReading(SoundEffect* tuner, float frequency,
+			float cents, int note, float confidence);
+	static InboundMessage* newMsgEffectOverrun(SoundEffect* effect,
+			float time_us, float budget_us);
 
 	virtual ~InboundMessage() { delete reply_; }
 
@@ -206,7 +360,8 @@ public:
 	 * outgoing message which has to be a subclass of OutboundMessage
 	 *
 	 * The setReply() method has to be called on the reply object before
-	 * returning it.
+	 * returning it. A message sending its output to some clients only
+	 * returns NULL, nothing is broadcast then.
 	 *
 	 * @param
 	 * @return Returns an OutboundMessage.
@@ -222,8 +377,35 @@ public:
 	static InboundMessage* unserialize(TProtocol protocol,
 			std::istream& stream, int delimiter = EOF);
 
+	/**
+	 * @brief Creates an InboundMessage from the payload of a binary frame.
+	 *
+	 * The fields are parsed in place from the payload and the message is
+	 * taken from the pool of the messages, nothing is allocated.
+	 * @param type The TMessageType from the header of the frame.
+	 * @param payload The payload of the frame.
+	 * @param length The length of the payload.
+	 * @return Returns a subclass of InboundMessage or NULL if the type is
+	 * unknown or the payload is too short.
+	 */
+	static InboundMessage* unserialize(unsigned int type, const char* payload,
+			unsigned int length);
+
 
 	virtual bool isExitMessage(void) { return false; }
+
+	/// @return Returns true if the client sending the message leaves.
+	virtual bool isClientOutMessage(void) { return false; }
+
+	/**
+	 * @brief Get the frames a message subscribes to or unsubscribes from.
+	 * @param subscribe True is returned here if the message subscribes.
+	 * @return Returns MSG_METERS or MSG_SPECTRUM for a subscription,
+	 * otherwise MSG_UNINITIALIZED.
+	 */
+	virtual TMessageType getSubscription(bool& subscribe) {
+		return MSG_UNINITIALIZED;
+	}
 };
 
 /**
@@ -287,8 +469,10 @@ public:
 	 * @param id
 	 * @param name
 	 * @param input
+	 * @param caps The capabilities of the stream or NULL if unknown.
 	 */
-	virtual void stream(int id, const char* name, bool input) {
+	virtual void stream(int id, const char* name, bool input,
+			const llaudio::llaStream::Capabilities* caps = NULL) {
 		current_->addStream(StreamInf( name, id), input);
 	}
 
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef METERS_H_
+#define METERS_H_
+
+#include "simd.h"
+#include <cmath>
+
+namespace soundalchemy {
+
+/**
+ * @brief Peak and RMS meters of the signals of the effect chain.
+ *
+ * The processing thread adds the samples of every cycle to the meters and
+ * the levels are taken by another thread at a much lower rate. The meters
+ * are double buffered without locking: the processing thread accumulates
+ * into one half while the other half is read. A read asks for the next
+ * frame and the processing thread swaps the halves at the end of its next
+ * cycle, so a frame holds all the cycles since the previous read. The
+ * levels of the current cycle alone are kept for the processing thread too.
+ */
+class MeterBank {
+public:
+
+	/// The most meters, the signals beyond are not metered
+	static const unsigned int MAX_METERS = 64;
+
+	/// The levels of the meters read at once
+	struct Frame {
+		unsigned int count;
+		float peak[MAX_METERS];
+		float rms[MAX_METERS];
+	};
+
+	MeterBank(): write_(0), requested_(true) {
+		clear(0);
+		clear(1);
+		clearCycle();
+	}
+
+	/**
+	 * Adds the samples of a signal to a meter. Called by the processing
+	 * thread.
+	 */
+	void add(unsigned int meter, const float* samples,
+			unsigned int sample_count) {
+		if(meter >= MAX_METERS) return;
+
+		float peak, energy;
+		simd::levels(samples, sample_count, peak, energy);
+
+		Accumulator& a = meters_[write_][meter];
+		if(peak > a.peak) a.peak = peak;
+		a.energy += energy;
+		a.samples += sample_count;
+
+		Accumulator& c = cycle_[meter];
+		if(peak > c.peak) c.peak = peak;
+		c.energy += energy;
+		c.samples += sample_count;
+	}
+
+	/**
+	 * Gets the levels of the current cycle. Called by the processing thread
+	 * before publish().
+	 * @param count The count of meters used in the cycle.
+	 * @return Returns the count of levels copied.
+	 */
+	unsigned int readCycle(float* peak, float* rms, unsigned int count) {
+		if(count > MAX_METERS) count = MAX_METERS;
+		for(unsigned int m = 0; m < count; m++) {
+			Accumulator& c = cycle_[m];
+			peak[m] = c.peak;
+			rms[m] = c.samples > 0 ? sqrtf(c.energy / c.samples) : 0.0f;
+		}
+		return count;
+	}
+
+	/**
+	 * Ends a cycle of the processing thread. The accumulated levels are
+	 * published if a read asked for them.
+	 * @param count The count of meters used in the cycle.
+	 */
+	void publish(unsigned int count) {
+		count_[write_] = count < MAX_METERS ? count : MAX_METERS;
+		clearCycle();
+		if(!requested_) return;
+
+		write_ ^= 1;
+		clear(write_);
+		__sync_synchronize();
+		requested_ = false;
+	}
+
+	/**
+	 * Reads the levels published by the processing thread and asks for the
+	 * next ones. Only one thread may read the meters.
+	 * @return Returns false if no levels have been published since the
+	 * previous read.
+	 */
+	bool read(Frame& frame) {
+		if(requested_) return false;
+		__sync_synchronize();
+
+		unsigned int half = write_ ^ 1;
+		frame.count = count_[half];
+		for(unsigned int m = 0; m < frame.count; m++) {
+			Accumulator& a = meters_[half][m];
+			frame.peak[m] = a.peak;
+			frame.rms[m] = a.samples > 0 ? sqrtf(a.energy / a.samples) : 0.0f;
+		}
+
+		__sync_synchronize();
+		requested_ = true;
+		return true;
+	}
+
+private:
+
+	struct Accumulator {
+		float peak;
+		float energy;
+		unsigned long samples;
+	};
+
+	void clear(unsigned int half) {
+		count_[half] = 0;
+		for(unsigned int m = 0; m < MAX_METERS; m++) {
+			meters_[half][m].peak = 0.0f;
+			meters_[half][m].energy = 0.0f;
+			meters_[half][m].samples = 0;
+		}
+	}
+
+	void clearCycle(void) {
+		for(unsigned int m = 0; m < MAX_METERS; m++) {
+			cycle_[m].peak = 0.0f;
+			cycle_[m].energy = 0.0f;
+			cycle_[m].samples = 0;
+		}
+	}
+
+	Accumulator meters_[2][MAX_METERS];
+	unsigned int count_[2];
+
+	// the levels of the current cycle, used by the processing thread only
+	Accumulator cycle_[MAX_METERS];
+
+	// The half written by the processing thread. It's changed only while
+	// requested_ is set, the reading thread reads the other half while it's
+	// clear.
+	volatile unsigned int write_;
+	volatile bool requested_;
+};
+
+} /* namespace soundalchemy */
+#endif /* METERS_H_ */
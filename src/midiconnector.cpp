@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "midiconnector.h"
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <time.h>
+
+namespace soundalchemy {
+
+// the time of the monotonic clock in microseconds, may wrap around
+static unsigned long now(void) {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000ul + ts.tv_nsec / 1000;
+}
+
+// MidiParser //////////////////////////////////////////////////////////////////
+//
+MidiParser::MidiParser(): status_(0), count_(0), control_(0), position_(0.0f) {
+	for(unsigned int c = 0; c < 16; c++) {
+		nrpn_[c] = NRPN_NONE;
+		data_msb_[c] = 0;
+	}
+}
+
+bool MidiParser::parse(unsigned char byte) {
+	// real time messages may come between the bytes of any other message
+	if(byte >= 0xF8) return false;
+
+	if(byte & 0x80) {
+		// a status byte, the system messages cancel the running status
+		status_ = byte < 0xF0 ? byte : 0;
+		count_ = 0;
+		return false;
+	}
+
+	// data of a system exclusive message or without a status
+	if(status_ == 0) return false;
+
+	data_[count_++] = byte;
+
+	unsigned int type = status_ & 0xF0;
+	unsigned int length = (type == 0xC0 || type == 0xD0) ? 1 : 2;
+	if(count_ < length) return false;
+
+	// running status: the following data bytes belong to the same status
+	count_ = 0;
+
+	if(type != 0xB0) return false;
+	return controller(status_ & 0x0F, data_[0], data_[1]);
+}
+
+bool MidiParser::controller(unsigned int channel, unsigned int number,
+		unsigned int value) {
+	switch(number) {
+	case CC_NRPN_MSB:
+		if(nrpn_[channel] == NRPN_NONE) nrpn_[channel] = 0;
+		nrpn_[channel] = (value << 7) | (nrpn_[channel] & 0x7F);
+		return false;
+	case CC_NRPN_LSB:
+		if(nrpn_[channel] == NRPN_NONE) nrpn_[channel] = 0;
+		nrpn_[channel] = (nrpn_[channel] & ~0x7Fu) | value;
+		return false;
+	case CC_RPN_MSB:
+	case CC_RPN_LSB:
+		// the data entry belongs to a registered parameter now
+		nrpn_[channel] = NRPN_NONE;
+		return false;
+	case CC_DATA_MSB:
+		if(nrpn_[channel] == NRPN_NONE) return false;
+		data_msb_[channel] = value;
+		control_ = ControlMap::makeId(ControlMap::CONTROL_NRPN, channel,
+				nrpn_[channel]);
+		position_ = (value << 7) / 16383.0f;
+		return true;
+	case CC_DATA_LSB:
+		if(nrpn_[channel] == NRPN_NONE) return false;
+		control_ = ControlMap::makeId(ControlMap::CONTROL_NRPN, channel,
+				nrpn_[channel]);
+		position_ = ((data_msb_[channel] << 7) | value) / 16383.0f;
+		return true;
+	default:
+		control_ = ControlMap::makeId(ControlMap::CONTROL_CC, channel, number);
+		position_ = value / 127.0f;
+		return true;
+	}
+}
+
+// MidiConnector ///////////////////////////////////////////////////////////////
+//
+MidiConnector::MidiConnector(int fd, const char* name): ClientConnector(name),
+		fd_(fd) {
+}
+
+MidiConnector::~MidiConnector() {
+	// the watcher has to exit before the descriptor is closed
+	stopWatching();
+	close(fd_);
+}
+
+MidiConnector* MidiConnector::openRawMidi(const char* device) {
+	char path[64];
+	int card, dev;
+	if(sscanf(device, "hw:%d,%d", &card, &dev) == 2) {
+		snprintf(path, sizeof(path), "/dev/snd/midiC%dD%d", card, dev);
+	}
+	else {
+		strncpy(path, device, sizeof(path) - 1);
+		path[sizeof(path) - 1] = '\0';
+	}
+
+	int fd = open(path, O_RDONLY | O_NONBLOCK);
+	if(fd < 0) {
+		log(LEVEL_ERROR, "%s: %s (%s)", STR_ERRORS[E_START_LISTENER], path,
+				strerror(errno));
+		return NULL;
+	}
+
+	return new MidiConnector(fd, device);
+}
+
+InboundMessage* MidiConnector::read(void) {
+	pollfd pfd;
+	pfd.fd = fd_;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+
+	// wait with a timeout to notice stopWatching()
+	int ret = poll(&pfd, 1, POLL_TIMEOUT_MS);
+	if(ret == 0 || (ret < 0 && errno == EINTR)) return NULL;
+
+	unsigned char bytes[256];
+	ssize_t count = ret > 0 ? ::read(fd_, bytes, sizeof(bytes)) : -1;
+	if(count < 0 && (errno == EAGAIN || errno == EINTR)) return NULL;
+
+	if(count <= 0) {
+		// the device is unplugged or the writer of the pipe exited
+		log(LEVEL_WARNING, "%s: %s", getName().c_str(), STR_ERRORS[E_READ]);
+		InboundMessage* message = InboundMessage::newMsgClientOut();
+		message->setChannelId(getChannelId());
+		return message;
+	}
+
+	// the bytes of one read are taken as arrived at the same time
+	unsigned long time = now();
+
+	InboundMessage* message = NULL;
+	for(ssize_t i = 0; i < count; i++) {
+		if(!parser_.parse(bytes[i])) continue;
+
+		ControlMap::Binding binding;
+		bool learned = getServer()->controlChanged(parser_.getControl(),
+				parser_.getPosition(), time, binding);
+
+		// the clients are told about the learned binding
+		if(learned && message == NULL) {
+			message = InboundMessage::newMsgControlLearned(
+					parser_.getControl(), binding.effect, binding.param);
+			message->setChannelId(getChannelId());
+		}
+	}
+
+	return message;
+}
+
+} /* namespace soundalchemy */
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef MIDICONNECTOR_H_
+#define MIDICONNECTOR_H_
+
+#include "clientconnector.h"
+#include "controlmap.h"
+
+namespace soundalchemy {
+
+/**
+ * @brief Parses a raw MIDI byte stream into controller events.
+ *
+ * Running status is followed and real time messages are skipped wherever
+ * they come. Control changes are given out as CONTROL_CC events, except the
+ * controllers selecting and entering a parameter number: an NRPN selected by
+ * CC 99 and 98 is given out as a CONTROL_NRPN event on every data entry by
+ * CC 6 and 38.
+ */
+class MidiParser {
+public:
+	MidiParser();
+
+	/**
+	 * Parses the next byte of the stream.
+	 * @param byte The byte.
+	 * @return Returns true if an event is completed, it can be retrieved
+	 * with getControl() and getPosition().
+	 */
+	bool parse(unsigned char byte);
+
+	/// @return Returns the controller of the last event.
+	TControlId getControl(void) { return control_; }
+
+	/// @return Returns the position of the controller between 0 and 1.
+	float getPosition(void) { return position_; }
+
+private:
+
+	// controllers of the parameter number selection and data entry
+	enum {
+		CC_DATA_MSB = 6,
+		CC_DATA_LSB = 38,
+		CC_NRPN_LSB = 98,
+		CC_NRPN_MSB = 99,
+		CC_RPN_LSB = 100,
+		CC_RPN_MSB = 101
+	};
+
+	// the selected NRPN of every channel, NRPN_NONE if an RPN or nothing
+	// is selected
+	static const unsigned int NRPN_NONE = 0x3FFF;
+
+	bool controller(unsigned int channel, unsigned int number,
+			unsigned int value);
+
+	unsigned char status_;
+	unsigned char data_[2];
+	unsigned int count_;
+
+	unsigned int nrpn_[16];
+	unsigned int data_msb_[16];
+
+	TControlId control_;
+	float position_;
+};
+
+/**
+ * @brief A client connector reading MIDI controllers.
+ *
+ * The controllers are read from a raw MIDI device or any file descriptor
+ * giving a MIDI byte stream, e.g. a pipe. The controllers bound to effect
+ * parameters are passed to the parameter worker directly through the
+ * server's ControlQueue with the time of their arrival, they don't go
+ * through the message queue. Only learning a binding produces a message.
+ */
+class MidiConnector: public ClientConnector {
+public:
+
+	/// The time read() waits for the input, the watcher stops in this time.
+	static const int POLL_TIMEOUT_MS = 100;
+
+	/**
+	 * Reads an open file descriptor. It's closed by the connector.
+	 */
+	MidiConnector(int fd, const char* name = "MIDI");
+	virtual ~MidiConnector();
+
+	/**
+	 * Opens the input of a raw MIDI device. The device node is read
+	 * directly, the same way the raw MIDI interface of ALSA does.
+	 * @param device The name of the device as "hw:card,device" or the path
+	 * of a device node.
+	 * @return Returns the connector or NULL if the device can't be opened.
+	 */
+	static MidiConnector* openRawMidi(const char* device);
+
+	/// The replies of the server aren't sent back to the MIDI device.
+	virtual void send(OutboundMessage& message) {}
+
+protected:
+
+	virtual InboundMessage* read(void);
+
+private:
+	int fd_;
+	MidiParser parser_;
+};
+
+} /* namespace soundalchemy */
+#endif /* MIDICONNECTOR_H_ */
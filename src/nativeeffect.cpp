@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "nativeeffect.h"
+#include "logs.h"
+
+namespace soundalchemy {
+
+// The registry is created on first use as the registrars of the effects run
+// during static initialization in an undefined order.
+NativeEffect::TRegistry& NativeEffect::getRegistry(void) {
+	static TRegistry registry;
+	return registry;
+}
+
+void NativeEffect::registerEffect(const std::string& short_name,
+		TFactory factory) {
+	getRegistry()[short_name] = factory;
+}
+
+NativeEffect* NativeEffect::create(const std::string& short_name,
+		llaudio::TSampleRate sample_rate) {
+	TRegistry::iterator it = getRegistry().find(short_name);
+	if(it == getRegistry().end()) {
+		log(LEVEL_ERROR, "%s: no native effect named %s",
+				STR_ERRORS[E_DATABASE], short_name.c_str());
+		return NULL;
+	}
+
+	return it->second(sample_rate);
+}
+
+void NativeEffect::NativeParam::setValue(TParamValue value) {
+	if(value < min_) value = min_;
+	else if(value > max_) value = max_;
+
+	value_ = value;
+
+	if(parent_effect_ != NULL)
+		static_cast<NativeEffect*>(parent_effect_)->paramChanged(*this);
+}
+
+} /* namespace soundalchemy */
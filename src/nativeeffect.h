@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef NATIVEEFFECT_H_
+#define NATIVEEFFECT_H_
+
+#include "soundeffect.h"
+#include <map>
+#include <string>
+
+namespace soundalchemy {
+
+/**
+ * Base class for the effects built into the server. It provides simple
+ * parameter and port implementations and a registry from which the effect
+ * database can instantiate the effects by their short name.
+ *
+ * A subclass registers itself with a static Registrar object in its source
+ * file:
+ * @code
+ * static NativeEffect::Registrar registrar("my_effect", MyEffect::create);
+ * @endcode
+ */
+class NativeEffect: public SoundEffect {
+public:
+
+	/// Function type creating a new instance of a native effect
+	typedef NativeEffect* (*TFactory)(llaudio::TSampleRate sample_rate);
+
+	/**
+	 * A helper for registering a native effect at static initialization.
+	 */
+	class Registrar {
+	public:
+		Registrar(const char* short_name, TFactory factory) {
+			registerEffect(short_name, factory);
+		}
+	};
+
+	/**
+	 * Adds a factory to the registry.
+	 * @param short_name The name used in the effect database.
+	 * @param factory The function creating the effect.
+	 */
+	static void registerEffect(const std::string& short_name, TFactory factory);
+
+	/**
+	 * Instantiates a registered native effect.
+	 * @param short_name The name of the effect given at registration.
+	 * @param sample_rate The sample rate of the processing.
+	 * @return Returns a new effect or NULL if no such effect is registered.
+	 */
+	static NativeEffect* create(const std::string& short_name,
+			llaudio::TSampleRate sample_rate);
+
+	NativeEffect(llaudio::TSampleRate sample_rate, const std::string name = ""):
+		SoundEffect(sample_rate, name) {}
+
+	virtual void activate(void) {}
+	virtual void deactivate(void) {}
+
+	/**
+	 * Loads the data file of the effect, e.g. an impulse response. The
+	 * database calls it with the plugin_file of the effect if it is set.
+	 * @param file Name together with the path of the file.
+	 * @return Returns E_OK or E_FILE if the file cannot be used.
+	 */
+	virtual TAlchemyError loadFile(const std::string& file) { return E_OK; }
+
+protected:
+
+	/**
+	 * A parameter holding its value with a range and a default.
+	 */
+	class NativeParam: public Param {
+		TParamValue value_;
+		TParamValue default_;
+		TParamValue min_;
+		TParamValue max_;
+		TParamType type_;
+		bool log_;
+
+	public:
+		NativeParam(const std::string name, TParamValue def, TParamValue min,
+				TParamValue max, TParamType type = PARAM_CONTINOUS,
+				bool logarithmic = false): Param(name), value_(def),
+				default_(def), min_(min), max_(max), type_(type),
+				log_(logarithmic) {}
+
+		TParamValue getValue() { return value_; }
+
+		// The value is clamped to the range and the parent effect is
+		// notified. This runs in the thread changing the parameter.
+		void setValue(TParamValue value);
+
+		TParamValue getDefault() { return default_; }
+		TParamValue getMin() { return min_; }
+		TParamValue getMax() { return max_; }
+		bool isLogarithmic() { return log_; }
+		TParamType getType() { return type_; }
+	};
+
+	/**
+	 * An audio port which simply stores the buffer it's connected to.
+	 */
+	class NativePort: public Port {
+		TSample *buffer_;
+	public:
+		NativePort(TPortDirection dir, const std::string name):
+			Port(dir, name), buffer_(NULL) {}
+
+		void connect(Port& port) { buffer_ = port.getBuffer(); }
+		TSample* getBuffer() { return buffer_; }
+	};
+
+	/**
+	 * Called when the value of a parameter changes. This is the place to
+	 * recompute everything derived from the parameters. It runs in the
+	 * control thread, never in the processing thread.
+	 * @param param The changed parameter.
+	 */
+	virtual void paramChanged(Param& param) {}
+
+private:
+
+	typedef std::map<std::string, TFactory> TRegistry;
+	static TRegistry& getRegistry(void);
+};
+
+} /* namespace soundalchemy */
+#endif /* NATIVEEFFECT_H_ */
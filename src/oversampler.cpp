@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "oversampler.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace soundalchemy {
+
+// half taps of the first stage and of the stages working on band limited
+// signals
+static const unsigned int FIRST_STAGE_HALF_TAPS = 8;
+static const unsigned int LATER_STAGE_HALF_TAPS = 4;
+
+// Kaiser window parameter of the filter design
+static const double KAISER_BETA = 7.0;
+
+// zeroth order modified Bessel function of the first kind
+static double besselI0(double x) {
+	double sum = 1.0, term = 1.0;
+	for(unsigned int k = 1; k < 32; k++) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+static inline float dot(const float* a, const float* b, unsigned int count) {
+	using namespace simd;
+	TVec acc = set1(0.0f);
+	for(unsigned int i = 0; i < count; i += LANES) {
+		acc = madd(load(a + i), load(b + i), acc);
+	}
+	return hsum(acc);
+}
+
+/* ************************************************************************** */
+
+Halfband::Halfband(unsigned int half_taps, unsigned int max_samples):
+		half_(half_taps), taps_(2 * half_taps), branch_(taps_),
+		fir_hist_(taps_ - 1 + max_samples, 0.0f),
+		delay_hist_(taps_ - 1 + max_samples, 0.0f) {
+
+	// windowed sinc, the taps of the FIR branch are the even taps of the
+	// filter and the middle tap is the delay branch
+	double center = 2 * half_ - 1;
+	double sum = 0.0;
+	std::vector<double> h(taps_);
+	for(unsigned int i = 0; i < taps_; i++) {
+		double d = 2 * i - center;
+		double r = d / center;
+		double w = besselI0(KAISER_BETA * sqrt(1.0 - r * r)) / besselI0(KAISER_BETA);
+		h[i] = sin(M_PI * d / 2.0) / (M_PI * d) * w;
+		sum += h[i];
+	}
+
+	// the branch gives the half of the DC gain
+	for(unsigned int i = 0; i < taps_; i++) {
+		branch_[taps_ - 1 - i] = 0.5 * h[i] / sum;
+	}
+}
+
+void Halfband::reset(void) {
+	std::fill(fir_hist_.begin(), fir_hist_.end(), 0.0f);
+	std::fill(delay_hist_.begin(), delay_hist_.end(), 0.0f);
+}
+
+void Halfband::upsample(const float* in, float* out, unsigned int sample_count) {
+	float *hist = &fir_hist_[0];
+	memcpy(hist + taps_ - 1, in, sample_count * sizeof(float));
+
+	// the zero stuffing halves the energy, the gain of 2 compensates it
+	for(unsigned int i = 0; i < sample_count; i++) {
+		out[2 * i] = 2.0f * dot(&branch_[0], hist + i, taps_);
+		out[2 * i + 1] = hist[i + half_];
+	}
+
+	memmove(hist, hist + sample_count, (taps_ - 1) * sizeof(float));
+}
+
+void Halfband::downsample(const float* in, float* out, unsigned int sample_count) {
+	float *even = &fir_hist_[0];
+	float *odd = &delay_hist_[0];
+	for(unsigned int i = 0; i < sample_count; i++) {
+		even[taps_ - 1 + i] = in[2 * i];
+		odd[taps_ - 1 + i] = in[2 * i + 1];
+	}
+
+	for(unsigned int i = 0; i < sample_count; i++) {
+		out[i] = dot(&branch_[0], even + i, taps_) + 0.5f * odd[i + half_ - 1];
+	}
+
+	memmove(even, even + sample_count, (taps_ - 1) * sizeof(float));
+	memmove(odd, odd + sample_count, (taps_ - 1) * sizeof(float));
+}
+
+/* ************************************************************************** */
+
+bool OversampledEffect::isValidFactor(unsigned int factor) {
+	return factor == 2 || factor == 4 || factor == 8;
+}
+
+OversampledEffect::OversampledEffect(SoundEffect* effect, unsigned int factor,
+		llaudio::TSampleRate sample_rate):
+		SoundEffect(sample_rate, effect->getName()), effect_(effect),
+		factor_(factor), up_(effect->getInputsCount()),
+		down_(effect->getOutputsCount()),
+		inner_in_(effect->getInputsCount(),
+				std::vector<TSample>(factor * CHUNK_SIZE, 0.0f)),
+		inner_out_(effect->getOutputsCount(),
+				std::vector<TSample>(factor * CHUNK_SIZE, 0.0f)) {
+
+	work_[0].resize(factor * CHUNK_SIZE);
+	work_[1].resize(factor * CHUNK_SIZE);
+
+	unsigned int stages = 0;
+	while((1u << stages) < factor_) stages++;
+
+	// stage s works between the rates 2^s and 2^(s+1)
+	for(unsigned int p = 0; p < up_.size(); p++) {
+		for(unsigned int s = 0; s < stages; s++) {
+			up_[p].push_back(new Halfband(s == 0 ? FIRST_STAGE_HALF_TAPS :
+					LATER_STAGE_HALF_TAPS, CHUNK_SIZE << s));
+		}
+	}
+	for(unsigned int p = 0; p < down_.size(); p++) {
+		for(unsigned int s = 0; s < stages; s++) {
+			down_[p].push_back(new Halfband(s == 0 ? FIRST_STAGE_HALF_TAPS :
+					LATER_STAGE_HALF_TAPS, CHUNK_SIZE << s));
+		}
+	}
+
+	// the inner effect works on the buffers of the wrapper, the ports of the
+	// wrapper are connected by the chain
+	for(unsigned int p = 0; p < effect_->getInputsCount(); p++) {
+		Port *in = effect_->getInputPort(p);
+		Port *port = new MixerEffect::MixerPort(INPUT_PORT, "", &inner_in_[p][0]);
+		in->connect(*port);
+		inner_ports_.push_back(port);
+		addPort(new MixerEffect::MixerPort(INPUT_PORT, in->getName()));
+	}
+	for(unsigned int p = 0; p < effect_->getOutputsCount(); p++) {
+		Port *out = effect_->getOutputPort(p);
+		Port *port = new MixerEffect::MixerPort(OUTPUT_PORT, "", &inner_out_[p][0]);
+		out->connect(*port);
+		inner_ports_.push_back(port);
+		addPort(new MixerEffect::MixerPort(OUTPUT_PORT, out->getName()));
+	}
+
+	for(unsigned int p = 0; p < effect_->getParamsCount(); p++) {
+		addParam(new ProxyParam(effect_->getParam((TParamID) p)));
+	}
+}
+
+OversampledEffect::~OversampledEffect() {
+	for(unsigned int p = 0; p < up_.size(); p++) {
+		for(TStages::iterator s = up_[p].begin(); s != up_[p].end(); s++)
+			delete *s;
+	}
+	for(unsigned int p = 0; p < down_.size(); p++) {
+		for(TStages::iterator s = down_[p].begin(); s != down_[p].end(); s++)
+			delete *s;
+	}
+	for(std::vector<Port*>::iterator p = inner_ports_.begin();
+			p != inner_ports_.end(); p++) {
+		delete *p;
+	}
+
+	delete effect_;
+}
+
+void OversampledEffect::activate(void) {
+	for(unsigned int p = 0; p < up_.size(); p++) {
+		for(TStages::iterator s = up_[p].begin(); s != up_[p].end(); s++)
+			(*s)->reset();
+	}
+	for(unsigned int p = 0; p < down_.size(); p++) {
+		for(TStages::iterator s = down_[p].begin(); s != down_[p].end(); s++)
+			(*s)->reset();
+	}
+	effect_->activate();
+}
+
+void OversampledEffect::deactivate(void) {
+	effect_->deactivate();
+}
+
+void OversampledEffect::setSampleRate(llaudio::TSampleRate srate) {
+	SoundEffect::setSampleRate(srate);
+	effect_->setSampleRate(srate * factor_);
+}
+
+unsigned int OversampledEffect::getLatency(void) {
+	// every stage delays the signal once upwards and once downwards
+	double latency = (double) effect_->getLatency() / factor_;
+	for(unsigned int s = 0; up_.size() > 0 && s < up_[0].size(); s++) {
+		latency += 2.0 * up_[0][s]->getDelay() / (2u << s);
+	}
+	return (unsigned int) (latency + 0.5);
+}
+
+unsigned int OversampledEffect::getTailLength(void) {
+	if(tail_length_ != TAIL_UNKNOWN) return tail_length_;
+
+	unsigned int tail = effect_->getTailLength();
+	if(tail == TAIL_UNKNOWN) return tail;
+	return tail / factor_ + getLatency();
+}
+
+void OversampledEffect::process(unsigned int sample_count) {
+	unsigned int done = 0;
+	while(done < sample_count) {
+		unsigned int count = sample_count - done;
+		if(count > CHUNK_SIZE) count = CHUNK_SIZE;
+
+		for(unsigned int p = 0; p < up_.size(); p++) {
+			const TSample *src = inputs_[p]->getBuffer() + done;
+			unsigned int last = up_[p].size() - 1;
+			for(unsigned int s = 0; s <= last; s++) {
+				TSample *dst = s == last ? &inner_in_[p][0] : &work_[s % 2][0];
+				up_[p][s]->upsample(src, dst, count << s);
+				src = dst;
+			}
+		}
+
+		effect_->getMutex()->lock();
+		effect_->process(count * factor_);
+		effect_->getMutex()->unlock();
+
+		for(unsigned int p = 0; p < down_.size(); p++) {
+			const TSample *src = &inner_out_[p][0];
+			for(unsigned int s = down_[p].size(); s-- > 0; ) {
+				TSample *dst = s == 0 ? outputs_[p]->getBuffer() + done :
+						&work_[s % 2][0];
+				down_[p][s]->downsample(src, dst, count << s);
+				src = dst;
+			}
+		}
+
+		done += count;
+	}
+}
+
+} /* namespace soundalchemy */
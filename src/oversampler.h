@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef OVERSAMPLER_H_
+#define OVERSAMPLER_H_
+
+#include "soundeffect.h"
+#include <vector>
+
+namespace soundalchemy {
+
+/**
+ * @brief A halfband FIR filter doubling or halving the sample rate.
+ *
+ * Every second tap of a halfband filter is zero except the middle one, so
+ * in polyphase form one branch is a FIR of 2*half_taps taps and the other
+ * one is a plain delay. An instance works in one direction only and keeps
+ * the history of that direction.
+ */
+class Halfband {
+public:
+
+	/**
+	 * @param half_taps Half of the taps of the FIR branch, it must be even.
+	 * The whole filter has 4*half_taps-1 taps.
+	 * @param max_samples The most samples passed to a call at the lower rate.
+	 */
+	Halfband(unsigned int half_taps, unsigned int max_samples);
+
+	/**
+	 * Doubles the sample rate.
+	 * @param in sample_count samples at the lower rate.
+	 * @param out 2*sample_count samples at the higher rate.
+	 */
+	void upsample(const float* in, float* out, unsigned int sample_count);
+
+	/**
+	 * Halves the sample rate.
+	 * @param in 2*sample_count samples at the higher rate.
+	 * @param out sample_count samples at the lower rate.
+	 */
+	void downsample(const float* in, float* out, unsigned int sample_count);
+
+	/// @return Returns the group delay in samples of the higher rate.
+	unsigned int getDelay(void) { return 2 * half_ - 1; }
+
+	void reset(void);
+
+private:
+
+	unsigned int half_;
+	unsigned int taps_;
+
+	// the taps of the FIR branch in reverse order
+	std::vector<float> branch_;
+
+	// histories of the FIR and the delay branch, the first taps_-1 samples
+	// are from the previous call
+	std::vector<float> fir_hist_;
+	std::vector<float> delay_hist_;
+};
+
+/**
+ * @brief Runs an effect at 2, 4 or 8 times the sample rate of the chain.
+ *
+ * The wrapper has the same parameters and the same count of ports as the
+ * wrapped effect, so the chain treats it as any other effect. The inputs are
+ * upsampled with a cascade of halfband filters, the inner effect processes
+ * them at the higher rate and the outputs are downsampled back. The processing
+ * is done in chunks of CHUNK_SIZE samples, so the internal buffers don't
+ * depend on the buffer size of the stream.
+ *
+ * The first stage has a steep filter, the later ones work on signals which
+ * are already band limited and use shorter filters.
+ */
+class OversampledEffect: public SoundEffect {
+public:
+
+	/// Count of samples at the rate of the chain processed in one round
+	static const unsigned int CHUNK_SIZE = 256;
+
+	/**
+	 * @param effect The wrapped effect, it must be created with factor times
+	 * the sample rate. The wrapper owns it.
+	 * @param factor The oversampling ratio: 2, 4 or 8.
+	 * @param sample_rate The sample rate of the chain.
+	 */
+	OversampledEffect(SoundEffect* effect, unsigned int factor,
+			llaudio::TSampleRate sample_rate);
+
+	~OversampledEffect();
+
+	void process(unsigned int sample_count);
+
+	void activate(void);
+	void deactivate(void);
+
+	void setSampleRate(llaudio::TSampleRate srate);
+
+	/// @return Returns the latency of the filters and of the inner effect.
+	unsigned int getLatency(void);
+
+	/// @return Returns the tail set on the wrapper or the one of the inner
+	/// effect delayed by the filters.
+	unsigned int getTailLength(void);
+
+	unsigned int getFactor(void) { return factor_; }
+
+	SoundEffect* getInnerEffect(void) { return effect_; }
+
+	/**
+	 * @return Returns true if the factor can be used for oversampling.
+	 */
+	static bool isValidFactor(unsigned int factor);
+
+private:
+
+	// Makes the parameters of the inner effect visible on the wrapper
+	class ProxyParam: public Param {
+		Param *param_;
+	public:
+		ProxyParam(Param* param): Param(param->getName()), param_(param) {}
+		TParamValue getValue() { return param_->getValue(); }
+		void setValue(TParamValue value) { param_->setValue(value); }
+		TParamValue getDefault() { return param_->getDefault(); }
+		TParamValue getMin() { return param_->getMin(); }
+		TParamValue getMax() { return param_->getMax(); }
+		bool isLogarithmic() { return param_->isLogarithmic(); }
+		TParamType getType() { return param_->getType(); }
+	};
+
+	// The filter stages of one port, from the rate of the chain up
+	typedef std::vector<Halfband*> TStages;
+
+	SoundEffect *effect_;
+	unsigned int factor_;
+
+	std::vector<TStages> up_;
+	std::vector<TStages> down_;
+
+	// buffers at the higher rate, one per port of the inner effect, and two
+	// work buffers for the stages between
+	std::vector<std::vector<TSample> > inner_in_;
+	std::vector<std::vector<TSample> > inner_out_;
+	std::vector<TSample> work_[2];
+
+	// ports connected to the buffers above
+	std::vector<Port*> inner_ports_;
+};
+
+} /* namespace soundalchemy */
+#endif /* OVERSAMPLER_H_ */
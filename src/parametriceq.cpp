@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "parametriceq.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace soundalchemy {
+
+static NativeEffect::Registrar registrar("parametric_eq", ParametricEq::create);
+
+// parameter ranges
+static const float FREQ_MIN = 20.0f;
+static const float FREQ_MAX = 20000.0f;
+static const float GAIN_MIN = -18.0f;
+static const float GAIN_MAX = 18.0f;
+static const float Q_MIN = 0.1f;
+static const float Q_MAX = 10.0f;
+static const float Q_DEFAULT = 0.707f;
+
+// the default band frequencies are spread logarithmically between these
+static const float FREQ_LOWEST = 100.0f;
+static const float FREQ_HIGHEST = 6400.0f;
+
+// every band has a frequency, a gain and a Q parameter in this order
+static const unsigned int PARAMS_PER_BAND = 3;
+
+void ParametricEq::Coefficients::resize(unsigned int size) {
+	b0.assign(size, 1.0f);
+	b1.assign(size, 0.0f);
+	b2.assign(size, 0.0f);
+	a1.assign(size, 0.0f);
+	a2.assign(size, 0.0f);
+}
+
+void ParametricEq::State::resize(unsigned int size) {
+	z1.resize(size);
+	z2.resize(size);
+	clear();
+}
+
+void ParametricEq::State::clear(void) {
+	std::fill(z1.begin(), z1.end(), 0.0f);
+	std::fill(z2.begin(), z2.end(), 0.0f);
+}
+
+ParametricEq::ParametricEq(llaudio::TSampleRate sample_rate,
+		unsigned int bands, unsigned int channels):
+		NativeEffect(sample_rate, "Parametric EQ"), bands_(bands),
+		channels_(channels),
+		groups_((channels + simd::LANES - 1) / simd::LANES), current_(0),
+		states_(groups_) {
+
+	banks_[0].resize(bands_ * simd::LANES);
+	banks_[1].resize(bands_ * simd::LANES);
+	for(std::vector<State>::iterator s = states_.begin(); s != states_.end(); s++) {
+		s->resize(bands_ * simd::LANES);
+	}
+
+	char name[32];
+	for(unsigned int i = 0; i < bands_; i++) {
+		float freq = FREQ_LOWEST;
+		if(bands_ > 1)
+			freq *= powf(FREQ_HIGHEST / FREQ_LOWEST, (float)i / (bands_ - 1));
+
+		snprintf(name, sizeof(name), "band%u_freq", i + 1);
+		addParam(new NativeParam(name, freq, FREQ_MIN, FREQ_MAX,
+				Param::PARAM_CONTINOUS, true));
+		snprintf(name, sizeof(name), "band%u_gain", i + 1);
+		addParam(new NativeParam(name, 0.0f, GAIN_MIN, GAIN_MAX));
+		snprintf(name, sizeof(name), "band%u_q", i + 1);
+		addParam(new NativeParam(name, Q_DEFAULT, Q_MIN, Q_MAX,
+				Param::PARAM_CONTINOUS, true));
+	}
+
+	for(unsigned int i = 0; i < channels_; i++) {
+		if(channels_ == 1) {
+			addPort(new NativePort(INPUT_PORT, "input"));
+			addPort(new NativePort(OUTPUT_PORT, "output"));
+		}
+		else {
+			snprintf(name, sizeof(name), "input_%u", i + 1);
+			addPort(new NativePort(INPUT_PORT, name));
+			snprintf(name, sizeof(name), "output_%u", i + 1);
+			addPort(new NativePort(OUTPUT_PORT, name));
+		}
+	}
+
+	updateCoefficients();
+}
+
+NativeEffect* ParametricEq::create(llaudio::TSampleRate sample_rate) {
+	return new ParametricEq(sample_rate);
+}
+
+void ParametricEq::activate(void) {
+	for(std::vector<State>::iterator s = states_.begin(); s != states_.end(); s++) {
+		s->clear();
+	}
+}
+
+void ParametricEq::setSampleRate(llaudio::TSampleRate srate) {
+	NativeEffect::setSampleRate(srate);
+	updateCoefficients();
+}
+
+void ParametricEq::paramChanged(Param& param) {
+	// the parameters are set one by one in the constructor, the coefficients
+	// are computed once all of them exist
+	if(params_.size() < bands_ * PARAMS_PER_BAND) return;
+
+	updateCoefficients();
+}
+
+ParametricEq::TBandType ParametricEq::getBandType(unsigned int band) {
+	if(band == 0 && bands_ > 1) return LOW_SHELF;
+	if(band == bands_ - 1 && bands_ > 1) return HIGH_SHELF;
+	return PEAK;
+}
+
+void ParametricEq::updateCoefficients(void) {
+	Coefficients& spare = banks_[current_ ^ 1];
+
+	for(unsigned int i = 0; i < bands_; i++) {
+		computeBand(i, spare);
+	}
+
+	// publish the new bank for the processing. The processing runs with the
+	// effect locked, so once the swap is done nobody reads the old bank and it
+	// can be overwritten by the next update.
+	bool locked = mutex_->isLockedByCurrent();
+	if(!locked) mutex_->lock();
+	__sync_synchronize();
+	current_ ^= 1;
+	if(!locked) mutex_->unlock();
+}
+
+// Audio EQ Cookbook by Robert Bristow-Johnson
+void ParametricEq::computeBand(unsigned int band, Coefficients& c) {
+	float freq = params_[band * PARAMS_PER_BAND]->getValue();
+	float gain = params_[band * PARAMS_PER_BAND + 1]->getValue();
+	float q = params_[band * PARAMS_PER_BAND + 2]->getValue();
+
+	// keep the band below the Nyquist frequency
+	if(freq > 0.49f * sample_rate_) freq = 0.49f * sample_rate_;
+
+	double A = pow(10.0, gain / 40.0);
+	double w0 = 2.0 * M_PI * freq / sample_rate_;
+	double cosw = cos(w0);
+	double alpha = sin(w0) / (2.0 * q);
+	double sqrta = 2.0 * sqrt(A) * alpha;
+
+	double b0, b1, b2, a0, a1, a2;
+	switch(getBandType(band)) {
+	case LOW_SHELF:
+		b0 = A * ((A + 1) - (A - 1) * cosw + sqrta);
+		b1 = 2 * A * ((A - 1) - (A + 1) * cosw);
+		b2 = A * ((A + 1) - (A - 1) * cosw - sqrta);
+		a0 = (A + 1) + (A - 1) * cosw + sqrta;
+		a1 = -2 * ((A - 1) + (A + 1) * cosw);
+		a2 = (A + 1) + (A - 1) * cosw - sqrta;
+		break;
+	case HIGH_SHELF:
+		b0 = A * ((A + 1) + (A - 1) * cosw + sqrta);
+		b1 = -2 * A * ((A - 1) + (A + 1) * cosw);
+		b2 = A * ((A + 1) + (A - 1) * cosw - sqrta);
+		a0 = (A + 1) - (A - 1) * cosw + sqrta;
+		a1 = 2 * ((A - 1) - (A + 1) * cosw);
+		a2 = (A + 1) - (A - 1) * cosw - sqrta;
+		break;
+	default:
+		b0 = 1 + alpha * A;
+		b1 = -2 * cosw;
+		b2 = 1 - alpha * A;
+		a0 = 1 + alpha / A;
+		a1 = -2 * cosw;
+		a2 = 1 - alpha / A;
+		break;
+	}
+
+	for(unsigned int l = band * simd::LANES; l < (band + 1) * simd::LANES; l++) {
+		c.b0[l] = b0 / a0;
+		c.b1[l] = b1 / a0;
+		c.b2[l] = b2 / a0;
+		c.a1[l] = a1 / a0;
+		c.a2[l] = a2 / a0;
+	}
+}
+
+void ParametricEq::process(unsigned int sample_count) {
+	using namespace simd;
+
+	Coefficients& c = banks_[current_];
+	if(channels_ == 1) {
+		processMono(c, sample_count);
+		return;
+	}
+
+	for(unsigned int g = 0; g < groups_; g++) {
+		// a lane without a channel or a buffer filters silence
+		TSample *in[LANES], *out[LANES];
+		for(unsigned int l = 0; l < LANES; l++) {
+			unsigned int ch = g * LANES + l;
+			in[l] = ch < channels_ ? inputs_[ch]->getBuffer() : NULL;
+			out[l] = ch < channels_ ? outputs_[ch]->getBuffer() : NULL;
+			if(in[l] == NULL || out[l] == NULL) in[l] = out[l] = NULL;
+		}
+
+		State& s = states_[g];
+		float frame[LANES];
+		for(unsigned int n = 0; n < sample_count; n++) {
+			for(unsigned int l = 0; l < LANES; l++)
+				frame[l] = in[l] != NULL ? in[l][n] : 0.0f;
+			TVec y = load(frame);
+
+			// transposed direct form II, the bands one after the other
+			for(unsigned int b = 0; b < bands_ * LANES; b += LANES) {
+				TVec x = y;
+				TVec z1 = load(&s.z1[b]);
+				TVec z2 = load(&s.z2[b]);
+				y = madd(load(&c.b0[b]), x, z1);
+				store(&s.z1[b], sub(madd(load(&c.b1[b]), x, z2),
+						mul(load(&c.a1[b]), y)));
+				store(&s.z2[b], sub(mul(load(&c.b2[b]), x),
+						mul(load(&c.a2[b]), y)));
+			}
+
+			// the input of the sample is read already, it may be in place
+			store(frame, y);
+			for(unsigned int l = 0; l < LANES; l++)
+				if(out[l] != NULL) out[l][n] = frame[l];
+		}
+	}
+}
+
+void ParametricEq::processMono(Coefficients& c, unsigned int sample_count) {
+	TSample *in = inputs_[0]->getBuffer();
+	TSample *out = outputs_[0]->getBuffer();
+	if(in == NULL || out == NULL) return;
+	if(bands_ == 0 && in != out) memcpy(out, in, sample_count * sizeof(TSample));
+
+	// the same transposed direct form II as in the lanes, a band at a time
+	// over the buffer, the bands after the first one work in place
+	State& s = states_[0];
+	const TSample *x = in;
+	for(unsigned int b = 0; b < bands_ * simd::LANES; b += simd::LANES) {
+		float b0 = c.b0[b], b1 = c.b1[b], b2 = c.b2[b];
+		float a1 = c.a1[b], a2 = c.a2[b];
+		float z1 = s.z1[b], z2 = s.z2[b];
+		for(unsigned int n = 0; n < sample_count; n++) {
+			float xn = x[n];
+			float y = b0 * xn + z1;
+			z1 = b1 * xn + z2 - a1 * y;
+			z2 = b2 * xn - a2 * y;
+			out[n] = y;
+		}
+		s.z1[b] = z1;
+		s.z2[b] = z2;
+		x = out;
+	}
+}
+
+} /* namespace soundalchemy */
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef PARAMETRICEQ_H_
+#define PARAMETRICEQ_H_
+
+#include "nativeeffect.h"
+#include "simd.h"
+#include <vector>
+
+namespace soundalchemy {
+
+/**
+ * @brief A multi-band parametric equalizer made of cascaded biquad filters.
+ *
+ * The first band is a low shelf, the last one is a high shelf and the bands
+ * between them are peaking filters. Every band has a frequency, a gain and a
+ * Q parameter named band<N>_freq, band<N>_gain and band<N>_q.
+ *
+ * The channels are computed in SIMD lanes: they are grouped by simd::LANES
+ * and every lane of a group runs the whole cascade of one channel. The bands
+ * stay serial in every lane, so the output isn't delayed. A mono equalizer
+ * would leave all but one lane empty, it runs a scalar cascade instead: the
+ * bands filter the whole buffer one after the other with their coefficients
+ * and state in registers.
+ *
+ * The filter coefficients are recomputed in the thread changing the
+ * parameters into a spare coefficient bank which is then swapped with the one
+ * used by the processing.
+ */
+class ParametricEq: public NativeEffect {
+public:
+
+	/// The band count of the effect in the database
+	static const unsigned int DEFAULT_BANDS = 4;
+
+	ParametricEq(llaudio::TSampleRate sample_rate,
+			unsigned int bands = DEFAULT_BANDS, unsigned int channels = 1);
+
+	static NativeEffect* create(llaudio::TSampleRate sample_rate);
+
+	void process(unsigned int sample_count);
+
+	void activate(void);
+
+	void setSampleRate(llaudio::TSampleRate srate);
+
+protected:
+
+	void paramChanged(Param& param);
+
+private:
+
+	typedef enum {
+		LOW_SHELF,
+		PEAK,
+		HIGH_SHELF
+	} TBandType;
+
+	// Coefficients of the biquads, normalized with a0. The arrays have
+	// bands*LANES elements, every band is repeated in the lanes of all the
+	// channels.
+	struct Coefficients {
+		std::vector<float> b0, b1, b2, a1, a2;
+		void resize(unsigned int size);
+	};
+
+	// The state of the filters for a group of channels, bands*LANES
+	// elements with the channels in the lanes.
+	struct State {
+		std::vector<float> z1, z2;
+		void resize(unsigned int size);
+		void clear(void);
+	};
+
+	// the scalar cascade of a single channel
+	void processMono(Coefficients& c, unsigned int sample_count);
+
+	// recompute all the coefficients to the spare bank and swap the banks
+	void updateCoefficients(void);
+
+	void computeBand(unsigned int band, Coefficients& c);
+
+	TBandType getBandType(unsigned int band);
+
+	unsigned int bands_;
+	unsigned int channels_;
+
+	// groups of LANES channels
+	unsigned int groups_;
+
+	Coefficients banks_[2];
+
+	// index of the bank used by the processing
+	volatile int current_;
+
+	std::vector<State> states_;
+};
+
+} /* namespace soundalchemy */
+#endif /* PARAMETRICEQ_H_ */
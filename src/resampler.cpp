@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "resampler.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace soundalchemy {
+
+// Kaiser window parameter and the passband of the filters relative to the
+// lower Nyquist frequency of the two rates
+static const double KAISER_BETA = 8.0;
+static const double PASSBAND = 0.92;
+
+static double besselI0(double x) {
+	double sum = 1.0, term = 1.0;
+	for(unsigned int k = 1; k < 32; k++) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+static unsigned int gcd(unsigned int a, unsigned int b) {
+	while(b != 0) {
+		unsigned int t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+static inline float dot(const float* a, const float* b) {
+	using namespace simd;
+	TVec acc = set1(0.0f);
+	for(unsigned int i = 0; i < Resampler::TAPS; i += LANES) {
+		acc = madd(load(a + i), load(b + i), acc);
+	}
+	return hsum(acc);
+}
+
+Resampler::Resampler(unsigned int max_input): fixed_(true), ratio_(1.0),
+		phases_(1), step_(1), phase_(0), frac_(0.0),
+		hist_(TAPS + max_input, 0.0f), fill_(0), pos_(0) {
+	setRates(1, 1);
+}
+
+void Resampler::designPhase(double frac, double cutoff, float* taps) {
+	const double half = TAPS / 2;
+	double sum = 0.0;
+	for(unsigned int j = 0; j < TAPS; j++) {
+		// distance of the tap from the position of the output sample
+		double x = j - (half - 1) - frac;
+		double r = x / half;
+		double w = r * r < 1.0 ?
+				besselI0(KAISER_BETA * sqrt(1.0 - r * r)) / besselI0(KAISER_BETA) :
+				0.0;
+		double s = x == 0.0 ? 1.0 : sin(M_PI * cutoff * x) / (M_PI * cutoff * x);
+		taps[j] = s * w;
+		sum += taps[j];
+	}
+
+	// unity gain at DC for every phase
+	for(unsigned int j = 0; j < TAPS; j++) taps[j] /= sum;
+}
+
+void Resampler::setRates(llaudio::TSampleRate in_rate,
+		llaudio::TSampleRate out_rate) {
+	ratio_ = (double) out_rate / in_rate;
+	double cutoff = ratio_ < 1.0 ? ratio_ * PASSBAND : PASSBAND;
+	if(in_rate == out_rate) cutoff = 1.0;
+
+	unsigned int d = gcd(in_rate, out_rate);
+	phases_ = out_rate / d;
+	step_ = in_rate / d;
+	fixed_ = phases_ <= MAX_FIXED_PHASES;
+
+	if(fixed_) {
+		table_.resize(phases_ * TAPS);
+		for(unsigned int p = 0; p < phases_; p++) {
+			designPhase((double) p / phases_, cutoff, &table_[p * TAPS]);
+		}
+	}
+	else {
+		// one more phase for the interpolation at the end
+		table_.resize((VARIABLE_PHASES + 1) * TAPS);
+		for(unsigned int p = 0; p <= VARIABLE_PHASES; p++) {
+			designPhase((double) p / VARIABLE_PHASES, cutoff, &table_[p * TAPS]);
+		}
+	}
+
+	reset();
+}
+
+void Resampler::setRatio(double ratio) {
+	if(fixed_) {
+		// move to the table of the variable mode keeping the position
+		frac_ = (double) phase_ / phases_;
+		double cutoff = ratio_ < 1.0 ? ratio_ * PASSBAND : PASSBAND;
+		table_.resize((VARIABLE_PHASES + 1) * TAPS);
+		for(unsigned int p = 0; p <= VARIABLE_PHASES; p++) {
+			designPhase((double) p / VARIABLE_PHASES, cutoff, &table_[p * TAPS]);
+		}
+		fixed_ = false;
+	}
+	ratio_ = ratio;
+}
+
+void Resampler::reset(void) {
+	std::fill(hist_.begin(), hist_.end(), 0.0f);
+	fill_ = TAPS / 2 - 1;
+	pos_ = 0;
+	phase_ = 0;
+	frac_ = 0.0;
+}
+
+unsigned int Resampler::getMaxOutput(unsigned int sample_count, double ratio) {
+	return (unsigned int) ceil((sample_count + 1) * ratio) + 1;
+}
+
+unsigned int Resampler::getLatency(void) {
+	return (unsigned int) (TAPS / 2 * ratio_ + 0.5);
+}
+
+unsigned int Resampler::process(const float* in, unsigned int sample_count,
+		float* out) {
+
+	memcpy(&hist_[fill_], in, sample_count * sizeof(float));
+	fill_ += sample_count;
+
+	unsigned int count = 0;
+	const float *hist = &hist_[0];
+
+	if(fixed_) {
+		const float *table = &table_[0];
+		while(pos_ + TAPS <= fill_) {
+			out[count++] = dot(table + phase_ * TAPS, hist + pos_);
+			phase_ += step_;
+			pos_ += phase_ / phases_;
+			phase_ %= phases_;
+		}
+	}
+	else {
+		double step = 1.0 / ratio_;
+		while(pos_ + TAPS <= fill_) {
+			double p = frac_ * VARIABLE_PHASES;
+			unsigned int i = (unsigned int) p;
+			float a = p - i;
+			const float *t = &table_[i * TAPS];
+			float y0 = dot(t, hist + pos_);
+			float y1 = dot(t + TAPS, hist + pos_);
+			out[count++] = y0 + a * (y1 - y0);
+
+			frac_ += step;
+			unsigned int skip = (unsigned int) frac_;
+			pos_ += skip;
+			frac_ -= skip;
+		}
+	}
+
+	// keep the samples needed by the next call
+	if(pos_ > fill_) pos_ = fill_;
+	memmove(&hist_[0], &hist_[pos_], (fill_ - pos_) * sizeof(float));
+	fill_ -= pos_;
+	pos_ = 0;
+
+	return count;
+}
+
+} /* namespace soundalchemy */
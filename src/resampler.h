@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef RESAMPLER_H_
+#define RESAMPLER_H_
+
+#include "llaudio/predef.h"
+#include <vector>
+
+namespace soundalchemy {
+
+/**
+ * @brief Polyphase windowed sinc sample rate converter for one channel.
+ *
+ * If the ratio of the rates reduces to a fraction with at most
+ * MAX_FIXED_PHASES as denominator (e.g. 44100 to 48000 is 160/147), every
+ * phase of the output has its own precomputed filter and the position is
+ * tracked exactly with integers. This is the fixed ratio fast path.
+ *
+ * Otherwise, or after setRatio() is called, the converter works in variable
+ * ratio mode: the filter table has VARIABLE_PHASES phases and the output is
+ * interpolated linearly between the two nearest phases. The ratio can be
+ * changed between two process() calls, which is needed for following the
+ * drift of two clocks.
+ *
+ * The filters are computed at setRates(), process() does no allocation.
+ */
+class Resampler {
+public:
+
+	/// Count of the filter taps for one output sample
+	static const unsigned int TAPS = 32;
+
+	/// The most phases of the fixed ratio mode
+	static const unsigned int MAX_FIXED_PHASES = 512;
+
+	/// Count of the phases of the variable ratio mode
+	static const unsigned int VARIABLE_PHASES = 256;
+
+	/**
+	 * @param max_input The most samples passed to one process() call.
+	 */
+	Resampler(unsigned int max_input);
+
+	/**
+	 * Designs the filters for converting between the two rates. The state
+	 * of the converter is reset.
+	 * @param in_rate The sample rate of the input.
+	 * @param out_rate The sample rate of the output.
+	 */
+	void setRates(llaudio::TSampleRate in_rate, llaudio::TSampleRate out_rate);
+
+	/**
+	 * Switches to variable ratio mode and sets the ratio. The filter designed
+	 * by setRates() is kept, so the ratio should stay close to the nominal.
+	 * @param ratio Output samples per input sample.
+	 */
+	void setRatio(double ratio);
+
+	/// @return Returns the output samples per input sample.
+	double getRatio(void) { return ratio_; }
+
+	/// @return Returns true if the converter uses the fixed ratio fast path.
+	bool isFixed(void) { return fixed_; }
+
+	/**
+	 * @param sample_count Count of input samples.
+	 * @param ratio The highest ratio which will be used.
+	 * @return Returns the most output samples which can be produced from
+	 * sample_count input samples.
+	 */
+	static unsigned int getMaxOutput(unsigned int sample_count, double ratio);
+
+	/**
+	 * Converts a block of samples. All the input is consumed, the samples
+	 * needed by the next call are kept internally.
+	 * @param in Input samples.
+	 * @param sample_count Count of input samples, at most max_input.
+	 * @param out The output, it must hold getMaxOutput() samples.
+	 * @return Returns the count of output samples.
+	 */
+	unsigned int process(const float* in, unsigned int sample_count, float* out);
+
+	/// Clears the history.
+	void reset(void);
+
+	/// @return Returns the delay of the filter in output samples.
+	unsigned int getLatency(void);
+
+private:
+
+	// Computes the filter for a fractional delay into taps
+	void designPhase(double frac, double cutoff, float* taps);
+
+	bool fixed_;
+	double ratio_;
+
+	// fixed mode: the position advances by step_ / phases_ input samples
+	unsigned int phases_;
+	unsigned int step_;
+	unsigned int phase_;
+
+	// variable mode: fractional position between two input samples
+	double frac_;
+
+	std::vector<float> table_;
+
+	// input history, pos_ is the first sample of the next output's window
+	std::vector<float> hist_;
+	unsigned int fill_;
+	unsigned int pos_;
+};
+
+} /* namespace soundalchemy */
+#endif /* RESAMPLER_H_ */
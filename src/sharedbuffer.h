@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef SHAREDBUFFER_H_
+#define SHAREDBUFFER_H_
+
+#include <string>
+#include <cstddef>
+
+namespace soundalchemy {
+
+/**
+ * @brief An immutable byte buffer shared by reference counting.
+ *
+ * A serialized message is queued to all the clients as the same buffer. The
+ * holders take a reference with acquire() and give it back with release()
+ * from any thread, the buffer is freed with the last reference.
+ */
+class SharedBuffer {
+public:
+
+	/**
+	 * Creates a buffer with one reference.
+	 * @param bytes The content, it's taken from the string without copying
+	 * and the string is left empty.
+	 */
+	static SharedBuffer* create(std::string& bytes) {
+		return new SharedBuffer(bytes);
+	}
+
+	/// Creates a buffer with one reference from a copy of the bytes.
+	static SharedBuffer* create(const char* bytes, size_t size) {
+		std::string copy(bytes, size);
+		return new SharedBuffer(copy);
+	}
+
+	SharedBuffer* acquire(void) {
+		__sync_add_and_fetch(&refs_, 1);
+		return this;
+	}
+
+	void release(void) {
+		if(__sync_sub_and_fetch(&refs_, 1) == 0) delete this;
+	}
+
+	const char* getData(void) const { return bytes_.data(); }
+	size_t getSize(void) const { return bytes_.size(); }
+
+private:
+	SharedBuffer(std::string& bytes): refs_(1) { bytes_.swap(bytes); }
+	~SharedBuffer() {}
+
+	std::string bytes_;
+	volatile int refs_;
+};
+
+} /* namespace soundalchemy */
+#endif /* SHAREDBUFFER_H_ */
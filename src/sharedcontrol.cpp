@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "sharedcontrol.h"
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace soundalchemy {
+
+SharedControl::SharedControl(): block_(NULL), seen_changes_(0), scanned_(0),
+		busy_(false) {
+	memset(seen_, 0, sizeof(seen_));
+}
+
+SharedControl::~SharedControl() {
+	close();
+}
+
+TAlchemyError SharedControl::open(const char* path) {
+	close();
+
+	int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0660);
+	if(fd < 0) {
+		log(LEVEL_ERROR, "%s: %s (%s)", STR_ERRORS[E_FILE], path,
+				strerror(errno));
+		return E_FILE;
+	}
+
+	size_t size = sizeof(SharedControlBlock);
+	void *p = MAP_FAILED;
+	if(ftruncate(fd, size) == 0)
+		p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	int err = errno;
+	::close(fd);
+
+	if(p == MAP_FAILED) {
+		log(LEVEL_ERROR, "%s: %s (%s)", STR_ERRORS[E_FILE], path,
+				strerror(err));
+		unlink(path);
+		return E_FILE;
+	}
+
+	block_ = (SharedControlBlock*) p;
+	memset(block_, 0, size);
+	block_->version = SharedControlBlock::VERSION;
+	block_->size = size;
+	block_->server_pid = getpid();
+
+	memset(seen_, 0, sizeof(seen_));
+	seen_changes_ = 0;
+
+	// the clients check the magic last
+	__sync_synchronize();
+	block_->magic = SharedControlBlock::MAGIC;
+
+	path_ = path;
+	log(LEVEL_INFO, "shared control block: %s", path);
+	return E_OK;
+}
+
+void SharedControl::close(void) {
+	if(block_ == NULL) return;
+
+	block_->magic = 0;
+	munmap(block_, sizeof(SharedControlBlock));
+	block_ = NULL;
+
+	unlink(path_.c_str());
+	path_.clear();
+}
+
+} /* namespace soundalchemy */
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef SHAREDCONTROL_H_
+#define SHAREDCONTROL_H_
+
+#include "logs.h"
+#include <stdint.h>
+#include <string>
+
+namespace soundalchemy {
+
+/**
+ * The layout of the shared control block. Local clients map the same file
+ * and use it without any system call: they write the parameter slots and
+ * read the status and the meters published by the processing thread in
+ * every cycle. Only fixed size types are used so 32 and 64 bit processes
+ * see the same layout.
+ *
+ * Every section is guarded by a sequence lock. Its sequence is odd while
+ * the section is written. A reader copies the section and accepts the copy
+ * if the sequence was even and didn't change meanwhile:
+ *
+ *   do {
+ *       seq = section.seq;
+ *       __sync_synchronize();
+ *       copy = section;
+ *       __sync_synchronize();
+ *   } while((seq & 1) || seq != section.seq);
+ *
+ * The parameter slots are written by the clients. A client takes a slot by
+ * moving its even sequence to odd with a compare and swap, writes the
+ * target and the value, makes the sequence even again and increments
+ * param_changes:
+ *
+ *   seq = slot.seq;
+ *   if(!(seq & 1) && __sync_bool_compare_and_swap(&slot.seq, seq, seq + 1)) {
+ *       slot.effect_id = effect; slot.param_id = param; slot.value = value;
+ *       __sync_synchronize();
+ *       slot.seq = seq + 2;
+ *       __sync_add_and_fetch(&block->param_changes, 1);
+ *   }
+ *
+ * The processing thread notices the changes in every cycle and the server
+ * applies the changed slots outside the processing thread. A slot holds the
+ * latest value written to it, a client keeps using the same slot for the same
+ * parameter.
+ */
+struct SharedControlBlock {
+
+	static const uint32_t MAGIC = 0x53414c43; // "SALC"
+	static const uint32_t VERSION = 1;
+
+	/// The count of the parameter slots
+	static const unsigned int MAX_PARAMS = 256;
+
+	/// The count of the meters, the same as MeterBank::MAX_METERS
+	static const unsigned int MAX_METERS = 64;
+
+	/// A parameter of an effect set by a client
+	struct Param {
+		volatile uint32_t seq;
+		uint32_t effect_id;  //!< the ID of the effect in the chain, 0 is the input
+		uint32_t param_id;   //!< the ID of the parameter of the effect
+		float value;
+	};
+
+	/// The state and the load of the processing, written in every cycle
+	struct Status {
+		volatile uint32_t seq;
+		uint32_t state;      //!< a TProcessingState
+		uint32_t sample_rate;//!< the rate of the device
+		uint32_t buffer_size;//!< frames of a cycle
+		uint32_t cycles;     //!< processed cycles
+		uint32_t overloads;  //!< cycles above the load limit
+		uint32_t xruns;      //!< over- and underruns of the streams
+		uint32_t busy_us;    //!< time spent in the graph, wraps around
+		uint32_t period_us;  //!< audio time of the cycles, wraps around
+		uint32_t cycle_busy_us;  //!< time spent in the graph in the last cycle
+		uint32_t cycle_period_us;//!< audio time of the last cycle
+	};
+
+	/// The levels of the last cycle, the meter of an effect has the index
+	/// of its ID, the output is the last one
+	struct Meters {
+		volatile uint32_t seq;
+		uint32_t count;
+		float peak[MAX_METERS];
+		float rms[MAX_METERS];
+	};
+
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;       //!< the size of the block in bytes
+	uint32_t server_pid;
+
+	/// incremented by the clients after writing a slot
+	volatile uint32_t param_changes;
+
+	Status status;
+	Meters meters;
+	Param params[MAX_PARAMS];
+};
+
+/**
+ * @brief The server side of the shared control block.
+ *
+ * The block is a file mapped into the memory of the server and the local
+ * clients. The processing thread publishes the status and the meters
+ * through it in every cycle without locking or system calls. The parameters
+ * written by the clients are scanned by a single other thread, the
+ * processing thread only checks if there are any.
+ */
+class SharedControl {
+public:
+
+	typedef SharedControlBlock::Param TParam;
+
+	SharedControl();
+	~SharedControl();
+
+	/**
+	 * Creates the block and maps it. The file is created or truncated and
+	 * its content is reset.
+	 * @param path The path of the file, on a tmpfs preferably.
+	 * @return Returns E_OK or E_FILE if it can't be created or mapped.
+	 */
+	TAlchemyError open(const char* path);
+
+	/**
+	 * Unmaps the block and removes the file.
+	 */
+	void close(void);
+
+	bool isOpen(void) { return block_ != NULL; }
+
+	/**
+	 * Returns true if a slot may have changed since the last complete scan.
+	 * Only a counter is read, the processing thread may call it during a
+	 * scan.
+	 */
+	bool hasParamChanges(void) {
+		return block_->param_changes != seen_changes_;
+	}
+
+	/**
+	 * Starts applying the parameters.
+	 * @return Returns false if no slot has changed since the last complete
+	 * scan.
+	 */
+	bool beginParamScan(void) {
+		scanned_ = block_->param_changes;
+		busy_ = false;
+		return scanned_ != seen_changes_;
+	}
+
+	/**
+	 * Reads a parameter slot.
+	 * @param slot The index of the slot below MAX_PARAMS.
+	 * @param param The content of the slot.
+	 * @return Returns true if the slot has changed since it was read last.
+	 * A slot being written is read again in the next scan.
+	 */
+	bool readParam(unsigned int slot, TParam& param) {
+		TParam& p = block_->params[slot];
+		uint32_t seq = p.seq;
+		if(seq == seen_[slot]) return false;
+		if(seq & 1) {
+			busy_ = true;
+			return false;
+		}
+
+		__sync_synchronize();
+		param.effect_id = p.effect_id;
+		param.param_id = p.param_id;
+		param.value = p.value;
+		__sync_synchronize();
+
+		if(p.seq != seq) {
+			busy_ = true;
+			return false;
+		}
+		seen_[slot] = seq;
+		return true;
+	}
+
+	/// Ends the scan started by beginParamScan().
+	void endParamScan(void) {
+		if(!busy_) seen_changes_ = scanned_;
+	}
+
+	/// The status to be filled between beginStatus() and endStatus().
+	SharedControlBlock::Status& beginStatus(void) {
+		beginWrite(block_->status.seq);
+		return block_->status;
+	}
+
+	void endStatus(void) { endWrite(block_->status.seq); }
+
+	/// The meters to be filled between beginMeters() and endMeters().
+	SharedControlBlock::Meters& beginMeters(void) {
+		beginWrite(block_->meters.seq);
+		return block_->meters;
+	}
+
+	void endMeters(void) { endWrite(block_->meters.seq); }
+
+private:
+
+	static void beginWrite(volatile uint32_t& seq) {
+		seq = seq + 1;
+		__sync_synchronize();
+	}
+
+	static void endWrite(volatile uint32_t& seq) {
+		__sync_synchronize();
+		seq = seq + 1;
+	}
+
+	SharedControlBlock* block_;
+	std::string path_;
+
+	// The sequences of the slots and the count of the changes seen by the
+	// last complete scan. A scan is incomplete if a slot was being written.
+	uint32_t seen_[SharedControlBlock::MAX_PARAMS];
+	volatile uint32_t seen_changes_;
+	uint32_t scanned_;
+	bool busy_;
+};
+
+} /* namespace soundalchemy */
+#endif /* SHAREDCONTROL_H_ */
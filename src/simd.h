@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef SIMD_H_
+#define SIMD_H_
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define SIMD_NEON
+#include <arm_neon.h>
+#elif defined(__SSE__)
+#define SIMD_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace soundalchemy {
+
+/**
+ * A thin layer over the vector instruction sets of the supported targets.
+ * The native effects use these 4 lane float vectors so the same code runs
+ * with NEON on ARM, SSE on x86 and in plain C everywhere else.
+ */
+namespace simd {
+
+/// The count of float lanes in a vector
+const unsigned int LANES = 4;
+
+#if defined(SIMD_NEON)
+
+typedef float32x4_t TVec;
+
+inline TVec load(const float* p) { return vld1q_f32(p); }
+inline void store(float* p, TVec v) { vst1q_f32(p, v); }
+inline TVec set1(float f) { return vdupq_n_f32(f); }
+inline TVec add(TVec a, TVec b) { return vaddq_f32(a, b); }
+inline TVec sub(TVec a, TVec b) { return vsubq_f32(a, b); }
+inline TVec mul(TVec a, TVec b) { return vmulq_f32(a, b); }
+inline TVec madd(TVec a, TVec b, TVec c) { return vmlaq_f32(c, a, b); }
+inline TVec abs(TVec a) { return vabsq_f32(a); }
+inline TVec max(TVec a, TVec b) { return vmaxq_f32(a, b); }
+inline TVec min(TVec a, TVec b) { return vminq_f32(a, b); }
+
+inline float hsum(TVec v) {
+	float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+	return vget_lane_f32(vpadd_f32(s, s), 0);
+}
+
+inline float hmax(TVec v) {
+	float32x2_t m = vmax_f32(vget_low_f32(v), vget_high_f32(v));
+	return vget_lane_f32(vpmax_f32(m, m), 0);
+}
+
+#elif defined(SIMD_SSE)
+
+typedef __m128 TVec;
+
+inline TVec load(const float* p) { return _mm_loadu_ps(p); }
+inline void store(float* p, TVec v) { _mm_storeu_ps(p, v); }
+inline TVec set1(float f) { return _mm_set1_ps(f); }
+inline TVec add(TVec a, TVec b) { return _mm_add_ps(a, b); }
+inline TVec sub(TVec a, TVec b) { return _mm_sub_ps(a, b); }
+inline TVec mul(TVec a, TVec b) { return _mm_mul_ps(a, b); }
+inline TVec madd(TVec a, TVec b, TVec c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+inline TVec abs(TVec a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline TVec max(TVec a, TVec b) { return _mm_max_ps(a, b); }
+inline TVec min(TVec a, TVec b) { return _mm_min_ps(a, b); }
+
+inline float hsum(TVec v) {
+	TVec s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+	s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+	return _mm_cvtss_f32(s);
+}
+
+inline float hmax(TVec v) {
+	TVec m = _mm_max_ps(v, _mm_movehl_ps(v, v));
+	m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+	return _mm_cvtss_f32(m);
+}
+
+#else
+
+struct TVec { float v[4]; };
+
+inline TVec load(const float* p) {
+	TVec r; for(unsigned int i = 0; i < 4; i++) r.v[i] = p[i]; return r;
+}
+inline void store(float* p, TVec a) { for(unsigned int i = 0; i < 4; i++) p[i] = a.v[i]; }
+inline TVec set1(float f) { TVec r; for(unsigned int i = 0; i < 4; i++) r.v[i] = f; return r; }
+inline TVec add(TVec a, TVec b) {
+	for(unsigned int i = 0; i < 4; i++) a.v[i] += b.v[i]; return a;
+}
+inline TVec sub(TVec a, TVec b) {
+	for(unsigned int i = 0; i < 4; i++) a.v[i] -= b.v[i]; return a;
+}
+inline TVec mul(TVec a, TVec b) {
+	for(unsigned int i = 0; i < 4; i++) a.v[i] *= b.v[i]; return a;
+}
+inline TVec madd(TVec a, TVec b, TVec c) {
+	for(unsigned int i = 0; i < 4; i++) c.v[i] += a.v[i]*b.v[i]; return c;
+}
+inline TVec abs(TVec a) {
+	for(unsigned int i = 0; i < 4; i++) a.v[i] = a.v[i] < 0 ? -a.v[i] : a.v[i]; return a;
+}
+inline TVec max(TVec a, TVec b) {
+	for(unsigned int i = 0; i < 4; i++) if(b.v[i] > a.v[i]) a.v[i] = b.v[i]; return a;
+}
+inline TVec min(TVec a, TVec b) {
+	for(unsigned int i = 0; i < 4; i++) if(b.v[i] < a.v[i]) a.v[i] = b.v[i]; return a;
+}
+inline float hsum(TVec a) { return a.v[0] + a.v[1] + a.v[2] + a.v[3]; }
+inline float hmax(TVec a) {
+	float m = a.v[0];
+	for(unsigned int i = 1; i < 4; i++) if(a.v[i] > m) m = a.v[i];
+	return m;
+}
+
+#endif
+
+/**
+ * @return Returns the highest absolute value of the samples.
+ */
+inline float peak(const float* p, unsigned int sample_count) {
+	TVec m = set1(0.0f);
+	unsigned int i = 0;
+	for(; i + LANES <= sample_count; i += LANES) m = max(m, abs(load(p + i)));
+
+	float r = hmax(m);
+	for(; i < sample_count; i++) {
+		float s = p[i] < 0 ? -p[i] : p[i];
+		if(s > r) r = s;
+	}
+	return r;
+}
+
+/**
+ * Finds the highest absolute value and the sum of the squares of the samples
+ * in one pass.
+ */
+inline void levels(const float* p, unsigned int sample_count, float& peak,
+		float& energy) {
+	TVec m = set1(0.0f);
+	TVec e = set1(0.0f);
+	unsigned int i = 0;
+	for(; i + LANES <= sample_count; i += LANES) {
+		TVec v = load(p + i);
+		m = max(m, abs(v));
+		e = madd(v, v, e);
+	}
+
+	peak = hmax(m);
+	energy = hsum(e);
+	for(; i < sample_count; i++) {
+		float s = p[i] < 0 ? -p[i] : p[i];
+		if(s > peak) peak = s;
+		energy += p[i] * p[i];
+	}
+}
+
+/**
+ * @return Returns the sum of the products of the samples of two buffers.
+ */
+inline float dot(const float* a, const float* b, unsigned int sample_count) {
+	TVec s = set1(0.0f);
+	unsigned int i = 0;
+	for(; i + LANES <= sample_count; i += LANES)
+		s = madd(load(a + i), load(b + i), s);
+
+	float r = hsum(s);
+	for(; i < sample_count; i++) r += a[i] * b[i];
+	return r;
+}
+
+/**
+ * Makes the floating point unit of the calling thread flush denormal results
+ * and inputs to zero. Decaying feedback loops of effects produce denormals
+ * which are many times slower to compute with on most processors.
+ */
+inline void disableDenormals(void) {
+#if defined(__aarch64__)
+	unsigned long fpcr;
+	__asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+	__asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr | (1ul << 24)));
+#elif defined(__arm__) && defined(__VFP_FP__) && !defined(__SOFTFP__)
+	// NEON always flushes denormals, the FZ bit is for the VFP instructions
+	unsigned int fpscr;
+	__asm__ __volatile__("vmrs %0, fpscr" : "=r"(fpscr));
+	__asm__ __volatile__("vmsr fpscr, %0" : : "r"(fpscr | (1u << 24)));
+#elif defined(SIMD_SSE)
+	// flush to zero and denormals are zero
+	_mm_setcsr(_mm_getcsr() | 0x8040);
+#endif
+}
+
+} /* namespace simd */
+} /* namespace soundalchemy */
+#endif /* SIMD_H_ */
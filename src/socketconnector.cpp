@@ -0,0 +1,495 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "socketconnector.h"
+#include "binaryprotocol.h"
+#include <sstream>
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+namespace soundalchemy {
+
+// the events handled by one turn of the loop
+static const int MAX_EVENTS = 64;
+
+// the buffers written by one call
+static const unsigned int MAX_IOV = 64;
+
+// the frames the clients subscribe to
+static const Message::TMessageType FRAMES[] = { Message::MSG_METERS,
+		Message::MSG_SPECTRUM };
+
+// the bit of a type of frames in the subscriptions of a client
+static unsigned int frameBit(Message::TMessageType frames) {
+	return frames == Message::MSG_METERS ? 1 : 2;
+}
+
+static bool setNonBlocking(int fd) {
+	int flags = fcntl(fd, F_GETFL, 0);
+	return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+SocketConnector::SocketConnector(const char* name): ClientConnector(name),
+		output_mutex_(Thread::getMutex()) {
+	epoll_ = epoll_create(MAX_EVENTS);
+	wakeup_ = eventfd(0, 0);
+	setNonBlocking(wakeup_);
+
+	epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.fd = wakeup_;
+	epoll_ctl(epoll_, EPOLL_CTL_ADD, wakeup_, &event);
+}
+
+SocketConnector::~SocketConnector() {
+	// the loop has to exit before the sockets are closed
+	stopWatching();
+
+	while(!clients_.empty()) closeClient(clients_.begin()->second);
+
+	for(unsigned int i = 0; i < listeners_.size(); i++) close(listeners_[i]);
+	for(unsigned int i = 0; i < unix_paths_.size(); i++) {
+		unlink(unix_paths_[i].c_str());
+	}
+
+	for(unsigned int i = 0; i < messages_.size(); i++) delete messages_[i];
+
+	close(wakeup_);
+	close(epoll_);
+	delete output_mutex_;
+}
+
+int SocketConnector::addListener(int fd) {
+	if(listen(fd, SOMAXCONN) < 0 || !setNonBlocking(fd)) return -1;
+
+	epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.fd = fd;
+	if(epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &event) < 0) return -1;
+
+	listeners_.push_back(fd);
+	return fd;
+}
+
+TAlchemyError SocketConnector::listenUnix(const char* path) {
+	sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+
+	size_t length = strlen(path);
+	if(length >= sizeof(addr.sun_path)) return E_START_LISTENER;
+	memcpy(addr.sun_path, path, length);
+
+	bool abstract = path[0] == '@';
+	if(abstract) addr.sun_path[0] = '\0';
+	else unlink(path);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	socklen_t size = offsetof(sockaddr_un, sun_path) + length;
+	if(fd < 0 || bind(fd, (sockaddr*) &addr, size) < 0 || addListener(fd) < 0) {
+		log(LEVEL_ERROR, "%s: %s (%s)", STR_ERRORS[E_START_LISTENER], path,
+				strerror(errno));
+		if(fd >= 0) close(fd);
+		return E_START_LISTENER;
+	}
+
+	if(!abstract) unix_paths_.push_back(path);
+	log(LEVEL_INFO, "%s listens on %s", getName().c_str(), path);
+	return E_OK;
+}
+
+TAlchemyError SocketConnector::listenTcp(unsigned short port,
+		const char* address) {
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	if(inet_aton(address, &addr.sin_addr) == 0) return E_START_LISTENER;
+
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+	int on = 1;
+	if(fd >= 0) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	if(fd < 0 || bind(fd, (sockaddr*) &addr, sizeof(addr)) < 0 ||
+			addListener(fd) < 0) {
+		log(LEVEL_ERROR, "%s: %s:%u (%s)", STR_ERRORS[E_START_LISTENER],
+				address, port, strerror(errno));
+		if(fd >= 0) close(fd);
+		return E_START_LISTENER;
+	}
+
+	log(LEVEL_INFO, "%s listens on %s:%u", getName().c_str(), address, port);
+	return E_OK;
+}
+
+unsigned int SocketConnector::getClientsCount(void) {
+	output_mutex_->lock();
+	unsigned int count = clients_.size();
+	output_mutex_->unlock();
+	return count;
+}
+
+void SocketConnector::queue(Client* client, SharedBuffer* buffer) {
+	if(client->dropped) return;
+
+	if(client->pending + buffer->getSize() > OUTPUT_MAX) {
+		client->dropped = true;
+		return;
+	}
+	client->output.push_back(buffer->acquire());
+	client->pending += buffer->getSize();
+}
+
+void SocketConnector::send(OutboundMessage& message) {
+	// the message is serialized once for each protocol
+	SharedBuffer* buffers[2] = { NULL, NULL };
+
+	Message::TMessageType frames = message.getFrameType();
+	unsigned int bit = frames == Message::MSG_UNINITIALIZED ? 0 :
+			frameBit(frames);
+
+	output_mutex_->lock();
+	for(TClients::iterator it = clients_.begin(); it != clients_.end(); it++) {
+		Client* client = it->second;
+		if(bit != 0 && !(client->subscriptions & bit)) continue;
+
+		int p = client->protocol == Message::PROTOCOL_BINARY ? 1 : 0;
+		if(buffers[p] == NULL) {
+			buffers[p] = message.getSerialized(client->protocol, DELIMITER);
+		}
+		queue(client, buffers[p]);
+	}
+	output_mutex_->unlock();
+
+	for(int p = 0; p < 2; p++) {
+		if(buffers[p] != NULL) buffers[p]->release();
+	}
+
+	// the loop writes the output
+	uint64_t one = 1;
+	if(write(wakeup_, &one, sizeof(one)) < 0) {
+		// the counter is full, the loop is woken up anyway
+	}
+}
+
+void SocketConnector::accept(int listener) {
+	for(;;) {
+		int fd = ::accept(listener, NULL, NULL);
+		if(fd < 0) break;
+
+		if(clients_.size() >= MAX_CLIENTS || !setNonBlocking(fd)) {
+			log(LEVEL_WARNING, "%s refused a client", getName().c_str());
+			close(fd);
+			continue;
+		}
+
+		// replies are small, they shouldn't wait for more data
+		int on = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+		Client* client = new Client(fd);
+		output_mutex_->lock();
+		clients_[fd] = client;
+		output_mutex_->unlock();
+
+		update(client);
+	}
+}
+
+void SocketConnector::update(Client* client) {
+	output_mutex_->lock();
+	size_t pending = client->pending;
+	output_mutex_->unlock();
+
+	unsigned int events = 0;
+	if(pending < OUTPUT_HIGH_WATER) events |= EPOLLIN;
+	if(pending > 0) events |= EPOLLOUT;
+
+	if(events == client->events) return;
+
+	epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = events;
+	event.data.fd = client->fd;
+	epoll_ctl(epoll_, client->events == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD,
+			client->fd, &event);
+	client->events = events;
+}
+
+void SocketConnector::closeClient(Client* client) {
+	if(client->dropped) {
+		log(LEVEL_WARNING, "%s dropped a slow client", getName().c_str());
+	}
+
+	epoll_ctl(epoll_, EPOLL_CTL_DEL, client->fd, NULL);
+	close(client->fd);
+
+	output_mutex_->lock();
+	clients_.erase(client->fd);
+	bool last[2];
+	for(unsigned int i = 0; i < 2; i++) {
+		unsigned int bit = frameBit(FRAMES[i]);
+		last[i] = (client->subscriptions & bit) && countSubscribers(bit) == 0;
+	}
+	output_mutex_->unlock();
+
+	// the server stops the frames nobody is subscribed to anymore
+	for(unsigned int i = 0; i < 2; i++) {
+		if(!last[i]) continue;
+		InboundMessage* message = InboundMessage::newMsgUnsubscribe(FRAMES[i]);
+		message->setChannelId(getChannelId());
+		messages_.push_back(message);
+	}
+
+	for(unsigned int i = 0; i < client->output.size(); i++) {
+		client->output[i]->release();
+	}
+
+	delete client;
+}
+
+unsigned int SocketConnector::countSubscribers(unsigned int bit) {
+	unsigned int count = 0;
+	for(TClients::iterator it = clients_.begin(); it != clients_.end(); it++) {
+		if(it->second->subscriptions & bit) count++;
+	}
+	return count;
+}
+
+bool SocketConnector::subscribe(Client* client, InboundMessage& message) {
+	bool subscribe;
+	Message::TMessageType frames = message.getSubscription(subscribe);
+	if(frames == Message::MSG_UNINITIALIZED) return true;
+
+	// send() reads the subscriptions from the thread of the server
+	unsigned int bit = frameBit(frames);
+	output_mutex_->lock();
+	if(subscribe) client->subscriptions |= bit;
+	else client->subscriptions &= ~bit;
+	unsigned int others = countSubscribers(bit);
+	output_mutex_->unlock();
+
+	if(subscribe || others == 0) return true;
+
+	// the other clients still get the frames, only this one is acknowledged
+	reply(client, frames == Message::MSG_METERS ?
+			OutboundMessage::AckSubscribeMeters(NULL, false) :
+			OutboundMessage::AckSubscribeSpectrum(NULL, false));
+	return false;
+}
+
+void SocketConnector::reply(Client* client, OutboundMessage* message) {
+	message->setChannelId(getChannelId());
+	SharedBuffer* buffer = message->getSerialized(client->protocol, DELIMITER);
+	output_mutex_->lock();
+	queue(client, buffer);
+	output_mutex_->unlock();
+	buffer->release();
+	delete message;
+}
+
+bool SocketConnector::receive(Client* client) {
+	char bytes[4096];
+	for(;;) {
+		ssize_t count = ::recv(client->fd, bytes, sizeof(bytes), 0);
+		if(count > 0) client->input.append(bytes, count);
+		else if(count == 0) {
+			// the messages sent before the client left are still served
+			parse(client);
+			return false;
+		}
+		else if(errno == EINTR) continue;
+		else if(errno == EAGAIN || errno == EWOULDBLOCK) break;
+		else return false;
+
+		// a long input is parsed at once, it can't grow without limit
+		if(count < (ssize_t) sizeof(bytes)) break;
+		if(client->input.size() > BinaryProtocol::MAX_PAYLOAD) break;
+	}
+	return parse(client);
+}
+
+bool SocketConnector::parse(Client* client) {
+	std::string& input = client->input;
+
+	if(!client->negotiated && !input.empty()) {
+		// send() reads the protocol from the thread of the server
+		output_mutex_->lock();
+		if(input[0] == BinaryProtocol::MAGIC_0) {
+			client->protocol = Message::PROTOCOL_BINARY;
+		}
+		output_mutex_->unlock();
+		client->negotiated = true;
+	}
+
+	size_t pos = 0;
+	for(;;) {
+		InboundMessage* message = NULL;
+
+		if(client->protocol == Message::PROTOCOL_BINARY) {
+			if(input.size() - pos < BinaryProtocol::HEADER_SIZE) break;
+
+			unsigned int type, length;
+			if(!BinaryProtocol::parseHeader(input.data() + pos, type, length)) {
+				return false;
+			}
+			if(input.size() - pos < BinaryProtocol::HEADER_SIZE + length) break;
+
+			pos += BinaryProtocol::HEADER_SIZE;
+			message = InboundMessage::unserialize(type, input.data() + pos,
+					length);
+			pos += length;
+		}
+		else {
+			size_t end = input.find(DELIMITER, pos);
+			if(end == std::string::npos) {
+				if(input.size() - pos > BinaryProtocol::MAX_PAYLOAD) return false;
+				break;
+			}
+
+			std::istringstream stream(input.substr(pos, end - pos + 1));
+			message = InboundMessage::unserialize(client->protocol, stream,
+					DELIMITER);
+			pos = end + 1;
+		}
+
+		if(message == NULL) {
+			log(LEVEL_WARNING, STR_ERRORS[E_READ]);
+			continue;
+		}
+		if(message->isExitMessage() || message->isClientOutMessage()) {
+			// only this client leaves, it's closed after its acknowledgement
+			delete message;
+			reply(client, OutboundMessage::AckClientOut());
+			flush(client);
+			return false;
+		}
+		if(!subscribe(client, *message)) {
+			delete message;
+			continue;
+		}
+		message->setChannelId(getChannelId());
+		messages_.push_back(message);
+	}
+
+	input.erase(0, pos);
+	return true;
+}
+
+bool SocketConnector::flush(Client* client) {
+	bool ok = true;
+
+	output_mutex_->lock();
+	while(!client->output.empty()) {
+		// the queued buffers are written at once without copying
+		iovec iov[MAX_IOV];
+		unsigned int count = 0;
+		for(; count < MAX_IOV && count < client->output.size(); count++) {
+			SharedBuffer* buffer = client->output[count];
+			size_t offset = count == 0 ? client->sent : 0;
+			iov[count].iov_base = (void*) (buffer->getData() + offset);
+			iov[count].iov_len = buffer->getSize() - offset;
+		}
+
+		msghdr msg;
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = count;
+		ssize_t written = sendmsg(client->fd, &msg, MSG_NOSIGNAL);
+		if(written < 0 && errno == EINTR) continue;
+		if(written <= 0) {
+			ok = written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+			break;
+		}
+
+		// the buffers written completely are released
+		client->pending -= written;
+		size_t left = written + client->sent;
+		while(!client->output.empty() &&
+				left >= client->output.front()->getSize()) {
+			left -= client->output.front()->getSize();
+			client->output.front()->release();
+			client->output.pop_front();
+		}
+		client->sent = left;
+	}
+	if(client->dropped) ok = false;
+	output_mutex_->unlock();
+
+	return ok;
+}
+
+InboundMessage* SocketConnector::read(void) {
+	if(messages_.empty()) {
+		epoll_event events[MAX_EVENTS];
+		int count = epoll_wait(epoll_, events, MAX_EVENTS, POLL_TIMEOUT_MS);
+
+		bool woken = false;
+		for(int i = 0; i < count; i++) {
+			int fd = events[i].data.fd;
+
+			if(fd == wakeup_) {
+				uint64_t value;
+				while(::read(wakeup_, &value, sizeof(value)) > 0) ;
+				woken = true;
+				continue;
+			}
+
+			TClients::iterator it = clients_.find(fd);
+			if(it == clients_.end()) {
+				accept(fd);
+				continue;
+			}
+
+			Client* client = it->second;
+			bool ok = !(events[i].events & EPOLLERR);
+			if(ok && (events[i].events & (EPOLLIN | EPOLLHUP))) {
+				ok = receive(client);
+			}
+			if(ok && (events[i].events & EPOLLOUT)) ok = flush(client);
+
+			if(ok) update(client);
+			else closeClient(client);
+		}
+
+		// the output queued by send() is written right away, the sockets
+		// which can't take it all are watched for EPOLLOUT
+		if(woken) {
+			std::vector<Client*> closed;
+			for(TClients::iterator it = clients_.begin(); it != clients_.end();
+					it++) {
+				if(flush(it->second)) update(it->second);
+				else closed.push_back(it->second);
+			}
+			for(unsigned int i = 0; i < closed.size(); i++) closeClient(closed[i]);
+		}
+	}
+
+	if(messages_.empty()) return NULL;
+
+	InboundMessage* message = messages_.front();
+	messages_.pop_front();
+	return message;
+}
+
+} /* namespace soundalchemy */
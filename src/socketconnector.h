@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef SOCKETCONNECTOR_H_
+#define SOCKETCONNECTOR_H_
+
+#include "clientconnector.h"
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace soundalchemy {
+
+/**
+ * @brief A client connector serving the clients of Unix domain and TCP
+ * sockets.
+ *
+ * All the listening and client sockets are non-blocking and driven by one
+ * epoll loop in the thread of the connector, so any count of clients is
+ * served by a single connector of the server. Every client negotiates its
+ * protocol by its first message like the other connectors, the JSON
+ * messages are delimited by DELIMITER.
+ *
+ * The replies are queued for each client by send() and written by the loop
+ * as the sockets can take them, the server never waits for a client. A
+ * reply is queued as the shared buffer of the serialized message, it's
+ * written from there without copying. A client with more than
+ * OUTPUT_HIGH_WATER bytes waiting isn't read until it takes its replies, and
+ * it's dropped above OUTPUT_MAX.
+ *
+ * A client sending MSG_EXIT or MSG_CLIENT_OUT is acknowledged and closed by
+ * the connector, the server and the other clients go on.
+ *
+ * The server subscribes the whole connector to the meter and the spectrum
+ * frames, so the connector tracks which of its clients are subscribed and
+ * queues the frames to them only. The server is unsubscribed when the last
+ * subscribed client unsubscribes or leaves.
+ */
+class SocketConnector: public ClientConnector {
+public:
+
+	/// The end of a JSON message on the sockets
+	static const char DELIMITER = '\n';
+
+	/// The time the loop waits for the sockets, the watcher stops in this time
+	static const int POLL_TIMEOUT_MS = 100;
+
+	/// The most clients served at once, further connections are refused
+	static const unsigned int MAX_CLIENTS = 1024;
+
+	/// Above this much queued output the input of a client isn't read
+	static const unsigned int OUTPUT_HIGH_WATER = 64 * 1024;
+
+	/// Above this much queued output a client is dropped
+	static const unsigned int OUTPUT_MAX = 1024 * 1024;
+
+	SocketConnector(const char* name = "Sockets");
+	virtual ~SocketConnector();
+
+	/**
+	 * Listens on a Unix domain socket. Has to be called before the
+	 * connector is passed to DspServer::listenOn().
+	 * @param path The path of the socket. A name starting with '@' is in
+	 * the abstract namespace, it doesn't need a writable file system.
+	 * @return Returns E_OK or E_START_LISTENER.
+	 */
+	TAlchemyError listenUnix(const char* path);
+
+	/**
+	 * Listens on a TCP port. Has to be called before the connector is passed
+	 * to DspServer::listenOn().
+	 * @param port The port.
+	 * @param address The address to listen on, the loopback interface by
+	 * default.
+	 * @return Returns E_OK or E_START_LISTENER.
+	 */
+	TAlchemyError listenTcp(unsigned short port,
+			const char* address = "127.0.0.1");
+
+	/**
+	 * Queues a message to all the clients, a frame to the subscribed ones. It
+	 * doesn't block on the sockets.
+	 */
+	virtual void send(OutboundMessage& message);
+
+	/// @return Returns the count of the connected clients.
+	unsigned int getClientsCount(void);
+
+protected:
+
+	/**
+	 * Runs the loop until a message is received or POLL_TIMEOUT_MS passes.
+	 * @return Returns the next message of the clients or NULL.
+	 */
+	virtual InboundMessage* read(void);
+
+private:
+
+	struct Client {
+		Client(int socket): fd(socket), protocol(Message::PROTOCOL_JSON),
+				negotiated(false), sent(0), pending(0), events(0),
+				dropped(false), subscriptions(0) {}
+
+		int fd;
+		Message::TProtocol protocol;
+		bool negotiated;
+
+		// bytes read but not parsed yet
+		std::string input;
+
+		// The messages queued for the client, the first sent bytes of the
+		// front one are already written. pending is the count of the bytes
+		// to write. Guarded by output_mutex_.
+		std::deque<SharedBuffer*> output;
+		size_t sent;
+		size_t pending;
+
+		// the epoll events the socket is registered for
+		unsigned int events;
+
+		// set by send() if the client can't keep up, closed by the loop
+		bool dropped;
+
+		// the bits of the frames the client is subscribed to. Guarded by
+		// output_mutex_.
+		unsigned int subscriptions;
+	};
+
+	typedef std::map<int, Client*> TClients;
+
+	// Accepts the waiting connections of a listening socket.
+	void accept(int listener);
+
+	// Reads the input of a client and parses the complete messages to
+	// messages_. Returns false if the client has to be closed.
+	bool receive(Client* client);
+
+	// Parses the complete messages of the input of a client. Returns false
+	// if the input is invalid or the client leaves.
+	bool parse(Client* client);
+
+	// Records the subscription of a client to the frames if the message is
+	// one. Returns false if the connector acknowledges the message itself as
+	// the subscription of the connector doesn't change.
+	bool subscribe(Client* client, InboundMessage& message);
+
+	// Queues a message of the connector to a client and deletes it.
+	void reply(Client* client, OutboundMessage* message);
+
+	// Counts the clients subscribed to the frames of a bit. Called with
+	// output_mutex_ locked.
+	unsigned int countSubscribers(unsigned int bit);
+
+	// Writes the queued output of a client. Returns false if the client has
+	// to be closed.
+	bool flush(Client* client);
+
+	// Registers the socket for the events the client waits for.
+	void update(Client* client);
+
+	void closeClient(Client* client);
+
+	// Queues a reference to a message to a client. Called with
+	// output_mutex_ locked.
+	void queue(Client* client, SharedBuffer* buffer);
+
+	int addListener(int fd);
+
+	int epoll_;
+	int wakeup_;
+	std::vector<int> listeners_;
+	std::vector<std::string> unix_paths_;
+
+	// The clients are added and removed by the loop. send() reads the list
+	// from the thread of the server, so the changes and the output of the
+	// clients are guarded by output_mutex_.
+	TClients clients_;
+	Mutex *output_mutex_;
+
+	// messages parsed but not passed to the server yet
+	std::deque<InboundMessage*> messages_;
+};
+
+} /* namespace soundalchemy */
+#endif /* SOCKETCONNECTOR_H_ */
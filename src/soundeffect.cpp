@@ -16,7 +16,7 @@ namespace soundalchemy {
 
 SoundEffect::SoundEffect(llaudio::TSampleRate sample_rate, const std::string name):
 		name_(name), sample_rate_(sample_rate), mutex_(Thread::getMutex()),
-		on_(true){}
+		on_(true), tail_length_(TAIL_UNKNOWN) {}
 
 SoundEffect::~SoundEffect() {
 	for(TParamVector::iterator p = params_.begin(); p != params_.end(); p++) {
@@ -79,6 +79,10 @@ unsigned int SoundEffect::getOutputsCount(void) {
 	return outputs_.size();
 }
 
+unsigned int SoundEffect::getParamsCount(void) {
+	return params_.size();
+}
+
 SoundEffect::Port * SoundEffect::getInputPort(TPortID index) {
 	if(index >= inputs_.size() ) {
 		log(LEVEL_ERROR, STR_ERRORS[E_INDEX]);
@@ -118,7 +122,7 @@ void MixerEffect::setInputsCount(unsigned int count) {
 void MixerEffect::setOutputsCount(unsigned int count) {
 
 	// do nothing if the count is already set
-	if( inputs_.size() == count ) return;
+	if( outputs_.size() == count ) return;
 
 	for(TPortVector::iterator it = outputs_.begin(); it != outputs_.end(); it++ ) {
 		delete (*it);
@@ -169,6 +169,22 @@ public:
 
 	virtual llaudio::TSampleRate getSampleRate() { return sample_rate_; }
 
+	/**
+	 * @return Returns the delay in samples the effect adds to the signal.
+	 */
+	virtual unsigned int getLatency(void) { return 0; }
+
+	/// The tail length of effects which don't declare it
+	static const unsigned int TAIL_UNKNOWN = ~0u;
+
+	/**
+	 * @return Returns the count of samples the output of the effect can be
+	 * other than silence after its input became silent, or TAIL_UNKNOWN.
+	 */
+	virtual unsigned int getTailLength(void) { return tail_length_; }
+
+	void setTailLength(unsigned int samples) { tail_length_ = samples; }
+
 	//void setId(TEffectID index) { id_ = index; }
 
 	Mutex* getMutex() { return mutex_; }
@@ -197,6 +213,8 @@ protected:
 
 	bool on_;
 
+	unsigned int tail_length_;
+
 };
 
 class MixerEffect: public SoundEffect {
@@ -12,16 +12,77 @@
 
 #ifdef __linux__
 #include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+// the private operations are missing from old kernel headers
+#ifndef FUTEX_WAIT_PRIVATE
+#define FUTEX_WAIT_PRIVATE FUTEX_WAIT
+#define FUTEX_WAKE_PRIVATE FUTEX_WAKE
 #endif
 
+// the deadline scheduling is missing from old headers
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+#ifndef SCHED_FLAG_RESET_ON_FORK
+#define SCHED_FLAG_RESET_ON_FORK 0x01
+#endif
+#endif
+
+#include <alloca.h>
 #include <errno.h>
+#include <stdint.h>
 #include <string.h>
+#include <time.h>
 
 namespace soundalchemy {
 
+// Gives the time of the monotonic clock a timeout in milliseconds ends at.
+static void deadlineAfter(timespec& deadline, int timeout) {
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += timeout / 1000;
+	deadline.tv_nsec += (timeout % 1000) * 1000000l;
+	if(deadline.tv_nsec >= 1000000000l) {
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000l;
+	}
+}
+
+// Gives the time left until a deadline. Returns false if it's passed.
+static bool timeLeft(const timespec& deadline, timespec& left) {
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	left.tv_sec = deadline.tv_sec - now.tv_sec;
+	left.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+	if(left.tv_nsec < 0) {
+		left.tv_sec--;
+		left.tv_nsec += 1000000000l;
+	}
+	return left.tv_sec >= 0;
+}
+
+// The real time threads ran with round robin scheduling at the highest
+// priority before the scheduling became configurable.
+static Thread::Scheduling realtimeScheduling(void) {
+	Thread::Scheduling s;
+	s.policy = Thread::POLICY_RR;
+	s.priority = 99;
+	s.prefault = Thread::DEFAULT_PREFAULT;
+	return s;
+}
+
+Thread::Scheduling Thread::defaults_[Thread::THREAD_CLASSES] = {
+	Thread::Scheduling(), realtimeScheduling(), realtimeScheduling()
+};
+
 Thread::Thread() {
 	returnval_ = NULL;
-	realtime_ = false;
+	class_ = THREAD_NORMAL;
+	explicit_ = false;
 }
 
 Thread::~Thread() {
@@ -58,6 +119,83 @@ Mutex * Thread::getConditionMutex(ConditionVariable& cond) {
 
 #ifdef __linux__
 
+// The attributes of sched_setattr(), the C library has no wrapper for it.
+struct SchedAttr {
+	uint32_t size;
+	uint32_t sched_policy;
+	uint64_t sched_flags;
+	int32_t sched_nice;
+	uint32_t sched_priority;
+	uint64_t sched_runtime;
+	uint64_t sched_deadline;
+	uint64_t sched_period;
+};
+
+// Touches the stack below the caller, so its pages are mapped before the
+// thread has to keep up with a deadline.
+static void __attribute__((noinline)) prefaultStack(unsigned int size) {
+	volatile char* p = (volatile char*) alloca(size);
+	for(unsigned int i = 0; i < size; i += 1024) p[i] = 0;
+}
+
+TAlchemyError Thread::lockMemory(void) {
+	if(mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+		log(LEVEL_WARNING, "%s: %s (%s)", STR_ERRORS[E_REALTIME], "mlockall",
+				strerror(errno));
+		return E_REALTIME;
+	}
+	return E_OK;
+}
+
+TAlchemyError Thread::applyScheduling(const Scheduling& scheduling) {
+	TAlchemyError ret = E_OK;
+
+	// the affinity is set first, a deadline is admitted on its CPUs
+	if(scheduling.cpus != 0) {
+		unsigned long mask = scheduling.cpus;
+		if(syscall(__NR_sched_setaffinity, 0, sizeof(mask), &mask) != 0) {
+			log(LEVEL_WARNING, "%s: %s (%s)", STR_ERRORS[E_REALTIME],
+					"affinity", strerror(errno));
+			ret = E_REALTIME;
+		}
+	}
+
+	int err = 0;
+	if(scheduling.policy == POLICY_DEADLINE) {
+#ifdef __NR_sched_setattr
+		SchedAttr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.sched_policy = SCHED_DEADLINE;
+
+		// a deadline thread may start threads only if they don't inherit it
+		attr.sched_flags = SCHED_FLAG_RESET_ON_FORK;
+		attr.sched_runtime = scheduling.runtime_us * 1000ull;
+		attr.sched_deadline = scheduling.period_us * 1000ull;
+		attr.sched_period = scheduling.period_us * 1000ull;
+		if(syscall(__NR_sched_setattr, 0, &attr, 0) != 0) err = errno;
+#else
+		err = ENOSYS;
+#endif
+	}
+	else {
+		int policy = SCHED_OTHER;
+		if(scheduling.policy == POLICY_FIFO) policy = SCHED_FIFO;
+		else if(scheduling.policy == POLICY_RR) policy = SCHED_RR;
+		sched_param p;
+		p.sched_priority = policy == SCHED_OTHER ? 0 : scheduling.priority;
+		err = pthread_setschedparam(pthread_self(), policy, &p);
+	}
+	if(err != 0) {
+		log(LEVEL_WARNING, "%s: %s (%s)", STR_ERRORS[E_REALTIME],
+				"policy", strerror(err));
+		ret = E_REALTIME;
+	}
+
+	if(scheduling.prefault > 0) prefaultStack(scheduling.prefault);
+	return ret;
+}
+
 class PthreadMutex: public Mutex {
 public:
 	PthreadMutex(int threads = 1):Mutex(threads) {
@@ -100,13 +238,25 @@ class Pthread: public Thread {
 	struct RunArg {
 		Runnable *runnable;
 		Pthread * thread;
+		bool schedule;
+		Scheduling scheduling;
 	};
 
 public:
 
 	Pthread(): Thread() {
 		thread_ = -1;
-		pthread_cond_init(&wait_cond_, NULL);
+		wakeups_ = 0;
+
+		// the timed waits are measured on the monotonic clock
+		pthread_condattr_t cond_attr;
+		pthread_condattr_init(&cond_attr);
+#ifndef HAVE_PTHREAD_COND_TIMEDWAIT_MONOTONIC
+		pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+#endif
+		pthread_cond_init(&wait_cond_, &cond_attr);
+		pthread_condattr_destroy(&cond_attr);
+
 		pthread_attr_init(&thread_attr_);
 		pthread_attr_setdetachstate(&thread_attr_,
 				PTHREAD_CREATE_JOINABLE);
@@ -118,68 +268,87 @@ public:
 		pthread_attr_destroy(&thread_attr_);
 	}
 
-	virtual void waitOn(ConditionVariable& c = COND_TRUE, int timeout = -1 ) {
+	virtual bool waitOn(ConditionVariable& c = COND_TRUE, int timeout = -1 ) {
+		PthreadMutex *pm = (PthreadMutex*) getConditionMutex(c);
 		pthread_mutex_t *m = getCondMutex(c);
-		if(m == NULL ) return;
+		if(m == NULL ) return true;
+
+		timespec deadline;
+		if(timeout > 0) deadlineAfter(deadline, timeout);
 
-		bool l = !getConditionMutex(c)->isLockedByCurrent();
+		bool l = !pm->isLockedByCurrent();
 		if(l) c.lock();
-		if(c.isTrue()) {
-			if(timeout > 0) {
-				// TODO pthread_cond_timedwait(&wait_cond_, &wait_mutex_, NULL);
-			}
+
+		// the condition and the wake ups are checked again after spurious
+		// wake ups
+		unsigned int wakeups = wakeups_;
+		bool ret = true;
+		while(c.isTrue() && wakeups == wakeups_) {
+			int err;
+			if(timeout <= 0) err = pthread_cond_wait(&wait_cond_, m);
 			else {
-				pthread_cond_wait( &wait_cond_, m);
+#ifdef HAVE_PTHREAD_COND_TIMEDWAIT_MONOTONIC
+				err = pthread_cond_timedwait_monotonic_np(&wait_cond_, m,
+						&deadline);
+#else
+				err = pthread_cond_timedwait(&wait_cond_, m, &deadline);
+#endif
+			}
+
+			// the mutex was released meanwhile, it's owned again
+			pm->locked_ = true;
+			pm->owner_ = pthread_self();
+
+			if(err == ETIMEDOUT) {
+				ret = !c.isTrue() || wakeups != wakeups_;
+				break;
 			}
 		}
-		if(l) c.unlock();
 
+		if(l) c.unlock();
+		return ret;
 	}
 
 	virtual TAlchemyError _run(Runnable& r) {
+		bool schedule = explicit_ || class_ != THREAD_NORMAL;
+
+		if(thread_ == pthread_self()) {
+			TAlchemyError retval = E_OK;
+			if(schedule) retval = applyScheduling(getScheduling());
+			returnval_ = r.run();
+			return retval;
+		}
+
 		RunArg *arg = new RunArg();
 		arg->runnable = &r;
 		arg->thread = this;
-		int ret = 0;
-		TAlchemyError retval = E_OK;
-
-		if( thread_ != pthread_self()) {
-			ret = pthread_create(&thread_, &thread_attr_, proc, arg );
-			if( ret == EPERM ){
-				log(LEVEL_WARNING, "%s %s", STR_ERRORS[E_REALTIME], "based on EPERM");
-				retval = E_REALTIME;
-			}else if( ret) {
-				log(LEVEL_ERROR, STR_ERRORS[E_THREAD]);
-				retval = E_THREAD;
-			}else if(realtime_) {
-
-				int policy;
-				sched_param p;
-				p.sched_priority = 99;
-				int schedret = pthread_setschedparam(thread_, SCHED_RR, &p);
-
-					log(LEVEL_ERROR, strerror(schedret));
-
-//				pthread_attr_getschedparam(&thread_attr_, &p);
-//				pthread_attr_getschedpolicy(&thread_attr_, &policy);
-				pthread_getschedparam(thread_, &policy, &p);
-				if(policy != SCHED_RR || p.sched_priority != 99) {
-
-					log(LEVEL_WARNING, "Cannot set real time priority!");
-					retval = E_REALTIME;
-				}
-			}
+		arg->schedule = schedule;
+		arg->scheduling = getScheduling();
+		scheduled_.reset();
+
+		int ret = pthread_create(&thread_, &thread_attr_, proc, arg);
+		if(ret) {
+			log(LEVEL_ERROR, "%s (%s)", STR_ERRORS[E_THREAD], strerror(ret));
+			delete arg;
+			running_cond_.lock(); running_cond_.running_ = false;
+			running_cond_.unlock();
+			return E_THREAD;
 		}
-		else returnval_ = r.run();
 
-		return retval;
+		// the thread schedules itself, it's known if it worked before it
+		// runs the runnable
+		if(!schedule) return E_OK;
+		scheduled_.wait();
+		return scheduling_result_;
 	}
 
 	int wakeUp(void) {
+		__sync_add_and_fetch(&wakeups_, 1);
 		return pthread_cond_signal(&wait_cond_);
 	}
 
 	int wakeUpAll(void) {
+		__sync_add_and_fetch(&wakeups_, 1);
 		return pthread_cond_broadcast(&wait_cond_);
 	}
 
@@ -189,27 +358,6 @@ public:
 		return ret;
 	}
 
-	virtual int setRealtime(bool realtime = true) {
-//		struct sched_param schp;
-//		schp.sched_priority = 1;
-//
-//		if( sched_setscheduler(0, SCHED_RR, &schp) != 0 )
-//		{
-//			log(LEVEL_WARNING, "Cannot set real time policy!");
-//		}
-//		else if( sched_getscheduler(0) != SCHED_RR )
-//		{
-//			log(LEVEL_WARNING,"Cannot set real time policy!");
-//		}
-		realtime_ = true;
-		sched_param p;
-		p.sched_priority = 99;
-		int ret = pthread_attr_setschedpolicy(&thread_attr_, SCHED_RR);
-		pthread_attr_setschedparam(&thread_attr_, &p);
-		return ret;
-	}
-
-
 private:
 
 	pthread_mutex_t* getCondMutex(ConditionVariable& c) {
@@ -219,6 +367,11 @@ private:
 
 	static void* proc(void* arg) {
 		RunArg *rarg = (RunArg*) arg;
+		if(rarg->schedule) {
+			rarg->thread->scheduling_result_ =
+					applyScheduling(rarg->scheduling);
+			rarg->thread->scheduled_.post();
+		}
 		rarg->thread->returnval_ = rarg->runnable->run();
 		void* ret = rarg->thread->returnval_;
 		rarg->thread->running_cond_.lock();
@@ -233,10 +386,59 @@ private:
 	pthread_cond_t wait_cond_;
 	pthread_attr_t thread_attr_;
 
+	// counts the wakeUp() calls, a wait ends on them even if its condition
+	// is still true
+	volatile unsigned int wakeups_;
+
+	// the result of the scheduling posted by the new thread
+	TAlchemyError scheduling_result_;
+	Semaphore scheduled_;
+
 	friend class Thread;
 };
 
 
+static int futex(volatile int* address, int op, int value,
+		const timespec* timeout) {
+	return syscall(__NR_futex, address, op, value, timeout, NULL, 0);
+}
+
+void Semaphore::post(void) {
+	__sync_add_and_fetch(&count_, 1);
+	if(waiters_ > 0) futex(&count_, FUTEX_WAKE_PRIVATE, 1, NULL);
+}
+
+bool Semaphore::tryWait(void) {
+	int count;
+	while((count = count_) > 0) {
+		if(__sync_bool_compare_and_swap(&count_, count, count - 1))
+			return true;
+	}
+	return false;
+}
+
+bool Semaphore::wait(int timeout) {
+	timespec deadline;
+	if(timeout >= 0) deadlineAfter(deadline, timeout);
+
+	while(!tryWait()) {
+		timespec left;
+		timespec *limit = NULL;
+		if(timeout >= 0) {
+			if(!timeLeft(deadline, left)) return false;
+			limit = &left;
+		}
+
+		// The post after the increment of the waiters wakes this thread up,
+		// the one before it leaves the count positive and the wait returns
+		// at once.
+		__sync_add_and_fetch(&waiters_, 1);
+		futex(&count_, FUTEX_WAIT_PRIVATE, 0, limit);
+		__sync_sub_and_fetch(&waiters_, 1);
+	}
+	return true;
+}
+
 #endif
 
 
@@ -62,6 +62,43 @@ protected:
 
 extern ConditionVariable COND_TRUE;
 
+/**
+ * @brief A counting semaphore on a futex.
+ *
+ * post() never blocks and makes a system call only if a thread waits, so
+ * the processing thread can use it to notify other threads.
+ */
+class Semaphore {
+public:
+	Semaphore(): count_(0), waiters_(0) {}
+
+	/**
+	 * Increments the count and wakes a waiting thread.
+	 */
+	void post(void);
+
+	/**
+	 * Waits until the count is positive and decrements it.
+	 * @param timeout The longest wait in milliseconds, negative to wait
+	 * without limit.
+	 * @return Returns false if the timeout expired.
+	 */
+	bool wait(int timeout = -1);
+
+	/**
+	 * Decrements the count if it's positive without waiting.
+	 * @return Returns false if the count was 0.
+	 */
+	bool tryWait(void);
+
+	/// Drops the posts which haven't been waited for.
+	void reset(void) { while(tryWait()) ; }
+
+private:
+	volatile int count_;
+	volatile int waiters_;
+};
+
 class Thread {
 protected:
 	class RunCondition: public ConditionVariable {
@@ -72,21 +109,118 @@ protected:
 	} running_cond_;
 public:
 
+	/// Scheduling policies of the threads
+	typedef enum e_policies {
+		POLICY_OTHER,    //!< the default time sharing
+		POLICY_FIFO,     //!< real time, first in first out
+		POLICY_RR,       //!< real time, round robin
+		POLICY_DEADLINE  //!< earliest deadline first with a runtime budget
+	} TPolicy;
+
+	/// Threads of a class get the same scheduling by default.
+	typedef enum e_thread_classes {
+		THREAD_NORMAL,   //!< threads without real time requirements
+		THREAD_DSP,      //!< the processing thread
+		THREAD_WORKER,   //!< the other real time threads, e.g. device bridges
+		THREAD_CLASSES
+	} TThreadClass;
+
+	/**
+	 * The scheduling of a thread. It's applied by the thread itself when it
+	 * starts.
+	 */
+	struct Scheduling {
+		TPolicy policy;
+		int priority;             //!< for FIFO and RR, 1 to 99
+		unsigned long runtime_us; //!< for DEADLINE, the budget of a period
+		unsigned long period_us;  //!< for DEADLINE, also the deadline
+		unsigned long cpus;       //!< the allowed CPUs as bits, 0 is any
+		unsigned int prefault;    //!< bytes of the stack touched at start
+
+		Scheduling(): policy(POLICY_OTHER), priority(0), runtime_us(0),
+			period_us(0), cpus(0), prefault(0) {}
+	};
+
+	/// Bytes of the stack of a real time thread touched at its start by
+	/// default, so it doesn't page fault later
+	static const unsigned int DEFAULT_PREFAULT = 65536;
+
 	Thread();
 
 	virtual ~Thread();
 
-	virtual void waitOn(ConditionVariable& c, int timeout = -1 ) = 0;
-	void waitOn(int timeout = -1) {
-		this->waitOn(running_cond_);
+	/**
+	 * Waits while a condition is true until wakeUp() or wakeUpAll() is called.
+	 * Spurious wake ups don't end the wait, the condition is checked again.
+	 * @param c The condition, it's locked by the call if the caller hasn't
+	 * locked it.
+	 * @param timeout The longest wait in milliseconds on the monotonic clock,
+	 * 0 or negative to wait without limit.
+	 * @return Returns false if the timeout expired before the condition turned
+	 * false or a wake up came.
+	 */
+	virtual bool waitOn(ConditionVariable& c, int timeout = -1 ) = 0;
+
+	/// Waits while the thread runs.
+	bool waitOn(int timeout = -1) {
+		return this->waitOn(running_cond_, timeout);
 	}
 	virtual int wakeUp(void) = 0;
 	virtual int wakeUpAll(void) = 0;
 	virtual void* join() = 0;
-	virtual int setRealtime(bool realtime = true) = 0;
+
+	/**
+	 * Makes the thread run with the default scheduling of a class, the
+	 * default is resolved when the thread starts.
+	 * @param thread_class The class of the thread.
+	 */
+	void setRealtime(TThreadClass thread_class = THREAD_DSP) {
+		class_ = thread_class;
+		explicit_ = false;
+	}
+
+	/**
+	 * Sets the scheduling of the thread instead of the default of its class.
+	 * It's applied by the next run().
+	 */
+	void setScheduling(const Scheduling& scheduling) {
+		scheduling_ = scheduling;
+		explicit_ = true;
+	}
+
+	/// @return Returns the scheduling the thread starts with.
+	const Scheduling& getScheduling(void) {
+		return explicit_ ? scheduling_ : defaults_[class_];
+	}
+
+	/**
+	 * Sets the default scheduling of a class of threads. The threads started
+	 * later get it.
+	 */
+	static void setDefaultScheduling(TThreadClass thread_class,
+			const Scheduling& scheduling) {
+		defaults_[thread_class] = scheduling;
+	}
+
+	static const Scheduling& getDefaultScheduling(TThreadClass thread_class) {
+		return defaults_[thread_class];
+	}
+
+	/**
+	 * Locks the current and the future memory of the process, so the real
+	 * time threads don't wait for paging.
+	 * @return Returns E_OK or E_REALTIME if it's not permitted.
+	 */
+	static TAlchemyError lockMemory(void);
 
 	bool isRunning(void);
 
+	/**
+	 * Starts the thread. It applies its scheduling first and the call
+	 * returns after that.
+	 * @return Returns E_OK, E_THREAD if it couldn't be started or
+	 * E_REALTIME if it runs without the requested scheduling.
+	 */
 	TAlchemyError run(Runnable& r);
 
 	void* getReturnValue(void) { return returnval_; }
@@ -98,9 +232,18 @@ public:
 protected:
 	Mutex * getConditionMutex(ConditionVariable& cond);
 	virtual TAlchemyError _run(Runnable& r) = 0;
+
+	// Applies the scheduling to the calling thread. Returns E_REALTIME if
+	// any part of it failed.
+	static TAlchemyError applyScheduling(const Scheduling& scheduling);
+
 	void* returnval_;
-	bool realtime_;
 
+	TThreadClass class_;
+	Scheduling scheduling_;
+	bool explicit_;
+
+	static Scheduling defaults_[THREAD_CLASSES];
 };
 
 } /* namespace llaudio */
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#include "tuner.h"
+#include "simd.h"
+#include <cmath>
+#include <cstring>
+#include <unistd.h>
+
+namespace soundalchemy {
+
+static NativeEffect::Registrar registrar("tuner", Tuner::create);
+
+const float Tuner::MIN_FREQUENCY = 40.0f;
+const float Tuner::MAX_FREQUENCY = 1400.0f;
+
+Tuner::Listener* volatile Tuner::listener_ = NULL;
+
+// the threshold of the normalized difference of YIN
+static const float THRESHOLD = 0.15f;
+
+// a normalized difference above this is no pitch
+static const float UNPITCHED = 0.5f;
+
+// the mean power of a signal regarded as silence, -60 dB
+static const float SILENCE_POWER = 1e-6f;
+
+// the range of the reference pitch of A4
+static const float REFERENCE_MIN = 415.0f;
+static const float REFERENCE_MAX = 466.0f;
+static const float REFERENCE_DEFAULT = 440.0f;
+
+// the parameters in the order they are added
+enum {
+	PARAM_MUTE,
+	PARAM_REFERENCE
+};
+
+Tuner::Tuner(llaudio::TSampleRate sample_rate):
+		NativeEffect(sample_rate, "Tuner"), worker_(*this),
+		thread_(Thread::getNewThread()), running_(false), window_(0),
+		filled_(0) {
+
+	addParam(new NativeParam("mute", 1.0f, 0.0f, 1.0f, Param::PARAM_TOGGLE));
+	addParam(new NativeParam("reference", REFERENCE_DEFAULT, REFERENCE_MIN,
+			REFERENCE_MAX));
+
+	addPort(new NativePort(INPUT_PORT, "input"));
+	addPort(new NativePort(OUTPUT_PORT, "output"));
+
+	setWindow();
+}
+
+Tuner::~Tuner() {
+	deactivate();
+	delete thread_;
+}
+
+NativeEffect* Tuner::create(llaudio::TSampleRate sample_rate) {
+	return new Tuner(sample_rate);
+}
+
+void Tuner::setWindow(void) {
+	// the longest period has to fit in the window, the window is rounded up
+	// to whole vectors
+	window_ = (unsigned int) (sample_rate_ / MIN_FREQUENCY) + 1;
+	window_ = (window_ + simd::LANES - 1) / simd::LANES * simd::LANES;
+
+	history_.assign(2 * window_, 0.0f);
+	diff_.assign(window_ + 1, 0.0f);
+	cmnd_.assign(window_ + 1, 1.0f);
+	filled_ = 0;
+}
+
+void Tuner::activate(void) {
+	if(running_) return;
+
+	ring_.read(NULL, ring_.getAvailable());
+	filled_ = 0;
+	worker_.reset();
+	running_ = thread_->run(worker_) == E_OK;
+}
+
+void Tuner::deactivate(void) {
+	if(!running_) return;
+
+	worker_.exit();
+	thread_->join();
+	running_ = false;
+}
+
+void Tuner::setSampleRate(llaudio::TSampleRate srate) {
+	bool running = running_;
+	deactivate();
+	NativeEffect::setSampleRate(srate);
+	setWindow();
+	if(running) activate();
+}
+
+void Tuner::process(unsigned int sample_count) {
+	TSample *in = inputs_[0]->getBuffer();
+	TSample *out = outputs_[0]->getBuffer();
+
+	// the detection runs in the worker, the samples which don't fit in the
+	// ring are lost for it
+	ring_.write(in, sample_count);
+
+	if(params_[PARAM_MUTE]->getValue() >= 0.5f)
+		memset(out, 0, sample_count * sizeof(TSample));
+	else if(out != in)
+		memcpy(out, in, sample_count * sizeof(TSample));
+}
+
+void* Tuner::Worker::run(void) {
+	Tuner& t = tuner_;
+	unsigned int size = t.history_.size();
+
+	while(!exit_) {
+		usleep(READING_PERIOD_MS * 1000);
+
+		// keep the latest samples of the ring
+		unsigned int available = t.ring_.getAvailable();
+		if(available > size) {
+			t.ring_.read(NULL, available - size);
+			available = size;
+		}
+		memmove(&t.history_[0], &t.history_[available],
+				(size - available) * sizeof(float));
+		t.ring_.read(&t.history_[size - available], available);
+
+		// nothing new while the effect isn't processed or bypassed
+		if(available == 0) continue;
+
+		t.filled_ += available;
+		if(t.filled_ < size) continue;
+		t.filled_ = size;
+
+		Reading reading;
+		t.detect(&t.history_[0], reading);
+
+		Listener *listener = listener_;
+		if(listener != NULL) listener->tuned(&t, reading);
+	}
+
+	return NULL;
+}
+
+void Tuner::detect(const float* x, Reading& reading) {
+	reading.frequency = 0.0f;
+	reading.cents = 0.0f;
+	reading.note = 0;
+	reading.confidence = 0.0f;
+
+	unsigned int w = window_;
+	float energy = simd::dot(x, x, w);
+	if(energy < SILENCE_POWER * w) return;
+
+	// The difference function of YIN from the autocorrelation:
+	// d(tau) = sum (x[j] - x[j+tau])^2 = e(0) + e(tau) - 2 r(tau)
+	// where e(tau) is the energy of the window starting at tau. The
+	// cumulative mean normalized difference is computed on the fly.
+	unsigned int tau_min = (unsigned int) (sample_rate_ / MAX_FREQUENCY);
+	if(tau_min < 2) tau_min = 2;
+
+	float shifted = energy;
+	float sum = 0.0f;
+	cmnd_[0] = 1.0f;
+	for(unsigned int tau = 1; tau <= w; tau++) {
+		shifted += x[tau + w - 1] * x[tau + w - 1] - x[tau - 1] * x[tau - 1];
+		float d = energy + shifted - 2.0f * simd::dot(x, x + tau, w);
+		if(d < 0.0f) d = 0.0f;
+		sum += d;
+		diff_[tau] = d;
+		cmnd_[tau] = sum > 0.0f ? d * tau / sum : 1.0f;
+	}
+
+	// the first dip below the threshold, or the deepest one
+	unsigned int best = 0;
+	for(unsigned int tau = tau_min; tau < w; tau++) {
+		if(cmnd_[tau] < THRESHOLD) {
+			while(tau + 1 < w && cmnd_[tau + 1] < cmnd_[tau]) tau++;
+			best = tau;
+			break;
+		}
+		if(best == 0 || cmnd_[tau] < cmnd_[best]) best = tau;
+	}
+	if(best == 0 || cmnd_[best] > UNPITCHED) return;
+
+	// parabolic interpolation of the minimum of the difference between the
+	// lags, the normalized difference is biased towards the longer lags
+	float period = best;
+	if(best > 1 && best < w) {
+		float a = diff_[best - 1];
+		float b = diff_[best];
+		float c = diff_[best + 1];
+		float div = a - 2.0f * b + c;
+		if(div > 0.0f) period += 0.5f * (a - c) / div;
+	}
+
+	float reference = params_[PARAM_REFERENCE]->getValue();
+	float note = 69.0f + 12.0f * log2f(sample_rate_ / period / reference);
+	reading.frequency = sample_rate_ / period;
+	reading.note = (int) floorf(note + 0.5f);
+	reading.cents = (note - reading.note) * 100.0f;
+	reading.confidence = 1.0f - cmnd_[best];
+}
+
+} /* namespace soundalchemy */
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2013 Mészáros Tamás.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Public License v2.0
+ * which accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ *
+ * Contributors:
+ *     Mészáros Tamás - initial API and implementation
+ */
+#ifndef TUNER_H_
+#define TUNER_H_
+
+#include "nativeeffect.h"
+#include "analyzer.h"
+#include "thread.h"
+#include <vector>
+
+namespace soundalchemy {
+
+/**
+ * @brief A guitar tuner detecting the pitch of its mono input.
+ *
+ * The processing only copies the input into a SampleRing, the pitch is
+ * detected by a worker thread of the effect with the YIN algorithm on the
+ * latest window of the signal every READING_PERIOD_MS. The difference
+ * function of YIN is computed from SIMD autocorrelations. The readings are
+ * passed to the Listener set for all the tuners.
+ *
+ * The output is muted while the mute parameter is on, the tuner can be
+ * left in the chain switched off with the bypass of the effect.
+ */
+class Tuner: public NativeEffect {
+public:
+
+	/// The period of the readings, 20 in a second
+	static const unsigned int READING_PERIOD_MS = 50;
+
+	/// The range of the detected pitch in Hz
+	static const float MIN_FREQUENCY;
+	static const float MAX_FREQUENCY;
+
+	/// The result of a detection
+	struct Reading {
+		float frequency;  //!< 0 if no pitch is detected
+		float cents;      //!< deviation from the nearest note
+		int note;         //!< the nearest note as a MIDI note number
+		float confidence; //!< between 0 and 1
+	};
+
+	/**
+	 * Receives the readings of the tuners. It's called from the worker
+	 * thread of the tuner.
+	 */
+	class Listener {
+	public:
+		virtual ~Listener() {}
+		virtual void tuned(SoundEffect* tuner, const Reading& reading) = 0;
+	};
+
+	/**
+	 * Sets the listener of all the tuners.
+	 * @param listener The listener or NULL.
+	 */
+	static void setListener(Listener* listener) { listener_ = listener; }
+
+	Tuner(llaudio::TSampleRate sample_rate);
+	virtual ~Tuner();
+
+	static NativeEffect* create(llaudio::TSampleRate sample_rate);
+
+	void process(unsigned int sample_count);
+
+	// The worker runs while the effect is active.
+	void activate(void);
+	void deactivate(void);
+
+	void setSampleRate(llaudio::TSampleRate srate);
+
+	/**
+	 * Detects the pitch of a window of samples.
+	 * @param samples 2 * getWindow() samples.
+	 * @param reading The result.
+	 */
+	void detect(const float* samples, Reading& reading);
+
+	/// @return Returns the count of samples integrated by the detection.
+	unsigned int getWindow(void) { return window_; }
+
+private:
+
+	class Worker: public Runnable {
+	public:
+		Worker(Tuner& tuner): tuner_(tuner), exit_(false) {}
+
+		void* run(void);
+
+		void reset(void) { exit_ = false; }
+		void exit(void) { exit_ = true; }
+
+	private:
+		Tuner& tuner_;
+		volatile bool exit_;
+	} worker_;
+
+	// sets up the buffers of the detection for the sample rate
+	void setWindow(void);
+
+	static Listener* volatile listener_;
+
+	Thread* thread_;
+	bool running_;
+
+	SampleRing ring_;
+
+	// The window integrated by the detection. The latest 2 * window_ samples
+	// are kept in history_, filled_ counts them until it's full.
+	unsigned int window_;
+	unsigned int filled_;
+	std::vector<float> history_;
+
+	// the difference and the cumulative mean normalized difference for
+	// each lag
+	std::vector<float> diff_;
+	std::vector<float> cmnd_;
+};
+
+} /* namespace soundalchemy */
+#endif /* TUNER_H_ */